@@ -0,0 +1,242 @@
+#ifndef A2D_BENCHMARK_H
+#define A2D_BENCHMARK_H
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <ctime>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace A2D {
+
+namespace Benchmark {
+
+// Prevent the compiler from optimizing away a value
+template <typename T>
+inline void do_not_optimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+  asm volatile("" : : "r,m"(value) : "memory");
+#else
+  static volatile const void* sink;
+  sink = &value;
+#endif
+}
+
+struct Options {
+  std::string filter;       // only run the cases that contain this string
+  double min_time = 0.1;    // minimum time of each repetition in s
+  int repetitions = 5;      // number of timed repetitions
+  int max_iterations = 1000000000;
+  bool list = false;
+};
+
+/**
+ * @brief Statistics of one benchmark case
+ *
+ * The times are for a single iteration of the kernel, the counters are per
+ * iteration and are reported as rates (e.g. flops/s) in the output.
+ */
+struct Result {
+  std::string name;
+  long iterations = 0;
+  double min = 0.0, median = 0.0, mean = 0.0, stddev = 0.0;  // in s
+  std::map<std::string, double> counters;
+  bool skipped = false;
+};
+
+/**
+ * @brief Handle passed to each benchmark case
+ *
+ * A case performs its setup, sets the counters for one iteration and then
+ * calls run() with the kernel to be timed:
+ *
+ * void bench(Benchmark::State& state) {
+ *   ... setup ...
+ *   state.counter("flops", 2.0 * n);
+ *   state.run([&]() { kernel(); });
+ * }
+ */
+class State {
+ public:
+  State(const Options& options, Result& result)
+      : options(options), result(result) {}
+
+  // Set a counter per iteration, reported as a rate
+  void counter(const std::string& name, double value) {
+    result.counters[name] = value;
+  }
+
+  // Skip the case, for instance when the problem is too large
+  void skip() { result.skipped = true; }
+
+  /**
+   * @brief Time the kernel
+   *
+   * The number of iterations of each repetition is chosen so that each
+   * repetition takes at least the minimum time.
+   */
+  template <class Kernel>
+  void run(Kernel&& kernel) {
+    // Warm up and estimate the number of iterations
+    long iters = 1;
+    double t = time(kernel, iters);
+    while (t < options.min_time && iters < options.max_iterations) {
+      long next = t > 0.0 ? long(1.2 * iters * options.min_time / t) : 0;
+      iters = std::min<long>(std::max(next, 2 * iters), options.max_iterations);
+      t = time(kernel, iters);
+    }
+
+    std::vector<double> samples(options.repetitions);
+    for (double& s : samples) {
+      s = time(kernel, iters) / iters;
+    }
+
+    std::sort(samples.begin(), samples.end());
+    const int n = samples.size();
+    result.iterations = iters;
+    result.min = samples[0];
+    result.median = n % 2 ? samples[n / 2]
+                          : 0.5 * (samples[n / 2 - 1] + samples[n / 2]);
+    result.mean = 0.0;
+    for (double s : samples) {
+      result.mean += s / n;
+    }
+    result.stddev = 0.0;
+    for (double s : samples) {
+      result.stddev += (s - result.mean) * (s - result.mean) / n;
+    }
+    result.stddev = std::sqrt(result.stddev);
+  }
+
+ private:
+  template <class Kernel>
+  static double time(Kernel& kernel, long iters) {
+    auto t0 = std::chrono::steady_clock::now();
+    for (long i = 0; i < iters; i++) {
+      kernel();
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(t1 - t0).count();
+  }
+
+  const Options& options;
+  Result& result;
+};
+
+/**
+ * @brief The list of registered benchmark cases
+ */
+class Registry {
+ public:
+  using Func = std::function<void(State&)>;
+
+  void add(const std::string& name, Func func) {
+    cases.push_back({name, func});
+  }
+
+  // Run the cases that match the filter and print a table as they finish
+  std::vector<Result> run(const Options& options) const {
+    std::vector<Result> results;
+    if (!options.list) {
+      std::printf("%-56s %12s %12s %12s %10s %10s\n", "benchmark", "median(us)",
+                  "min(us)", "iterations", "GFLOP/s", "GB/s");
+    }
+    for (const auto& c : cases) {
+      if (c.first.find(options.filter) == std::string::npos) {
+        continue;
+      }
+      if (options.list) {
+        std::printf("%s\n", c.first.c_str());
+        continue;
+      }
+
+      Result result;
+      result.name = c.first;
+      State state(options, result);
+      c.second(state);
+      if (result.skipped) {
+        continue;
+      }
+
+      auto rate = [&](const char* name) {
+        auto it = result.counters.find(name);
+        return it == result.counters.end() ? 0.0
+                                           : 1e-9 * it->second / result.median;
+      };
+      std::printf("%-56s %12.3f %12.3f %12ld %10.3f %10.3f\n",
+                  result.name.c_str(), 1e6 * result.median, 1e6 * result.min,
+                  result.iterations, rate("flops"), rate("bytes"));
+      std::fflush(stdout);
+      results.push_back(result);
+    }
+    return results;
+  }
+
+  // Write the results in a JSON format similar to Google Benchmark
+  static void write_json(const std::string& filename,
+                         const std::vector<Result>& results) {
+    std::FILE* fp = std::fopen(filename.c_str(), "w");
+    if (!fp) {
+      std::fprintf(stderr, "cannot open %s\n", filename.c_str());
+      return;
+    }
+
+    auto now = std::chrono::system_clock::now();
+    std::time_t now_time = std::chrono::system_clock::to_time_t(now);
+    char date[64];
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S",
+                  std::localtime(&now_time));
+
+    int num_threads = 1;
+#ifdef _OPENMP
+    num_threads = omp_get_max_threads();
+#endif
+
+    std::fprintf(fp, "{\n  \"context\": {\n");
+    std::fprintf(fp, "    \"date\": \"%s\",\n", date);
+    std::fprintf(fp, "    \"num_threads\": %d,\n", num_threads);
+#ifdef NDEBUG
+    std::fprintf(fp, "    \"library_build_type\": \"release\",\n");
+#else
+    std::fprintf(fp, "    \"library_build_type\": \"debug\",\n");
+#endif
+    std::fprintf(fp, "    \"time_unit\": \"us\"\n  },\n");
+    std::fprintf(fp, "  \"benchmarks\": [");
+    for (std::size_t i = 0; i < results.size(); i++) {
+      const Result& r = results[i];
+      std::fprintf(fp, "%s\n    {\n", i > 0 ? "," : "");
+      std::fprintf(fp, "      \"name\": \"%s\",\n", r.name.c_str());
+      std::fprintf(fp, "      \"iterations\": %ld,\n", r.iterations);
+      std::fprintf(fp, "      \"real_time\": %.6e,\n", 1e6 * r.median);
+      std::fprintf(fp, "      \"min_time\": %.6e,\n", 1e6 * r.min);
+      std::fprintf(fp, "      \"mean_time\": %.6e,\n", 1e6 * r.mean);
+      std::fprintf(fp, "      \"stddev_time\": %.6e,\n", 1e6 * r.stddev);
+      std::fprintf(fp, "      \"time_unit\": \"us\"");
+      for (const auto& c : r.counters) {
+        std::fprintf(fp, ",\n      \"%s\": %.6e", c.first.c_str(), c.second);
+        std::fprintf(fp, ",\n      \"%s_per_second\": %.6e", c.first.c_str(),
+                     c.second / r.median);
+      }
+      std::fprintf(fp, "\n    }");
+    }
+    std::fprintf(fp, "\n  ]\n}\n");
+    std::fclose(fp);
+  }
+
+ private:
+  std::vector<std::pair<std::string, Func>> cases;
+};
+
+}  // namespace Benchmark
+
+}  // namespace A2D
+
+#endif  // A2D_BENCHMARK_H
@@ -0,0 +1,70 @@
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "Kokkos_Core.hpp"
+#include "a2d_benchmark.h"
+#include "bench_ad.h"
+#include "bench_assembly.h"
+#include "bench_sparse.h"
+#include "utils/a2dprofiler.h"
+
+using namespace A2D;
+
+/*
+  Run the A2D benchmark suite
+
+  Usage: ./a2d_benchmarks [options]
+
+  --filter=<string>    only run the benchmarks whose name contains the string
+  --min_time=<s>       minimum time of each repetition (default 0.1)
+  --repetitions=<n>    number of timed repetitions (default 5)
+  --json=<file>        write the results to a JSON file
+  --list               list the benchmarks without running them
+*/
+int main(int argc, char* argv[]) {
+  Benchmark::Options options;
+  std::string json;
+
+  for (int i = 1; i < argc; i++) {
+    std::string arg(argv[i]);
+    auto value = [&](const char* key) -> const char* {
+      std::size_t len = std::strlen(key);
+      if (arg.compare(0, len, key) == 0) {
+        return argv[i] + len;
+      }
+      return nullptr;
+    };
+
+    if (const char* v = value("--filter=")) {
+      options.filter = v;
+    } else if (const char* v = value("--min_time=")) {
+      options.min_time = std::atof(v);
+    } else if (const char* v = value("--repetitions=")) {
+      options.repetitions = std::max(1, std::atoi(v));
+    } else if (const char* v = value("--json=")) {
+      json = v;
+    } else if (arg == "--list") {
+      options.list = true;
+    }
+  }
+
+  // The profiler would be included in the timings
+  Timer::off();
+
+  Kokkos::initialize();
+  {
+    Benchmark::Registry registry;
+    Benchmark::register_ad_benchmarks(registry);
+    Benchmark::register_assembly_benchmarks(registry);
+    Benchmark::register_sparse_benchmarks(registry);
+
+    auto results = registry.run(options);
+    if (!json.empty()) {
+      Benchmark::Registry::write_json(json, results);
+    }
+  }
+  Kokkos::finalize();
+
+  return 0;
+}
@@ -0,0 +1,153 @@
+#ifndef A2D_BENCH_AD_H
+#define A2D_BENCH_AD_H
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "a2d_benchmark.h"
+#include "a2dcore.h"
+
+namespace A2D {
+
+namespace Benchmark {
+
+// Number of independent inputs evaluated in each iteration
+constexpr int nbatch = 256;
+
+template <typename T, class MatType>
+std::vector<MatType> random_matrices(int n) {
+  std::mt19937 gen(1234);
+  std::uniform_real_distribution<T> distr(-1.0, 1.0);
+  std::vector<MatType> mats(n);
+  for (MatType& m : mats) {
+    for (int i = 0; i < MatType::ncomp; i++) {
+      m[i] = distr(gen);
+    }
+  }
+  return mats;
+}
+
+// C = A * B with the core kernel
+template <typename T, int N>
+void bench_matmatmult(State& state) {
+  auto A = random_matrices<T, Mat<T, N, N>>(nbatch);
+  auto B = random_matrices<T, Mat<T, N, N>>(nbatch);
+  std::vector<Mat<T, N, N>> C(nbatch);
+
+  state.counter("flops", 2.0 * N * N * N * nbatch);
+  state.run([&]() {
+    for (int i = 0; i < nbatch; i++) {
+      MatMatMultCore<T, N, N, N, N, N, N>(get_data(A[i]), get_data(B[i]),
+                                          get_data(C[i]));
+    }
+    do_not_optimize(C[0]);
+  });
+}
+
+// S = 2 * mu * E + lambda * tr(E) * I
+template <typename T, int N, ADorder order>
+void bench_symisotropic(State& state) {
+  const T mu = 0.7, lambda = 1.3;
+  auto E = random_matrices<T, SymMat<T, N>>(nbatch);
+  auto Sb = random_matrices<T, SymMat<T, N>>(nbatch);
+  auto Ep = random_matrices<T, SymMat<T, N>>(nbatch);
+  std::vector<SymMat<T, N>> S(nbatch);
+
+  state.run([&]() {
+    for (int i = 0; i < nbatch; i++) {
+      if constexpr (order == ADorder::ZERO) {
+        SymIsotropic(mu, lambda, E[i], S[i]);
+      } else if constexpr (order == ADorder::FIRST) {
+        ADObj<SymMat<T, N>> Eobj(E[i]), Sobj;
+        auto stack = MakeStack(SymIsotropic(mu, lambda, Eobj, Sobj));
+        Sobj.bvalue() = Sb[i];
+        stack.reverse();
+        S[i] = Eobj.bvalue();
+      } else {
+        A2DObj<SymMat<T, N>> Eobj(E[i]), Sobj;
+        auto stack = MakeStack(SymIsotropic(mu, lambda, Eobj, Sobj));
+        Sobj.bvalue() = Sb[i];
+        Eobj.pvalue() = Ep[i];
+        stack.hproduct();
+        S[i] = Eobj.hvalue();
+      }
+    }
+    do_not_optimize(S[0]);
+  });
+}
+
+// E = 0.5 * (Ux + Ux^T + Ux^T * Ux)
+template <typename T, int N, GreenStrainType etype, ADorder order>
+void bench_greenstrain(State& state) {
+  auto Ux = random_matrices<T, Mat<T, N, N>>(nbatch);
+  auto Up = random_matrices<T, Mat<T, N, N>>(nbatch);
+  auto Eb = random_matrices<T, SymMat<T, N>>(nbatch);
+  std::vector<SymMat<T, N>> E(nbatch);
+  std::vector<Mat<T, N, N>> Uh(nbatch);
+
+  state.run([&]() {
+    for (int i = 0; i < nbatch; i++) {
+      if constexpr (order == ADorder::ZERO) {
+        MatGreenStrain<etype>(Ux[i], E[i]);
+      } else if constexpr (order == ADorder::FIRST) {
+        ADObj<Mat<T, N, N>> Uobj(Ux[i]);
+        ADObj<SymMat<T, N>> Eobj;
+        auto stack = MakeStack(MatGreenStrain<etype>(Uobj, Eobj));
+        Eobj.bvalue() = Eb[i];
+        stack.reverse();
+        Uh[i] = Uobj.bvalue();
+      } else {
+        A2DObj<Mat<T, N, N>> Uobj(Ux[i]);
+        A2DObj<SymMat<T, N>> Eobj;
+        auto stack = MakeStack(MatGreenStrain<etype>(Uobj, Eobj));
+        Eobj.bvalue() = Eb[i];
+        Uobj.pvalue() = Up[i];
+        stack.hproduct();
+        Uh[i] = Uobj.hvalue();
+      }
+    }
+    do_not_optimize(E[0]);
+    do_not_optimize(Uh[0]);
+  });
+}
+
+inline const char* order_name(ADorder order) {
+  return order == ADorder::ZERO    ? "value"
+         : order == ADorder::FIRST ? "first_order"
+                                   : "second_order";
+}
+
+template <int N, ADorder order>
+void register_order(Registry& registry) {
+  using T = double;
+  std::string n = std::to_string(N);
+  std::string o = order_name(order);
+
+  registry.add("ad/SymIsotropic/N=" + n + "/" + o + "/batch=256",
+               bench_symisotropic<T, N, order>);
+  registry.add("ad/MatGreenStrain/LINEAR/N=" + n + "/" + o + "/batch=256",
+               bench_greenstrain<T, N, GreenStrainType::LINEAR, order>);
+  registry.add("ad/MatGreenStrain/NONLINEAR/N=" + n + "/" + o + "/batch=256",
+               bench_greenstrain<T, N, GreenStrainType::NONLINEAR, order>);
+}
+
+inline void register_ad_benchmarks(Registry& registry) {
+  using T = double;
+  registry.add("ad/MatMatMultCore/N=2/batch=256", bench_matmatmult<T, 2>);
+  registry.add("ad/MatMatMultCore/N=3/batch=256", bench_matmatmult<T, 3>);
+  registry.add("ad/MatMatMultCore/N=6/batch=256", bench_matmatmult<T, 6>);
+
+  register_order<2, ADorder::ZERO>(registry);
+  register_order<2, ADorder::FIRST>(registry);
+  register_order<2, ADorder::SECOND>(registry);
+  register_order<3, ADorder::ZERO>(registry);
+  register_order<3, ADorder::FIRST>(registry);
+  register_order<3, ADorder::SECOND>(registry);
+}
+
+}  // namespace Benchmark
+
+}  // namespace A2D
+
+#endif  // A2D_BENCH_AD_H
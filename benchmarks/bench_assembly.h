@@ -0,0 +1,116 @@
+#ifndef A2D_BENCH_ASSEMBLY_H
+#define A2D_BENCH_ASSEMBLY_H
+
+#include <string>
+
+#include "a2d_benchmark.h"
+#include "bench_problem.h"
+#include "multiphysics/feelementvector.h"
+
+namespace A2D {
+
+namespace Benchmark {
+
+// Number of elements along each edge of the brick for the given degree, chosen
+// so that the number of degrees of freedom is similar for each degree
+template <index_t degree>
+constexpr int brick_size() {
+  return degree == 1 ? 16 : degree == 2 ? 8 : degree == 3 ? 5 : 4;
+}
+
+// Assemble the residual of TopoElasticityIntegrand
+template <index_t degree>
+void bench_residual(State& state) {
+  BrickProblem<degree> prob(brick_size<degree>());
+  prob.set_displacement();
+
+  state.counter("elements", prob.nhex);
+  state.run([&]() {
+    prob.res->zero();
+    prob.assembler.add_residual(1.0, *prob.data, *prob.geo, *prob.sol,
+                                *prob.res);
+    do_not_optimize((*prob.res)[0]);
+  });
+}
+
+// Assemble the Jacobian of TopoElasticityIntegrand
+template <index_t degree>
+void bench_jacobian(State& state) {
+  BrickProblem<degree> prob(brick_size<degree>());
+  prob.set_displacement();
+  auto mat = prob.create_matrix();
+
+  state.counter("elements", prob.nhex);
+  state.run([&]() {
+    mat->zero();
+    prob.assembler.add_jacobian(1.0, *prob.data, *prob.geo, *prob.sol, *mat);
+    do_not_optimize(mat->vals(0, 0, 0));
+  });
+}
+
+// Gather the element degrees of freedom from the global vector
+template <index_t degree>
+void bench_gather(State& state) {
+  using Problem = BrickProblem<degree>;
+  using T = typename Problem::T;
+  using Basis = typename Problem::Basis;
+  Problem prob(brick_size<degree>());
+  prob.set_displacement();
+  ElementVector_Parallel<T, Basis, typename Problem::Vec_t> elem_sol(
+      *prob.sol_mesh, *prob.sol);
+
+  // Each element dof is read from the global vector and written
+  double entries = double(prob.nhex) * Basis::ndof;
+  state.counter("elements", prob.nhex);
+  state.counter("bytes", entries * (2.0 * sizeof(T) + sizeof(index_t)));
+  state.run([&]() { elem_sol.get_values(); });
+}
+
+// Scatter-add the element degrees of freedom to the global vector
+template <index_t degree>
+void bench_scatter(State& state) {
+  using Problem = BrickProblem<degree>;
+  using T = typename Problem::T;
+  using Basis = typename Problem::Basis;
+  Problem prob(brick_size<degree>());
+  prob.set_displacement();
+  ElementVector_Parallel<T, Basis, typename Problem::Vec_t> elem_res(
+      *prob.sol_mesh, *prob.res);
+  elem_res.get_values();
+
+  // Each element dof is read and the global entry is read and written
+  double entries = double(prob.nhex) * Basis::ndof;
+  state.counter("elements", prob.nhex);
+  state.counter("bytes", entries * (3.0 * sizeof(T) + sizeof(index_t)));
+  state.run([&]() {
+    elem_res.add_values();
+    do_not_optimize((*prob.res)[0]);
+  });
+}
+
+template <index_t degree>
+void register_degree(Registry& registry) {
+  std::string suffix = "/hex/degree=" + std::to_string(degree) +
+                       "/n=" + std::to_string(brick_size<degree>());
+  registry.add("assembly/TopoElasticity/residual" + suffix,
+               bench_residual<degree>);
+  registry.add("assembly/TopoElasticity/jacobian" + suffix,
+               bench_jacobian<degree>);
+  registry.add("assembly/ElementVector_Parallel/gather" + suffix,
+               bench_gather<degree>);
+  registry.add("assembly/ElementVector_Parallel/scatter" + suffix,
+               bench_scatter<degree>);
+}
+
+inline void register_assembly_benchmarks(Registry& registry) {
+  register_degree<1>(registry);
+  register_degree<2>(registry);
+  register_degree<3>(registry);
+  register_degree<4>(registry);
+}
+
+}  // namespace Benchmark
+
+}  // namespace A2D
+
+#endif  // A2D_BENCH_ASSEMBLY_H
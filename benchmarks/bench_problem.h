@@ -0,0 +1,122 @@
+#ifndef A2D_BENCH_PROBLEM_H
+#define A2D_BENCH_PROBLEM_H
+
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "multiphysics/feanalysis.h"
+#include "multiphysics/hex_tools.h"
+#include "multiphysics/integrand_elasticity.h"
+#include "utils/a2dmesh.h"
+
+namespace A2D {
+
+namespace Benchmark {
+
+/**
+ * @brief Topology elasticity problem on a brick of nx^3 hexahedral elements
+ * created with MesherBrick3D, clamped on the face x = 0
+ *
+ * @tparam degree Polynomial degree of the basis
+ */
+template <index_t degree>
+class BrickProblem {
+ public:
+  using T = double;
+  static constexpr index_t block_size = 3;
+  using Impl_t = DirectCholeskyAnalysisImpl<T, block_size>;
+  using Vec_t = typename Impl_t::Vec_t;
+  using Mat_t = typename Impl_t::Mat_t;
+  using Elem_t = HexTopoElement<Impl_t, GreenStrainType::NONLINEAR, degree>;
+  using DataBasis = typename Elem_t::DataBasis;
+  using GeoBasis = typename Elem_t::GeoBasis;
+  using Basis = typename Elem_t::Basis;
+
+  BrickProblem(int nx) : nx(nx) {
+    index_t nverts = (nx + 1) * (nx + 1) * (nx + 1);
+    nhex = nx * nx * nx;
+    hex.resize(8 * nhex);
+    Xloc.resize(3 * nverts);
+    MesherBrick3D mesher(nx, nx, nx, 1.0, 1.0, 1.0);
+    mesher.set_X_conn<index_t, double>(Xloc.data(), hex.data());
+
+    index_t ntets = 0, nwedge = 0, npyrmd = 0;
+    index_t *tets = nullptr, *wedge = nullptr, *pyrmd = nullptr;
+    conn = std::make_unique<MeshConnectivity3D>(nverts, ntets, tets, nhex,
+                                                hex.data(), nwedge, wedge,
+                                                npyrmd, pyrmd);
+
+    // Clamp the face x = 0
+    std::vector<index_t> verts;
+    for (int k = 0; k < nx + 1; k++) {
+      for (int j = 0; j < nx + 1; j++) {
+        verts.push_back(j * (nx + 1) + k * (nx + 1) * (nx + 1));
+      }
+    }
+    index_t label = conn->add_boundary_label_from_verts(verts.size(),
+                                                        verts.data());
+    DirichletBCInfo bcinfo;
+    bcinfo.add_boundary_condition(label);
+
+    data_mesh = std::make_shared<ElementMesh<DataBasis>>(*conn);
+    geo_mesh = std::make_shared<ElementMesh<GeoBasis>>(*conn);
+    sol_mesh = std::make_shared<ElementMesh<Basis>>(*conn);
+    bcs = std::make_shared<DirichletBasis<T, Basis>>(*conn, *sol_mesh, bcinfo,
+                                                     0.0);
+
+    data = std::make_shared<Vec_t>(data_mesh->get_num_dof());
+    geo = std::make_shared<Vec_t>(geo_mesh->get_num_dof());
+    sol = std::make_shared<Vec_t>(sol_mesh->get_num_dof());
+    res = std::make_shared<Vec_t>(sol_mesh->get_num_dof());
+    data->fill(1.0);
+
+    typename Impl_t::template ElementVector<GeoBasis> elem_geo(*geo_mesh, *geo);
+    set_geo_from_hex_nodes<GeoBasis>(nhex, hex.data(), Xloc.data(), elem_geo);
+
+    TopoElasticityIntegrand<T, 3, GreenStrainType::NONLINEAR> integrand(
+        70.0, 0.3, 5.0);
+    assembler.add_element(
+        std::make_shared<Elem_t>(integrand, data_mesh, geo_mesh, sol_mesh));
+  }
+
+  // Set a small smooth displacement so the nonlinear terms are active
+  void set_displacement(T scale = 1e-3) {
+    for (index_t i = 0; i < sol->get_num_dof(); i++) {
+      (*sol)[i] = scale * std::sin(0.1 * i);
+    }
+  }
+
+  // Create the matrix and assemble the Jacobian with the rows of the
+  // boundary conditions zeroed
+  std::shared_ptr<Mat_t> create_matrix() {
+    index_t nrows;
+    std::vector<index_t> rowp, cols;
+    assembler.get_bsr_data(block_size, nrows, rowp, cols);
+    auto mat = std::make_shared<Mat_t>(nrows, nrows, cols.size(), rowp, cols);
+    assembler.add_jacobian(T(1.0), *data, *geo, *sol, *mat);
+
+    const index_t* bc_dofs;
+    index_t nbcs = bcs->get_bcs(&bc_dofs, nullptr);
+    mat->zero_rows(nbcs, bc_dofs);
+    return mat;
+  }
+
+  int nx;
+  index_t nhex;
+  std::vector<index_t> hex;
+  std::vector<double> Xloc;
+  std::unique_ptr<MeshConnectivity3D> conn;
+  std::shared_ptr<ElementMesh<DataBasis>> data_mesh;
+  std::shared_ptr<ElementMesh<GeoBasis>> geo_mesh;
+  std::shared_ptr<ElementMesh<Basis>> sol_mesh;
+  std::shared_ptr<DirichletBasis<T, Basis>> bcs;
+  std::shared_ptr<Vec_t> data, geo, sol, res;
+  ElementAssembler<Impl_t> assembler;
+};
+
+}  // namespace Benchmark
+
+}  // namespace A2D
+
+#endif  // A2D_BENCH_PROBLEM_H
@@ -0,0 +1,258 @@
+#ifndef A2D_BENCH_SPARSE_H
+#define A2D_BENCH_SPARSE_H
+
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "a2d_benchmark.h"
+#include "bench_problem.h"
+#include "sparse/sparse_amg.h"
+#include "sparse/sparse_cholesky.h"
+#include "sparse/sparse_matrix.h"
+#include "sparse/sparse_numeric.h"
+#include "sparse/sparse_utils.h"
+
+namespace A2D {
+
+namespace Benchmark {
+
+// Number of nodes along each edge of the grid used for the matrix-vector
+// products, the matrix has the 27-point stencil of a trilinear hex mesh
+constexpr int spmv_nodes = 21;
+
+// Nodal matrix of a structured grid with random block values
+template <typename T, index_t M>
+std::shared_ptr<BSRMat<T, M, M>> create_grid_matrix(int n) {
+  auto node = [n](int i, int j, int k) { return i + n * (j + n * k); };
+
+  std::vector<index_t> rowp(1, 0), cols;
+  for (int k = 0; k < n; k++) {
+    for (int j = 0; j < n; j++) {
+      for (int i = 0; i < n; i++) {
+        for (int kk = std::max(k - 1, 0); kk <= std::min(k + 1, n - 1); kk++) {
+          for (int jj = std::max(j - 1, 0); jj <= std::min(j + 1, n - 1);
+               jj++) {
+            for (int ii = std::max(i - 1, 0); ii <= std::min(i + 1, n - 1);
+                 ii++) {
+              cols.push_back(node(ii, jj, kk));
+            }
+          }
+        }
+        rowp.push_back(cols.size());
+      }
+    }
+  }
+
+  const index_t nrows = n * n * n;
+  auto A = std::make_shared<BSRMat<T, M, M>>(nrows, nrows, cols.size(), rowp,
+                                             cols);
+  std::mt19937 gen(1234);
+  std::uniform_real_distribution<T> distr(-1.0, 1.0);
+  for (index_t jp = 0; jp < A->nnz; jp++) {
+    for (index_t ii = 0; ii < M; ii++) {
+      for (index_t jj = 0; jj < M; jj++) {
+        A->vals(jp, ii, jj) = distr(gen);
+      }
+    }
+  }
+  return A;
+}
+
+// y = A * x for the block size M
+template <index_t M>
+void bench_matvec(State& state) {
+  using T = double;
+  auto A = create_grid_matrix<T, M>(spmv_nodes);
+  MultiArrayNew<T* [M]> x("x", A->nbcols), y("y", A->nbrows);
+  BLAS::fill(x, 1.0);
+
+  // Same work model as BSRMatVecMultCount()
+  state.counter("flops", 2.0 * M * M * A->nnz);
+  state.counter("bytes",
+                double(A->nnz) * (M * M * sizeof(T) + sizeof(index_t)) +
+                    (A->nbrows + 1.0) * sizeof(index_t) +
+                    double(A->nbcols + A->nbrows) * M * sizeof(T));
+  state.run([&]() {
+    BSRMatVecMult<T, M, M>(*A, x, y);
+    do_not_optimize(y(0, 0));
+  });
+}
+
+// y = A * x for the block size M with the compressed column indices
+template <index_t M>
+void bench_matvec_compressed(State& state) {
+  using T = double;
+  auto A = create_grid_matrix<T, M>(spmv_nodes);
+  std::unique_ptr<CompressedBSRMat<T, M, M>> C(BSRMatCompressIndex(*A));
+  MultiArrayNew<T* [M]> x("x", C->nbcols), y("y", C->nbrows);
+  BLAS::fill(x, 1.0);
+
+  // Same work model as CompressedBSRMatVecMultCount()
+  state.counter("flops", 2.0 * M * M * C->nnz);
+  state.counter("bytes", double(C->nnz) * M * M * sizeof(T) +
+                             C->get_index_bytes() +
+                             double(C->nbcols + C->nbrows) * M * sizeof(T));
+  state.run([&]() {
+    CompressedBSRMatVecMult(*C, x, y);
+    do_not_optimize(y(0, 0));
+  });
+}
+
+// Elasticity problem with the Jacobian and the rigid body modes used by AMG
+class AmgProblem {
+ public:
+  using T = double;
+  static constexpr index_t block_size = 3;
+  static constexpr index_t null_size = 6;
+  static constexpr int num_levels = 3;
+
+  AmgProblem(int nx) : prob(nx) {
+    A = prob.create_matrix();
+
+    const index_t nnodes = A->nbrows;
+    B = MultiArrayNew<T* [block_size][null_size]>("B", nnodes);
+    for (index_t i = 0; i < nnodes; i++) {
+      T x = (*prob.geo)[3 * i], y = (*prob.geo)[3 * i + 1],
+        z = (*prob.geo)[3 * i + 2];
+      B(i, 0, 0) = 1.0;
+      B(i, 1, 1) = 1.0;
+      B(i, 2, 2) = 1.0;
+      B(i, 1, 3) = z;
+      B(i, 2, 3) = -y;
+      B(i, 0, 4) = z;
+      B(i, 2, 4) = -x;
+      B(i, 0, 5) = y;
+      B(i, 1, 5) = -x;
+    }
+
+    const index_t* dofs;
+    index_t nbcs = prob.bcs->get_bcs(&dofs, nullptr);
+    for (index_t i = 0; i < nbcs; i++) {
+      for (index_t j = 0; j < null_size; j++) {
+        B(dofs[i] / block_size, dofs[i] % block_size, j) = 0.0;
+      }
+    }
+  }
+
+  BrickProblem<1> prob;
+  std::shared_ptr<BSRMat<T, block_size, block_size>> A;
+  MultiArrayNew<T* [block_size][null_size]> B;
+};
+
+constexpr int amg_size = 12;
+
+// Construct the AMG hierarchy, including the aggregation, the smoothed
+// prolongation, the Galerkin products and the coarse factorization
+inline void bench_amg_setup(State& state) {
+  using T = AmgProblem::T;
+  AmgProblem amg_prob(amg_size);
+
+  state.counter("blocks", amg_prob.A->nnz);
+  state.run([&]() {
+    BSRMatAmg<T, 3, 6> amg(AmgProblem::num_levels, 0.5, 0.0, amg_prob.A,
+                           amg_prob.B);
+  });
+}
+
+// Apply one V-cycle of the AMG preconditioner, optionally with the compressed
+// column indices
+template <bool compress>
+void bench_amg_vcycle(State& state) {
+  using T = AmgProblem::T;
+  AmgProblem amg_prob(amg_size);
+  BSRMatAmg<T, 3, 6> amg(AmgProblem::num_levels, 0.5, 0.0, amg_prob.A,
+                         amg_prob.B);
+  amg.compressIndex(compress);
+
+  MultiArrayNew<T* [3]> b("b", amg_prob.A->nbrows), x("x", amg_prob.A->nbrows);
+  BLAS::fill(b, 1.0);
+
+  state.counter("blocks", amg_prob.A->nnz);
+  state.run([&]() {
+    amg.applyFactor(b, x);
+    do_not_optimize(x(0, 0));
+  });
+}
+
+constexpr int chol_size = 10;
+
+// Matrix of the elasticity problem in CSC format with the boundary conditions
+inline CSCMat<double> create_csc_matrix(BrickProblem<1>& prob) {
+  auto A = prob.create_matrix();
+  CSCMat<double> csc = bsr_to_csc(*A);
+  const index_t* dofs;
+  index_t nbcs = prob.bcs->get_bcs(&dofs, nullptr);
+  csc.zero_columns(nbcs, dofs);
+  return csc;
+}
+
+// Numerical factorization with the nested dissection ordering
+inline void bench_cholesky_factor(State& state) {
+  using T = double;
+  BrickProblem<1> prob(chol_size);
+  CSCMat<T> csc = create_csc_matrix(prob);
+  SparseCholesky<T> chol(csc, CholOrderingType::ND);
+
+  state.counter("rows", csc.nrows);
+  state.run([&]() {
+    chol.setValues(csc);
+    chol.factor();
+  });
+}
+
+// Forward and backward substitution with the factored matrix
+inline void bench_cholesky_solve(State& state) {
+  using T = double;
+  BrickProblem<1> prob(chol_size);
+  CSCMat<T> csc = create_csc_matrix(prob);
+  SparseCholesky<T> chol(csc, CholOrderingType::ND);
+  chol.factor();
+
+  std::vector<T> x(csc.nrows);
+  state.counter("rows", csc.nrows);
+  state.run([&]() {
+    std::fill(x.begin(), x.end(), T(1.0));
+    chol.solve(x.data());
+    do_not_optimize(x[0]);
+  });
+}
+
+inline void register_sparse_benchmarks(Registry& registry) {
+  std::string n = "/n=" + std::to_string(spmv_nodes);
+  registry.add("sparse/BSRMatVecMult/M=1" + n, bench_matvec<1>);
+  registry.add("sparse/BSRMatVecMult/M=2" + n, bench_matvec<2>);
+  registry.add("sparse/BSRMatVecMult/M=3" + n, bench_matvec<3>);
+  registry.add("sparse/BSRMatVecMult/M=4" + n, bench_matvec<4>);
+  registry.add("sparse/BSRMatVecMult/M=5" + n, bench_matvec<5>);
+  registry.add("sparse/BSRMatVecMult/M=6" + n, bench_matvec<6>);
+  registry.add("sparse/CompressedBSRMatVecMult/M=1" + n,
+               bench_matvec_compressed<1>);
+  registry.add("sparse/CompressedBSRMatVecMult/M=2" + n,
+               bench_matvec_compressed<2>);
+  registry.add("sparse/CompressedBSRMatVecMult/M=3" + n,
+               bench_matvec_compressed<3>);
+  registry.add("sparse/CompressedBSRMatVecMult/M=4" + n,
+               bench_matvec_compressed<4>);
+  registry.add("sparse/CompressedBSRMatVecMult/M=5" + n,
+               bench_matvec_compressed<5>);
+  registry.add("sparse/CompressedBSRMatVecMult/M=6" + n,
+               bench_matvec_compressed<6>);
+
+  std::string amg = "/hex/n=" + std::to_string(amg_size);
+  registry.add("sparse/BSRMatAmg/setup" + amg, bench_amg_setup);
+  registry.add("sparse/BSRMatAmg/vcycle" + amg, bench_amg_vcycle<false>);
+  registry.add("sparse/BSRMatAmg/vcycle_compressed" + amg,
+               bench_amg_vcycle<true>);
+
+  std::string chol = "/hex/n=" + std::to_string(chol_size);
+  registry.add("sparse/SparseCholesky/factor" + chol, bench_cholesky_factor);
+  registry.add("sparse/SparseCholesky/solve" + chol, bench_cholesky_solve);
+}
+
+}  // namespace Benchmark
+
+}  // namespace A2D
+
+#endif  // A2D_BENCH_SPARSE_H
@@ -3,6 +3,7 @@
 
 #include "multiphysics/febasis.h"
 #include "multiphysics/feelement.h"
+#include "multiphysics/fematrixfree.h"
 #include "multiphysics/femesh.h"
 #include "multiphysics/fequadrature.h"
 #include "multiphysics/hex_tools.h"
@@ -368,7 +369,8 @@ class HelmholtzSphere {
 
   // Matrix-free operator
   using MatFree =
-      MatrixFree<T, Integrand, Quadrature, DataBasis, GeoBasis, Basis>;
+      MatrixFree<T, FEVarType::STATE, FEVarType::STATE, Integrand, Quadrature,
+                 DataBasis, GeoBasis, Basis>;
 
   // Static condensation matrix information
   using SDMatType =
@@ -435,44 +437,22 @@ class HelmholtzSphere {
     // Initialize the matrix-free data
     matfree.initialize(integrand, elem_data, elem_geo, elem_sol);
 
-    // Allocate space for temporary variables with the matrix-vector code
-    SolutionVector<T> xvec(mesh.get_num_dof());
-    SolutionVector<T> yvec(mesh.get_num_dof());
-    ElemVec elem_xvec(mesh, xvec);
-    ElemVec elem_yvec(mesh, yvec);
-
     // Apply the boundary conditions
     const I* bc_dofs;
     I nbcs = bcs.get_bcs(&bc_dofs);
 
+    // Matrix-free operator that acts directly on the Krylov vectors
+    MatrixFreeOperator<T, block_size, MatFree, ElemVec> matfree_op(
+        matfree, mesh, nbcs, bc_dofs);
     auto mat_vec = [&](MultiArrayNew<T* [block_size]>& in,
                        MultiArrayNew<T* [block_size]>& out) -> void {
-      xvec.zero();
-      yvec.zero();
-      for (I i = 0; i < xvec.get_num_dof(); i++) {
-        xvec[i] = in(i / block_size, i % block_size);
-      }
-      matfree.add_jacobian_vector_product(elem_xvec, elem_yvec);
-
-      for (I i = 0; i < yvec.get_num_dof(); i++) {
-        out(i / block_size, i % block_size) = yvec[i];
-      }
-
-      // Set the boundary conditions as equal to the inputs
-      const I* bc_dofs;
-      I nbcs = bcs.get_bcs(&bc_dofs);
-      for (I i = 0; i < nbcs; i++) {
-        I dof = bc_dofs[i];
-
-        out(dof / block_size, dof % block_size) =
-            in(dof / block_size, dof % block_size);
-      }
+      matfree_op(in, out);
     };
 
-    // Create the solution and right-hand-side vectors
-    I size = sol.get_num_dof() / block_size;
-    MultiArrayNew<T* [block_size]> sol_vec("sol_vec", size);
-    MultiArrayNew<T* [block_size]> rhs_vec("rhs_vec", size);
+    // Create the right-hand-side and a blocked view of the solution
+    SolutionVector<T> rhs(mesh.get_num_dof());
+    auto rhs_vec = rhs.template get_block_view<block_size>();
+    auto sol_vec = sol.template get_block_view<block_size>();
 
     // Zero the solution
     sol.zero();
@@ -484,13 +464,13 @@ class HelmholtzSphere {
 
     // Set the right-hand-side
     for (I i = 0; i < sol.get_num_dof(); i++) {
-      rhs_vec(i / block_size, i % block_size) = -res[i];
+      rhs[i] = -res[i];
     }
 
     // Zero out the boundary conditions
     for (index_t i = 0; i < nbcs; i++) {
       index_t dof = bc_dofs[i];
-      rhs_vec(dof / block_size, dof % block_size) = 0.0;
+      rhs[dof] = 0.0;
     }
 
     // Solve the problem
@@ -513,11 +493,6 @@ class HelmholtzSphere {
       std::cout << msg << std::endl;
       // throw std::runtime_error(msg);
     }
-
-    // Record the solution
-    for (I i = 0; i < sol.get_num_dof(); i++) {
-      sol[i] = sol_vec(i / block_size, i % block_size);
-    }
   }
 
   T compute_solution_error() {
@@ -0,0 +1,166 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "multiphysics/femesh.h"
+
+using namespace A2D;
+
+using ET = ElementTypes;
+using I = index_t;
+
+// Create a structured mesh of n x n x n hexahedra or 6 * n^3 tetrahedra
+void create_mesh(I n, bool tets, I& nverts, std::vector<I>& hex,
+                 std::vector<I>& tet) {
+  auto node = [&](I i, I j, I k) {
+    return i + j * (n + 1) + k * (n + 1) * (n + 1);
+  };
+  nverts = (n + 1) * (n + 1) * (n + 1);
+
+  // Split each hex into 6 tets that share the diagonal from vertex 0 to 6
+  const I hex_to_tet[6][4] = {{0, 1, 2, 6}, {0, 2, 3, 6}, {0, 3, 7, 6},
+                              {0, 7, 4, 6}, {0, 4, 5, 6}, {0, 5, 1, 6}};
+
+  hex.clear();
+  tet.clear();
+  for (I k = 0; k < n; k++) {
+    for (I j = 0; j < n; j++) {
+      for (I i = 0; i < n; i++) {
+        I v[8];
+        for (I ii = 0; ii < 8; ii++) {
+          v[ii] = node(i + ET::HEX_VERTS_CART[ii][0],
+                       j + ET::HEX_VERTS_CART[ii][1],
+                       k + ET::HEX_VERTS_CART[ii][2]);
+        }
+        if (tets) {
+          for (I t = 0; t < 6; t++) {
+            for (I ii = 0; ii < 4; ii++) {
+              tet.push_back(v[hex_to_tet[t][ii]]);
+            }
+          }
+        } else {
+          hex.insert(hex.end(), v, v + 8);
+        }
+      }
+    }
+  }
+}
+
+// Check that the two connectivities have identical numbering
+bool compare(MeshConnectivity3D& a, MeshConnectivity3D& b) {
+  if (a.get_num_bounds() != b.get_num_bounds() ||
+      a.get_num_edges() != b.get_num_edges()) {
+    return false;
+  }
+
+  for (I elem = 0; elem < a.get_num_elements(); elem++) {
+    const I *ab, *bb, *ae, *be;
+    I nb = a.get_element_bounds(elem, &ab);
+    b.get_element_bounds(elem, &bb);
+    for (I i = 0; i < nb; i++) {
+      if (ab[i] != bb[i]) {
+        return false;
+      }
+    }
+    I ne = a.get_element_edges(elem, &ae);
+    b.get_element_edges(elem, &be);
+    for (I i = 0; i < ne; i++) {
+      if (ae[i] != be[i]) {
+        return false;
+      }
+    }
+  }
+
+  for (I bound = 0; bound < a.get_num_bounds(); bound++) {
+    I a1, a2, b1, b2;
+    a.get_bound_elements(bound, &a1, &a2);
+    b.get_bound_elements(bound, &b1, &b2);
+    if (a1 != b1 || a2 != b2) {
+      return false;
+    }
+  }
+
+  for (I vert = 0; vert < a.get_num_verts(); vert++) {
+    const I *ae, *be;
+    I na = a.get_adjacent_elements_from_vert(vert, &ae);
+    I nb = b.get_adjacent_elements_from_vert(vert, &be);
+    if (na != nb) {
+      return false;
+    }
+    for (I i = 0; i < na; i++) {
+      if (ae[i] != be[i]) {
+        return false;
+      }
+    }
+  }
+
+  const I *abound, *alabel, *bbound, *blabel;
+  I na = a.get_boundary_bounds(&abound, &alabel);
+  I nb = b.get_boundary_bounds(&bbound, &blabel);
+  if (na != nb) {
+    return false;
+  }
+  for (I i = 0; i < na; i++) {
+    if (abound[i] != bbound[i] || alabel[i] != blabel[i]) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/*
+  Time the construction of MeshConnectivity3D with the serial and parallel
+  algorithms as the number of elements grows
+
+  Usage: ./bench_connectivity [max n] [max n for the serial algorithm]
+*/
+int main(int argc, char* argv[]) {
+  I max_n = argc > 1 ? std::atoi(argv[1]) : 64;
+  I max_serial_n = argc > 2 ? std::atoi(argv[2]) : 32;
+
+  auto elapsed = [](auto t0) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0)
+        .count();
+  };
+
+  std::printf("%6s %12s %12s %12s %8s %10s\n", "type", "nelems", "serial(s)",
+              "parallel(s)", "speedup", "identical");
+
+  for (bool tets : {false, true}) {
+    for (I n = 8; n <= max_n; n *= 2) {
+      I nverts;
+      std::vector<I> hex, tet;
+      create_mesh(n, tets, nverts, hex, tet);
+      I nhex = hex.size() / 8, ntets = tet.size() / 4;
+      I nelems = nhex + ntets, z = 0;
+      I* null = nullptr;
+
+      auto t0 = std::chrono::steady_clock::now();
+      MeshConnectivity3D par(nverts, ntets, tet.data(), nhex, hex.data(), z,
+                             null, z, null, MeshConnectivityBuild::PARALLEL);
+      double tpar = elapsed(t0);
+
+      if (n <= max_serial_n) {
+        t0 = std::chrono::steady_clock::now();
+        MeshConnectivity3D ser(nverts, ntets, tet.data(), nhex, hex.data(), z,
+                               null, z, null, MeshConnectivityBuild::SERIAL);
+        double tser = elapsed(t0);
+
+        bool same = compare(ser, par);
+        std::printf("%6s %12d %12.4f %12.4f %8.2f %10s\n",
+                    tets ? "tet" : "hex", nelems, tser, tpar, tser / tpar,
+                    same ? "yes" : "NO");
+        if (!same) {
+          return 1;
+        }
+      } else {
+        std::printf("%6s %12d %12s %12.4f %8s %10s\n", tets ? "tet" : "hex",
+                    nelems, "-", tpar, "-", "-");
+      }
+    }
+  }
+
+  return 0;
+}
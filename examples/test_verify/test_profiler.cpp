@@ -5,6 +5,7 @@
 
 int main() {
   A2D::Timer::set_threshold_ms(50.0);
+  A2D::Timer::set_trace_path("profile_trace.json");
   {
     A2D::Timer t("sleep(20)");
     std::this_thread::sleep_for(std::chrono::milliseconds(20));
@@ -16,6 +17,17 @@ int main() {
         std::this_thread::sleep_for(std::chrono::milliseconds(40));
       }
     }
+
+    // Timers are recorded separately on each thread
+#pragma omp parallel for
+    for (int i = 0; i < 8; i++) {
+      A2D::Timer t("sleep(5) in parallel");
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
   }
+
+  // Print the merged call tree, the log files and the trace are written at
+  // exit
+  A2D::Timer::report();
   return 0;
-}
\ No newline at end of file
+}
@@ -91,8 +91,9 @@ create_analysis_vtk(std::string prefix, std::string vtk_name,
                     double vb_traction_frac, int amg_nlevels, int cg_it,
                     double cg_rtol, double cg_atol, bool verbose, int maxit,
                     int vtk_freq, double ramp_q, bool check_grad_and_exit) {
-  // Load vtk
-  ReadVTK3D<I, T> readvtk(vtk_name);
+  // Load vtk, sorting the elements along a Hilbert curve for locality
+  bool hilbert_sort = true;
+  ReadVTK3D<I, T> readvtk(vtk_name, verbose, hilbert_sort);
   T *Xloc = readvtk.get_Xloc();
   I nverts = readvtk.get_nverts();
   I nhex = readvtk.get_nhex();
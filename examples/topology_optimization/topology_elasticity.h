@@ -9,6 +9,7 @@
 #include "multiphysics/febasis.h"
 #include "multiphysics/feelement.h"
 #include "multiphysics/feelementvector.h"
+#include "multiphysics/fematrixfree.h"
 #include "multiphysics/femesh.h"
 #include "multiphysics/fequadrature.h"
 #include "multiphysics/hex_tools.h"
@@ -101,7 +102,8 @@ class TopoElasticityAnalysis {
 
   // Matrix-free operator
   using MatFree =
-      MatrixFree<T, Integrand, Quadrature, DataBasis, GeoBasis, Basis>;
+      MatrixFree<T, FEVarType::STATE, FEVarType::STATE, Integrand, Quadrature,
+                 DataBasis, GeoBasis, Basis>;
 
   // Algebraic multigrid solver
   static constexpr I null_size = 6;
@@ -289,34 +291,12 @@ class TopoElasticityAnalysis {
     // Initialize the matrix-free data
     matfree.initialize(integrand, elem_data, elem_geo, elem_sol);
 
-    // Allocate space for temporary variables with the matrix-vector code
-    SolutionVector<T> xvec(mesh.get_num_dof());
-    SolutionVector<T> yvec(mesh.get_num_dof());
-    ElemVec elem_xvec(mesh, xvec);
-    ElemVec elem_yvec(mesh, yvec);
-
+    // Matrix-free operator that acts directly on the Krylov vectors
+    MatrixFreeOperator<T, block_size, MatFree, ElemVec> matfree_op(
+        matfree, mesh, nbcs, bc_dofs);
     auto mat_vec = [&](MultiArrayNew<T *[block_size]> &in,
                        MultiArrayNew<T *[block_size]> &out) -> void {
-      xvec.zero();
-      yvec.zero();
-      for (I i = 0; i < xvec.get_num_dof(); i++) {
-        xvec[i] = in(i / block_size, i % block_size);
-      }
-      matfree.add_jacobian_vector_product(elem_xvec, elem_yvec);
-
-      for (I i = 0; i < yvec.get_num_dof(); i++) {
-        out(i / block_size, i % block_size) = yvec[i];
-      }
-
-      // Set the boundary conditions as equal to the inputs
-      const I *bc_dofs;
-      I nbcs = bcs.get_bcs(&bc_dofs);
-      for (I i = 0; i < nbcs; i++) {
-        I dof = bc_dofs[i];
-
-        out(dof / block_size, dof % block_size) =
-            in(dof / block_size, dof % block_size);
-      }
+      matfree_op(in, out);
     };
 
     // Allocate the solver
@@ -329,10 +309,10 @@ class TopoElasticityAnalysis {
     }
     BSRMatAmgType amg(amg_nlevels, omega, epsilon, mat, B, print_info);
 
-    // Create the solution and right-hand-side vectors
-    I size = sol.get_num_dof() / block_size;
-    MultiArrayNew<T *[block_size]> sol_vec("sol_vec", size);
-    MultiArrayNew<T *[block_size]> rhs_vec("rhs_vec", size);
+    // Create the right-hand-side and a blocked view of the solution
+    SolutionVector<T> rhs(mesh.get_num_dof());
+    auto rhs_vec = rhs.template get_block_view<block_size>();
+    auto sol_vec = sol.template get_block_view<block_size>();
 
     // Zero the solution
     sol.zero();
@@ -354,13 +334,13 @@ class TopoElasticityAnalysis {
 
     // Set the right-hand-side
     for (I i = 0; i < sol.get_num_dof(); i++) {
-      rhs_vec(i / block_size, i % block_size) = -traction_res[i] - res[i];
+      rhs[i] = -traction_res[i] - res[i];
     }
 
     // Zero out the boundary conditions
     for (index_t i = 0; i < nbcs; i++) {
       index_t dof = bc_dofs[i];
-      rhs_vec(dof / block_size, dof % block_size) = 0.0;
+      rhs[dof] = 0.0;
     }
 
     // Solve the problem
@@ -378,11 +358,6 @@ class TopoElasticityAnalysis {
                     __FILE__, __LINE__, cg_it, cg_rtol, cg_atol);
       throw std::runtime_error(msg);
     }
-
-    // Record the solution
-    for (I i = 0; i < sol.get_num_dof(); i++) {
-      sol[i] = sol_vec(i / block_size, i % block_size);
-    }
   }
 
   /**
@@ -397,19 +372,16 @@ class TopoElasticityAnalysis {
     constexpr ElemVecType evtype = same_evtype::evtype;
 
     // Copy the design variables to the filter data
-    for (index_t i = 0; i < filtermesh.get_num_dof(); i++) {
-      filter_data[i] = xvec[i];
-    }
+    T *fdata = filter_data.data();
+    parallel_for(
+        filtermesh.get_num_dof(),
+        KOKKOS_LAMBDA(index_t i)->void { fdata[i] = xvec[i]; });
 
     // Loop over the elements and interpolate the values to the refined data
     // mesh
     const index_t num_elements = elem_filter_data.get_num_elements();
 
-    if constexpr (evtype == ElemVecType::Parallel) {
-      elem_filter_data.get_values();
-    }
-
-    for (index_t i = 0; i < num_elements; i++) {
+    auto loop_body = KOKKOS_LAMBDA(const index_t i) {
       // Interpolate the data from the Bernstein filter
       typename FilterElemVec::FEDof filter_dof(i, elem_filter_data);
       if constexpr (evtype == ElemVecType::Serial) {
@@ -431,9 +403,18 @@ class TopoElasticityAnalysis {
       if constexpr (evtype == ElemVecType::Serial) {
         elem_data.set_element_values(i, data_dof);
       }
-    }
+    };
+
+    // The parallel element vectors only touch element-local storage in the
+    // loop, so the elements can be processed concurrently
     if constexpr (evtype == ElemVecType::Parallel) {
+      elem_filter_data.get_values();
+      parallel_for(num_elements, loop_body);
       elem_data.set_values();
+    } else {
+      for (index_t i = 0; i < num_elements; i++) {
+        loop_body(i);
+      }
     }
   }
 
@@ -454,11 +435,7 @@ class TopoElasticityAnalysis {
     // mesh
     const index_t num_elements = elem_filter_data.get_num_elements();
 
-    if constexpr (evtype == ElemVecType::Parallel) {
-      elem_dfdx.get_values();
-      filter_dfdx.get_zero_values();
-    }
-    for (index_t i = 0; i < num_elements; i++) {
+    auto loop_body = KOKKOS_LAMBDA(const index_t i) {
       typename DataDerivElemVec::FEDof data_dof(i, elem_dfdx);
       if constexpr (evtype == ElemVecType::Serial) {
         elem_dfdx.get_element_values(i, data_dof);
@@ -477,9 +454,17 @@ class TopoElasticityAnalysis {
       if constexpr (evtype == ElemVecType::Serial) {
         filter_dfdx.add_element_values(i, filter_dof);
       }
-    }
+    };
+
     if constexpr (evtype == ElemVecType::Parallel) {
+      elem_dfdx.get_values();
+      filter_dfdx.get_zero_values();
+      parallel_for(num_elements, loop_body);
       filter_dfdx.add_values();
+    } else {
+      for (index_t i = 0; i < num_elements; i++) {
+        loop_body(i);
+      }
     }
   }
 
@@ -655,34 +640,12 @@ class TopoElasticityAnalysis {
     // Initialize the matrix-free data
     matfree.initialize(integrand, elem_data, elem_geo, elem_sol);
 
-    // Allocate space for temporary variables with the matrix-vector code
-    SolutionVector<T> xvec(mesh.get_num_dof());
-    SolutionVector<T> yvec(mesh.get_num_dof());
-    ElemVec elem_xvec(mesh, xvec);
-    ElemVec elem_yvec(mesh, yvec);
-
+    // Matrix-free operator that acts directly on the Krylov vectors
+    MatrixFreeOperator<T, block_size, MatFree, ElemVec> matfree_op(
+        matfree, mesh, nbcs, bc_dofs);
     auto mat_vec = [&](MultiArrayNew<T *[block_size]> &in,
                        MultiArrayNew<T *[block_size]> &out) -> void {
-      xvec.zero();
-      yvec.zero();
-      for (I i = 0; i < xvec.get_num_dof(); i++) {
-        xvec[i] = in(i / block_size, i % block_size);
-      }
-      matfree.add_jacobian_vector_product(elem_xvec, elem_yvec);
-
-      for (I i = 0; i < yvec.get_num_dof(); i++) {
-        out(i / block_size, i % block_size) = yvec[i];
-      }
-
-      // Set the boundary conditions as equal to the inputs
-      const I *bc_dofs;
-      I nbcs = bcs.get_bcs(&bc_dofs);
-      for (I i = 0; i < nbcs; i++) {
-        I dof = bc_dofs[i];
-
-        out(dof / block_size, dof % block_size) =
-            in(dof / block_size, dof % block_size);
-      }
+      matfree_op(in, out);
     };
 
     // Allocate the solver - we should add some of these as solver options
@@ -694,20 +657,20 @@ class TopoElasticityAnalysis {
     }
     BSRMatAmgType amg(amg_nlevels, omega, epsilon, mat, B, print_info);
 
-    // Create the solution and right-hand-side vectors
-    I size = sol.get_num_dof() / block_size;
-    MultiArrayNew<T *[block_size]> sol_vec("sol_vec", size);
-    MultiArrayNew<T *[block_size]> rhs_vec("rhs_vec", size);
+    // Create the right-hand-side and a blocked view of the adjoint
+    SolutionVector<T> rhs(mesh.get_num_dof());
+    auto rhs_vec = rhs.template get_block_view<block_size>();
+    auto sol_vec = dfdu.template get_block_view<block_size>();
 
     // Set the right-hand-side
     for (I i = 0; i < dfdu.get_num_dof(); i++) {
-      rhs_vec(i / block_size, i % block_size) = -dfdu[i];
+      rhs[i] = -dfdu[i];
     }
 
     // Zero out the boundary conditions
     for (I i = 0; i < nbcs; i++) {
       I dof = bc_dofs[i];
-      rhs_vec(dof / block_size, dof % block_size) = 0.0;
+      rhs[dof] = 0.0;
     }
 
     // Solve the problem
@@ -721,11 +684,6 @@ class TopoElasticityAnalysis {
       throw std::runtime_error("CG failed to converge!");
     }
 
-    // Record the solution back into the right-hand-side vector
-    for (I i = 0; i < sol.get_num_dof(); i++) {
-      dfdu[i] = sol_vec(i / block_size, i % block_size);
-    }
-
     fe.add_adjoint_residual_data_derivative(integrand, elem_data, elem_geo,
                                             elem_sol, elem_dfdu, elem_dfdrho);
     feb.add_adjoint_residual_data_derivative(bodyforce, elem_data, elem_geo,
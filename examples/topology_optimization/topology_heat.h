@@ -8,6 +8,7 @@
 
 #include "multiphysics/febasis.h"
 #include "multiphysics/feelement.h"
+#include "multiphysics/fematrixfree.h"
 #include "multiphysics/femesh.h"
 #include "multiphysics/fequadrature.h"
 #include "multiphysics/hex_tools.h"
@@ -122,7 +123,8 @@ class TopoHeatAnalysis {
 
   // Matrix-free operator
   using MatFree =
-      MatrixFree<T, Integrand, Quadrature, DataBasis, GeoBasis, Basis>;
+      MatrixFree<T, FEVarType::STATE, FEVarType::STATE, Integrand, Quadrature,
+                 DataBasis, GeoBasis, Basis>;
 
   // Algebraic multigrid solver
   static constexpr I null_size = 1;
@@ -262,34 +264,12 @@ class TopoHeatAnalysis {
     // Initialize the matrix-free data
     matfree.initialize(integrand, elem_data, elem_geo, elem_sol);
 
-    // Allocate space for temporary variables with the matrix-vector code
-    SolutionVector<T> xvec(mesh.get_num_dof());
-    SolutionVector<T> yvec(mesh.get_num_dof());
-    ElemVec elem_xvec(mesh, xvec);
-    ElemVec elem_yvec(mesh, yvec);
-
+    // Matrix-free operator that acts directly on the Krylov vectors
+    MatrixFreeOperator<T, block_size, MatFree, ElemVec> matfree_op(
+        matfree, mesh, nbcs, bc_dofs);
     auto mat_vec = [&](MultiArrayNew<T *[block_size]> &in,
                        MultiArrayNew<T *[block_size]> &out) -> void {
-      xvec.zero();
-      yvec.zero();
-      for (I i = 0; i < xvec.get_num_dof(); i++) {
-        xvec[i] = in(i / block_size, i % block_size);
-      }
-      matfree.add_jacobian_vector_product(elem_xvec, elem_yvec);
-
-      for (I i = 0; i < yvec.get_num_dof(); i++) {
-        out(i / block_size, i % block_size) = yvec[i];
-      }
-
-      // Set the boundary conditions as equal to the inputs
-      const I *bc_dofs;
-      I nbcs = bcs.get_bcs(&bc_dofs);
-      for (I i = 0; i < nbcs; i++) {
-        I dof = bc_dofs[i];
-
-        out(dof / block_size, dof % block_size) =
-            in(dof / block_size, dof % block_size);
-      }
+      matfree_op(in, out);
     };
 
     // Allocate the solver - we should add some of these as solver options
@@ -301,10 +281,10 @@ class TopoHeatAnalysis {
     }
     BSRMatAmgType amg(amg_nlevels, omega, epsilon, mat, B, print_info);
 
-    // Create the solution and right-hand-side vectors
-    I size = sol.get_num_dof() / block_size;
-    MultiArrayNew<T *[block_size]> sol_vec("sol_vec", size);
-    MultiArrayNew<T *[block_size]> rhs_vec("rhs_vec", size);
+    // Create the right-hand-side and a blocked view of the solution
+    SolutionVector<T> rhs(mesh.get_num_dof());
+    auto rhs_vec = rhs.template get_block_view<block_size>();
+    auto sol_vec = sol.template get_block_view<block_size>();
 
     SolutionVector<T> res(mesh.get_num_dof());
     ElemVec elem_res(mesh, res);
@@ -312,13 +292,13 @@ class TopoHeatAnalysis {
     fe.add_residual(integrand, elem_data, elem_geo, elem_sol, elem_res);
 
     for (I i = 0; i < sol.get_num_dof(); i++) {
-      rhs_vec(i / block_size, i % block_size) = -res[i];
+      rhs[i] = -res[i];
     }
 
     // Zero out the boundary conditions
     for (I i = 0; i < nbcs; i++) {
       I dof = bc_dofs[i];
-      rhs_vec(dof / block_size, dof % block_size) = bc_temp;
+      rhs[dof] = bc_temp;
     }
 
     // Solve the problem
@@ -337,11 +317,6 @@ class TopoHeatAnalysis {
                     __FILE__, __LINE__, cg_it, cg_rtol, cg_atol);
       throw std::runtime_error(msg);
     }
-
-    // Record the solution
-    for (I i = 0; i < sol.get_num_dof(); i++) {
-      sol[i] = sol_vec(i / block_size, i % block_size);
-    }
   }
 
   /**
@@ -607,7 +582,8 @@ void test_heat_analysis(int argc, char *argv[]) {
   if (argc > 1) {
     vtk_name = argv[1];
   }
-  ReadVTK3D<I, T> readvtk(vtk_name);
+  bool verbose = false, hilbert_sort = true;
+  ReadVTK3D<I, T> readvtk(vtk_name, verbose, hilbert_sort);
 
   // Get connectivity for each element type
   T *Xloc = readvtk.get_Xloc();
@@ -625,8 +601,8 @@ void test_heat_analysis(int argc, char *argv[]) {
   std::vector<int> ids{100};
   std::vector<I> bc_verts = readvtk.get_verts_given_cell_entity_id(ids);
 
-  // Construct A2D mesh objects
-  ElementMesh<Basis> mesh(conn);
+  // Construct A2D mesh objects, with the solution dof in RCM order
+  ElementMesh<Basis> mesh(conn, DofOrdering::RCM, block_size);
   ElementMesh<GeoBasis> geomesh(conn);
   ElementMesh<DataBasis> datamesh(conn);
 
@@ -6,6 +6,7 @@
 #include "multiphysics/febasis.h"
 #include "multiphysics/feelement.h"
 #include "multiphysics/feelementmat.h"
+#include "multiphysics/fefilter.h"
 #include "multiphysics/femesh.h"
 #include "multiphysics/fequadrature.h"
 #include "multiphysics/hex_tools.h"
@@ -19,8 +20,9 @@
 using namespace A2D;
 
 /**
- * @brief Make the analysis look like it's using the
- *
+ * @brief Make the analysis look like it's using the design variables
+ * directly. The design variables x are filtered with the Helmholtz PDE filter
+ * to give the data rho of the analysis.
  */
 template <class FltrImpl, class AnlyImpl>
 class TopoFilterAnalysis : public Analysis<AnlyImpl> {
@@ -31,23 +33,27 @@ class TopoFilterAnalysis : public Analysis<AnlyImpl> {
   static_assert(std::is_same<Vec_t, typename FltrImpl::Vec_t>::value,
                 "Vector types must be the same");
 
-  TopoFilterAnalysis(std::shared_ptr<Analysis<FltrImpl>> filter,
+  TopoFilterAnalysis(std::shared_ptr<HelmholtzPDEFilter<FltrImpl>> filter,
+                     std::shared_ptr<Vec_t> x,
                      std::shared_ptr<Analysis<AnlyImpl>> analysis)
-      : filter(filter), analysis(analysis) {}
+      : filter(filter),
+        x(x),
+        analysis(analysis),
+        dfdrho(analysis->get_data()->get_num_dof()) {}
 
-  std::shared_ptr<Vec_t> get_data() { return filter->get_data(); }
+  std::shared_ptr<Vec_t> get_data() { return x; }
   std::shared_ptr<Vec_t> get_geo() { return analysis->get_geo(); }
   std::shared_ptr<Vec_t> get_sol() { return analysis->get_sol(); }
   std::shared_ptr<Vec_t> get_res() { return analysis->get_res(); }
 
   // x -> rho -> topology optimization
   void linear_solve() {
-    filter->linear_solve();
+    filter->apply(*x, *analysis->get_data());
     analysis->linear_solve();
   }
 
   void nonlinear_solve() {
-    filter->linear_solve();
+    filter->apply(*x, *analysis->get_data());
     analysis->nonlinear_solve();
   }
 
@@ -67,21 +73,23 @@ class TopoFilterAnalysis : public Analysis<AnlyImpl> {
     if (wrt == FEVarType::GEOMETRY) {
       analysis->eval_adjoint_derivative(func, wrt, dfdx);
     } else if (wrt == FEVarType::DATA) {
-      analysis->eval_adjoint_derivative(func, wrt, *filter->get_res());
-      filter->eval_adjoint_derivative(wrt, dfdx);
+      dfdrho.zero();
+      analysis->eval_adjoint_derivative(func, wrt, dfdrho);
+      filter->apply_transpose(dfdrho, dfdx);
     }
   }
 
   void eval_adjoint_derivative(FEVarType wrt, Vec_t &dfdx) {}
 
   void to_vtk(const std::string filename) {
-    filter->to_vtk(filename + std::string("-filter"));
     analysis->to_vtk(filename + std::string("-elasticity"));
   }
 
  private:
-  std::shared_ptr<Analysis<FltrImpl>> filter;
+  std::shared_ptr<HelmholtzPDEFilter<FltrImpl>> filter;
+  std::shared_ptr<Vec_t> x;
   std::shared_ptr<Analysis<AnlyImpl>> analysis;
+  Vec_t dfdrho;
 };
 
 template <class FltrImpl, class AnlyImpl>
@@ -311,13 +319,11 @@ int main(int argc, char *argv[]) {
     index_t ngeo = geo_mesh->get_num_dof();
     index_t ndof = sol_mesh->get_num_dof();
 
-    // Create the data vector for the filter
+    // Create the design variables, the input of the filter
     auto filter_data = std::make_shared<Vec_t>(ndata);
 
-    // Create the solution vector for the filter - same as the analysis data
-    // vector
+    // Create the filtered variables - same as the analysis data vector
     auto filter_sol = std::make_shared<Vec_t>(ndata);
-    auto filter_res = std::make_shared<Vec_t>(ndata);
 
     // Derivative of the function of interest
     auto dfdx = std::make_shared<Vec_t>(ndata);
@@ -349,8 +355,9 @@ int main(int argc, char *argv[]) {
     filer_assembler->add_element(std::make_shared<Filter_t>(
         filter_integrand, data_mesh, geo_mesh, data_mesh));
 
-    auto filter = std::make_shared<DirectCholeskyAnalysis<T, 1>>(
-        filter_data, geo, filter_sol, filter_res, filer_assembler);
+    // The filter matrix and its AMG hierarchy are built once
+    auto filter = std::make_shared<HelmholtzPDEFilter<FltrImpl_t>>(
+        filer_assembler, geo, ndata, ndata);
 
     // Create the element integrand
     T E = 70.0, nu = 0.3, q = 8.0;
@@ -394,7 +401,7 @@ int main(int argc, char *argv[]) {
                                              sol_mesh);
 
     auto topo = std::make_shared<TopoFilterAnalysis<FltrImpl_t, AnlyImpl_t>>(
-        filter, analysis);
+        filter, filter_data, analysis);
 
     // Set up the topology optimization problem
     std::string prefix("./results/");
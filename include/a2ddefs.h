@@ -92,7 +92,7 @@ KOKKOS_FUNCTION double fmt(A2D_complex_t<T> val) {
 
 KOKKOS_FUNCTION double fmt(double val) { return val; }
 
-double absfunc(A2D_complex_t<double> a) {
+KOKKOS_FUNCTION double absfunc(A2D_complex_t<double> a) {
   if (a.real() >= 0.0) {
     return a.real();
   } else {
@@ -100,7 +100,7 @@ double absfunc(A2D_complex_t<double> a) {
   }
 }
 
-double absfunc(double a) {
+KOKKOS_FUNCTION double absfunc(double a) {
   if (a >= 0.0) {
     return a;
   } else {
@@ -108,9 +108,9 @@ double absfunc(double a) {
   }
 }
 
-double RealPart(double a) { return a; }
+KOKKOS_FUNCTION double RealPart(double a) { return a; }
 
-double RealPart(A2D_complex_t<double> a) { return a.real(); }
+KOKKOS_FUNCTION double RealPart(A2D_complex_t<double> a) { return a.real(); }
 
 /*
   Remove the const-ness and references for a type
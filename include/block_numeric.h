@@ -195,7 +195,8 @@ extern void dgetri_(int* n, double* a, int* lda, int* ipiv, double* work,
 extern void zgelss_(int* m, int* n, int* nrhs, void* a, int* lda, void* b,
                     int* ldb, double* s, double* rcond, int* rank, void* work,
                     int* lwork, double* rwork, int* info);
-extern void zgetrf_(int* m, int* n, void* a, int* lda, int* ipiv, int* info);
+extern void zgetrf_(int* m, int* n, std::complex<double>* a, int* lda,
+                    int* ipiv, int* info);
 extern void zgetri_(int* n, void* a, int* lda, int* ipiv, void* work,
                     int* lwork, int* info);
 }
@@ -251,7 +252,8 @@ int blockPseudoInverse(AType& A, Mat<T, N, N>& Ainv) {
 
   if constexpr (is_complex<T>::value) {
     int ipiv[N];
-    zgetrf_(&m, &n, a, &lda, ipiv, &fail);
+    zgetrf_(&m, &n, reinterpret_cast<std::complex<double>*>(a), &lda, ipiv,
+            &fail);
     zgetri_(&n, a, &lda, ipiv, work, &lwork, &fail);
     for (int ii = 0; ii != N * N; ii++) {
       b[ii] = a[ii];
@@ -270,25 +272,43 @@ int blockPseudoInverse(AType& A, Mat<T, N, N>& Ainv) {
 }
 
 /*
-  Compute: Ainv = A^{-1} with pivoting
+  Compute the LU factorization P * A = L * U in place with partial pivoting.
+  The unit lower triangle of L and the upper triangle U overwrite A and the
+  row interchanges are stored in ipiv. All loop bounds are compile-time
+  constants so that the kernel is unrolled for the small blocks (N <= 8)
+  found in BSR matrices. Returns k + 1 if the k-th pivot is not larger than
+  pivot_tol * max|A|, i.e. zero for the default pivot_tol.
 */
-template <typename T, int N, class AType, class AinvType, class IType>
-int blockInverse(AType& A, AinvType& Ainv, IType& ipiv) {
-  int fail = 0;
+template <typename T, int N, class AType, class IType>
+KOKKOS_FUNCTION int blockLUFactor(AType& A, IType& ipiv,
+                                  double pivot_tol = 0.0) {
+  double amax = 0.0;
+  for (int i = 0; i < N; i++) {
+    for (int j = 0; j < N; j++) {
+      double t = absfunc(A(i, j));
+      if (t > amax) {
+        amax = t;
+      }
+    }
+  }
+  const double tol = pivot_tol * amax;
 
-  for (int k = 0; k < N - 1; k++) {
+  for (int k = 0; k < N; k++) {
     // Find the maximum value and use it as the pivot
     int r = k;
-    T maxv = A(k, k);
-    for (int j = k + 1; j < N; j++) {
-      T t = A(j, k);
-      if (absfunc(t) > absfunc(maxv)) {
+    double maxv = absfunc(A(k, k));
+    for (int i = k + 1; i < N; i++) {
+      double t = absfunc(A(i, k));
+      if (t > maxv) {
         maxv = t;
-        r = j;
+        r = i;
       }
     }
 
     ipiv(k) = r;
+    if (maxv <= tol) {
+      return k + 1;
+    }
 
     // If a swap is required, swap the rows
     if (r != k) {
@@ -299,13 +319,9 @@ int blockInverse(AType& A, AinvType& Ainv, IType& ipiv) {
       }
     }
 
-    if (absfunc(A(k, k)) == 0.0) {
-      fail = k + 1;
-      return fail;
-    }
-
+    T dinv = 1.0 / A(k, k);
     for (int i = k + 1; i < N; i++) {
-      A(i, k) = A(i, k) / A(k, k);
+      A(i, k) *= dinv;
     }
 
     for (int i = k + 1; i < N; i++) {
@@ -315,39 +331,180 @@ int blockInverse(AType& A, AinvType& Ainv, IType& ipiv) {
     }
   }
 
-  // Now, compute the matrix-inverse
+  return 0;
+}
+
+/*
+  Solve A * x = b in place using the factor from blockLUFactor, x holds b on
+  entry and the solution on exit
+*/
+template <typename T, int N, class LUType, class IType, class xType>
+KOKKOS_FUNCTION void blockLUSolve(const LUType& LU, const IType& ipiv,
+                                  xType& x) {
+  for (int i = 0; i < N; i++) {
+    int r = ipiv(i);
+    if (r != i) {
+      T t = x(i);
+      x(i) = x(r);
+      x(r) = t;
+    }
+  }
+
+  for (int i = 1; i < N; i++) {
+    T t = x(i);
+    for (int j = 0; j < i; j++) {
+      t -= LU(i, j) * x(j);
+    }
+    x(i) = t;
+  }
+
+  for (int i = N - 1; i >= 0; i--) {
+    T t = x(i);
+    for (int j = i + 1; j < N; j++) {
+      t -= LU(i, j) * x(j);
+    }
+    x(i) = t / LU(i, i);
+  }
+}
+
+/*
+  Solve A * X = B in place for the M columns of X using the factor from
+  blockLUFactor, X holds B on entry and the solution on exit
+*/
+template <typename T, int N, int M, class LUType, class IType, class XType>
+KOKKOS_FUNCTION void blockLUSolveMat(const LUType& LU, const IType& ipiv,
+                                     XType& X) {
+  for (int i = 0; i < N; i++) {
+    int r = ipiv(i);
+    if (r != i) {
+      for (int k = 0; k < M; k++) {
+        T t = X(i, k);
+        X(i, k) = X(r, k);
+        X(r, k) = t;
+      }
+    }
+  }
+
+  for (int i = 1; i < N; i++) {
+    for (int k = 0; k < M; k++) {
+      T t = X(i, k);
+      for (int j = 0; j < i; j++) {
+        t -= LU(i, j) * X(j, k);
+      }
+      X(i, k) = t;
+    }
+  }
+
+  for (int i = N - 1; i >= 0; i--) {
+    T dinv = 1.0 / LU(i, i);
+    for (int k = 0; k < M; k++) {
+      T t = X(i, k);
+      for (int j = i + 1; j < N; j++) {
+        t -= LU(i, j) * X(j, k);
+      }
+      X(i, k) = t * dinv;
+    }
+  }
+}
+
+/*
+  Compute: Ainv = A^{-1} with pivoting. A is overwritten by its LU factor.
+  Returns k + 1 if the k-th pivot is not larger than pivot_tol * max|A|.
+*/
+template <typename T, int N, class AType, class AinvType, class IType>
+KOKKOS_FUNCTION int blockInverse(AType& A, AinvType& Ainv, IType& ipiv,
+                                 double pivot_tol = 0.0) {
+  int fail = blockLUFactor<T, N>(A, ipiv, pivot_tol);
+  if (fail) {
+    return fail;
+  }
+
+  for (int i = 0; i < N; i++) {
+    for (int j = 0; j < N; j++) {
+      Ainv(i, j) = 0.0;
+    }
+    Ainv(i, i) = 1.0;
+  }
+  blockLUSolveMat<T, N, N>(A, ipiv, Ainv);
+
+  return 0;
+}
+
+/*
+  Compute the Cholesky factorization A = L * L^{T} in place. Only the lower
+  triangle of A is referenced and overwritten with L. Returns k + 1 if the
+  k-th pivot is not positive.
+*/
+template <typename T, int N, class AType>
+KOKKOS_FUNCTION int blockCholesky(AType& A) {
   for (int k = 0; k < N; k++) {
-    int ip = k;
-    for (int i = 0; i < N - 1; i++) {
-      if (ip == ipiv(i)) {
-        ip = i;
-      } else if (ip == i) {
-        ip = ipiv(i);
+    T d = A(k, k);
+    for (int j = 0; j < k; j++) {
+      d -= A(k, j) * A(k, j);
+    }
+    if (RealPart(d) <= 0.0) {
+      return k + 1;
+    }
+    A(k, k) = sqrt(d);
+
+    for (int i = k + 1; i < N; i++) {
+      T t = A(i, k);
+      for (int j = 0; j < k; j++) {
+        t -= A(i, j) * A(k, j);
       }
+      A(i, k) = t / A(k, k);
     }
+  }
 
-    for (int i = 0; i < ip; i++) {
-      Ainv(i, k) = 0.0;
+  return 0;
+}
+
+/*
+  Solve L * L^{T} * x = x in place using the factor from blockCholesky
+*/
+template <typename T, int N, class LType, class xType>
+KOKKOS_FUNCTION void blockCholeskySolve(const LType& L, xType& x) {
+  for (int i = 0; i < N; i++) {
+    T t = x(i);
+    for (int j = 0; j < i; j++) {
+      t -= L(i, j) * x(j);
     }
+    x(i) = t / L(i, i);
+  }
 
-    Ainv(ip, k) = 1.0;
+  for (int i = N - 1; i >= 0; i--) {
+    T t = x(i);
+    for (int j = i + 1; j < N; j++) {
+      t -= L(j, i) * x(j);
+    }
+    x(i) = t / L(i, i);
+  }
+}
 
-    for (int i = ip + 1; i < N; i++) {
-      Ainv(i, k) = 0.0;
-      for (int j = ip; j < i; j++) {
-        Ainv(i, k) -= A(i, j) * Ainv(j, k);
+/*
+  Solve L * L^{T} * X = X in place for the M columns of X
+*/
+template <typename T, int N, int M, class LType, class XType>
+KOKKOS_FUNCTION void blockCholeskySolveMat(const LType& L, XType& X) {
+  for (int i = 0; i < N; i++) {
+    for (int k = 0; k < M; k++) {
+      T t = X(i, k);
+      for (int j = 0; j < i; j++) {
+        t -= L(i, j) * X(j, k);
       }
+      X(i, k) = t / L(i, i);
     }
+  }
 
-    for (int i = N - 1; i >= 0; i--) {
+  for (int i = N - 1; i >= 0; i--) {
+    for (int k = 0; k < M; k++) {
+      T t = X(i, k);
       for (int j = i + 1; j < N; j++) {
-        Ainv(i, k) -= A(i, j) * Ainv(j, k);
+        t -= L(j, i) * X(j, k);
       }
-      Ainv(i, k) = Ainv(i, k) / A(i, i);
+      X(i, k) = t / L(i, i);
     }
   }
-
-  return fail;
 }
 
 }  // namespace A2D
@@ -6,11 +6,85 @@
 #include "multiphysics/febase.h"
 #include "multiphysics/femesh.h"
 #include "multiphysics/fesolution.h"
+#include "sparse/sparse_amg.h"
 #include "sparse/sparse_cholesky.h"
+#include "sparse/sparse_numeric.h"
 #include "sparse/sparse_utils.h"
+#include "utils/a2dprofiler.h"
 
 namespace A2D {
 
+/**
+ * @brief Options for the Newton solver used in nonlinear_solve()
+ *
+ * Setting max_reuse > 0 gives a modified Newton method that keeps the last
+ * factorization for up to max_reuse steps as long as the residual norm is
+ * reduced by at least reuse_rate at each step. When max_krylov_iters > 0, the
+ * step computed with a reused factorization is refined by preconditioned CG
+ * with the current Jacobian to the Eisenstat-Walker forcing tolerance.
+ */
+struct NewtonOptions {
+  index_t max_iters = 50;  // Maximum number of Newton iterations
+  double rtol = 1e-10;     // Relative tolerance on the residual norm
+  double atol = 1e-30;     // Absolute tolerance on the residual norm
+
+  // Modified Newton parameters
+  index_t max_reuse = 0;    // Maximum consecutive reuses of a factorization
+  double reuse_rate = 0.5;  // Refactor if |R_{k+1}| > reuse_rate * |R_k|
+
+  // Inexact Newton parameters (Eisenstat-Walker choice 2)
+  index_t max_krylov_iters = 0;  // Maximum Krylov iterations per step
+  double ew_eta0 = 0.5;          // Initial forcing term
+  double ew_eta_max = 0.9;       // Maximum forcing term
+  double ew_gamma = 0.9;         // Forcing term scaling
+  double ew_alpha = 1.618;       // Forcing term exponent
+
+  // Backtracking line search parameters
+  index_t max_line_search = 10;  // Maximum number of backtracking steps
+  double armijo = 1e-4;          // Sufficient decrease parameter
+  double backtrack = 0.5;        // Step length reduction factor
+
+  int print_level = 0;  // 0: silent, 1: summary, 2: every iteration
+};
+
+/**
+ * @brief Counters and per-phase timing collected by nonlinear_solve()
+ */
+struct NewtonStats {
+  bool converged = false;
+  index_t iterations = 0;
+  index_t factorizations = 0;   // Number of numerical factorizations
+  index_t reuses = 0;           // Steps that reused an existing factorization
+  index_t residual_evals = 0;   // Residual-only assemblies
+  index_t fused_evals = 0;      // Fused residual and Jacobian assemblies
+  index_t jacobian_evals = 0;   // Jacobian-only assemblies
+  index_t line_search_steps = 0;
+  index_t krylov_iters = 0;
+  index_t krylov_failures = 0;  // Krylov solves that missed the tolerance
+
+  // Time spent in each phase in seconds
+  double t_assembly = 0.0;
+  double t_factor = 0.0;
+  double t_solve = 0.0;
+  double t_total = 0.0;
+
+  void report() const {
+    std::printf("Newton %s in %d iterations\n",
+                converged ? "converged" : "did not converge", iterations);
+    std::printf("  factorizations:      %8d (reused %d times)\n",
+                factorizations, reuses);
+    std::printf("  assemblies:          %8d residual, %d fused, %d jacobian\n",
+                residual_evals, fused_evals, jacobian_evals);
+    std::printf("  line search steps:   %8d\n", line_search_steps);
+    std::printf("  krylov iterations:   %8d (%d failed solves)\n",
+                krylov_iters, krylov_failures);
+    std::printf("  time assembly:       %12.4e s\n", t_assembly);
+    std::printf("  time factor:         %12.4e s\n", t_factor);
+    std::printf("  time solve:          %12.4e s\n", t_solve);
+    std::printf("  time total:          %12.4e s\n", t_total);
+  }
+};
+
 template <class Impl>
 class Analysis {
  public:
@@ -36,6 +110,42 @@ class Analysis {
   virtual void to_vtk(const std::string prefix) {}
 };
 
+/**
+ * @brief Add the derivative of a simple eigenvalue of K * x = lambda * M * x
+ *
+ * For an M-normalized eigenvector x, d(lambda)/dp = x^{T} * (dK/dp - lambda *
+ * dM/dp) * x. Each term is an adjoint-residual product with x as both the
+ * state and the adjoint, so the residuals of the stiffness and mass
+ * assemblers must be the linear forms K * u and M * u without load terms.
+ *
+ * @param stiffness Assembler with the residual K * u
+ * @param mass Assembler with the residual M * u, or nullptr if M does not
+ * depend on the design variables
+ * @param wrt Derivative with respect to the data or the geometry
+ * @param alpha Scalar multiple of the derivative
+ * @param lambda The eigenvalue
+ * @param data The data vector
+ * @param geo The geometry vector
+ * @param eigvec The M-normalized eigenvector
+ * @param dfdx Derivative output dfdx += alpha * d(lambda)/dp
+ */
+template <class Impl>
+void add_eigenvalue_derivative(ElementAssembler<Impl> &stiffness,
+                               ElementAssembler<Impl> *mass, FEVarType wrt,
+                               typename Impl::type alpha,
+                               typename Impl::type lambda,
+                               typename Impl::Vec_t &data,
+                               typename Impl::Vec_t &geo,
+                               typename Impl::Vec_t &eigvec,
+                               typename Impl::Vec_t &dfdx) {
+  stiffness.add_adjoint_res_product(wrt, alpha, data, geo, eigvec, eigvec,
+                                    dfdx);
+  if (mass) {
+    mass->add_adjoint_res_product(wrt, -alpha * lambda, data, geo, eigvec,
+                                  eigvec, dfdx);
+  }
+}
+
 template <typename T, index_t block_size>
 class DirectCholeskyAnalysisImpl {
  public:
@@ -133,28 +243,30 @@ class DirectCholeskyAnalysis
    */
   void residual() {
     res->zero();
-    assembler->add_residual(T(1.0), *data, *geo, *sol, *res);
 
-    // Apply boundary conditions
-    if (bcs != nullptr) {
-      bcs->zero_bcs(*res);
-    }
+    // Assemble and apply the boundary conditions
+    assembler->add_residual(T(1.0), *data, *geo, *sol, *res, bcs.get());
   }
 
   /**
    * @brief Compute the Jacobian and store it
    */
   void jacobian() {
-    // Compute the BSR matrix
+    // Compute the BSR matrix and zero the rows corresponding to the boundary
+    // conditions
     bsr_mat->zero();
-    assembler->add_jacobian(T(1.0), *data, *geo, *sol, *bsr_mat);
+    assembler->add_jacobian(T(1.0), *data, *geo, *sol, *bsr_mat, bcs.get());
+  }
 
-    // Zero the rows corresponding to the boundary conditions
-    if (bcs != nullptr) {
-      const index_t *bc_dofs;
-      index_t nbcs = bcs->get_bcs(&bc_dofs);
-      bsr_mat->zero_rows(nbcs, bc_dofs);
-    }
+  /**
+   * @brief Compute the residual and the Jacobian in a single pass over the
+   * elements and store them
+   */
+  void residual_and_jacobian() {
+    res->zero();
+    bsr_mat->zero();
+    assembler->add_residual_and_jacobian(T(1.0), *data, *geo, *sol, *res,
+                                         *bsr_mat, bcs.get());
   }
 
   /**
@@ -182,9 +294,9 @@ class DirectCholeskyAnalysis
    * @brief Perform a linear solve to obtain the solution
    */
   void linear_solve() {
-    residual();
-    jacobian();
+    residual_and_jacobian();
     factor();
+    factor_is_current = true;
 
     // Find the solution
     chol->solve(res->data());
@@ -198,7 +310,206 @@ class DirectCholeskyAnalysis
     sol->axpy(-1.0, *res);
   }
 
-  void nonlinear_solve() {}
+  /**
+   * @brief Set the options for the Newton solver
+   */
+  void set_newton_options(const NewtonOptions &opts) { newton_opts = opts; }
+
+  /**
+   * @brief Get the counters and timing from the last nonlinear solve
+   */
+  const NewtonStats &get_newton_stats() const { return newton_stats; }
+
+  /**
+   * @brief Solve the nonlinear problem R(u) = 0 using Newton's method
+   *
+   * Each step solves J * du = R using the Cholesky factorization and updates
+   * u <- u - alpha * du, where alpha is found by a backtracking line search on
+   * |R|. Only the residual is assembled at the trial points of the line
+   * search, the Jacobian is assembled once a step is accepted and a new
+   * factorization is needed. The initial point uses the fused residual and
+   * Jacobian assembly for the full Newton method. See NewtonOptions for the
+   * modified and inexact Newton variants. If the Krylov refinement of an
+   * inexact step does not converge, the step is recomputed with a new
+   * factorization of the current Jacobian.
+   */
+  void nonlinear_solve() {
+    const NewtonOptions &opts = newton_opts;
+    NewtonStats &stats = newton_stats;
+    stats = NewtonStats();
+    StopWatch total_watch, watch;
+
+    const index_t ndof = sol->get_num_dof();
+    Vec_t du(ndof), sol0(ndof), res0(ndof);
+
+    // Apply the boundary condition values
+    if (bcs != nullptr) {
+      bcs->set_bcs(*sol);
+    }
+
+    // Compute the initial residual
+    const bool full_newton = (opts.max_reuse == 0);
+    bool jac_current = false;
+    watch.reset_start();
+    if (full_newton) {
+      residual_and_jacobian();
+      stats.fused_evals++;
+      jac_current = true;
+    } else {
+      residual();
+      stats.residual_evals++;
+    }
+    stats.t_assembly += watch.lap();
+
+    double res_norm = absfunc(res->norm());
+    double init_norm = res_norm;
+    double eta = opts.ew_eta0;
+    bool refactor = true;
+    index_t reuse_count = 0;
+    factor_is_current = false;
+
+    for (index_t k = 0;; k++) {
+      if (opts.print_level >= 2) {
+        std::printf("Newton |R|[%3d]: %20.10e\n", k, res_norm);
+      }
+      if (res_norm <= opts.atol || res_norm <= opts.rtol * init_norm) {
+        stats.converged = true;
+        break;
+      }
+      if (k >= opts.max_iters) {
+        break;
+      }
+      stats.iterations++;
+
+      // Factor the Jacobian or reuse the existing factorization
+      bool stale = true;
+      if (refactor || reuse_count >= opts.max_reuse) {
+        if (!jac_current) {
+          watch.reset_start();
+          jacobian();
+          stats.jacobian_evals++;
+          stats.t_assembly += watch.lap();
+          jac_current = true;
+        }
+
+        watch.reset_start();
+        factor();
+        stats.factorizations++;
+        stats.t_factor += watch.lap();
+        reuse_count = 0;
+        stale = false;
+      } else {
+        stats.reuses++;
+        reuse_count++;
+      }
+
+      // Compute the update
+      if (stale && opts.max_krylov_iters > 0) {
+        if (!jac_current) {
+          watch.reset_start();
+          jacobian();
+          stats.jacobian_evals++;
+          stats.t_assembly += watch.lap();
+          jac_current = true;
+        }
+
+        watch.reset_start();
+        index_t iters = 0;
+        bool solved = krylov_solve(eta, opts.max_krylov_iters, du, iters);
+        stats.krylov_iters += iters;
+        stats.t_solve += watch.lap();
+
+        // Fall back to a direct solve with the current Jacobian
+        if (!solved) {
+          stats.krylov_failures++;
+          watch.reset_start();
+          factor();
+          stats.factorizations++;
+          stats.t_factor += watch.lap();
+          reuse_count = 0;
+          stale = false;
+
+          watch.reset_start();
+          du.copy(*res);
+          chol->solve(du.data());
+          stats.t_solve += watch.lap();
+        }
+      } else {
+        watch.reset_start();
+        du.copy(*res);
+        chol->solve(du.data());
+        stats.t_solve += watch.lap();
+      }
+
+      // Backtracking line search on the residual norm
+      sol0.copy(*sol);
+      res0.copy(*res);
+      double alpha = 1.0, new_norm = res_norm;
+      bool accepted = false;
+      for (index_t ls = 0;; ls++) {
+        sol->copy(sol0);
+        sol->axpy(-alpha, du);
+
+        watch.reset_start();
+        residual();
+        stats.residual_evals++;
+        jac_current = false;
+        stats.t_assembly += watch.lap();
+
+        new_norm = absfunc(res->norm());
+        if (new_norm <= (1.0 - opts.armijo * alpha) * res_norm) {
+          accepted = true;
+          break;
+        }
+        if (ls >= opts.max_line_search) {
+          break;
+        }
+        alpha *= opts.backtrack;
+        stats.line_search_steps++;
+      }
+      factor_is_current = false;
+
+      if (opts.print_level >= 2) {
+        std::printf("Newton step[%3d]: alpha %10.3e %s%s\n", k, alpha,
+                    stale ? "reused factor" : "new factor",
+                    accepted ? "" : ", line search failed");
+      }
+      if (!accepted) {
+        // Return to the last accepted iterate and its residual
+        sol->copy(sol0);
+        res->copy(res0);
+        jac_current = false;
+
+        // Retry from the same point with a new factorization, unless the
+        // factorization was already current
+        if (!stale) {
+          break;
+        }
+        refactor = true;
+        continue;
+      }
+
+      // Keep the factorization only while the convergence is satisfactory
+      refactor = (full_newton || alpha < 1.0 ||
+                  new_norm > opts.reuse_rate * res_norm);
+
+      // Eisenstat-Walker forcing term (choice 2) with safeguard
+      double eta_prev = eta;
+      eta = opts.ew_gamma * std::pow(new_norm / res_norm, opts.ew_alpha);
+      double eta_safe = opts.ew_gamma * std::pow(eta_prev, opts.ew_alpha);
+      if (eta_safe > 0.1) {
+        eta = std::max(eta, eta_safe);
+      }
+      eta = std::min(eta, opts.ew_eta_max);
+
+      res_norm = new_norm;
+    }
+
+    stats.t_total = total_watch.lap();
+    if (opts.print_level >= 1) {
+      stats.report();
+    }
+  }
 
   T evaluate(FunctionalBase<Impl_t> &func) {
     return func.evaluate(*data, *geo, *sol);
@@ -230,6 +541,13 @@ class DirectCholeskyAnalysis
       bcs->zero_bcs(*res);
     }
 
+    // Make sure the factorization corresponds to the current solution
+    if (!factor_is_current) {
+      jacobian();
+      factor();
+      factor_is_current = true;
+    }
+
     // Solve the adjoint system
     chol->solve(res->data());
 
@@ -249,6 +567,13 @@ class DirectCholeskyAnalysis
       bcs->zero_bcs(*res);
     }
 
+    // Make sure the factorization corresponds to the current solution
+    if (!factor_is_current) {
+      jacobian();
+      factor();
+      factor_is_current = true;
+    }
+
     // Solve the adjoint system
     chol->solve(res->data());
 
@@ -280,6 +605,40 @@ class DirectCholeskyAnalysis
 
   // Cholesky solver
   SparseCholesky<T> *chol;
+
+  // Flag to indicate whether the factorization is at the current solution
+  bool factor_is_current = false;
+
+  // Newton solver options and statistics
+  NewtonOptions newton_opts;
+  NewtonStats newton_stats;
+
+  // Solve J * du = res using CG preconditioned with the current factorization.
+  // Returns whether CG reached the tolerance, iters is set to the number of
+  // matrix-vector products.
+  bool krylov_solve(double rtol, index_t max_iters, Vec_t &du,
+                    index_t &iters) {
+    using Array_t = MultiArrayNew<T *[block_size]>;
+    const index_t nbrows = bsr_mat->nbrows;
+    Array_t b(res->data(), nbrows);
+    Array_t x(du.data(), nbrows);
+
+    index_t count = 0;
+    auto mat_vec = [&](Array_t &in, Array_t &out) {
+      BSRMatVecMult(*bsr_mat, in, out);
+      count++;
+    };
+    auto apply_factor = [&](Array_t &in, Array_t &out) {
+      BLAS::copy(out, in);
+      chol->solve(out.data());
+    };
+
+    index_t monitor = 0;
+    bool solved = conjugate_gradient<T, block_size>(
+        mat_vec, apply_factor, b, x, monitor, max_iters, rtol);
+    iters = count;
+    return solved;
+  }
 };
 
 // template <typename T, index_t block_size>
@@ -2,12 +2,15 @@
 #define A2D_FE_BASE_H
 
 #include <algorithm>
+#include <cmath>
 #include <list>
 #include <set>
+#include <vector>
 
 #include "a2ddefs.h"
 #include "multiphysics/feelement.h"
 #include "multiphysics/femesh.h"
+#include "parallel.h"
 
 namespace A2D {
 
@@ -48,6 +51,9 @@ class ElementBase {
 
   virtual const ElementMeshBase& get_mesh(FEVarType wrt) const = 0;
 
+  // Estimated cost of the element group used for scheduling
+  virtual double get_cost() const { return 0.0; }
+
   // Add the residual
   virtual void add_residual(T alpha, Vec_t& data, Vec_t& geo, Vec_t& sol,
                             Vec_t& res) = 0;
@@ -56,6 +62,13 @@ class ElementBase {
   virtual void add_jacobian(T alpha, Vec_t& data, Vec_t& geo, Vec_t& sol,
                             Mat_t& mat) = 0;
 
+  // Add the residual and the Jacobian
+  virtual void add_residual_and_jacobian(T alpha, Vec_t& data, Vec_t& geo,
+                                         Vec_t& sol, Vec_t& res, Mat_t& mat) {
+    add_residual(alpha, data, geo, sol, res);
+    add_jacobian(alpha, data, geo, sol, mat);
+  }
+
   // Add the adjoint-residual product
   virtual void add_adjoint_res_product(FEVarType wrt, T alpha, Vec_t& data,
                                        Vec_t& geo, Vec_t& sol, Vec_t& adjoint,
@@ -83,6 +96,10 @@ class ElementAssembler {
   // Add an element at the specified index
   void add_element(Elem_t element) { elements.push_back(element); }
 
+  // Evaluate the small element groups concurrently, see schedule_groups()
+  // (off by default)
+  void set_concurrent_groups(bool flag) { concurrent_groups = flag; }
+
   // Get the CSR structure for all the elements in the mesh
   void get_bsr_data(const index_t block_size, index_t& nrows,
                     std::vector<index_t>& rowp, std::vector<index_t>& cols) {
@@ -95,19 +112,119 @@ class ElementAssembler {
     ElementMeshBase::create_block_csr(pairs, nrows, rowp, cols);
   }
 
-  // Add the residual from all the elements
-  void add_residual(T alpha, Vec_t& data, Vec_t& geo, Vec_t& sol, Vec_t& res) {
-    typename std::list<Elem_t>::iterator it;
-    for (it = elements.begin(); it != elements.end(); ++it) {
-      (*it)->add_residual(alpha, data, geo, sol, res);
+  /**
+   * @brief Add the residual from all the elements
+   *
+   * Small element groups can be evaluated concurrently, see
+   * schedule_groups(). If bcs is provided, the boundary condition entries of
+   * the residual are zeroed as part of the assembly.
+   */
+  void add_residual(T alpha, Vec_t& data, Vec_t& geo, Vec_t& sol, Vec_t& res,
+                    const DirichletBCs<T>* bcs = nullptr) {
+    std::vector<Elem_t> large;
+    std::vector<std::vector<Elem_t>> bins;
+    schedule_groups(large, bins);
+    const int nbins = bins.size();
+
+    // Each bin except the first accumulates into its own residual
+    std::vector<std::shared_ptr<Vec_t>>& local = get_bin_vectors(nbins, res);
+
+    for (auto& elem : large) {
+      elem->add_residual(alpha, data, geo, sol, res);
+    }
+
+#pragma omp parallel for schedule(dynamic, 1) if (nbins > 1)
+    for (int b = 0; b < nbins; b++) {
+      Vec_t& out = (b == 0 ? res : *local[b]);
+      for (auto& elem : bins[b]) {
+        elem->add_residual(alpha, data, geo, sol, out);
+      }
     }
+
+    // Sum the contributions and apply the boundary conditions
+    reduce_and_zero_bcs(res, local, nbins, bcs);
   }
 
-  // Add the Jacobian contributions from all the elements
-  void add_jacobian(T alpha, Vec_t& data, Vec_t& geo, Vec_t& sol, Mat_t& mat) {
-    typename std::list<Elem_t>::iterator it;
-    for (it = elements.begin(); it != elements.end(); ++it) {
-      (*it)->add_jacobian(alpha, data, geo, sol, mat);
+  /**
+   * @brief Add the Jacobian contributions from all the elements
+   *
+   * Element groups are evaluated concurrently in the same manner as the
+   * residual. If bcs is provided, the rows corresponding to the boundary
+   * conditions are zeroed and the diagonal set to one during the reduction.
+   */
+  void add_jacobian(T alpha, Vec_t& data, Vec_t& geo, Vec_t& sol, Mat_t& mat,
+                    const DirichletBCs<T>* bcs = nullptr) {
+    std::vector<Elem_t> large;
+    std::vector<std::vector<Elem_t>> bins;
+    schedule_groups(large, bins);
+    const int nbins = bins.size();
+
+    // Each bin except the first accumulates into a matrix with the same
+    // non-zero pattern
+    std::vector<std::shared_ptr<Mat_t>>& local = get_bin_matrices(nbins, mat);
+
+    for (auto& elem : large) {
+      elem->add_jacobian(alpha, data, geo, sol, mat);
+    }
+
+#pragma omp parallel for schedule(dynamic, 1) if (nbins > 1)
+    for (int b = 0; b < nbins; b++) {
+      Mat_t& out = (b == 0 ? mat : *local[b]);
+      for (auto& elem : bins[b]) {
+        elem->add_jacobian(alpha, data, geo, sol, out);
+      }
+    }
+
+    if (nbins > 1) {
+      reduce_and_zero_rows(mat, local, nbins, bcs);
+    } else if (bcs) {
+      const index_t* bc_dofs;
+      index_t nbcs = bcs->get_bcs(&bc_dofs);
+      mat.zero_rows(nbcs, bc_dofs);
+    }
+  }
+
+  /**
+   * @brief Add the residual and the Jacobian from all the elements
+   *
+   * This is equivalent to calling add_residual() and add_jacobian(), but each
+   * element group computes both contributions in a single pass over its
+   * elements.
+   */
+  void add_residual_and_jacobian(T alpha, Vec_t& data, Vec_t& geo, Vec_t& sol,
+                                 Vec_t& res, Mat_t& mat,
+                                 const DirichletBCs<T>* bcs = nullptr) {
+    std::vector<Elem_t> large;
+    std::vector<std::vector<Elem_t>> bins;
+    schedule_groups(large, bins);
+    const int nbins = bins.size();
+
+    std::vector<std::shared_ptr<Vec_t>>& local_res =
+        get_bin_vectors(nbins, res);
+    std::vector<std::shared_ptr<Mat_t>>& local_mat =
+        get_bin_matrices(nbins, mat);
+
+    for (auto& elem : large) {
+      elem->add_residual_and_jacobian(alpha, data, geo, sol, res, mat);
+    }
+
+#pragma omp parallel for schedule(dynamic, 1) if (nbins > 1)
+    for (int b = 0; b < nbins; b++) {
+      Vec_t& out_res = (b == 0 ? res : *local_res[b]);
+      Mat_t& out_mat = (b == 0 ? mat : *local_mat[b]);
+      for (auto& elem : bins[b]) {
+        elem->add_residual_and_jacobian(alpha, data, geo, sol, out_res,
+                                        out_mat);
+      }
+    }
+
+    reduce_and_zero_bcs(res, local_res, nbins, bcs);
+    if (nbins > 1) {
+      reduce_and_zero_rows(mat, local_mat, nbins, bcs);
+    } else if (bcs) {
+      const index_t* bc_dofs;
+      index_t nbcs = bcs->get_bcs(&bc_dofs);
+      mat.zero_rows(nbcs, bc_dofs);
     }
   }
 
@@ -132,7 +249,201 @@ class ElementAssembler {
   }
 
  private:
+  /**
+   * @brief Get the residuals for the bins 1, ..., nbins - 1
+   *
+   * The vectors are kept between calls and zeroed on reuse, so repeated
+   * assemblies do not allocate.
+   */
+  std::vector<std::shared_ptr<Vec_t>>& get_bin_vectors(int nbins,
+                                                       Vec_t& res) {
+    if (int(bin_vectors.size()) < nbins) {
+      bin_vectors.resize(nbins);
+    }
+    for (int b = 1; b < nbins; b++) {
+      if (!bin_vectors[b] ||
+          bin_vectors[b]->get_num_dof() != res.get_num_dof()) {
+        bin_vectors[b] = std::make_shared<Vec_t>(res.get_num_dof());
+      } else {
+        bin_vectors[b]->zero();
+      }
+    }
+    return bin_vectors;
+  }
+
+  /**
+   * @brief Get the matrices for the bins 1, ..., nbins - 1
+   *
+   * The matrices share the non-zero pattern of mat and only allocate their
+   * values. They are kept between calls with the same matrix and zeroed on
+   * reuse.
+   */
+  std::vector<std::shared_ptr<Mat_t>>& get_bin_matrices(int nbins,
+                                                        Mat_t& mat) {
+    if (int(bin_matrices.size()) < nbins) {
+      bin_matrices.resize(nbins);
+    }
+    for (int b = 1; b < nbins; b++) {
+      if (!bin_matrices[b] || bin_matrices[b]->nnz != mat.nnz ||
+          bin_matrices[b]->rowp.data() != mat.rowp.data()) {
+        bin_matrices[b] = std::make_shared<Mat_t>(mat);
+        bin_matrices[b]->vals = decltype(mat.vals)("vals", mat.nnz);
+      } else {
+        bin_matrices[b]->zero();
+      }
+    }
+    return bin_matrices;
+  }
+
+  /**
+   * @brief Sum the vectors from the bins into the first vector and zero the
+   * entries with boundary conditions
+   */
+  void reduce_and_zero_bcs(Vec_t& res,
+                           std::vector<std::shared_ptr<Vec_t>>& local,
+                           const int nbins, const DirichletBCs<T>* bcs) {
+    const index_t* bc_dofs = nullptr;
+    const index_t nbcs = (bcs ? bcs->get_bcs(&bc_dofs) : 0);
+    const index_t ndof = (nbins > 1 ? res.get_num_dof() : 0);
+
+#pragma omp parallel if (nbins > 1)
+    {
+#pragma omp for
+      for (index_t i = 0; i < ndof; i++) {
+        for (int b = 1; b < nbins; b++) {
+          res[i] += (*local[b])[i];
+        }
+      }
+
+#pragma omp for
+      for (index_t i = 0; i < nbcs; i++) {
+        res[bc_dofs[i]] = T(0.0);
+      }
+    }
+  }
+
+  /**
+   * @brief Sum the matrices from the bins into the first matrix and apply the
+   * boundary conditions to each block row in the same pass
+   */
+  template <index_t M, index_t N>
+  void reduce_and_zero_rows(BSRMat<T, M, N>& mat,
+                            std::vector<std::shared_ptr<Mat_t>>& local,
+                            const int nbins, const DirichletBCs<T>* bcs) {
+
+    // Flag the rows with boundary conditions
+    std::vector<char> is_bc;
+    if (bcs) {
+      const index_t* bc_dofs;
+      index_t nbcs = bcs->get_bcs(&bc_dofs);
+      is_bc.resize(M * mat.nbrows, 0);
+      for (index_t i = 0; i < nbcs; i++) {
+        is_bc[bc_dofs[i]] = 1;
+      }
+    }
+
+#pragma omp parallel for
+    for (index_t i = 0; i < mat.nbrows; i++) {
+      for (index_t jp = mat.rowp[i]; jp < mat.rowp[i + 1]; jp++) {
+        for (int b = 1; b < nbins; b++) {
+          for (index_t ii = 0; ii < M; ii++) {
+            for (index_t jj = 0; jj < N; jj++) {
+              mat.vals(jp, ii, jj) += local[b]->vals(jp, ii, jj);
+            }
+          }
+        }
+
+        if (bcs) {
+          for (index_t ii = 0; ii < M; ii++) {
+            if (is_bc[M * i + ii]) {
+              for (index_t jj = 0; jj < N; jj++) {
+                mat.vals(jp, ii, jj) = T(0.0);
+              }
+              if (mat.cols[jp] == i) {
+                mat.vals(jp, ii, ii) = T(1.0);
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+
+  /**
+   * @brief Partition the element groups into bins of balanced cost
+   *
+   * The cost of each group is estimated as the number of elements times
+   * ndof^2. The element loop of each group is itself parallel, and runs on a
+   * single thread when it is nested inside a concurrent bin. Groups that cost
+   * at least 1/nthreads of the total are therefore evaluated one after
+   * another, each with all the threads. Only the remaining small groups are
+   * assigned, most expensive first, to the bin with the lowest accumulated
+   * cost. The number of bins is the smallest number that attains the lower
+   * bound on the run time set by the most expensive small group, limited by
+   * the number of threads. This keeps the storage for the additional bins to
+   * a minimum.
+   *
+   * @param large the groups evaluated one after another
+   * @param bins the small groups of elements assigned to each bin
+   */
+  void schedule_groups(std::vector<Elem_t>& large,
+                       std::vector<std::vector<Elem_t>>& bins) {
+    large.clear();
+    if (!concurrent_groups) {
+      large.assign(elements.begin(), elements.end());
+      bins.clear();
+      return;
+    }
+
+    const int nthreads = omp_get_max_threads();
+    double total = 0.0;
+    for (auto& elem : elements) {
+      total += elem->get_cost();
+    }
+
+    std::vector<std::pair<double, Elem_t>> groups;
+    double small_total = 0.0, max_cost = 0.0;
+    for (auto& elem : elements) {
+      double cost = elem->get_cost();
+      if (cost * nthreads >= total) {
+        large.push_back(elem);
+      } else {
+        groups.push_back(std::make_pair(cost, elem));
+        small_total += cost;
+        max_cost = std::max(max_cost, cost);
+      }
+    }
+
+    int nbins = (groups.empty() ? 0 : 1);
+    if (groups.size() > 1 && max_cost > 0.0) {
+      nbins = std::ceil(small_total / max_cost);
+      nbins = std::min(nbins, nthreads);
+      nbins = std::min(nbins, int(groups.size()));
+    }
+
+    std::stable_sort(groups.begin(), groups.end(),
+                     [](const std::pair<double, Elem_t>& a,
+                        const std::pair<double, Elem_t>& b) {
+                       return a.first > b.first;
+                     });
+
+    bins.assign(nbins, std::vector<Elem_t>());
+    std::vector<double> bin_cost(nbins, 0.0);
+    for (auto& group : groups) {
+      int b = std::min_element(bin_cost.begin(), bin_cost.end()) -
+              bin_cost.begin();
+      bins[b].push_back(group.second);
+      bin_cost[b] += group.first;
+    }
+  }
+
   std::list<Elem_t> elements;
+
+  bool concurrent_groups = false;
+
+  // Residuals and matrices of the bins, reused between assemblies
+  std::vector<std::shared_ptr<Vec_t>> bin_vectors;
+  std::vector<std::shared_ptr<Mat_t>> bin_matrices;
 };
 
 /*
@@ -173,6 +484,16 @@ class ElementIntegrand : public ElementBase<Impl> {
     }
   }
 
+  // The cost is estimated as num_elements * ndof^2
+  double get_cost() const {
+    double ndof = Basis::ndof;
+    return sol_mesh->get_num_elements() * ndof * ndof;
+  }
+
+  // Set whether the element loops use a team of threads for each element (off
+  // by default)
+  void set_team_policy(bool flag) { element.set_team_policy(flag); }
+
   // Add the residual to the residual vector
   void add_residual(T alpha, Vec_t& data, Vec_t& geo, Vec_t& sol, Vec_t& res) {
     const Integrand& integrand = this->get_integrand();
@@ -195,6 +516,19 @@ class ElementIntegrand : public ElementBase<Impl> {
         integrand, alpha, elem_data, elem_geo, elem_sol, elem_jac);
   }
 
+  // Add the residual and the Jacobian in a single pass over the elements
+  void add_residual_and_jacobian(T alpha, Vec_t& data, Vec_t& geo, Vec_t& sol,
+                                 Vec_t& res, Mat_t& mat) {
+    const Integrand& integrand = this->get_integrand();
+    ElementVector<DataBasis> elem_data(*data_mesh, data);
+    ElementVector<GeoBasis> elem_geo(*geo_mesh, geo);
+    ElementVector<Basis> elem_sol(*sol_mesh, sol);
+    ElementVector<Basis> elem_res(*sol_mesh, res);
+    ElementMatrix<Basis> elem_jac(*sol_mesh, mat);
+    element.template add_residual_and_jacobian<FEVarType::STATE>(
+        integrand, alpha, elem_data, elem_geo, elem_sol, elem_res, elem_jac);
+  }
+
   // Add the adjoint-residual product
   void add_adjoint_res_product(FEVarType wrt, T alpha, Vec_t& data, Vec_t& geo,
                                Vec_t& sol, Vec_t& adjoint, Vec_t& dfdx) {
@@ -1,6 +1,9 @@
 #ifndef A2D_FE_BASIS_H
 #define A2D_FE_BASIS_H
 
+#include <tuple>
+#include <type_traits>
+
 #include "a2ddefs.h"
 #include "multiphysics/feelementtypes.h"
 #include "multiphysics/fespace.h"
@@ -171,6 +174,24 @@ struct have_same_dim<B1, B2, rest...> {
   static constexpr index_t dim = B1::dim;
 };
 
+/*
+  Check whether a basis provides a sum-factorized outer product over all the
+  quadrature points with the signature
+
+  template <class Quadrature, class QMat, class Mat>
+  static void add_outer_tensor(const QMat jac[], Mat& mat);
+*/
+template <class Basis, class Quadrature, class QMat, class Mat,
+          typename = void>
+struct has_add_outer_tensor : std::false_type {};
+
+template <class Basis, class Quadrature, class QMat, class Mat>
+struct has_add_outer_tensor<
+    Basis, Quadrature, QMat, Mat,
+    std::void_t<decltype(Basis::template add_outer_tensor<Quadrature>(
+        std::declval<const QMat*>(), std::declval<Mat&>()))>>
+    : std::true_type {};
+
 /*
   The finite element basis class.
 
@@ -369,6 +390,41 @@ class FEBasis {
     add_outer_<QMat, Mat, 0, Basis...>(N, jac, mat);
   }
 
+  /**
+   * @brief Check whether add_outer_tensor() can be used in place of
+   * add_outer() at each quadrature point
+   *
+   * This requires a single basis that provides the sum-factorized kernel and
+   * a tensor-product quadrature.
+   */
+  template <class Quadrature, class QMat, class Mat>
+  KOKKOS_FUNCTION static constexpr bool has_outer_tensor() {
+    if constexpr (nbasis == 1 && Quadrature::is_tensor_product) {
+      return has_add_outer_tensor<std::tuple_element_t<0, BasisSpace>,
+                                  Quadrature, QMat, Mat>::value;
+    } else {
+      return false;
+    }
+  }
+
+  /**
+   * @brief Add the outer products with the Jacobians at all the quadrature
+   * points to the element matrix with a sum-factorized kernel
+   *
+   * @tparam Quadrature The tensor-product quadrature object
+   * @tparam QMat The Jacobian matrix at a quadrature point
+   * @tparam Mat The matrix type
+   * @param jac The Jacobians at all the quadrature points
+   * @param mat The element Jacobian matrix
+   */
+  template <class Quadrature, class QMat, class Mat>
+  KOKKOS_FUNCTION static void add_outer_tensor(const QMat jac[], Mat& mat) {
+    static_assert(has_outer_tensor<Quadrature, QMat, Mat>(),
+                  "The basis does not provide add_outer_tensor()");
+    std::tuple_element_t<0, BasisSpace>::template add_outer_tensor<Quadrature>(
+        jac, mat);
+  }
+
   /**
    * @brief Get the number of degrees of freedom for the entity
    *
@@ -888,6 +944,21 @@ class FEBasis {
   }
 };
 
+/*
+  The low-order refined basis of a high-order FEBasis, where each basis is
+  replaced by its LOrderBasis
+*/
+template <class HOrderBasis>
+struct __lorder_fe_basis;
+
+template <typename T, class... Basis>
+struct __lorder_fe_basis<FEBasis<T, Basis...>> {
+  using type = FEBasis<T, typename Basis::LOrderBasis...>;
+};
+
+template <class HOrderBasis>
+using LOrderFEBasis = typename __lorder_fe_basis<HOrderBasis>::type;
+
 }  // namespace A2D
 
 #endif  // A2D_FE_BASIS_H
\ No newline at end of file
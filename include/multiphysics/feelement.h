@@ -3,8 +3,11 @@
 
 #include <iomanip>
 #include <iostream>
+#include <mutex>
+#include <new>
 #include <random>
 #include <type_traits>
+#include <vector>
 
 #include "multiphysics/feelementmat.h"
 #include "multiphysics/feelementvector.h"
@@ -98,6 +101,26 @@ class DOFCoordinates {
   }
 };
 
+/**
+ * @brief Check whether the integrand provides a combined residual and Jacobian
+ * evaluation with the signature
+ *
+ * template <FEVarType wrt>
+ * void residual_and_jacobian(T weight, const DataSpace& data,
+ *                            const FiniteElementGeometry& geo,
+ *                            const FiniteElementSpace& sref,
+ *                            FiniteElementVar<wrt>& res,
+ *                            FiniteElementJacobian<wrt, wrt>& jac) const;
+ */
+template <class Integrand, FEVarType wrt, typename = void>
+struct has_residual_and_jacobian : std::false_type {};
+
+template <class Integrand, FEVarType wrt>
+struct has_residual_and_jacobian<
+    Integrand, wrt,
+    std::void_t<decltype(&Integrand::template residual_and_jacobian<wrt>)>>
+    : std::true_type {};
+
 // A set of element-wise operations that operate on all elements at once
 template <typename T, class Integrand, class Quadrature, class DataBasis,
           class GeoBasis, class Basis>
@@ -117,7 +140,24 @@ class FiniteElement {
   template <FEVarType wrt>
   using QSpaceSelect = FEVarSelect<wrt, QDataSpace, QGeoSpace, QSpace>;
 
-  FiniteElement() {}
+  // Number of vector lanes used for the quadrature points in the team loops
+  static constexpr index_t team_vector_length = 4;
+
+  FiniteElement() : use_team_policy(false) {}
+
+  /**
+   * @brief Set whether the element loops with a parallel element vector use
+   * a team of threads for each element (Kokkos::TeamPolicy) or a single
+   * thread for each element
+   *
+   * The team policy is opt-in, it is intended for the high-order elements
+   * with many quadrature points on GPU backends. It is not selected from the
+   * degree or the backend and no speedup has been measured on the host
+   * backends, where the per-team scratch setup usually makes it slower than
+   * the default. Only add_residual() uses it.
+   */
+  void set_team_policy(bool flag) { use_team_policy = flag; }
+  bool get_team_policy() const { return use_team_policy; }
 
   /**
    * @brief Compute the value of an integral functional over the finite-element
@@ -252,6 +292,9 @@ class FiniteElement {
   /**
    * @brief Add the residuals for the finite-element problem
    *
+   * With a parallel element vector, the elements are processed by one thread
+   * each, or by one team of threads each, see set_team_policy().
+   *
    * @tparam DataElemVec Element vector class for the data
    * @tparam GeoElemVec Element vector class for the geometry
    * @tparam ElemVec Element vector class for the solution
@@ -267,6 +310,8 @@ class FiniteElement {
   void add_residual(const Integrand& integrand, const T alpha,
                     DataElemVec& elem_data, GeoElemVec& elem_geo,
                     ElemVec& elem_sol, ElemResVec& elem_res) {
+    Timer timer("FiniteElement::add_residual()");
+
     using same_evtype =
         have_same_evtype<DataElemVec, GeoElemVec, ElemVec, ElemResVec>;
     static_assert(same_evtype::value,
@@ -276,6 +321,7 @@ class FiniteElement {
 
     const index_t num_elements = elem_geo.get_num_elements();
     const index_t num_quadrature_points = Quadrature::get_num_points();
+    count_work(num_elements, 0);
 
     auto loop_body = KOKKOS_LAMBDA(const index_t i) {
       // Get the data, geometry and solution for this element and
@@ -335,7 +381,12 @@ class FiniteElement {
       elem_sol.get_values();
       elem_res.get_zero_values();
 
-      Kokkos::parallel_for("add_residual", num_elements, loop_body);
+      if (use_team_policy) {
+        add_residual_team<wrt>(integrand, alpha, elem_data, elem_geo, elem_sol,
+                               elem_res);
+      } else {
+        Kokkos::parallel_for("add_residual", num_elements, loop_body);
+      }
       Kokkos::fence();
 
       elem_res.add_values();
@@ -444,8 +495,12 @@ class FiniteElement {
    * @brief Assemble element Jacobian matrices based on the data, geometry and
    * solution vectors.
    *
-   * WARNING: This is intended only for the lowest order elements, ie. p = 1.
-   * It scales O(p^9) so it is unsuitable for high-order elements!
+   * If the basis provides a sum-factorized kernel for a tensor-product
+   * quadrature (see FEBasis::has_outer_tensor()), the Jacobians at all the
+   * quadrature points are stored and the element matrix is formed in O(p^7)
+   * operations in 3D. Otherwise the outer product is formed at each
+   * quadrature point, which scales O(p^9) and is unsuitable for high-order
+   * elements!
    *
    * @tparam DataElemVec Element vector class for the data
    * @tparam GeoElemVec Element vector class for the geometry
@@ -473,8 +528,14 @@ class FiniteElement {
                   "parallel and serial at the same time)");
     constexpr ElemVecType evtype = same_evtype::evtype;
 
+    using QMat = typename Integrand::template FiniteElementJacobian<of, wrt>;
+    constexpr bool use_outer_tensor =
+        Basis::template has_outer_tensor<Quadrature, QMat,
+                                         typename ElemMat::FEMat>();
+
     const index_t num_elements = elem_geo.get_num_elements();
     const index_t num_quadrature_points = Quadrature::get_num_points();
+    count_work(num_elements, Basis::ndof * Basis::ndof);
 
     if constexpr (evtype == ElemVecType::Parallel) {
       elem_data.get_values();
@@ -482,6 +543,11 @@ class FiniteElement {
       elem_sol.get_values();
     }
 
+    // Jacobians at all the quadrature points for the sum-factorized kernel,
+    // allocated once and reused for all the elements since they may be too
+    // large for the stack
+    std::vector<QMat> jac(use_outer_tensor ? Quadrature::num_quad_points : 0);
+
     for (index_t i = 0; i < num_elements; i++) {
       // Get the data, geometry and solution for this element and
       // interpolate it
@@ -506,19 +572,321 @@ class FiniteElement {
       // Initialize the element matrix
       typename ElemMat::FEMat element_mat(i, elem_mat);
 
+      if constexpr (use_outer_tensor) {
+        for (index_t j = 0; j < num_quadrature_points; j++) {
+          T weight = alpha * Quadrature::get_weight(j);
+          jac[j].zero();
+          integrand.template jacobian<of, wrt>(weight, data.get(j), geo.get(j),
+                                               sol.get(j), jac[j]);
+        }
+
+        // Add the outer products at all the quadrature points
+        Basis::template add_outer_tensor<Quadrature>(jac.data(), element_mat);
+      } else {
+        for (index_t j = 0; j < num_quadrature_points; j++) {
+          T weight = alpha * Quadrature::get_weight(j);
+          QMat jac;
+          integrand.template jacobian<of, wrt>(weight, data.get(j), geo.get(j),
+                                               sol.get(j), jac);
+
+          // Add the results of the outer product
+          Basis::template add_outer<Quadrature>(j, jac, element_mat);
+        }
+      }
+
+      elem_mat.add_element_values(i, element_mat);
+    }
+  }
+
+  /**
+   * @brief Add the residual and assemble the element Jacobian matrices in a
+   * single pass over the elements
+   *
+   * The data, geometry and solution are gathered and interpolated once for
+   * each element. If the integrand provides residual_and_jacobian(), the
+   * residual is obtained from the same A2D stack that is used to extract the
+   * Jacobian, otherwise residual() and jacobian() are called at each
+   * quadrature point.
+   *
+   * The element matrix is formed in the same way as in add_jacobian(), with
+   * the sum-factorized kernel when the basis and the quadrature allow it.
+   *
+   * With a parallel element vector, the elements are processed concurrently
+   * as in add_residual() and the element matrices are added to the global
+   * matrix under a lock, since the matrix has no atomic updates.
+   *
+   * @tparam DataElemVec Element vector class for the data
+   * @tparam GeoElemVec Element vector class for the geometry
+   * @tparam ElemVec Element vector class for the solution
+   * @tparam ElemResVec Element vector class for the residual
+   * @tparam ElemMat The element matrix
+   * @param integrand The Integrand instance
+   * @param alpha Scalar multiplier for the residual and Jacobian
+   * @param elem_data Element vector for the data
+   * @param elem_geo Element vector for the geometry
+   * @param elem_sol Element solution vector
+   * @param elem_res Element residual vector
+   * @param elem_mat Element matrix output
+   */
+  template <FEVarType wrt, class DataElemVec, class GeoElemVec, class ElemVec,
+            class ElemResVec, class ElemMat>
+  void add_residual_and_jacobian(const Integrand& integrand, const T alpha,
+                                 DataElemVec& elem_data, GeoElemVec& elem_geo,
+                                 ElemVec& elem_sol, ElemResVec& elem_res,
+                                 ElemMat& elem_mat) {
+    Timer timer("FiniteElement::add_residual_and_jacobian()");
+
+    using same_evtype =
+        have_same_evtype<DataElemVec, GeoElemVec, ElemVec, ElemResVec>;
+    static_assert(same_evtype::value,
+                  "Cannot mix up different element vector types (e.g. using "
+                  "parallel and serial at the same time)");
+    constexpr ElemVecType evtype = same_evtype::evtype;
+
+    using QMat = typename Integrand::template FiniteElementJacobian<wrt, wrt>;
+    constexpr bool use_outer_tensor =
+        Basis::template has_outer_tensor<Quadrature, QMat,
+                                         typename ElemMat::FEMat>();
+
+    const index_t num_elements = elem_geo.get_num_elements();
+    const index_t num_quadrature_points = Quadrature::get_num_points();
+    count_work(num_elements, Basis::ndof * Basis::ndof);
+
+    // Jacobians at all the quadrature points for the sum-factorized kernel,
+    // otherwise only the one at the current point is stored
+    const index_t jac_size = use_outer_tensor ? Quadrature::num_quad_points : 1;
+
+    // Add the residual and the element matrix for element i, the element
+    // matrices are added under mat_lock when it is not null
+    auto loop_body = [&](const index_t i, std::vector<QMat>& jac,
+                         std::mutex* mat_lock) {
+      // Get the data, geometry and solution for this element and
+      // interpolate it
+      typename DataElemVec::FEDof data_dof(i, elem_data);
+      typename GeoElemVec::FEDof geo_dof(i, elem_geo);
+      typename ElemVec::FEDof sol_dof(i, elem_sol);
+
+      if constexpr (evtype == ElemVecType::Serial) {
+        elem_data.get_element_values(i, data_dof);
+        elem_geo.get_element_values(i, geo_dof);
+        elem_sol.get_element_values(i, sol_dof);
+      }
+
+      QDataSpace data;
+      QGeoSpace geo;
+      QSpace sol;
+
+      // Space for the residual
+      QSpaceSelect<wrt> res;
+
+      DataBasis::template interp(data_dof, data);
+      GeoBasis::template interp(geo_dof, geo);
+      Basis::template interp(sol_dof, sol);
+
+      // Initialize the element matrix
+      typename ElemMat::FEMat element_mat(i, elem_mat);
+
       for (index_t j = 0; j < num_quadrature_points; j++) {
         T weight = alpha * Quadrature::get_weight(j);
-        typename Integrand::template FiniteElementJacobian<of, wrt> jac;
-        integrand.template jacobian<of, wrt>(weight, data.get(j), geo.get(j),
-                                             sol.get(j), jac);
+        QMat& jacq = jac[use_outer_tensor ? j : 0];
+        jacq.zero();
+        if constexpr (has_residual_and_jacobian<Integrand, wrt>::value) {
+          integrand.template residual_and_jacobian<wrt>(
+              weight, data.get(j), geo.get(j), sol.get(j), res.get(j), jacq);
+        } else {
+          integrand.template residual<wrt>(weight, data.get(j), geo.get(j),
+                                           sol.get(j), res.get(j));
+          integrand.template jacobian<wrt, wrt>(weight, data.get(j),
+                                                geo.get(j), sol.get(j), jacq);
+        }
 
         // Add the results of the outer product
-        Basis::template add_outer<Quadrature>(j, jac, element_mat);
+        if constexpr (!use_outer_tensor) {
+          Basis::template add_outer<Quadrature>(j, jacq, element_mat);
+        }
       }
 
-      elem_mat.add_element_values(i, element_mat);
+      if constexpr (use_outer_tensor) {
+        Basis::template add_outer_tensor<Quadrature>(jac.data(), element_mat);
+      }
+
+      typename ElemResVec::FEDof res_dof(i, elem_res);
+      if constexpr (wrt == FEVarType::DATA) {
+        DataBasis::template add(res, res_dof);
+      } else if constexpr (wrt == FEVarType::GEOMETRY) {
+        GeoBasis::template add(res, res_dof);
+      } else if constexpr (wrt == FEVarType::STATE) {
+        Basis::template add(res, res_dof);
+      }
+
+      elem_res.add_element_values(i, res_dof);
+      if (mat_lock) {
+        std::lock_guard<std::mutex> guard(*mat_lock);
+        elem_mat.add_element_values(i, element_mat);
+      } else {
+        elem_mat.add_element_values(i, element_mat);
+      }
+    };
+
+    // Execution
+    if constexpr (evtype == ElemVecType::Parallel) {
+      elem_data.get_values();
+      elem_geo.get_values();
+      elem_sol.get_values();
+      elem_res.get_zero_values();
+
+      // The elements are processed concurrently, but the element matrices
+      // are added to the global matrix one at a time
+      std::mutex mat_lock;
+      Kokkos::parallel_for(
+          "add_residual_and_jacobian", num_elements, [&](const index_t i) {
+            std::vector<QMat> jac(jac_size);
+            loop_body(i, jac, &mat_lock);
+          });
+      Kokkos::fence();
+
+      elem_res.add_values();
+    } else {
+      static_assert(evtype == ElemVecType::Serial,
+                    "invalid ElemVecType deduced.");
+
+      // The buffer is allocated once and reused for all the elements
+      std::vector<QMat> jac(jac_size);
+      for (index_t i = 0; i < num_elements; i++) {
+        loop_body(i, jac, nullptr);
+      }
     }
   }
+
+ private:
+  /**
+   * @brief Add the residuals with one team of threads for each element
+   *
+   * The data, geometry, solution and residual at the quadrature points are
+   * stored in the team scratch memory, constructed once by a single thread
+   * of the team. The three interpolations are independent and are split
+   * among the threads, then the quadrature points are split among the
+   * threads and their vector lanes. The residual is added back to the
+   * element by a single thread.
+   */
+  template <FEVarType wrt, class DataElemVec, class GeoElemVec, class ElemVec,
+            class ElemResVec>
+  void add_residual_team(const Integrand& integrand, const T alpha,
+                         DataElemVec& elem_data, GeoElemVec& elem_geo,
+                         ElemVec& elem_sol, ElemResVec& elem_res) {
+    using QResSpace = QSpaceSelect<wrt>;
+    using TeamPolicy = Kokkos::TeamPolicy<>;
+    using Member = typename TeamPolicy::member_type;
+
+    const index_t num_elements = elem_geo.get_num_elements();
+    const index_t num_quadrature_points = Quadrature::get_num_points();
+
+    // Pad each object for the alignment of the scratch allocations
+    const size_t scratch_bytes = get_scratch_size<QDataSpace>() +
+                                 get_scratch_size<QGeoSpace>() +
+                                 get_scratch_size<QSpace>() +
+                                 get_scratch_size<QResSpace>();
+    // The quadrature points are split into blocks of team_vector_length
+    // points: the blocks are shared among the threads and the points in a
+    // block among the vector lanes of a thread
+    const index_t num_blocks =
+        (num_quadrature_points + team_vector_length - 1) / team_vector_length;
+
+    TeamPolicy policy(num_elements, Kokkos::AUTO, team_vector_length);
+    policy.set_scratch_size(0, Kokkos::PerTeam(scratch_bytes));
+
+    auto loop_body = KOKKOS_LAMBDA(const Member& team) {
+      const index_t i = team.league_rank();
+
+      // Every thread gets the same team scratch allocations, the objects are
+      // constructed by one thread before any thread uses them
+      void* data_ptr =
+          team.team_scratch(0).get_shmem(get_scratch_size<QDataSpace>());
+      void* geo_ptr =
+          team.team_scratch(0).get_shmem(get_scratch_size<QGeoSpace>());
+      void* sol_ptr =
+          team.team_scratch(0).get_shmem(get_scratch_size<QSpace>());
+      void* res_ptr =
+          team.team_scratch(0).get_shmem(get_scratch_size<QResSpace>());
+      Kokkos::single(Kokkos::PerTeam(team), [&]() {
+        new (data_ptr) QDataSpace;
+        new (geo_ptr) QGeoSpace;
+        new (sol_ptr) QSpace;
+        new (res_ptr) QResSpace;
+      });
+      team.team_barrier();
+
+      QDataSpace& data = *static_cast<QDataSpace*>(data_ptr);
+      QGeoSpace& geo = *static_cast<QGeoSpace*>(geo_ptr);
+      QSpace& sol = *static_cast<QSpace*>(sol_ptr);
+      QResSpace& res = *static_cast<QResSpace*>(res_ptr);
+
+      Kokkos::parallel_for(Kokkos::TeamThreadRange(team, 3),
+                           [&](const index_t k) {
+                             if (k == 0) {
+                               typename DataElemVec::FEDof dof(i, elem_data);
+                               DataBasis::template interp(dof, data);
+                             } else if (k == 1) {
+                               typename GeoElemVec::FEDof dof(i, elem_geo);
+                               GeoBasis::template interp(dof, geo);
+                             } else {
+                               typename ElemVec::FEDof dof(i, elem_sol);
+                               Basis::template interp(dof, sol);
+                             }
+                           });
+      team.team_barrier();
+
+      Kokkos::parallel_for(
+          Kokkos::TeamThreadRange(team, num_blocks), [&](const index_t b) {
+            const index_t start = b * team_vector_length;
+            const index_t end =
+                (start + team_vector_length < num_quadrature_points
+                     ? start + team_vector_length
+                     : num_quadrature_points);
+            Kokkos::parallel_for(
+                Kokkos::ThreadVectorRange(team, start, end),
+                [&](const index_t j) {
+                  T weight = alpha * Quadrature::get_weight(j);
+                  integrand.template residual<wrt>(weight, data.get(j),
+                                                   geo.get(j), sol.get(j),
+                                                   res.get(j));
+                });
+          });
+      team.team_barrier();
+
+      Kokkos::single(Kokkos::PerTeam(team), [&]() {
+        typename ElemResVec::FEDof res_dof(i, elem_res);
+        if constexpr (wrt == FEVarType::DATA) {
+          DataBasis::template add(res, res_dof);
+        } else if constexpr (wrt == FEVarType::GEOMETRY) {
+          GeoBasis::template add(res, res_dof);
+        } else if constexpr (wrt == FEVarType::STATE) {
+          Basis::template add(res, res_dof);
+        }
+      });
+    };
+
+    Kokkos::parallel_for("add_residual_team", policy, loop_body);
+  }
+
+  // Size of an object in the scratch memory, rounded up to 8 bytes
+  template <class Obj>
+  KOKKOS_FUNCTION static constexpr size_t get_scratch_size() {
+    return 8 * ((sizeof(Obj) + 7) / 8);
+  }
+
+  // Use one team of threads for each element
+  bool use_team_policy;
+
+  // Count the elements and quadrature points, and the bytes of the element
+  // matrices with the given number of entries, for the profiler
+  static void count_work(index_t num_elements, index_t mat_entries) {
+    Timer::count(PerfCounter::ELEMENTS, num_elements);
+    Timer::count(PerfCounter::QUADRATURE_POINTS,
+                 double(num_elements) * Quadrature::get_num_points());
+    Timer::count(PerfCounter::BYTES,
+                 double(num_elements) * mat_entries * sizeof(T));
+  }
 };
 
 }  // namespace A2D
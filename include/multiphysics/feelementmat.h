@@ -1,6 +1,8 @@
 #ifndef A2D_FE_ELEMENT_MAT_H
 #define A2D_FE_ELEMENT_MAT_H
 
+#include <vector>
+
 #include "multiphysics/feelementvector.h"
 #include "multiphysics/femesh.h"
 #include "utils/complex_math.h"
@@ -87,6 +89,65 @@ class ElementMat_Serial {
   MatType& mat;
 };
 
+/**
+ * @brief Element matrix that only adds the diagonal entries of each element
+ * matrix to a vector
+ *
+ * This is used to form the diagonal of an operator that is otherwise applied
+ * matrix-free, e.g. for Jacobi or Chebyshev smoothing.
+ */
+template <typename T, class Basis, class VecType>
+class ElementMat_Diagonal {
+ public:
+  ElementMat_Diagonal(ElementMesh<Basis>& mesh, VecType& vec)
+      : mesh(mesh), vec(vec) {}
+
+  // Element matrix that only stores the diagonal, the off-diagonal entries
+  // are accumulated into a single entry that is discarded
+  class FEMat {
+   public:
+    FEMat(index_t elem, ElementMat_Diagonal<T, Basis, VecType>& elem_mat)
+        : discard(0.0) {
+      for (index_t i = 0; i < Basis::ndof; i++) {
+        D[i] = 0.0;
+      }
+    }
+
+    T& operator()(const index_t i, const index_t j) {
+      return (i == j ? D[i] : discard);
+    }
+    const T& operator()(const index_t i, const index_t j) const {
+      return (i == j ? D[i] : zero);
+    }
+
+   private:
+    T D[Basis::ndof];
+    T discard;
+    static constexpr T zero = 0.0;
+  };
+
+  /**
+   * @brief Get the number of elements
+   */
+  index_t get_num_elements() const { return mesh.get_num_elements(); }
+
+  /**
+   * @brief Add the diagonal of the element matrix to the vector, the signs of
+   * the degrees of freedom cancel on the diagonal
+   */
+  void add_element_values(index_t elem, FEMat& elem_mat) {
+    const index_t* dof;
+    mesh.get_element_dof(elem, &dof);
+    for (index_t i = 0; i < Basis::ndof; i++) {
+      vec[dof[i]] += elem_mat(i, i);
+    }
+  }
+
+ private:
+  ElementMesh<Basis>& mesh;
+  VecType& vec;
+};
+
 }  // namespace A2D
 
 #endif  // A2D_FE_ELEMENT_MAT_H
\ No newline at end of file
@@ -0,0 +1,392 @@
+#ifndef A2D_FE_FILTER_H
+#define A2D_FE_FILTER_H
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "a2ddefs.h"
+#include "array.h"
+#include "multiphysics/febase.h"
+#include "multiphysics/fesolution.h"
+#include "parallel.h"
+#include "sparse/sparse_amg.h"
+#include "sparse/sparse_matrix.h"
+#include "sparse/sparse_numeric.h"
+#include "utils/a2dprofiler.h"
+
+namespace A2D {
+
+/**
+ * @brief Density filter for topology optimization
+ *
+ * The filtered design variables are the weighted averages
+ *
+ * rho_i = sum_j w_ij x_j / sum_j w_ij,  w_ij = max(0, r - |X_i - X_j|)
+ *
+ * The symmetric weights H = [w_ij] are computed once and stored in CSR
+ * format together with the inverse row sums D^{-1}, so that the filter is the
+ * product W = D^{-1} H. Both W and its transpose W^T = H D^{-1}, needed for
+ * the sensitivities, are applied as row-parallel sparse matrix-vector
+ * products with the same data and without atomics.
+ *
+ * @tparam T Scalar type
+ * @tparam dim Spatial dimension of the filter points
+ */
+template <typename T, index_t dim>
+class DensityFilter {
+ public:
+  using Vec_t = SolutionVector<T>;
+
+  /**
+   * @brief Compute the filter weights
+   *
+   * @param npts Number of design variables
+   * @param X Coordinates of the design variables, size: dim * npts
+   * @param r Filter radius
+   */
+  DensityFilter(index_t npts, const T X[], T r) : npts(npts), r(r) {
+    Timer timer("DensityFilter::DensityFilter()");
+    if (!(r > 0.0)) {
+      char msg[256];
+      std::snprintf(msg, sizeof(msg),
+                    "DensityFilter: the filter radius must be positive");
+      throw std::runtime_error(msg);
+    }
+
+    std::vector<index_t> cell_ptr, cell_pts;
+    create_cells(X, cell_ptr, cell_pts);
+    const index_t* cp = cell_ptr.data();
+    const index_t* pts = cell_pts.data();
+
+    // Count the number of neighbors of each point, then fill in the weights
+    std::vector<index_t> rowp(npts + 1, 0);
+    index_t* rp = rowp.data();
+    parallel_for(
+        npts, KOKKOS_LAMBDA(index_t i)->void {
+          index_t count = 0;
+          for_each_neighbor(i, X, cp, pts,
+                            [&](index_t j, T w) { count++; });
+          rp[i + 1] = count;
+        });
+    for (index_t i = 0; i < npts; i++) {
+      rowp[i + 1] += rowp[i];
+    }
+
+    H = CSRMat<T>(npts, npts, rowp[npts]);
+    dinv = MultiArrayNew<T*>("dinv", npts);
+    auto Hrowp = H.rowp;
+    auto Hcols = H.cols;
+    auto Hvals = H.vals;
+    auto d = dinv;
+    parallel_for(
+        npts + 1, KOKKOS_LAMBDA(index_t i)->void { Hrowp(i) = rp[i]; });
+    parallel_for(
+        npts, KOKKOS_LAMBDA(index_t i)->void {
+          index_t jp = rp[i];
+          T sum = 0.0;
+          for_each_neighbor(i, X, cp, pts, [&](index_t j, T w) {
+            Hcols(jp) = j;
+            Hvals(jp) = w;
+            sum += w;
+            jp++;
+          });
+          d(i) = 1.0 / sum;
+        });
+  }
+
+  /**
+   * @brief Apply the filter: rho = D^{-1} H x
+   */
+  void apply(Vec_t& x, Vec_t& rho) const {
+    Timer timer("DensityFilter::apply()");
+    Timer::count(PerfCounter::FLOPS, 2.0 * H.nnz + npts);
+    auto Hrowp = H.rowp;
+    auto Hcols = H.cols;
+    auto Hvals = H.vals;
+    auto d = dinv;
+    const T* xp = x.data();
+    T* yp = rho.data();
+    parallel_for(
+        npts, KOKKOS_LAMBDA(index_t i)->void {
+          T sum = 0.0;
+          for (index_t jp = Hrowp(i); jp < Hrowp(i + 1); jp++) {
+            sum += Hvals(jp) * xp[Hcols(jp)];
+          }
+          yp[i] = d(i) * sum;
+        });
+  }
+
+  /**
+   * @brief Apply the transpose of the filter: dfdx = H D^{-1} dfdrho
+   */
+  void apply_transpose(Vec_t& dfdrho, Vec_t& dfdx) const {
+    Timer timer("DensityFilter::apply_transpose()");
+    Timer::count(PerfCounter::FLOPS, 3.0 * H.nnz);
+    auto Hrowp = H.rowp;
+    auto Hcols = H.cols;
+    auto Hvals = H.vals;
+    auto d = dinv;
+    const T* xp = dfdrho.data();
+    T* yp = dfdx.data();
+    parallel_for(
+        npts, KOKKOS_LAMBDA(index_t i)->void {
+          T sum = 0.0;
+          for (index_t jp = Hrowp(i); jp < Hrowp(i + 1); jp++) {
+            index_t j = Hcols(jp);
+            sum += Hvals(jp) * d(j) * xp[j];
+          }
+          yp[i] = sum;
+        });
+  }
+
+  index_t get_num_design_vars() const { return npts; }
+
+  // Get the symmetric weights H, the filter is D^{-1} H
+  const CSRMat<T>& get_weights() const { return H; }
+
+ private:
+  // Sort the points into a uniform grid of cells with edge length >= r so
+  // that the neighbors of a point are in the adjacent cells
+  void create_cells(const T X[], std::vector<index_t>& cell_ptr,
+                    std::vector<index_t>& cell_pts) {
+    for (index_t k = 0; k < dim; k++) {
+      xmin[k] = xmax[k] = npts > 0 ? X[k] : 0.0;
+    }
+    for (index_t i = 0; i < npts; i++) {
+      for (index_t k = 0; k < dim; k++) {
+        xmin[k] = std::min(xmin[k], X[dim * i + k]);
+        xmax[k] = std::max(xmax[k], X[dim * i + k]);
+      }
+    }
+
+    // Enlarge the cells when there would be many more cells than points
+    h = r;
+    while (true) {
+      double ncells = 1.0;
+      for (index_t k = 0; k < dim; k++) {
+        ncells *= std::floor((xmax[k] - xmin[k]) / h) + 1.0;
+      }
+      if (ncells <= 8.0 * npts + 1.0) {
+        break;
+      }
+      h *= 2.0;
+    }
+
+    index_t ncells = 1;
+    for (index_t k = 0; k < dim; k++) {
+      nc[k] = index_t(std::floor((xmax[k] - xmin[k]) / h)) + 1;
+      ncells *= nc[k];
+    }
+
+    // Counting sort of the points by cell
+    cell_ptr.assign(ncells + 1, 0);
+    cell_pts.resize(npts);
+    for (index_t i = 0; i < npts; i++) {
+      cell_ptr[get_cell(&X[dim * i]) + 1]++;
+    }
+    for (index_t c = 0; c < ncells; c++) {
+      cell_ptr[c + 1] += cell_ptr[c];
+    }
+    std::vector<index_t> pos(cell_ptr.begin(), cell_ptr.end() - 1);
+    for (index_t i = 0; i < npts; i++) {
+      cell_pts[pos[get_cell(&X[dim * i])]++] = i;
+    }
+  }
+
+  index_t get_cell_index(const T x[], index_t k) const {
+    index_t c = index_t((x[k] - xmin[k]) / h);
+    return c < nc[k] ? c : nc[k] - 1;
+  }
+
+  index_t get_cell(const T x[]) const {
+    index_t c = 0;
+    for (index_t k = dim; k > 0; k--) {
+      c = c * nc[k - 1] + get_cell_index(x, k - 1);
+    }
+    return c;
+  }
+
+  // Call func(j, w_ij) for each point j within the filter radius of point i
+  template <class Func>
+  void for_each_neighbor(index_t i, const T X[], const index_t cell_ptr[],
+                         const index_t cell_pts[], const Func& func) const {
+    const T* xi = &X[dim * i];
+    index_t lo[3] = {0, 0, 0}, hi[3] = {0, 0, 0};
+    for (index_t k = 0; k < dim; k++) {
+      index_t c = get_cell_index(xi, k);
+      lo[k] = c > 0 ? c - 1 : 0;
+      hi[k] = c + 1 < nc[k] ? c + 1 : c;
+    }
+
+    for (index_t c2 = lo[2]; c2 <= hi[2]; c2++) {
+      for (index_t c1 = lo[1]; c1 <= hi[1]; c1++) {
+        for (index_t c0 = lo[0]; c0 <= hi[0]; c0++) {
+          index_t c = c0;
+          if constexpr (dim > 1) {
+            c += nc[0] * c1;
+          }
+          if constexpr (dim > 2) {
+            c += nc[0] * nc[1] * c2;
+          }
+          for (index_t p = cell_ptr[c]; p < cell_ptr[c + 1]; p++) {
+            index_t j = cell_pts[p];
+            T d2 = 0.0;
+            for (index_t k = 0; k < dim; k++) {
+              T dx = X[dim * j + k] - xi[k];
+              d2 += dx * dx;
+            }
+            T d = std::sqrt(d2);
+            if (d < r) {
+              func(j, r - d);
+            }
+          }
+        }
+      }
+    }
+  }
+
+  index_t npts;
+  T r;
+
+  // Uniform grid of cells used to find the neighbors
+  T h;
+  T xmin[dim], xmax[dim];
+  index_t nc[dim];
+
+  // Symmetric weights and inverse row sums
+  CSRMat<T> H;
+  MultiArrayNew<T*> dinv;
+};
+
+/**
+ * @brief Helmholtz PDE filter for topology optimization
+ *
+ * The filtered field rho solves the PDE -r0^2 * Laplacian(rho) + rho = x
+ * given by the HelmholtzFilter integrand. The residual is R(x, rho) = K rho -
+ * B x where K is independent of x and rho, so K and its AMG hierarchy are
+ * built once in the constructor and reused for every application of the
+ * filter. The sensitivities use the same K and AMG hierarchy since
+ *
+ * dfdx = -(dR/dx)^{T} K^{-1} dfdrho
+ *
+ * @tparam Impl Implementation type with block size 1, e.g.
+ * DirectCholeskyAnalysisImpl<T, 1>
+ */
+template <class Impl>
+class HelmholtzPDEFilter {
+ public:
+  using T = typename Impl::type;
+  using Vec_t = typename Impl::Vec_t;
+  using Mat_t = BSRMat<T, 1, 1>;
+  using Amg_t = BSRMatAmg<T, 1, 1>;
+  static_assert(std::is_same<typename Impl::Mat_t, Mat_t>::value,
+                "HelmholtzPDEFilter requires a matrix with block size 1");
+
+  /**
+   * @brief Assemble the filter matrix and build the AMG hierarchy
+   *
+   * @param assembler Assembler with the HelmholtzFilter elements
+   * @param geo Geometry vector for the assembler
+   * @param ndata Number of design variables (the data of the integrand)
+   * @param nsol Number of filtered variables (the state of the integrand)
+   * @param amg_nlevels Number of levels in the AMG hierarchy
+   * @param cg_rtol Relative tolerance for the preconditioned CG solve
+   * @param cg_max_iters Maximum number of CG iterations
+   */
+  HelmholtzPDEFilter(std::shared_ptr<ElementAssembler<Impl>> assembler,
+                     std::shared_ptr<Vec_t> geo, index_t ndata, index_t nsol,
+                     int amg_nlevels = 3, double cg_rtol = 1e-10,
+                     index_t cg_max_iters = 200)
+      : assembler(assembler),
+        geo(geo),
+        data(ndata),
+        sol(nsol),
+        res(nsol),
+        adjoint(nsol),
+        cg_rtol(cg_rtol),
+        cg_max_iters(cg_max_iters) {
+    Timer timer("HelmholtzPDEFilter::HelmholtzPDEFilter()");
+
+    // The Jacobian does not depend on the data or the solution
+    index_t nrows;
+    std::vector<index_t> rowp, cols;
+    assembler->get_bsr_data(1, nrows, rowp, cols);
+    mat = std::make_shared<Mat_t>(nrows, nrows, cols.size(), rowp, cols);
+    assembler->add_jacobian(T(1.0), data, *geo, sol, *mat);
+
+    // The near null-space is the constant
+    MultiArrayNew<T* [1][1]> B("B", nrows);
+    BLAS::fill(B, 1.0);
+    T omega = 4.0 / 3.0, epsilon = 0.0;
+    amg = std::make_shared<Amg_t>(amg_nlevels, omega, epsilon, mat, B);
+  }
+
+  /**
+   * @brief Apply the filter: solve K rho = B x
+   *
+   * @param x The design variables
+   * @param rho The filtered variables
+   */
+  void apply(Vec_t& x, Vec_t& rho) {
+    Timer timer("HelmholtzPDEFilter::apply()");
+    data.copy(x);
+
+    // With rho = 0 the residual is -B x
+    res.zero();
+    assembler->add_residual(T(1.0), data, *geo, sol, res);
+    auto b = res.template get_block_view<1>();
+    BLAS::scale(b, -1.0);
+
+    solve(res, rho);
+  }
+
+  /**
+   * @brief Apply the transpose of the filter to the derivative
+   *
+   * @param dfdrho The derivative with respect to the filtered variables
+   * @param dfdx The derivative with respect to the design variables
+   */
+  void apply_transpose(Vec_t& dfdrho, Vec_t& dfdx) {
+    Timer timer("HelmholtzPDEFilter::apply_transpose()");
+    solve(dfdrho, adjoint);
+    dfdx.zero();
+    assembler->add_adjoint_res_product(FEVarType::DATA, T(-1.0), data, *geo,
+                                       sol, adjoint, dfdx);
+  }
+
+  std::shared_ptr<Mat_t> get_mat() { return mat; }
+  std::shared_ptr<Amg_t> get_amg() { return amg; }
+
+ private:
+  // Solve K x = b with CG preconditioned by the AMG hierarchy
+  void solve(Vec_t& b, Vec_t& x) {
+    auto bview = b.template get_block_view<1>();
+    auto xview = x.template get_block_view<1>();
+    auto mat_vec = [&](MultiArrayNew<T* [1]>& in,
+                       MultiArrayNew<T* [1]>& out) -> void {
+      BSRMatVecMult<T, 1, 1>(*mat, in, out);
+    };
+    index_t monitor = 0;
+    amg->cg(mat_vec, bview, xview, monitor, cg_max_iters, cg_rtol);
+  }
+
+  std::shared_ptr<ElementAssembler<Impl>> assembler;
+  std::shared_ptr<Vec_t> geo;
+
+  // The data and solution are only used to evaluate the residual and its
+  // derivative, the solution is always zero
+  Vec_t data, sol, res, adjoint;
+
+  std::shared_ptr<Mat_t> mat;
+  std::shared_ptr<Amg_t> amg;
+
+  double cg_rtol;
+  index_t cg_max_iters;
+};
+
+}  // namespace A2D
+
+#endif  // A2D_FE_FILTER_H
@@ -1,10 +1,14 @@
 #ifndef FE_MATRIX_FREE_H
 #define FE_MATRIX_FREE_H
 
+#include <cstdio>
 #include <iomanip>
 #include <iostream>
+#include <memory>
 #include <random>
+#include <stdexcept>
 #include <type_traits>
+#include <vector>
 
 #include "multiphysics/feelementmat.h"
 #include "multiphysics/feelementvector.h"
@@ -15,6 +19,51 @@
 
 namespace A2D {
 
+/**
+ * @brief Storage options for the quadrature point Jacobians
+ *
+ * FULL: Store the Jacobian type of the integrand in the precision T. When
+ * of == wrt, the Jacobian is a SymMat so only the upper triangle is stored.
+ *
+ * FLOAT: Store the same entries as FULL, but in single precision when T is
+ * double. This halves the storage at the cost of a ~1e-7 relative error in
+ * the matrix-vector product, which is acceptable for preconditioning or for
+ * Krylov methods with moderate tolerances.
+ *
+ * ON_THE_FLY: Evaluate the Jacobian-vector product with the integrand at each
+ * application. If the integrand provides a JacobianProductData type (see
+ * has_jacobian_product_data), only this constitutive data is stored at the
+ * quadrature points. Otherwise the data, geometry and solution at the
+ * quadrature points are stored and the product is formed with the AD stack.
+ * Only the state Jacobian can be applied on the fly.
+ */
+enum class MatFreeStorage { FULL, FLOAT, ON_THE_FLY };
+
+/**
+ * @brief Check whether the integrand can cache the data needed by the state
+ * Jacobian-vector product at a quadrature point, with
+ *
+ * struct JacobianProductData;
+ * void jacobian_product_data(T weight, const DataSpace& data,
+ *                            const FiniteElementGeometry& geo,
+ *                            const FiniteElementSpace& sref,
+ *                            JacobianProductData& qdata) const;
+ * void cached_jacobian_product(const JacobianProductData& qdata,
+ *                              const FiniteElementSpace& p,
+ *                              FiniteElementSpace& res) const;
+ */
+template <class Integrand, typename = void>
+struct has_jacobian_product_data : std::false_type {
+  struct type {};
+};
+
+template <class Integrand>
+struct has_jacobian_product_data<
+    Integrand, std::void_t<typename Integrand::JacobianProductData>>
+    : std::true_type {
+  using type = typename Integrand::JacobianProductData;
+};
+
 template <typename T, FEVarType of, FEVarType wrt, class Integrand,
           class Quadrature, class DataBasis, class GeoBasis, class Basis>
 class MatrixFree {
@@ -33,7 +82,60 @@ class MatrixFree {
   using QMatType = typename Integrand::template FiniteElementJacobian<of, wrt>;
   using QMatSpace = QptSpace<Quadrature, QMatType>;
 
-  MatrixFree() {}
+  // Type used for the compressed storage
+  using FloatType =
+      typename std::conditional<std::is_same<T, double>::value, float, T>::type;
+
+  // Is the quadrature point Jacobian stored as a symmetric matrix
+  static constexpr bool is_symmetric =
+      std::is_same<QMatType, SymMat<T, QMatType::nrows>>::value;
+
+  // Can the Jacobian be applied on the fly, and with the cached data
+  static constexpr bool state_jacobian =
+      (of == FEVarType::STATE && wrt == FEVarType::STATE);
+  static constexpr bool use_product_data =
+      state_jacobian && has_jacobian_product_data<Integrand>::value;
+  using QProductData = typename has_jacobian_product_data<Integrand>::type;
+
+  MatrixFree(MatFreeStorage storage = MatFreeStorage::FULL)
+      : storage(storage) {
+    if (storage == MatFreeStorage::ON_THE_FLY && !state_jacobian) {
+      throw std::runtime_error(
+          "MatrixFree: ON_THE_FLY storage requires the state Jacobian");
+    }
+  }
+
+  /**
+   * @brief Get the storage type
+   */
+  MatFreeStorage get_storage() const { return storage; }
+
+  /**
+   * @brief Get the number of bytes used to store the quadrature point data
+   */
+  std::size_t get_memory_usage() const {
+    return qmat.size() * sizeof(QMatSpace) +
+           qmat_float.size() * sizeof(FloatType) +
+           qproduct.size() * sizeof(QProductData) +
+           qdata.size() * sizeof(QDataSpace) +
+           qgeo.size() * sizeof(QGeoSpace) + qsol.size() * sizeof(QSpace);
+  }
+
+  /**
+   * @brief Print the storage and timing information
+   */
+  void report() const {
+    const char* names[] = {"FULL", "FLOAT", "ON_THE_FLY"};
+    std::size_t nelems = get_num_elements();
+    double mem = get_memory_usage();
+    std::printf("MatrixFree storage: %s\n", names[int(storage)]);
+    std::printf("  memory:            %12.4e MB (%.1f bytes/element)\n",
+                mem / (1024.0 * 1024.0), nelems > 0 ? mem / nelems : 0.0);
+    std::printf("  initialize time:   %12.4e s\n", t_init);
+    std::printf("  products:          %12d\n", num_products);
+    std::printf("  time per product:  %12.4e s\n",
+                num_products > 0 ? t_product / num_products : 0.0);
+  }
 
   template <class DataElemVec, class GeoElemVec, class ElemVec>
   void initialize(const Integrand& integrand, DataElemVec& elem_data,
@@ -45,17 +147,42 @@ class MatrixFree {
     constexpr ElemVecType evtype = same_evtype::evtype;
 
     Timer timer("MatrixFree::initialize()");
-    // Re-size the vector as needed
-    const index_t num_elements = elem_geo.get_num_elements();
-    if (qmat.size() != num_elements) {
-      qmat.resize(num_elements);
-    }
+    StopWatch watch;
 
-    // Number of components at the quadrature point
-    const index_t ncomp = Integrand::FiniteElementSpace::ncomp;
-
-    // Get the number of quadrature points
+    // Re-size the storage as needed and release storage that is not used
+    num_elements = elem_geo.get_num_elements();
     const index_t num_quadrature_points = Quadrature::get_num_points();
+    if (storage == MatFreeStorage::FULL) {
+      qmat.resize(num_elements);
+    } else {
+      std::vector<QMatSpace>().swap(qmat);
+    }
+    if (storage == MatFreeStorage::FLOAT) {
+      qmat_float.resize(num_elements * num_quadrature_points *
+                        QMatType::ncomp);
+    } else {
+      std::vector<FloatType>().swap(qmat_float);
+    }
+    const bool on_the_fly = (storage == MatFreeStorage::ON_THE_FLY);
+    if (on_the_fly) {
+      integrand_copy = std::make_shared<Integrand>(integrand);
+    } else {
+      integrand_copy = nullptr;
+    }
+    if (on_the_fly && use_product_data) {
+      qproduct.resize(num_elements * num_quadrature_points);
+    } else {
+      std::vector<QProductData>().swap(qproduct);
+    }
+    if (on_the_fly && !use_product_data) {
+      qdata.resize(num_elements);
+      qgeo.resize(num_elements);
+      qsol.resize(num_elements);
+    } else {
+      std::vector<QDataSpace>().swap(qdata);
+      std::vector<QGeoSpace>().swap(qgeo);
+      std::vector<QSpace>().swap(qsol);
+    }
 
     if constexpr (evtype == ElemVecType::Parallel) {
       elem_data.get_values();
@@ -84,21 +211,48 @@ class MatrixFree {
       GeoBasis::template interp(geo_dof, geo);
       Basis::template interp(sol_dof, sol);
 
-      for (index_t j = 0; j < num_quadrature_points; j++) {
-        T weight = Quadrature::get_weight(j);
-        integrand.template jacobian<of, wrt>(weight, data.get(j), geo.get(j),
-                                             sol.get(j), qmat[i].get(j));
+      if (storage == MatFreeStorage::FULL) {
+        for (index_t j = 0; j < num_quadrature_points; j++) {
+          T weight = Quadrature::get_weight(j);
+          integrand.template jacobian<of, wrt>(
+              weight, data.get(j), geo.get(j), sol.get(j), qmat[i].get(j));
+        }
+      } else if (storage == MatFreeStorage::FLOAT) {
+        FloatType* ptr =
+            &qmat_float[i * num_quadrature_points * QMatType::ncomp];
+        for (index_t j = 0; j < num_quadrature_points; j++) {
+          T weight = Quadrature::get_weight(j);
+          QMatType jac;
+          integrand.template jacobian<of, wrt>(weight, data.get(j), geo.get(j),
+                                               sol.get(j), jac);
+          for (index_t k = 0; k < QMatType::ncomp; k++, ptr++) {
+            ptr[0] = FloatType(jac[k]);
+          }
+        }
+      } else if constexpr (use_product_data) {
+        QProductData* ptr = &qproduct[i * num_quadrature_points];
+        for (index_t j = 0; j < num_quadrature_points; j++) {
+          T weight = Quadrature::get_weight(j);
+          integrand.jacobian_product_data(weight, data.get(j), geo.get(j),
+                                          sol.get(j), ptr[j]);
+        }
+      } else {
+        qdata[i] = data;
+        qgeo[i] = geo;
+        qsol[i] = sol;
       }
     }
+
+    t_init = watch.lap();
   }
 
   template <class ElemVec>
   void add_jacobian_vector_product(ElemVec& elem_xvec, ElemVec& elem_yvec) {
     constexpr ElemVecType evtype = ElemVec::evtype;
+    StopWatch watch;
 
-    const index_t num_elements = qmat.size();
     const index_t num_quadrature_points = Quadrature::get_num_points();
-    const index_t ncomp = Integrand::FiniteElementSpace::ncomp;
+    constexpr index_t ncomp = Integrand::FiniteElementSpace::ncomp;
 
     if constexpr (evtype == ElemVecType::Parallel) {
       elem_xvec.get_values();
@@ -122,15 +276,23 @@ class MatrixFree {
         typename Integrand::FiniteElementSpace& yref = ysol.get(j);
         typename Integrand::FiniteElementSpace& xref = xsol.get(j);
 
-        // The entries of the Jacobian matrix at the quadrature point
-        const QMatType& jac = qmat[i].get(j);
-
         // Matrix-vector product at the quadrature point
         yref.zero();
-        for (index_t ii = 0; ii < ncomp; ii++) {
-          for (index_t jj = 0; jj < ncomp; jj++) {
-            yref[ii] += jac(ii, jj) * xref[jj];
-          }
+        if (storage == MatFreeStorage::FULL) {
+          const QMatType& jac = qmat[i].get(j);
+          quadrature_mult<ncomp>(jac.get_data(), xref, yref);
+        } else if (storage == MatFreeStorage::FLOAT) {
+          const FloatType* jac =
+              &qmat_float[(i * num_quadrature_points + j) * QMatType::ncomp];
+          quadrature_mult<ncomp>(jac, xref, yref);
+        } else if constexpr (use_product_data) {
+          integrand_copy->cached_jacobian_product(
+              qproduct[i * num_quadrature_points + j], xref, yref);
+        } else if constexpr (state_jacobian) {
+          T weight = Quadrature::get_weight(j);
+          integrand_copy->template jacobian_product<of, wrt>(
+              weight, qdata[i].get(j), qgeo[i].get(j), qsol[i].get(j), xref,
+              yref);
         }
       }
 
@@ -144,12 +306,118 @@ class MatrixFree {
     if constexpr (evtype == ElemVecType::Parallel) {
       elem_yvec.add_values();
     }
+
+    t_product += watch.lap();
+    num_products++;
   }
 
  private:
+  index_t get_num_elements() const { return num_elements; }
+
+  /**
+   * @brief Compute y += A * x at a quadrature point where the entries of A
+   * are stored in the same order as QMatType. For the symmetric case, each
+   * stored entry of the upper triangle is used for both triangles.
+   */
+  template <index_t ncomp, typename S, class Space>
+  static void quadrature_mult(const S* A, const Space& x, Space& y) {
+    if constexpr (is_symmetric) {
+      for (index_t jj = 0, k = 0; jj < ncomp; jj++) {
+        for (index_t ii = 0; ii < jj; ii++, k++) {
+          y[ii] += A[k] * x[jj];
+          y[jj] += A[k] * x[ii];
+        }
+        y[jj] += A[k] * x[jj];
+        k++;
+      }
+    } else {
+      for (index_t ii = 0; ii < ncomp; ii++) {
+        for (index_t jj = 0; jj < ncomp; jj++) {
+          y[ii] += A[ii * ncomp + jj] * x[jj];
+        }
+      }
+    }
+  }
+
+  // Storage type
+  MatFreeStorage storage;
+
+  // Number of elements from the last call to initialize()
+  index_t num_elements = 0;
+
+  // Jacobians stored in the precision T
   std::vector<QMatSpace> qmat;
+
+  // Jacobians stored in compressed precision
+  std::vector<FloatType> qmat_float;
+
+  // Quadrature point data used for the on-the-fly products
+  std::shared_ptr<Integrand> integrand_copy;
+  std::vector<QProductData> qproduct;
+  std::vector<QDataSpace> qdata;
+  std::vector<QGeoSpace> qgeo;
+  std::vector<QSpace> qsol;
+
+  // Timing information
+  double t_init = 0.0;
+  double t_product = 0.0;
+  index_t num_products = 0;
+};
+
+/**
+ * @brief Linear operator that applies a matrix-free Jacobian to blocked vectors
+ *
+ * The input and output vectors of each product are aliased by SolutionVector
+ * objects, so the element vectors read and write the Krylov vectors directly
+ * without copies. Rows associated with Dirichlet boundary conditions are set
+ * to the identity.
+ *
+ * The operator is not copyable since the element vectors reference its
+ * members. Wrap it in a lambda or std::ref when passing it to a solver.
+ */
+template <typename T, index_t block_size, class MatFree, class ElemVec>
+class MatrixFreeOperator {
+ public:
+  template <class Mesh>
+  MatrixFreeOperator(MatFree& matfree, Mesh& mesh, index_t nbcs = 0,
+                     const index_t* bc_dofs = nullptr)
+      : matfree(matfree),
+        xvec(mesh.get_num_dof(), nullptr),
+        yvec(mesh.get_num_dof(), nullptr),
+        elem_xvec(mesh, xvec),
+        elem_yvec(mesh, yvec),
+        nbcs(nbcs),
+        bc_dofs(bc_dofs) {}
+
+  MatrixFreeOperator(const MatrixFreeOperator&) = delete;
+  MatrixFreeOperator& operator=(const MatrixFreeOperator&) = delete;
+
+  /**
+   * @brief Compute out = J * in
+   */
+  void operator()(MultiArrayNew<T* [block_size]>& in,
+                  MultiArrayNew<T* [block_size]>& out) {
+    xvec.alias(in);
+    yvec.alias(out);
+
+    yvec.zero();
+    matfree.add_jacobian_vector_product(elem_xvec, elem_yvec);
+
+    // Set the boundary conditions as equal to the inputs
+    for (index_t i = 0; i < nbcs; i++) {
+      index_t dof = bc_dofs[i];
+      yvec[dof] = xvec[dof];
+    }
+  }
+
+ private:
+  MatFree& matfree;
+  SolutionVector<T> xvec, yvec;
+  ElemVec elem_xvec, elem_yvec;
+  index_t nbcs;
+  const index_t* bc_dofs;
 };
 
 }  // namespace A2D
 
-#endif  // FE_MATRIX_FREE_H
\ No newline at end of file
+#endif  // FE_MATRIX_FREE_H
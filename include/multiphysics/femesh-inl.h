@@ -96,15 +96,122 @@ inline MeshConnectivityBase::~MeshConnectivityBase() {
   }
 }
 
+/**
+ * @brief Load the connectivity data from a checkpoint
+ *
+ * @param ckpt The checkpoint reader
+ * @param prefix The prefix used when the connectivity was saved
+ * @param dim The spatial dimension expected by the derived class
+ */
+inline MeshConnectivityBase::MeshConnectivityBase(const CheckpointReader& ckpt,
+                                                  const std::string& prefix,
+                                                  index_t dim) {
+  if (ckpt.read_scalar<index_t>(prefix + "/dim") != dim) {
+    char msg[256];
+    std::snprintf(msg, sizeof(msg),
+                  "checkpoint %s does not contain a %dD mesh connectivity",
+                  prefix.c_str(), dim);
+    throw std::runtime_error(msg);
+  }
+
+  index_t sizes[9];
+  ckpt.read(prefix + "/sizes", sizes, 9);
+  nelems = sizes[0];
+  nbounds = sizes[1];
+  nedges = sizes[2];
+  nverts = sizes[3];
+  nline_bounds = sizes[4];
+  ntri_bounds = sizes[5];
+  nquad_bounds = sizes[6];
+  num_boundary_labels = sizes[7];
+  num_boundary_bounds = sizes[8];
+
+  vert_element_ptr = load_array(ckpt, prefix + "/vert_element_ptr", nverts + 1);
+  vert_elements = load_array(ckpt, prefix + "/vert_elements",
+                             vert_element_ptr[nverts]);
+
+  line_bound_elements =
+      load_array(ckpt, prefix + "/line_bound_elements", 2 * nline_bounds);
+  tri_bound_elements =
+      load_array(ckpt, prefix + "/tri_bound_elements", 2 * ntri_bounds);
+  quad_bound_elements =
+      load_array(ckpt, prefix + "/quad_bound_elements", 2 * nquad_bounds);
+
+  boundary_bounds =
+      load_array(ckpt, prefix + "/boundary_bounds", num_boundary_bounds);
+  boundary_labels =
+      load_array(ckpt, prefix + "/boundary_labels", num_boundary_bounds);
+}
+
+/**
+ * @brief Save the connectivity, the derived bound, edge and vertex to
+ * element data and the boundary labels to a checkpoint
+ *
+ * @param ckpt The checkpoint writer
+ * @param prefix Prefix for the names of the arrays in the checkpoint
+ */
+inline void MeshConnectivityBase::save(CheckpointWriter& ckpt,
+                                       const std::string& prefix) {
+  const index_t sizes[9] = {nelems,       nbounds,
+                            nedges,       nverts,
+                            nline_bounds, ntri_bounds,
+                            nquad_bounds, num_boundary_labels,
+                            num_boundary_bounds};
+  ckpt.write(prefix + "/sizes", sizes, 9);
+
+  ckpt.write(prefix + "/vert_element_ptr", vert_element_ptr, nverts + 1);
+  ckpt.write(prefix + "/vert_elements", vert_elements,
+             vert_element_ptr[nverts]);
+
+  ckpt.write(prefix + "/line_bound_elements", line_bound_elements,
+             2 * nline_bounds);
+  ckpt.write(prefix + "/tri_bound_elements", tri_bound_elements,
+             2 * ntri_bounds);
+  ckpt.write(prefix + "/quad_bound_elements", quad_bound_elements,
+             2 * nquad_bounds);
+
+  ckpt.write(prefix + "/boundary_bounds", boundary_bounds,
+             num_boundary_bounds);
+  ckpt.write(prefix + "/boundary_labels", boundary_labels,
+             num_boundary_bounds);
+
+  save_elements(ckpt, prefix);
+}
+
+inline index_t* MeshConnectivityBase::load_array(const CheckpointReader& ckpt,
+                                                 const std::string& name,
+                                                 std::size_t count) {
+  std::size_t n;
+  const index_t* src = ckpt.get<index_t>(name, &n);
+  if (n != count) {
+    char msg[256];
+    std::snprintf(msg, sizeof(msg),
+                  "checkpoint array %s has %zu entries, expected %zu",
+                  name.c_str(), n, count);
+    throw std::runtime_error(msg);
+  }
+  index_t* array = new index_t[count];
+  std::copy(src, src + count, array);
+  return array;
+}
+
 /**
  * @brief Initialize all derived connectivity data and set up boundary
  *
  * Note: allocation must be performed explicitly before calling this function
+ *
+ * @param build The algorithm used to find the shared bounds and edges
  */
-inline void MeshConnectivityBase::initialize() {
-  init_vert_element_data();
-  init_bound_data();
-  init_edge_data();
+inline void MeshConnectivityBase::initialize(MeshConnectivityBuild build) {
+  if (build == MeshConnectivityBuild::PARALLEL) {
+    init_vert_element_data_parallel();
+    init_bound_data_parallel();
+    init_edge_data_parallel();
+  } else {
+    init_vert_element_data();
+    init_bound_data();
+    init_edge_data();
+  }
 
   // Count up all the bounds that are on the boundary
   num_boundary_bounds = 0;
@@ -599,7 +706,8 @@ inline void MeshConnectivityBase::get_element_edge_verts(index_t elem,
 
 template <typename I>
 inline MeshConnectivity2D::MeshConnectivity2D(I nverts, I ntri, I* tri, I nquad,
-                                              I* quad)
+                                              I* quad,
+                                              MeshConnectivityBuild build)
     : MeshConnectivityBase(nverts, ntri + nquad),
       ntri(ntri),
       nquad(nquad),
@@ -628,7 +736,7 @@ inline MeshConnectivity2D::MeshConnectivity2D(I nverts, I ntri, I* tri, I nquad,
   std::fill(tri_bounds, tri_bounds + ET::TRI_NBOUNDS * ntri, NO_LABEL);
   std::fill(quad_bounds, quad_bounds + ET::QUAD_NBOUNDS * nquad, NO_LABEL);
 
-  initialize();
+  initialize(build);
 }
 
 inline MeshConnectivity2D::~MeshConnectivity2D() {
@@ -647,6 +755,40 @@ inline MeshConnectivity2D::~MeshConnectivity2D() {
   }
 }
 
+inline MeshConnectivity2D::MeshConnectivity2D(const CheckpointReader& ckpt,
+                                              const std::string& prefix)
+    : MeshConnectivityBase(ckpt, prefix, 2),
+      meta_tri(MetaDataFactory::create_2d_meta(ET::Element::Tri, &tri_bounds,
+                                               &tri_verts)),
+      meta_quad(MetaDataFactory::create_2d_meta(ET::Element::Quad, &quad_bounds,
+                                                &quad_verts)) {
+  Timer timer("MeshConnectivity2D");
+  index_t counts[2];
+  ckpt.read(prefix + "/counts", counts, 2);
+  ntri = counts[0];
+  nquad = counts[1];
+
+  tri_verts = load_array(ckpt, prefix + "/tri_verts", ET::TRI_NVERTS * ntri);
+  quad_verts =
+      load_array(ckpt, prefix + "/quad_verts", ET::QUAD_NVERTS * nquad);
+  tri_bounds =
+      load_array(ckpt, prefix + "/tri_bounds", ET::TRI_NBOUNDS * ntri);
+  quad_bounds =
+      load_array(ckpt, prefix + "/quad_bounds", ET::QUAD_NBOUNDS * nquad);
+}
+
+inline void MeshConnectivity2D::save_elements(CheckpointWriter& ckpt,
+                                              const std::string& prefix) {
+  const index_t counts[2] = {ntri, nquad};
+  ckpt.write_scalar<index_t>(prefix + "/dim", 2);
+  ckpt.write(prefix + "/counts", counts, 2);
+
+  ckpt.write(prefix + "/tri_verts", tri_verts, ET::TRI_NVERTS * ntri);
+  ckpt.write(prefix + "/quad_verts", quad_verts, ET::QUAD_NVERTS * nquad);
+  ckpt.write(prefix + "/tri_bounds", tri_bounds, ET::TRI_NBOUNDS * ntri);
+  ckpt.write(prefix + "/quad_bounds", quad_bounds, ET::QUAD_NBOUNDS * nquad);
+}
+
 /**
  * @brief Shift elem to get local index within its element type (tri or quad)
  * and return the meta data for this element type
@@ -673,7 +815,8 @@ const inline ElemConnMetaData& MeshConnectivity2D::get_local_elem_and_meta(
 template <typename I>
 inline MeshConnectivity3D::MeshConnectivity3D(I nverts, I ntets, I* tets,
                                               I nhex, I* hex, I nwedge,
-                                              I* wedge, I npyrmd, I* pyrmd)
+                                              I* wedge, I npyrmd, I* pyrmd,
+                                              MeshConnectivityBuild build)
     : MeshConnectivityBase(nverts, ntets + nhex + nwedge + npyrmd),
       ntets(ntets),
       nhex(nhex),
@@ -732,7 +875,7 @@ inline MeshConnectivity3D::MeshConnectivity3D(I nverts, I ntets, I* tets,
   std::fill(wedge_edges, wedge_edges + ET::WEDGE_NEDGES * nwedge, NO_LABEL);
   std::fill(pyrmd_edges, pyrmd_edges + ET::PYRMD_NEDGES * npyrmd, NO_LABEL);
 
-  initialize();
+  initialize(build);
 }
 
 inline MeshConnectivity3D::~MeshConnectivity3D() {
@@ -776,6 +919,72 @@ inline MeshConnectivity3D::~MeshConnectivity3D() {
   }
 }
 
+inline MeshConnectivity3D::MeshConnectivity3D(const CheckpointReader& ckpt,
+                                              const std::string& prefix)
+    : MeshConnectivityBase(ckpt, prefix, 3),
+      meta_tet(MetaDataFactory::create_3d_meta(ET::Element::Tet, &tet_bounds,
+                                               &tet_edges, &tet_verts)),
+      meta_hex(MetaDataFactory::create_3d_meta(ET::Element::Hex, &hex_bounds,
+                                               &hex_edges, &hex_verts)),
+      meta_wedge(MetaDataFactory::create_3d_meta(
+          ET::Element::Wedge, &wedge_bounds, &wedge_edges, &wedge_verts)),
+      meta_pyrmd(MetaDataFactory::create_3d_meta(
+          ET::Element::Pyrmd, &pyrmd_bounds, &pyrmd_edges, &pyrmd_verts)) {
+  Timer timer("MeshConnectivity3D");
+  index_t counts[4];
+  ckpt.read(prefix + "/counts", counts, 4);
+  ntets = counts[0];
+  nhex = counts[1];
+  nwedge = counts[2];
+  npyrmd = counts[3];
+
+  tet_verts = load_array(ckpt, prefix + "/tet_verts", ET::TET_NVERTS * ntets);
+  hex_verts = load_array(ckpt, prefix + "/hex_verts", ET::HEX_NVERTS * nhex);
+  wedge_verts =
+      load_array(ckpt, prefix + "/wedge_verts", ET::WEDGE_NVERTS * nwedge);
+  pyrmd_verts =
+      load_array(ckpt, prefix + "/pyrmd_verts", ET::PYRMD_NVERTS * npyrmd);
+
+  tet_bounds =
+      load_array(ckpt, prefix + "/tet_bounds", ET::TET_NBOUNDS * ntets);
+  hex_bounds = load_array(ckpt, prefix + "/hex_bounds", ET::HEX_NBOUNDS * nhex);
+  wedge_bounds =
+      load_array(ckpt, prefix + "/wedge_bounds", ET::WEDGE_NBOUNDS * nwedge);
+  pyrmd_bounds =
+      load_array(ckpt, prefix + "/pyrmd_bounds", ET::PYRMD_NBOUNDS * npyrmd);
+
+  tet_edges = load_array(ckpt, prefix + "/tet_edges", ET::TET_NEDGES * ntets);
+  hex_edges = load_array(ckpt, prefix + "/hex_edges", ET::HEX_NEDGES * nhex);
+  wedge_edges =
+      load_array(ckpt, prefix + "/wedge_edges", ET::WEDGE_NEDGES * nwedge);
+  pyrmd_edges =
+      load_array(ckpt, prefix + "/pyrmd_edges", ET::PYRMD_NEDGES * npyrmd);
+}
+
+inline void MeshConnectivity3D::save_elements(CheckpointWriter& ckpt,
+                                              const std::string& prefix) {
+  const index_t counts[4] = {ntets, nhex, nwedge, npyrmd};
+  ckpt.write_scalar<index_t>(prefix + "/dim", 3);
+  ckpt.write(prefix + "/counts", counts, 4);
+
+  ckpt.write(prefix + "/tet_verts", tet_verts, ET::TET_NVERTS * ntets);
+  ckpt.write(prefix + "/hex_verts", hex_verts, ET::HEX_NVERTS * nhex);
+  ckpt.write(prefix + "/wedge_verts", wedge_verts, ET::WEDGE_NVERTS * nwedge);
+  ckpt.write(prefix + "/pyrmd_verts", pyrmd_verts, ET::PYRMD_NVERTS * npyrmd);
+
+  ckpt.write(prefix + "/tet_bounds", tet_bounds, ET::TET_NBOUNDS * ntets);
+  ckpt.write(prefix + "/hex_bounds", hex_bounds, ET::HEX_NBOUNDS * nhex);
+  ckpt.write(prefix + "/wedge_bounds", wedge_bounds,
+             ET::WEDGE_NBOUNDS * nwedge);
+  ckpt.write(prefix + "/pyrmd_bounds", pyrmd_bounds,
+             ET::PYRMD_NBOUNDS * npyrmd);
+
+  ckpt.write(prefix + "/tet_edges", tet_edges, ET::TET_NEDGES * ntets);
+  ckpt.write(prefix + "/hex_edges", hex_edges, ET::HEX_NEDGES * nhex);
+  ckpt.write(prefix + "/wedge_edges", wedge_edges, ET::WEDGE_NEDGES * nwedge);
+  ckpt.write(prefix + "/pyrmd_edges", pyrmd_edges, ET::PYRMD_NEDGES * npyrmd);
+}
+
 /**
  * @brief Shift elem to get local index within its element type (tet, hex, etc.)
  * and return the meta data for this element type
@@ -1114,6 +1323,332 @@ inline void MeshConnectivityBase::init_edge_data() {
   }
 }
 
+/**
+ * @brief Initialize the vertex to element data in parallel
+ *
+ * The elements of each vertex are sorted so that the result is identical to
+ * init_vert_element_data()
+ */
+inline void MeshConnectivityBase::init_vert_element_data_parallel() {
+  vert_element_ptr = new index_t[nverts + 1];
+  std::fill(vert_element_ptr, vert_element_ptr + nverts + 1, 0);
+
+#pragma omp parallel for
+  for (index_t elem = 0; elem < nelems; elem++) {
+    const index_t* verts;
+    index_t nv = get_element_verts(elem, &verts);
+    for (index_t i = 0; i < nv; i++) {
+#pragma omp atomic
+      vert_element_ptr[verts[i] + 1]++;
+    }
+  }
+
+  for (index_t i = 0; i < nverts; i++) {
+    vert_element_ptr[i + 1] += vert_element_ptr[i];
+  }
+
+  vert_elements = new index_t[vert_element_ptr[nverts]];
+  std::vector<index_t> count(nverts, 0);
+
+#pragma omp parallel for
+  for (index_t elem = 0; elem < nelems; elem++) {
+    const index_t* verts;
+    index_t nv = get_element_verts(elem, &verts);
+    for (index_t i = 0; i < nv; i++) {
+      index_t pos;
+#pragma omp atomic capture
+      pos = count[verts[i]]++;
+      vert_elements[vert_element_ptr[verts[i]] + pos] = elem;
+    }
+  }
+
+#pragma omp parallel for schedule(dynamic, 1024)
+  for (index_t i = 0; i < nverts; i++) {
+    std::sort(&vert_elements[vert_element_ptr[i]],
+              &vert_elements[vert_element_ptr[i + 1]]);
+  }
+}
+
+/**
+ * @brief Match the slots (element bounds or edges) that share the same key
+ *
+ * Each slot has nkeys vertex indices, with the smallest vertex first, padded
+ * with NO_INDEX. The slots are grouped by their first vertex with a parallel
+ * bucket sort, then each bucket is sorted by key and slot index.
+ *
+ * @param nslots Number of slots in the element sweep order
+ * @param keys The keys for each slot
+ * @param max_matches Maximum number of slots that share an entity, others
+ * become separate entities
+ * @param first On exit, the first slot with the same key
+ * @param second On exit, the second slot with the same key or NO_INDEX
+ */
+template <index_t nkeys>
+void MeshConnectivityBase::match_slots(index_t nslots,
+                                       const std::vector<index_t>& keys,
+                                       index_t max_matches,
+                                       std::vector<index_t>& first,
+                                       std::vector<index_t>& second) {
+  // Bucket the slots by their smallest vertex
+  std::vector<index_t> ptr(nverts + 1, 0), order(nslots), count(nverts, 0);
+
+#pragma omp parallel for
+  for (index_t slot = 0; slot < nslots; slot++) {
+#pragma omp atomic
+    ptr[keys[nkeys * slot] + 1]++;
+  }
+  for (index_t i = 0; i < nverts; i++) {
+    ptr[i + 1] += ptr[i];
+  }
+
+#pragma omp parallel for
+  for (index_t slot = 0; slot < nslots; slot++) {
+    index_t v = keys[nkeys * slot];
+    index_t pos;
+#pragma omp atomic capture
+    pos = count[v]++;
+    order[ptr[v] + pos] = slot;
+  }
+
+  auto compare = [&](index_t a, index_t b) {
+    for (index_t k = 0; k < nkeys; k++) {
+      if (keys[nkeys * a + k] != keys[nkeys * b + k]) {
+        return keys[nkeys * a + k] < keys[nkeys * b + k];
+      }
+    }
+    return a < b;
+  };
+
+  auto equal = [&](index_t a, index_t b) {
+    for (index_t k = 0; k < nkeys; k++) {
+      if (keys[nkeys * a + k] != keys[nkeys * b + k]) {
+        return false;
+      }
+    }
+    return true;
+  };
+
+  first.resize(nslots);
+  second.assign(nslots, NO_INDEX);
+
+#pragma omp parallel for schedule(dynamic, 1024)
+  for (index_t i = 0; i < nverts; i++) {
+    std::sort(&order[ptr[i]], &order[ptr[i + 1]], compare);
+
+    for (index_t start = ptr[i]; start < ptr[i + 1];) {
+      index_t end = start + 1;
+      while (end < ptr[i + 1] && equal(order[start], order[end])) {
+        end++;
+      }
+
+      index_t f = order[start];
+      for (index_t j = start; j < end; j++) {
+        if (j - start < max_matches) {
+          first[order[j]] = f;
+        } else {
+          first[order[j]] = order[j];
+        }
+      }
+      if (end - start > 1 && max_matches > 1) {
+        second[f] = order[start + 1];
+      }
+      start = end;
+    }
+  }
+}
+
+/**
+ * @brief Initialize the bound data in parallel
+ *
+ * The bounds are numbered in the order in which they first appear in the
+ * sweep over the elements, separately for each bound type, so the numbering
+ * is identical to init_bound_data()
+ */
+inline void MeshConnectivityBase::init_bound_data_parallel() {
+  // Offset of the bounds of each element in the sweep order
+  std::vector<index_t> slot_ptr(nelems + 1, 0);
+#pragma omp parallel for
+  for (index_t elem = 0; elem < nelems; elem++) {
+    index_t* bounds;
+    slot_ptr[elem + 1] = get_element_bounds(elem, &bounds);
+  }
+  for (index_t elem = 0; elem < nelems; elem++) {
+    slot_ptr[elem + 1] += slot_ptr[elem];
+  }
+  const index_t nslots = slot_ptr[nelems];
+
+  // Find the unique vertices of each bound
+  const index_t nkeys = ET::MAX_BOUND_VERTS;
+  std::vector<index_t> keys(nkeys * nslots, NO_INDEX), slot_elem(nslots);
+  std::vector<index_t> slot_nverts(nslots);
+#pragma omp parallel for
+  for (index_t elem = 0; elem < nelems; elem++) {
+    index_t* bounds;
+    const index_t nf = get_element_bounds(elem, &bounds);
+    for (index_t bound = 0; bound < nf; bound++) {
+      index_t slot = slot_ptr[elem] + bound;
+      slot_elem[slot] = elem;
+      slot_nverts[slot] =
+          get_element_global_bound_verts(elem, bound, &keys[nkeys * slot]);
+    }
+  }
+
+  // A bound is shared by at most two elements
+  std::vector<index_t> first, second;
+  match_slots<nkeys>(nslots, keys, 2, first, second);
+
+  // Number the bounds of each type in the order of their first slot. Count
+  // the new bounds in each chunk of slots, then number them in parallel.
+  const index_t chunk = 1 << 16;
+  const index_t nchunks = (nslots + chunk - 1) / chunk;
+  std::vector<index_t> chunk_counts(3 * (nchunks + 1), 0);
+  auto type = [&](index_t slot) {
+    return slot_nverts[slot] == 2 ? 0 : (slot_nverts[slot] == 3 ? 1 : 2);
+  };
+
+#pragma omp parallel for
+  for (index_t c = 0; c < nchunks; c++) {
+    index_t end = std::min(nslots, (c + 1) * chunk);
+    for (index_t slot = c * chunk; slot < end; slot++) {
+      if (first[slot] == slot) {
+        chunk_counts[3 * (c + 1) + type(slot)]++;
+      }
+    }
+  }
+  for (index_t c = 0; c < nchunks; c++) {
+    for (index_t k = 0; k < 3; k++) {
+      chunk_counts[3 * (c + 1) + k] += chunk_counts[3 * c + k];
+    }
+  }
+  nline_bounds = chunk_counts[3 * nchunks];
+  ntri_bounds = chunk_counts[3 * nchunks + 1];
+  nquad_bounds = chunk_counts[3 * nchunks + 2];
+  nbounds = nline_bounds + ntri_bounds + nquad_bounds;
+
+  std::vector<index_t> number(nslots);
+#pragma omp parallel for
+  for (index_t c = 0; c < nchunks; c++) {
+    index_t counter[3] = {chunk_counts[3 * c], chunk_counts[3 * c + 1],
+                          chunk_counts[3 * c + 2]};
+    index_t end = std::min(nslots, (c + 1) * chunk);
+    for (index_t slot = c * chunk; slot < end; slot++) {
+      if (first[slot] == slot) {
+        number[slot] = counter[type(slot)]++;
+      }
+    }
+  }
+
+  line_bound_elements = new index_t[2 * nline_bounds];
+  std::fill(line_bound_elements, line_bound_elements + 2 * nline_bounds,
+            NO_LABEL);
+  tri_bound_elements = new index_t[2 * ntri_bounds];
+  std::fill(tri_bound_elements, tri_bound_elements + 2 * ntri_bounds, NO_LABEL);
+  quad_bound_elements = new index_t[2 * nquad_bounds];
+  std::fill(quad_bound_elements, quad_bound_elements + 2 * nquad_bounds,
+            NO_LABEL);
+
+  // Set the bound -> element data and the global bound index for each element
+  // bound, triangle bounds follow the line bounds and quadrilateral bounds
+  // follow the triangle bounds
+  index_t* bound_elements[3] = {line_bound_elements, tri_bound_elements,
+                                quad_bound_elements};
+  const index_t offset[3] = {0, nline_bounds, nline_bounds + ntri_bounds};
+
+#pragma omp parallel for
+  for (index_t elem = 0; elem < nelems; elem++) {
+    index_t* bounds;
+    const index_t nf = get_element_bounds(elem, &bounds);
+    for (index_t bound = 0; bound < nf; bound++) {
+      index_t slot = slot_ptr[elem] + bound;
+      index_t f = first[slot];
+      index_t t = type(slot);
+      bounds[bound] = number[f] + offset[t];
+
+      if (f == slot) {
+        bound_elements[t][2 * number[f]] = elem;
+        if (second[f] != NO_INDEX) {
+          bound_elements[t][2 * number[f] + 1] = slot_elem[second[f]];
+        }
+      }
+    }
+  }
+}
+
+/**
+ * @brief Initialize the edge data in parallel
+ *
+ * The edges are numbered in the order in which they first appear in the
+ * sweep over the elements, so the numbering is identical to init_edge_data()
+ */
+inline void MeshConnectivityBase::init_edge_data_parallel() {
+  std::vector<index_t> slot_ptr(nelems + 1, 0);
+#pragma omp parallel for
+  for (index_t elem = 0; elem < nelems; elem++) {
+    index_t* elem_edges;
+    slot_ptr[elem + 1] = get_element_edges(elem, &elem_edges);
+  }
+  for (index_t elem = 0; elem < nelems; elem++) {
+    slot_ptr[elem + 1] += slot_ptr[elem];
+  }
+  const index_t nslots = slot_ptr[nelems];
+
+  // Sorted vertices of each edge
+  std::vector<index_t> keys(2 * nslots);
+#pragma omp parallel for
+  for (index_t elem = 0; elem < nelems; elem++) {
+    index_t* elem_edges;
+    const index_t ne = get_element_edges(elem, &elem_edges);
+    for (index_t e = 0; e < ne; e++) {
+      index_t slot = slot_ptr[elem] + e, v[2];
+      get_element_edge_verts(elem, e, v);
+      keys[2 * slot] = std::min(v[0], v[1]);
+      keys[2 * slot + 1] = std::max(v[0], v[1]);
+    }
+  }
+
+  std::vector<index_t> first, second;
+  match_slots<2>(nslots, keys, MAX_INDEX, first, second);
+
+  // Number the edges in the order of their first slot
+  const index_t chunk = 1 << 16;
+  const index_t nchunks = (nslots + chunk - 1) / chunk;
+  std::vector<index_t> chunk_counts(nchunks + 1, 0);
+#pragma omp parallel for
+  for (index_t c = 0; c < nchunks; c++) {
+    index_t end = std::min(nslots, (c + 1) * chunk);
+    for (index_t slot = c * chunk; slot < end; slot++) {
+      if (first[slot] == slot) {
+        chunk_counts[c + 1]++;
+      }
+    }
+  }
+  for (index_t c = 0; c < nchunks; c++) {
+    chunk_counts[c + 1] += chunk_counts[c];
+  }
+  nedges = chunk_counts[nchunks];
+
+  std::vector<index_t> number(nslots);
+#pragma omp parallel for
+  for (index_t c = 0; c < nchunks; c++) {
+    index_t counter = chunk_counts[c];
+    index_t end = std::min(nslots, (c + 1) * chunk);
+    for (index_t slot = c * chunk; slot < end; slot++) {
+      if (first[slot] == slot) {
+        number[slot] = counter++;
+      }
+    }
+  }
+
+#pragma omp parallel for
+  for (index_t elem = 0; elem < nelems; elem++) {
+    index_t* elem_edges;
+    const index_t ne = get_element_edges(elem, &elem_edges);
+    for (index_t e = 0; e < ne; e++) {
+      elem_edges[e] = number[first[slot_ptr[elem] + e]];
+    }
+  }
+}
+
 /**
  * @brief Add a boundary condition
  *
@@ -1206,9 +1741,12 @@ inline bool DirichletBCInfo::active_for_dof(index_t label, index_t basis,
  * across the entire mesh
  *
  * @param conn The mesh connectivity
+ * @param ordering The ordering applied to the degrees of freedom
+ * @param block_size Block size that is preserved by the reordering
  */
 template <class Basis>
-ElementMesh<Basis>::ElementMesh(MeshConnectivityBase& conn)
+ElementMesh<Basis>::ElementMesh(MeshConnectivityBase& conn,
+                                DofOrdering ordering, index_t block_size)
     : nelems(conn.get_num_elements()), num_dof(0) {
   // Count up the number of degrees of freedom
   element_dof = new index_t[nelems * ndof_per_element];
@@ -1400,6 +1938,119 @@ ElementMesh<Basis>::ElementMesh(MeshConnectivityBase& conn)
 
   // Set the number of degrees of freedom
   num_dof = dof_counter;
+
+  if (ordering == DofOrdering::RCM) {
+    reorder_dof_rcm(block_size);
+  }
+}
+
+/**
+ * @brief Reorder the degrees of freedom using reverse Cuthill-McKee
+ *
+ * The graph is formed from the blocks of block_size dof that share an element.
+ * Each basis is reordered separately so that the dof of basis i remain in the
+ * range [num_dof_offset[i - 1], num_dof_offset[i]).
+ *
+ * @param block_size Size of the blocks that are kept contiguous
+ */
+template <class Basis>
+void ElementMesh<Basis>::reorder_dof_rcm(index_t block_size) {
+  dof_perm.resize(num_dof);
+  for (index_t i = 0; i < num_dof; i++) {
+    dof_perm[i] = i;
+  }
+
+  for (index_t basis = 0; basis < Basis::nbasis; basis++) {
+    index_t lower = (basis == 0 ? 0 : num_dof_offset[basis - 1]);
+    index_t upper = num_dof_offset[basis];
+    if (lower % block_size != 0 || upper % block_size != 0) {
+      char msg[256];
+      std::snprintf(msg, sizeof(msg),
+                    "ElementMesh: dof range [%d, %d) of basis %d is not "
+                    "compatible with the block size %d.",
+                    lower, upper, basis, block_size);
+      throw std::runtime_error(msg);
+    }
+
+    const index_t offset = lower / block_size;
+    const index_t nblocks = (upper - lower) / block_size;
+    if (nblocks == 0) {
+      continue;
+    }
+
+    // Create the block to element data structure
+    std::vector<index_t> block_ptr(nblocks + 1, 0), marker(nblocks, NO_INDEX);
+    for (index_t elem = 0; elem < nelems; elem++) {
+      for (index_t j = 0; j < ndof_per_element; j++) {
+        index_t dof = element_dof[ndof_per_element * elem + j];
+        if (dof >= lower && dof < upper) {
+          index_t block = dof / block_size - offset;
+          if (marker[block] != elem) {
+            marker[block] = elem;
+            block_ptr[block + 1]++;
+          }
+        }
+      }
+    }
+    for (index_t i = 0; i < nblocks; i++) {
+      block_ptr[i + 1] += block_ptr[i];
+    }
+
+    std::vector<index_t> block_elems(block_ptr[nblocks]);
+    std::fill(marker.begin(), marker.end(), NO_INDEX);
+    for (index_t elem = 0; elem < nelems; elem++) {
+      for (index_t j = 0; j < ndof_per_element; j++) {
+        index_t dof = element_dof[ndof_per_element * elem + j];
+        if (dof >= lower && dof < upper) {
+          index_t block = dof / block_size - offset;
+          if (marker[block] != elem) {
+            marker[block] = elem;
+            block_elems[block_ptr[block]++] = elem;
+          }
+        }
+      }
+    }
+    for (index_t i = nblocks; i > 0; i--) {
+      block_ptr[i] = block_ptr[i - 1];
+    }
+    block_ptr[0] = 0;
+
+    // Form the block adjacency graph
+    std::vector<index_t> rowp(nblocks + 1, 0), cols;
+    std::fill(marker.begin(), marker.end(), NO_INDEX);
+    for (index_t i = 0; i < nblocks; i++) {
+      for (index_t ep = block_ptr[i]; ep < block_ptr[i + 1]; ep++) {
+        index_t elem = block_elems[ep];
+        for (index_t j = 0; j < ndof_per_element; j++) {
+          index_t dof = element_dof[ndof_per_element * elem + j];
+          if (dof >= lower && dof < upper) {
+            index_t block = dof / block_size - offset;
+            if (block != i && marker[block] != i) {
+              marker[block] = i;
+              cols.push_back(block);
+            }
+          }
+        }
+      }
+      rowp[i + 1] = cols.size();
+    }
+
+    std::vector<index_t> order;
+    reverse_cuthill_mckee(nblocks, rowp, cols, order);
+
+    for (index_t k = 0; k < nblocks; k++) {
+      index_t old_block = order[k] + offset;
+      for (index_t j = 0; j < block_size; j++) {
+        dof_perm[old_block * block_size + j] = (k + offset) * block_size + j;
+      }
+    }
+  }
+
+  for (index_t i = 0; i < nelems * ndof_per_element; i++) {
+    if (element_dof[i] < num_dof) {
+      element_dof[i] = dof_perm[element_dof[i]];
+    }
+  }
 }
 
 /**
@@ -1582,6 +2233,62 @@ ElementMesh<Basis>::ElementMesh(ElementMesh<HOrderBasis>& mesh)
   }
 }
 
+/**
+ * @brief Load the degrees of freedom from a checkpoint
+ *
+ * @param ckpt The checkpoint reader
+ * @param prefix The prefix used when the mesh was saved
+ */
+template <class Basis>
+ElementMesh<Basis>::ElementMesh(const CheckpointReader& ckpt,
+                                const std::string& prefix) {
+  index_t info[4];
+  ckpt.read(prefix + "/info", info, 4);
+  if (info[2] != ndof_per_element || info[3] != Basis::nbasis) {
+    char msg[256];
+    std::snprintf(msg, sizeof(msg),
+                  "checkpoint %s has %d dof and %d bases per element, "
+                  "expected %d and %d",
+                  prefix.c_str(), info[2], info[3], ndof_per_element,
+                  Basis::nbasis);
+    throw std::runtime_error(msg);
+  }
+  nelems = info[0];
+  num_dof = info[1];
+  ckpt.read(prefix + "/num_dof_offset", num_dof_offset, Basis::nbasis);
+
+  element_dof = new index_t[nelems * ndof_per_element];
+  element_sign = new int[nelems * ndof_per_element];
+  ckpt.read(prefix + "/element_dof", element_dof, nelems * ndof_per_element);
+  ckpt.read(prefix + "/element_sign", element_sign,
+            nelems * ndof_per_element);
+  ckpt.read(prefix + "/dof_perm", dof_perm);
+}
+
+template <class Basis>
+ElementMesh<Basis>::~ElementMesh() {
+  DELETE_ARRAY(element_dof);
+  DELETE_ARRAY(element_sign);
+}
+
+/**
+ * @brief Save the element to global dof maps and signs to a checkpoint
+ *
+ * @param ckpt The checkpoint writer
+ * @param prefix Prefix for the names of the arrays in the checkpoint
+ */
+template <class Basis>
+void ElementMesh<Basis>::save(CheckpointWriter& ckpt,
+                              const std::string& prefix) const {
+  const index_t info[4] = {nelems, num_dof, ndof_per_element, Basis::nbasis};
+  ckpt.write(prefix + "/info", info, 4);
+  ckpt.write(prefix + "/num_dof_offset", num_dof_offset, Basis::nbasis);
+  ckpt.write(prefix + "/element_dof", element_dof, nelems * ndof_per_element);
+  ckpt.write(prefix + "/element_sign", element_sign,
+             nelems * ndof_per_element);
+  ckpt.write(prefix + "/dof_perm", dof_perm);
+}
+
 template <class Basis>
 template <index_t basis>
 int ElementMesh<Basis>::get_global_dof_sign(index_t elem, index_t index) {
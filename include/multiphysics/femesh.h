@@ -2,12 +2,18 @@
 #define A2D_FE_MESH_H
 
 #include <algorithm>
+#include <cstdio>
 #include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 #include "a2ddefs.h"
 #include "multiphysics/feelementtypes.h"
+#include "multiphysics/femesh_ordering.h"
 #include "sparse/sparse_matrix.h"
 #include "sparse/sparse_symbolic.h"
+#include "utils/a2dcheckpoint.h"
 #include "utils/a2dprofiler.h"
 
 namespace A2D {
@@ -234,6 +240,18 @@ class MetaDataFactory {
   }
 };
 
+/**
+ * @brief Algorithm used to find the bounds and edges shared between elements
+ *
+ * SERIAL: For each element bound and edge, search the elements adjacent to
+ * its vertices for a match
+ *
+ * PARALLEL: Group the bounds and edges by their sorted vertices with a
+ * parallel bucket sort. The numbering is identical to SERIAL for conforming
+ * meshes. This is opt-in, SERIAL is the default.
+ */
+enum class MeshConnectivityBuild { SERIAL, PARALLEL };
+
 class MeshConnectivityBase {
  public:
   using ET = ElementTypes;
@@ -297,13 +315,27 @@ class MeshConnectivityBase {
   template <typename IdxType>
   index_t add_boundary_label_from_verts(index_t nv, const IdxType vert_list[]);
 
+  // Save the connectivity and all derived data to a checkpoint
+  void save(CheckpointWriter& ckpt, const std::string& prefix = "conn");
+
  protected:
   MeshConnectivityBase(index_t nverts, index_t nelems);
+  MeshConnectivityBase(const CheckpointReader& ckpt, const std::string& prefix,
+                       index_t dim);
   ~MeshConnectivityBase();
 
+  // Save the data specific to the element types
+  virtual void save_elements(CheckpointWriter& ckpt,
+                             const std::string& prefix) = 0;
+
+  // Allocate and read an array of known length from a checkpoint
+  static index_t* load_array(const CheckpointReader& ckpt,
+                             const std::string& name, std::size_t count);
+
   // Initialize all derived connectivity data and set up boundary, allocation
   // must be performed explicitly before calling this function
-  void initialize();
+  void initialize(
+      MeshConnectivityBuild build = MeshConnectivityBuild::SERIAL);
 
   // Get a non-constant entities
   index_t get_element_bounds(index_t elem, index_t* bounds[]);
@@ -334,6 +366,17 @@ class MeshConnectivityBase {
   void init_vert_element_data();
   void init_bound_data();
   void init_edge_data();
+
+  // Parallel versions of the initialization based on sorting
+  void init_vert_element_data_parallel();
+  void init_bound_data_parallel();
+  void init_edge_data_parallel();
+
+  // Find the first slot with the same key, and the second for bounds
+  template <index_t nkeys>
+  void match_slots(index_t nslots, const std::vector<index_t>& keys,
+                   index_t max_matches, std::vector<index_t>& first,
+                   std::vector<index_t>& second);
 };
 
 // Mesh connectivity class for 2D meshes composed of triangle and quadrilateral
@@ -341,7 +384,11 @@ class MeshConnectivityBase {
 class MeshConnectivity2D final : public MeshConnectivityBase {
  public:
   template <typename I>
-  MeshConnectivity2D(I nverts, I ntri, I* tri, I nquad, I* quad);
+  MeshConnectivity2D(
+      I nverts, I ntri, I* tri, I nquad, I* quad,
+      MeshConnectivityBuild build = MeshConnectivityBuild::SERIAL);
+  MeshConnectivity2D(const CheckpointReader& ckpt,
+                     const std::string& prefix = "conn");
   ~MeshConnectivity2D();
 
   // Shift elem to get local index within its element type (tri or quad)
@@ -349,6 +396,8 @@ class MeshConnectivity2D final : public MeshConnectivityBase {
   const inline ElemConnMetaData& get_local_elem_and_meta(index_t& elem);
 
  private:
+  void save_elements(CheckpointWriter& ckpt, const std::string& prefix);
+
   // Input counts of the triangle and quadrilateral elements
   index_t ntri, nquad;
 
@@ -369,8 +418,12 @@ class MeshConnectivity2D final : public MeshConnectivityBase {
 class MeshConnectivity3D final : public MeshConnectivityBase {
  public:
   template <typename I>
-  MeshConnectivity3D(I nverts, I ntets, I* tets, I nhex, I* hex, I nwedge,
-                     I* wedge, I npyrmd, I* pyrmd);
+  MeshConnectivity3D(
+      I nverts, I ntets, I* tets, I nhex, I* hex, I nwedge, I* wedge,
+      I npyrmd, I* pyrmd,
+      MeshConnectivityBuild build = MeshConnectivityBuild::SERIAL);
+  MeshConnectivity3D(const CheckpointReader& ckpt,
+                     const std::string& prefix = "conn");
   ~MeshConnectivity3D();
 
   // Shift elem to get local index within its element type (tet, hex, etc.)
@@ -378,6 +431,8 @@ class MeshConnectivity3D final : public MeshConnectivityBase {
   const inline ElemConnMetaData& get_local_elem_and_meta(index_t& elem);
 
  private:
+  void save_elements(CheckpointWriter& ckpt, const std::string& prefix);
+
   // Input counts of the tet, hex, wedge and pyramid elements
   index_t ntets, nhex, nwedge, npyrmd;
 
@@ -501,12 +556,19 @@ class ElementMesh : public ElementMeshBase {
   static const index_t ndof_per_element = Basis::ndof;
 
   // Constructors
-  ElementMesh(MeshConnectivityBase& conn);
+  ElementMesh(MeshConnectivityBase& conn,
+              DofOrdering ordering = DofOrdering::NATURAL,
+              index_t block_size = 1);
   template <class InteriorBasis>
   ElementMesh(const index_t label, MeshConnectivityBase& conn,
               ElementMesh<InteriorBasis>& mesh);
   template <class HOrderBasis>
   ElementMesh(ElementMesh<HOrderBasis>& mesh);
+  ElementMesh(const CheckpointReader& ckpt, const std::string& prefix = "mesh");
+  ~ElementMesh();
+
+  ElementMesh(const ElementMesh&) = delete;
+  ElementMesh& operator=(const ElementMesh&) = delete;
 
   index_t get_num_elements() const { return nelems; }
   index_t get_num_dof() const { return num_dof; }
@@ -534,7 +596,16 @@ class ElementMesh : public ElementMeshBase {
   void add_matrix_pairs(const index_t block_size,
                         std::set<std::pair<index_t, index_t>>& pairs) const;
 
+  // Get the new index of each dof in the natural ordering, empty if the
+  // natural ordering is used
+  const std::vector<index_t>& get_dof_permutation() const { return dof_perm; }
+
+  // Save the dof maps to a checkpoint
+  void save(CheckpointWriter& ckpt, const std::string& prefix = "mesh") const;
+
  private:
+  void reorder_dof_rcm(index_t block_size);
+
   index_t nelems;                         // Total number of elements
   index_t num_dof;                        // Total number of degrees of freedom
   index_t num_dof_offset[Basis::nbasis];  // Cumulative number of degrees of
@@ -543,6 +614,9 @@ class ElementMesh : public ElementMeshBase {
   // Store the degrees of freedom for each element and the element sign
   index_t* element_dof;
   int* element_sign;
+
+  // Permutation from the natural to the reordered dof
+  std::vector<index_t> dof_perm;
 };
 
 /*
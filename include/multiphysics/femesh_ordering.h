@@ -0,0 +1,263 @@
+#ifndef A2D_FE_MESH_ORDERING_H
+#define A2D_FE_MESH_ORDERING_H
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+#include "a2ddefs.h"
+
+namespace A2D {
+
+/**
+ * @brief Ordering of the degrees of freedom within an ElementMesh
+ *
+ * NATURAL: The order in which the entities are first encountered during the
+ * sweep of the elements
+ *
+ * RCM: Reverse Cuthill-McKee ordering of the degree of freedom graph, applied
+ * separately within each basis so that the cumulative dof offsets are
+ * preserved
+ */
+enum class DofOrdering { NATURAL, RCM };
+
+/**
+ * @brief Compute the reverse Cuthill-McKee ordering of a graph
+ *
+ * Each connected component is started from a pseudo-peripheral node of
+ * minimum degree.
+ *
+ * @param n Number of nodes in the graph
+ * @param rowp Pointer into the adjacency list for each node
+ * @param cols Adjacency list
+ * @param order On exit, order[k] is the node placed at position k
+ */
+inline void reverse_cuthill_mckee(const index_t n,
+                                  const std::vector<index_t>& rowp,
+                                  const std::vector<index_t>& cols,
+                                  std::vector<index_t>& order) {
+  order.clear();
+  order.reserve(n);
+
+  auto degree = [&](index_t i) { return rowp[i + 1] - rowp[i]; };
+
+  // Candidate start nodes sorted by degree
+  std::vector<index_t> candidates(n);
+  std::iota(candidates.begin(), candidates.end(), 0);
+  std::stable_sort(
+      candidates.begin(), candidates.end(),
+      [&](index_t a, index_t b) { return degree(a) < degree(b); });
+
+  std::vector<char> visited(n, 0);
+  std::vector<index_t> level(n, NO_INDEX);
+  std::vector<index_t> queue, neighbors;
+  queue.reserve(n);
+
+  // Breadth-first search from root on the unvisited nodes. Returns the
+  // number of levels and leaves the nodes in the queue.
+  auto level_structure = [&](index_t root) {
+    queue.clear();
+    queue.push_back(root);
+    level[root] = 0;
+    index_t nlevels = 1;
+    for (index_t k = 0; k < queue.size(); k++) {
+      index_t i = queue[k];
+      for (index_t jp = rowp[i]; jp < rowp[i + 1]; jp++) {
+        index_t j = cols[jp];
+        if (!visited[j] && level[j] == NO_INDEX) {
+          level[j] = level[i] + 1;
+          nlevels = level[j] + 1;
+          queue.push_back(j);
+        }
+      }
+    }
+    return nlevels;
+  };
+
+  for (index_t c = 0; c < n; c++) {
+    index_t root = candidates[c];
+    if (visited[root]) {
+      continue;
+    }
+
+    // Find a pseudo-peripheral node by repeatedly moving to a node of minimum
+    // degree on the last level
+    index_t nlevels = level_structure(root);
+    for (index_t iter = 0; iter < 8; iter++) {
+      index_t next = root;
+      for (index_t i : queue) {
+        if (level[i] == nlevels - 1 &&
+            (next == root || degree(i) < degree(next))) {
+          next = i;
+        }
+      }
+      for (index_t i : queue) {
+        level[i] = NO_INDEX;
+      }
+
+      index_t next_nlevels = level_structure(next);
+      if (next_nlevels <= nlevels) {
+        break;
+      }
+      root = next;
+      nlevels = next_nlevels;
+    }
+    for (index_t i : queue) {
+      level[i] = NO_INDEX;
+    }
+
+    // Cuthill-McKee ordering of the component
+    index_t start = order.size();
+    order.push_back(root);
+    visited[root] = 1;
+    for (index_t k = start; k < order.size(); k++) {
+      index_t i = order[k];
+      neighbors.clear();
+      for (index_t jp = rowp[i]; jp < rowp[i + 1]; jp++) {
+        index_t j = cols[jp];
+        if (!visited[j]) {
+          visited[j] = 1;
+          neighbors.push_back(j);
+        }
+      }
+      std::stable_sort(
+          neighbors.begin(), neighbors.end(),
+          [&](index_t a, index_t b) { return degree(a) < degree(b); });
+      order.insert(order.end(), neighbors.begin(), neighbors.end());
+    }
+  }
+
+  std::reverse(order.begin(), order.end());
+}
+
+/**
+ * @brief Compute the index of a point along a Hilbert curve
+ *
+ * Uses Skilling's transpose algorithm with the given number of bits per
+ * coordinate. dim * bits must not exceed 64.
+ *
+ * @param dim Number of coordinates (2 or 3)
+ * @param bits Number of bits in each coordinate
+ * @param X Integer coordinates, overwritten
+ */
+inline uint64_t hilbert_index(const index_t dim, const index_t bits,
+                              uint32_t X[]) {
+  const uint32_t M = 1u << (bits - 1);
+
+  // Inverse undo excess work
+  for (uint32_t Q = M; Q > 1; Q >>= 1) {
+    uint32_t P = Q - 1;
+    for (index_t i = 0; i < dim; i++) {
+      if (X[i] & Q) {
+        X[0] ^= P;
+      } else {
+        uint32_t t = (X[0] ^ X[i]) & P;
+        X[0] ^= t;
+        X[i] ^= t;
+      }
+    }
+  }
+
+  // Gray encode
+  for (index_t i = 1; i < dim; i++) {
+    X[i] ^= X[i - 1];
+  }
+  uint32_t t = 0;
+  for (uint32_t Q = M; Q > 1; Q >>= 1) {
+    if (X[dim - 1] & Q) {
+      t ^= Q - 1;
+    }
+  }
+  for (index_t i = 0; i < dim; i++) {
+    X[i] ^= t;
+  }
+
+  // Interleave the transposed bits into the index
+  uint64_t index = 0;
+  for (index_t b = bits; b > 0; b--) {
+    for (index_t i = 0; i < dim; i++) {
+      index = (index << 1) | ((X[i] >> (b - 1)) & 1u);
+    }
+  }
+
+  return index;
+}
+
+/**
+ * @brief Sort elements along a Hilbert curve through their centroids
+ *
+ * The connectivity array is permuted in place so that elements that are close
+ * in space are close in memory. The permutation is returned so that element
+ * data in the original order (cell labels, output fields) can be mapped.
+ *
+ * @param dim Spatial dimension (2 or 3)
+ * @param nelems Number of elements
+ * @param nverts_per_elem Number of vertices for each element
+ * @param elems Element connectivity, permuted in place
+ * @param Xloc Vertex locations, dim values for each vertex
+ * @param perm On exit, perm[i] is the original index of the element at i
+ */
+template <typename I, typename T>
+void hilbert_sort_elements(const index_t dim, const index_t nelems,
+                           const index_t nverts_per_elem, I elems[],
+                           const T Xloc[], std::vector<index_t>& perm) {
+  perm.resize(nelems);
+  std::iota(perm.begin(), perm.end(), 0);
+  if (nelems == 0) {
+    return;
+  }
+
+  // Compute the centroids and their bounding box
+  std::vector<double> xc(dim * nelems, 0.0);
+  double lower[3] = {1e300, 1e300, 1e300}, upper[3] = {-1e300, -1e300, -1e300};
+  for (index_t e = 0; e < nelems; e++) {
+    for (index_t j = 0; j < nverts_per_elem; j++) {
+      const I v = elems[nverts_per_elem * e + j];
+      for (index_t k = 0; k < dim; k++) {
+        xc[dim * e + k] += RealPart(Xloc[dim * v + k]);
+      }
+    }
+    for (index_t k = 0; k < dim; k++) {
+      xc[dim * e + k] /= nverts_per_elem;
+      lower[k] = std::min(lower[k], xc[dim * e + k]);
+      upper[k] = std::max(upper[k], xc[dim * e + k]);
+    }
+  }
+
+  // Compute the Hilbert index of each centroid on a uniform grid over the
+  // bounding box
+  const index_t bits = 63 / dim;
+  const double scale = double((uint64_t(1) << bits) - 1);
+  double extent = 0.0;
+  for (index_t k = 0; k < dim; k++) {
+    extent = std::max(extent, upper[k] - lower[k]);
+  }
+  if (extent == 0.0) {
+    extent = 1.0;
+  }
+
+  std::vector<uint64_t> keys(nelems);
+  for (index_t e = 0; e < nelems; e++) {
+    uint32_t X[3];
+    for (index_t k = 0; k < dim; k++) {
+      X[k] = uint32_t(scale * (xc[dim * e + k] - lower[k]) / extent);
+    }
+    keys[e] = hilbert_index(dim, bits, X);
+  }
+
+  std::stable_sort(perm.begin(), perm.end(),
+                   [&](index_t a, index_t b) { return keys[a] < keys[b]; });
+
+  // Permute the connectivity
+  std::vector<I> copy(elems, elems + nelems * nverts_per_elem);
+  for (index_t e = 0; e < nelems; e++) {
+    for (index_t j = 0; j < nverts_per_elem; j++) {
+      elems[nverts_per_elem * e + j] = copy[nverts_per_elem * perm[e] + j];
+    }
+  }
+}
+
+}  // namespace A2D
+
+#endif  // A2D_FE_MESH_ORDERING_H
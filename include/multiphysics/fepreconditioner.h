@@ -0,0 +1,1131 @@
+#ifndef FE_PRECONDITIONER_H
+#define FE_PRECONDITIONER_H
+
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <set>
+#include <stdexcept>
+#include <vector>
+
+#include "multiphysics/febasis.h"
+#include "multiphysics/feelement.h"
+#include "multiphysics/feelementmat.h"
+#include "multiphysics/feelementvector.h"
+#include "multiphysics/fematrixfree.h"
+#include "multiphysics/femesh.h"
+#include "multiphysics/fesolution.h"
+#include "multiphysics/fespace.h"
+#include "multiphysics/lagrange_hypercube_basis.h"
+#include "sparse/sparse_amg.h"
+#include "sparse/sparse_matrix.h"
+#include "utils/a2dprofiler.h"
+
+namespace A2D {
+
+/**
+ * @brief Options for the low-order refined preconditioner
+ */
+struct LORPreconditionerOptions {
+  int amg_levels = 3;         // Number of levels in the AMG hierarchy
+  double omega = 4.0 / 3.0;   // Prolongation smoothing parameter
+  double epsilon = 0.0;       // Strength of connection threshold
+  bool print_info = false;    // Print the AMG hierarchy when it is built
+
+  // Storage of the high-order matrix-free operator
+  MatFreeStorage storage = MatFreeStorage::FULL;
+};
+
+/**
+ * @brief Counters and per-phase timing collected by LORPreconditioner
+ */
+struct LORPreconditionerStats {
+  index_t assemblies = 0;    // Low-order matrix assemblies
+  index_t amg_builds = 0;    // Full constructions of the AMG hierarchy
+  index_t amg_updates = 0;   // Numerical updates of the AMG hierarchy
+  index_t solves = 0;        // Krylov solves
+  index_t converged = 0;     // Krylov solves that reached the tolerance
+  index_t mat_vecs = 0;      // High-order matrix-free products
+  index_t applications = 0;  // Applications of the AMG V-cycle
+
+  // Time spent in each phase in seconds
+  double t_plan = 0.0;      // Low-order meshes, sparsity and assembly plan
+  double t_assembly = 0.0;  // Low-order matrix assembly
+  double t_amg = 0.0;       // AMG construction and updates
+  double t_matfree = 0.0;   // Initialization of the high-order operator
+  double t_mat_vec = 0.0;   // High-order matrix-free products
+  double t_factor = 0.0;    // AMG V-cycles
+  double t_solve = 0.0;     // Krylov solves, including products and V-cycles
+
+  void report() const {
+    std::printf("LORPreconditioner\n");
+    std::printf("  assemblies:          %8d\n", assemblies);
+    std::printf("  amg builds/updates:  %8d / %d\n", amg_builds, amg_updates);
+    std::printf("  solves:              %8d (%d converged)\n", solves,
+                converged);
+    std::printf("  matrix-free products:%8d\n", mat_vecs);
+    std::printf("  amg applications:    %8d\n", applications);
+    std::printf("  time plan:           %12.4e s\n", t_plan);
+    std::printf("  time assembly:       %12.4e s\n", t_assembly);
+    std::printf("  time amg setup:      %12.4e s\n", t_amg);
+    std::printf("  time matfree init:   %12.4e s\n", t_matfree);
+    std::printf("  time solve:          %12.4e s\n", t_solve);
+    std::printf("    matrix-free:       %12.4e s\n", t_mat_vec);
+    std::printf("    amg:               %12.4e s\n", t_factor);
+  }
+};
+
+/**
+ * @brief Low-order refined (LOR) preconditioner for a high-order problem
+ *
+ * The high-order element meshes are refined into low-order meshes that share
+ * the same global degrees of freedom. The state Jacobian of the integrand on
+ * the low-order mesh is assembled into a BSR matrix and approximately
+ * inverted with algebraic multigrid, while the Krylov method uses the
+ * matrix-free Jacobian of the high-order problem. Since the two operators are
+ * spectrally equivalent, the iteration count is nearly independent of the
+ * polynomial degree.
+ *
+ * The sparsity pattern and the location of every element block in the BSR
+ * matrix are computed once in the constructor, so that each assembly is a
+ * parallel loop over the low-order elements that adds the element blocks to
+ * the matrix with atomic operations.
+ *
+ * The solution basis must be nodal, i.e. the degrees of freedom of each
+ * low-order node are a full block of the matrix with a positive sign, as is
+ * the case for Lagrange H1 bases with block_size components.
+ *
+ * @tparam T Scalar type
+ * @tparam block_size Block size of the matrix
+ * @tparam null_size Dimension of the near null-space used by AMG
+ * @tparam Integrand The integrand of the problem
+ * @tparam Quadrature Quadrature for the high-order elements
+ * @tparam LOrderQuadrature Quadrature for the low-order elements
+ * @tparam DataBasis High-order data basis
+ * @tparam GeoBasis High-order geometry basis
+ * @tparam Basis High-order solution basis
+ */
+template <typename T, index_t block_size, index_t null_size, class Integrand,
+          class Quadrature, class LOrderQuadrature, class DataBasis,
+          class GeoBasis, class Basis>
+class LORPreconditioner {
+ public:
+  using Vec_t = SolutionVector<T>;
+  using Mat_t = BSRMat<T, block_size, block_size>;
+  using Amg_t = BSRMatAmg<T, block_size, null_size>;
+  using BlockVec_t = MultiArrayNew<T* [block_size]>;
+
+  // Low-order refined bases
+  using LOrderDataBasis = LOrderFEBasis<DataBasis>;
+  using LOrderGeoBasis = LOrderFEBasis<GeoBasis>;
+  using LOrderBasis = LOrderFEBasis<Basis>;
+
+  // Element vectors for the low-order assembly
+  using LOrderDataElemVec = ElementVector_Parallel<T, LOrderDataBasis, Vec_t>;
+  using LOrderGeoElemVec = ElementVector_Parallel<T, LOrderGeoBasis, Vec_t>;
+  using LOrderElemVec = ElementVector_Parallel<T, LOrderBasis, Vec_t>;
+
+  // Quadrature point objects for the low-order elements
+  using QDataSpace = QptSpace<LOrderQuadrature, typename Integrand::DataSpace>;
+  using QGeoSpace =
+      QptSpace<LOrderQuadrature, typename Integrand::FiniteElementGeometry>;
+  using QSpace =
+      QptSpace<LOrderQuadrature, typename Integrand::FiniteElementSpace>;
+  using QMat = typename Integrand::template FiniteElementJacobian<
+      FEVarType::STATE, FEVarType::STATE>;
+
+  // Matrix-free operator for the high-order problem
+  using MatFree = MatrixFree<T, FEVarType::STATE, FEVarType::STATE, Integrand,
+                             Quadrature, DataBasis, GeoBasis, Basis>;
+  using DataElemVec = ElementVector_Serial<T, DataBasis, Vec_t>;
+  using GeoElemVec = ElementVector_Serial<T, GeoBasis, Vec_t>;
+  using ElemVec = ElementVector_Serial<T, Basis, Vec_t>;
+  using MatFreeOp = MatrixFreeOperator<T, block_size, MatFree, ElemVec>;
+
+  // Number of matrix blocks for each low-order element node
+  static constexpr index_t num_nodes = LOrderBasis::ndof / block_size;
+  static_assert(LOrderBasis::ndof % block_size == 0,
+                "The low-order dof must be a multiple of the block size");
+
+  /**
+   * @brief Create the low-order meshes, the matrix and the assembly plan
+   *
+   * The data, geometry and solution vectors are referenced, the values at
+   * the time of each call to update() are used to form the operators.
+   *
+   * @param integrand The integrand of the problem
+   * @param datamesh High-order data mesh
+   * @param geomesh High-order geometry mesh
+   * @param mesh High-order solution mesh
+   * @param data Data vector
+   * @param geo Geometry vector
+   * @param sol Solution vector
+   * @param B Near null-space of the operator with zeros at the bcs
+   * @param nbcs Number of Dirichlet boundary conditions
+   * @param bc_dofs Degrees of freedom of the boundary conditions
+   * @param options Options for AMG and the matrix-free operator
+   */
+  LORPreconditioner(const Integrand& integrand,
+                    ElementMesh<DataBasis>& datamesh,
+                    ElementMesh<GeoBasis>& geomesh, ElementMesh<Basis>& mesh,
+                    Vec_t& data, Vec_t& geo, Vec_t& sol,
+                    MultiArrayNew<T* [block_size][null_size]> B,
+                    index_t nbcs = 0, const index_t* bc_dofs = nullptr,
+                    const LORPreconditionerOptions& options = {})
+      : integrand(integrand),
+        options(options),
+        lorder_datamesh(datamesh),
+        lorder_geomesh(geomesh),
+        lorder_mesh(mesh),
+        lorder_elem_data(lorder_datamesh, data),
+        lorder_elem_geo(lorder_geomesh, geo),
+        lorder_elem_sol(lorder_mesh, sol),
+        elem_data(datamesh, data),
+        elem_geo(geomesh, geo),
+        elem_sol(mesh, sol),
+        matfree(options.storage),
+        matfree_op(matfree, mesh, nbcs, bc_dofs),
+        B(B),
+        nbcs(nbcs),
+        bc_dofs(bc_dofs) {
+    Timer timer("LORPreconditioner::LORPreconditioner()");
+    StopWatch watch;
+
+    // Create the non-zero pattern from the low-order mesh
+    std::set<std::pair<index_t, index_t>> pairs;
+    lorder_mesh.add_matrix_pairs(block_size, pairs);
+
+    index_t nrows;
+    std::vector<index_t> rowp, cols;
+    ElementMeshBase::create_block_csr(pairs, nrows, rowp, cols);
+    mat = std::make_shared<Mat_t>(nrows, nrows, cols.size(), rowp, cols);
+
+    // Find the location of each element block in the matrix
+    const index_t num_elements = lorder_mesh.get_num_elements();
+    plan = MultiArrayNew<index_t*>("plan", num_elements * num_nodes * num_nodes);
+
+    for (index_t i = 0; i < num_elements; i++) {
+      const index_t* dof;
+      const int* signs;
+      lorder_mesh.get_element_dof(i, &dof);
+      lorder_mesh.get_element_signs(i, &signs);
+
+      index_t rows[num_nodes];
+      for (index_t a = 0; a < num_nodes; a++) {
+        rows[a] = dof[block_size * a] / block_size;
+        for (index_t r = 0; r < block_size; r++) {
+          if (dof[block_size * a + r] != block_size * rows[a] + r ||
+              signs[block_size * a + r] != 1) {
+            char msg[256];
+            std::snprintf(msg, sizeof(msg),
+                          "LORPreconditioner: dof %d of low-order element %d "
+                          "is not part of a nodal block",
+                          block_size * a + r, i);
+            throw std::runtime_error(msg);
+          }
+        }
+      }
+
+      for (index_t a = 0; a < num_nodes; a++) {
+        for (index_t b = 0; b < num_nodes; b++) {
+          plan((i * num_nodes + a) * num_nodes + b) =
+              mat->find_value_index(rows[a], rows[b]);
+        }
+      }
+    }
+
+    stats.t_plan = watch.lap();
+  }
+
+  LORPreconditioner(const LORPreconditioner&) = delete;
+  LORPreconditioner& operator=(const LORPreconditioner&) = delete;
+
+  /**
+   * @brief Form the operators with the current data, geometry and solution
+   *
+   * The low-order matrix is re-assembled and the high-order matrix-free
+   * operator is re-initialized. The AMG hierarchy is constructed on the first
+   * call. On later calls, the Galerkin products and the coarse factorization
+   * are updated with the aggregates and prolongation of the first matrix,
+   * unless rebuild is true.
+   *
+   * @param rebuild Re-construct the AMG hierarchy from scratch
+   */
+  void update(bool rebuild = false) {
+    Timer timer("LORPreconditioner::update()");
+    StopWatch watch;
+
+    assemble();
+    double t_assembly = watch.lap();
+
+    if (!amg || rebuild) {
+      amg.reset();
+      amg = std::make_unique<Amg_t>(options.amg_levels, options.omega,
+                                    options.epsilon, mat, B,
+                                    options.print_info);
+      stats.amg_builds++;
+    } else {
+      amg->update();
+      stats.amg_updates++;
+    }
+    double t_amg = watch.lap();
+
+    matfree.initialize(integrand, elem_data, elem_geo, elem_sol);
+    double t_matfree = watch.lap();
+
+    stats.t_assembly += t_assembly;
+    stats.t_amg += t_amg - t_assembly;
+    stats.t_matfree += t_matfree - t_amg;
+  }
+
+  /**
+   * @brief Compute out = J * in with the high-order matrix-free Jacobian
+   */
+  void mat_vec(BlockVec_t& in, BlockVec_t& out) {
+    StopWatch watch;
+    matfree_op(in, out);
+    stats.t_mat_vec += watch.lap();
+    stats.mat_vecs++;
+  }
+
+  /**
+   * @brief Apply one AMG V-cycle of the low-order matrix, out = P^{-1} * in
+   */
+  void apply_factor(BlockVec_t& in, BlockVec_t& out) {
+    check_update();
+    StopWatch watch;
+    amg->applyFactor(in, out);
+    stats.t_factor += watch.lap();
+    stats.applications++;
+  }
+
+  /**
+   * @brief Solve J * x = rhs with the LOR-preconditioned conjugate gradient
+   * method, the initial value of x is used as the starting point
+   *
+   * @return true if the tolerance is met
+   */
+  bool solve(Vec_t& rhs, Vec_t& x, index_t monitor = 0,
+             index_t max_iters = 500, double rtol = 1e-8,
+             double atol = 1e-30) {
+    check_update();
+    Timer timer("LORPreconditioner::solve()");
+    StopWatch watch;
+
+    auto rhs_vec = rhs.template get_block_view<block_size>();
+    auto x_vec = x.template get_block_view<block_size>();
+    bool flag = conjugate_gradient<T, block_size>(
+        get_mat_vec(), get_apply_factor(), rhs_vec, x_vec, monitor, max_iters,
+        rtol, atol);
+
+    stats.t_solve += watch.lap();
+    stats.solves++;
+    stats.converged += flag;
+    return flag;
+  }
+
+  /**
+   * @brief Solve J * x = rhs with the LOR-preconditioned flexible GMRES
+   * method for non-symmetric Jacobians
+   *
+   * @tparam gmres_size Size of the Krylov subspace before a restart
+   * @return true if the tolerance is met
+   */
+  template <index_t gmres_size = 30>
+  bool solve_gmres(Vec_t& rhs, Vec_t& x, index_t monitor = 0,
+                   index_t max_restart = 10, double rtol = 1e-8,
+                   double atol = 1e-30) {
+    check_update();
+    Timer timer("LORPreconditioner::solve_gmres()");
+    StopWatch watch;
+
+    auto rhs_vec = rhs.template get_block_view<block_size>();
+    auto x_vec = x.template get_block_view<block_size>();
+    bool flag = fgmres<T, block_size, gmres_size>(
+        get_mat_vec(), get_apply_factor(), rhs_vec, x_vec, monitor,
+        max_restart, rtol, atol);
+
+    stats.t_solve += watch.lap();
+    stats.solves++;
+    stats.converged += flag;
+    return flag;
+  }
+
+  /**
+   * @brief Print the timing of each phase
+   */
+  void report() const {
+    std::printf("LOR mesh: %d elements, %d block rows, %d blocks\n",
+                lorder_mesh.get_num_elements(), mat->nbrows, mat->nnz);
+    stats.report();
+    matfree.report();
+  }
+
+  std::shared_ptr<Mat_t> get_matrix() { return mat; }
+  Amg_t* get_amg() { return amg.get(); }
+  MatFree& get_matrix_free() { return matfree; }
+  const LORPreconditionerStats& get_stats() const { return stats; }
+
+ private:
+  // Assemble the low-order state Jacobian with the boundary conditions
+  void assemble() {
+    const index_t num_elements = lorder_mesh.get_num_elements();
+    const index_t num_quadrature_points = LOrderQuadrature::get_num_points();
+
+    lorder_elem_data.get_values();
+    lorder_elem_geo.get_values();
+    lorder_elem_sol.get_values();
+    mat->zero();
+
+    // Copies captured by the loop body
+    const Integrand integrand_ = integrand;
+    const LOrderDataElemVec& elem_data_ = lorder_elem_data;
+    const LOrderGeoElemVec& elem_geo_ = lorder_elem_geo;
+    const LOrderElemVec& elem_sol_ = lorder_elem_sol;
+    MultiArrayNew<index_t*> plan_ = plan;
+    auto vals = mat->vals;
+
+    auto loop_body = KOKKOS_LAMBDA(const index_t i) {
+      typename LOrderDataElemVec::FEDof data_dof(i, elem_data_);
+      typename LOrderGeoElemVec::FEDof geo_dof(i, elem_geo_);
+      typename LOrderElemVec::FEDof sol_dof(i, elem_sol_);
+
+      QDataSpace data;
+      QGeoSpace geo;
+      QSpace sol;
+
+      LOrderDataBasis::template interp(data_dof, data);
+      LOrderGeoBasis::template interp(geo_dof, geo);
+      LOrderBasis::template interp(sol_dof, sol);
+
+      Mat<T, LOrderBasis::ndof, LOrderBasis::ndof> element_mat;
+      for (index_t j = 0; j < num_quadrature_points; j++) {
+        T weight = LOrderQuadrature::get_weight(j);
+        QMat jac;
+        integrand_.template jacobian<FEVarType::STATE, FEVarType::STATE>(
+            weight, data.get(j), geo.get(j), sol.get(j), jac);
+        LOrderBasis::template add_outer<LOrderQuadrature>(j, jac,
+                                                          element_mat);
+      }
+
+      // Add the element blocks at the locations in the plan
+      for (index_t a = 0; a < num_nodes; a++) {
+        for (index_t b = 0; b < num_nodes; b++) {
+          index_t jp = plan_((i * num_nodes + a) * num_nodes + b);
+          for (index_t r = 0; r < block_size; r++) {
+            for (index_t c = 0; c < block_size; c++) {
+              Kokkos::atomic_add(
+                  &vals(jp, r, c),
+                  element_mat(block_size * a + r, block_size * b + c));
+            }
+          }
+        }
+      }
+    };
+
+    Kokkos::parallel_for("LORPreconditioner::assemble", num_elements,
+                         loop_body);
+    Kokkos::fence();
+
+    mat->zero_rows(nbcs, bc_dofs);
+    stats.assemblies++;
+  }
+
+  void check_update() const {
+    if (!amg) {
+      throw std::runtime_error(
+          "LORPreconditioner: update() must be called before the "
+          "preconditioner is applied");
+    }
+  }
+
+  std::function<void(BlockVec_t&, BlockVec_t&)> get_mat_vec() {
+    return [this](BlockVec_t& in, BlockVec_t& out) { mat_vec(in, out); };
+  }
+
+  std::function<void(BlockVec_t&, BlockVec_t&)> get_apply_factor() {
+    return [this](BlockVec_t& in, BlockVec_t& out) { apply_factor(in, out); };
+  }
+
+  Integrand integrand;
+  LORPreconditionerOptions options;
+
+  // Low-order meshes and element vectors
+  ElementMesh<LOrderDataBasis> lorder_datamesh;
+  ElementMesh<LOrderGeoBasis> lorder_geomesh;
+  ElementMesh<LOrderBasis> lorder_mesh;
+  LOrderDataElemVec lorder_elem_data;
+  LOrderGeoElemVec lorder_elem_geo;
+  LOrderElemVec lorder_elem_sol;
+
+  // High-order element vectors and the matrix-free operator
+  DataElemVec elem_data;
+  GeoElemVec elem_geo;
+  ElemVec elem_sol;
+  MatFree matfree;
+  MatFreeOp matfree_op;
+
+  // Near null-space and boundary conditions
+  MultiArrayNew<T* [block_size][null_size]> B;
+  index_t nbcs;
+  const index_t* bc_dofs;
+
+  // Low-order matrix, the block index of each element block and AMG
+  std::shared_ptr<Mat_t> mat;
+  MultiArrayNew<index_t*> plan;
+  std::unique_ptr<Amg_t> amg;
+
+  LORPreconditionerStats stats;
+};
+
+/**
+ * @brief Options for the polynomial multigrid preconditioner
+ */
+struct PMGPreconditionerOptions {
+  index_t smoothing_degree = 3;   // Degree of the Chebyshev polynomial
+  double smoothing_range = 15.0;  // Smooth the range [lmax / range, lmax]
+  index_t eig_iters = 20;         // Max. power iterations to estimate lmax
+  double eig_rtol = 1e-3;         // Relative change of lmax to stop early
+  double eig_safety = 1.2;        // Safety factor applied to the estimate
+
+  // Options for AMG on the degree 1 level
+  int amg_levels = 3;
+  double omega = 4.0 / 3.0;
+  double epsilon = 0.0;
+  bool print_info = false;
+
+  // Storage of the matrix-free operators on the polynomial levels
+  MatFreeStorage storage = MatFreeStorage::FULL;
+};
+
+/**
+ * @brief Counters and per-phase timing collected by PMGPreconditioner
+ */
+struct PMGPreconditionerStats {
+  index_t updates = 0;       // Calls to update()
+  index_t amg_builds = 0;    // Full constructions of the AMG hierarchy
+  index_t amg_updates = 0;   // Numerical updates of the AMG hierarchy
+  index_t solves = 0;        // Krylov solves
+  index_t converged = 0;     // Krylov solves that reached the tolerance
+  index_t applications = 0;  // Applications of the V-cycle
+  index_t power_iters = 0;   // Power iterations for the eigenvalue estimates
+
+  // Time spent in each phase in seconds
+  double t_operator = 0.0;  // Matrix-free operators and diagonals
+  double t_eig = 0.0;       // Eigenvalue estimates
+  double t_amg = 0.0;       // Degree 1 assembly and AMG setup
+  double t_smooth = 0.0;    // Chebyshev smoothing
+  double t_transfer = 0.0;  // Residuals and transfers between levels
+  double t_coarse = 0.0;    // AMG V-cycles on the degree 1 level
+  double t_solve = 0.0;     // Krylov solves, including the V-cycles
+
+  void report() const {
+    std::printf("PMGPreconditioner\n");
+    std::printf("  updates:             %8d\n", updates);
+    std::printf("  amg builds/updates:  %8d / %d\n", amg_builds, amg_updates);
+    std::printf("  solves:              %8d (%d converged)\n", solves,
+                converged);
+    std::printf("  v-cycles:            %8d\n", applications);
+    std::printf("  power iterations:    %8d\n", power_iters);
+    std::printf("  time operators:      %12.4e s\n", t_operator);
+    std::printf("  time eigenvalues:    %12.4e s\n", t_eig);
+    std::printf("  time amg setup:      %12.4e s\n", t_amg);
+    std::printf("  time smoothing:      %12.4e s\n", t_smooth);
+    std::printf("  time transfer:       %12.4e s\n", t_transfer);
+    std::printf("  time coarse:         %12.4e s\n", t_coarse);
+    std::printf("  time solve:          %12.4e s\n", t_solve);
+  }
+};
+
+/*
+  Parameters of a Lagrange H1 hypercube solution basis
+*/
+template <class Basis>
+struct __lagrange_h1_basis;
+
+template <typename T, index_t Dim, index_t C, index_t Degree,
+          InterpolationType Interp>
+struct __lagrange_h1_basis<
+    FEBasis<T, LagrangeH1HypercubeBasis<T, Dim, C, Degree, Interp>>> {
+  static constexpr index_t dim = Dim;
+  static constexpr index_t ncomp = C;
+  static constexpr index_t degree = Degree;
+  static constexpr InterpolationType interp_type = Interp;
+
+  template <index_t q>
+  using LevelBasis =
+      FEBasis<T, LagrangeH1HypercubeBasis<T, Dim, C, q, Interp>>;
+};
+
+/**
+ * @brief Polynomial multigrid (p-multigrid) preconditioner
+ *
+ * The levels use the Lagrange H1 basis of degree p, p / 2, ..., 1 on the same
+ * elements. Every level keeps the high-order data, geometry and quadrature,
+ * only the solution basis changes. The degree 1 level is assembled and
+ * approximately inverted with one AMG V-cycle. On the other levels, the
+ * Jacobian is applied matrix-free and smoothed with a Chebyshev polynomial of
+ * the Jacobi-preconditioned operator, with the diagonal formed element by
+ * element and the largest eigenvalue estimated with power iterations. The
+ * prolongation interpolates the coarse solution at the fine nodes and the
+ * restriction is its transpose, both applied element by element.
+ *
+ * The V-cycle is symmetric, so apply_factor() can be used as the
+ * preconditioner in conjugate_gradient() as well as in fgmres().
+ *
+ * @tparam T Scalar type
+ * @tparam null_size Dimension of the near null-space used by AMG
+ * @tparam Integrand The integrand of the problem
+ * @tparam Quadrature Quadrature for the high-order elements
+ * @tparam DataBasis High-order data basis
+ * @tparam GeoBasis High-order geometry basis
+ * @tparam Basis Solution basis, FEBasis with a single LagrangeH1HypercubeBasis
+ */
+template <typename T, index_t null_size, class Integrand, class Quadrature,
+          class DataBasis, class GeoBasis, class Basis>
+class PMGPreconditioner {
+ public:
+  using BasisInfo = __lagrange_h1_basis<Basis>;
+  static constexpr index_t dim = BasisInfo::dim;
+  static constexpr index_t block_size = BasisInfo::ncomp;
+  static constexpr index_t degree = BasisInfo::degree;
+
+  using Vec_t = SolutionVector<T>;
+  using Mat_t = BSRMat<T, block_size, block_size>;
+  using Amg_t = BSRMatAmg<T, block_size, null_size>;
+  using BlockVec_t = MultiArrayNew<T* [block_size]>;
+  using DataElemVec = ElementVector_Serial<T, DataBasis, Vec_t>;
+  using GeoElemVec = ElementVector_Serial<T, GeoBasis, Vec_t>;
+
+  /**
+   * @brief Create the polynomial levels
+   *
+   * The coarse meshes and their boundary conditions are created from the
+   * connectivity. The data, geometry and solution vectors are referenced,
+   * the values at the time of each call to update() are used to form the
+   * operators.
+   *
+   * @param integrand The integrand of the problem
+   * @param conn The mesh connectivity
+   * @param bcinfo The Dirichlet boundary conditions
+   * @param datamesh Data mesh
+   * @param geomesh Geometry mesh
+   * @param mesh Solution mesh of degree p
+   * @param data Data vector
+   * @param geo Geometry vector
+   * @param sol Solution vector
+   * @param B Near null-space on the degree p mesh
+   * @param options Options for the smoothers and AMG
+   */
+  PMGPreconditioner(const Integrand& integrand, MeshConnectivityBase& conn,
+                    DirichletBCInfo& bcinfo, ElementMesh<DataBasis>& datamesh,
+                    ElementMesh<GeoBasis>& geomesh, ElementMesh<Basis>& mesh,
+                    Vec_t& data, Vec_t& geo, Vec_t& sol,
+                    MultiArrayNew<T* [block_size][null_size]> B,
+                    const PMGPreconditionerOptions& options = {})
+      : integrand(integrand),
+        conn(conn),
+        bcinfo(bcinfo),
+        options(options),
+        sol(sol),
+        elem_data(datamesh, data),
+        elem_geo(geomesh, geo) {
+    Timer timer("PMGPreconditioner::PMGPreconditioner()");
+    fine = std::make_unique<Level<degree>>(*this, &mesh);
+
+    // Inject the near null-space to the degree 1 level
+    const index_t ndof = mesh.get_num_dof();
+    for (index_t j = 0; j < null_size; j++) {
+      Vec_t vec(ndof);
+      for (index_t i = 0; i < ndof; i++) {
+        vec[i] = B(i / block_size, i % block_size, j);
+      }
+      fine->set_null_space(j, vec);
+    }
+  }
+
+  PMGPreconditioner(const PMGPreconditioner&) = delete;
+  PMGPreconditioner& operator=(const PMGPreconditioner&) = delete;
+
+  /**
+   * @brief Form the operators on all levels with the current data, geometry
+   * and solution
+   *
+   * The solution is injected to each coarse level to linearize the
+   * integrand. The AMG hierarchy is constructed on the first call and its
+   * Galerkin products are updated on later calls, unless rebuild is true.
+   *
+   * @param rebuild Re-construct the AMG hierarchy from scratch
+   */
+  void update(bool rebuild = false) {
+    Timer timer("PMGPreconditioner::update()");
+    for (index_t i = 0; i < sol.get_num_dof(); i++) {
+      fine->sol[i] = sol[i];
+    }
+    fine->update(rebuild);
+    stats.updates++;
+  }
+
+  /**
+   * @brief Compute out = J * in with the matrix-free Jacobian of degree p
+   */
+  void mat_vec(BlockVec_t& in, BlockVec_t& out) { (*fine->op)(in, out); }
+
+  /**
+   * @brief Apply one V-cycle, out = P^{-1} * in
+   */
+  void apply_factor(BlockVec_t& in, BlockVec_t& out) {
+    if (!fine->is_ready()) {
+      throw std::runtime_error(
+          "PMGPreconditioner: update() must be called before the "
+          "preconditioner is applied");
+    }
+    fine->vcycle(in, out);
+    stats.applications++;
+  }
+
+  /**
+   * @brief Solve J * x = rhs with the p-multigrid preconditioned conjugate
+   * gradient method, the initial value of x is used as the starting point
+   *
+   * @return true if the tolerance is met
+   */
+  bool solve(Vec_t& rhs, Vec_t& x, index_t monitor = 0,
+             index_t max_iters = 500, double rtol = 1e-8,
+             double atol = 1e-30) {
+    Timer timer("PMGPreconditioner::solve()");
+    StopWatch watch;
+
+    auto rhs_vec = rhs.template get_block_view<block_size>();
+    auto x_vec = x.template get_block_view<block_size>();
+    bool flag = conjugate_gradient<T, block_size>(
+        get_mat_vec(), get_apply_factor(), rhs_vec, x_vec, monitor, max_iters,
+        rtol, atol);
+
+    stats.t_solve += watch.lap();
+    stats.solves++;
+    stats.converged += flag;
+    return flag;
+  }
+
+  /**
+   * @brief Solve J * x = rhs with the p-multigrid preconditioned flexible
+   * GMRES method for non-symmetric Jacobians
+   *
+   * @tparam gmres_size Size of the Krylov subspace before a restart
+   * @return true if the tolerance is met
+   */
+  template <index_t gmres_size = 30>
+  bool solve_gmres(Vec_t& rhs, Vec_t& x, index_t monitor = 0,
+                   index_t max_restart = 10, double rtol = 1e-8,
+                   double atol = 1e-30) {
+    Timer timer("PMGPreconditioner::solve_gmres()");
+    StopWatch watch;
+
+    auto rhs_vec = rhs.template get_block_view<block_size>();
+    auto x_vec = x.template get_block_view<block_size>();
+    bool flag = fgmres<T, block_size, gmres_size>(
+        get_mat_vec(), get_apply_factor(), rhs_vec, x_vec, monitor,
+        max_restart, rtol, atol);
+
+    stats.t_solve += watch.lap();
+    stats.solves++;
+    stats.converged += flag;
+    return flag;
+  }
+
+  /**
+   * @brief Print the levels and the timing of each phase
+   */
+  void report() const {
+    fine->report();
+    stats.report();
+  }
+
+  const PMGPreconditionerStats& get_stats() const { return stats; }
+
+ private:
+  /*
+    A level of the hierarchy with the Lagrange basis of degree q. The work
+    vectors b and x hold the right-hand-side and the correction when this
+    level is visited from the finer level.
+  */
+  template <index_t q>
+  class Level {
+   public:
+    static constexpr bool is_coarse = (q == 1);
+    static constexpr index_t coarse_degree = (q > 1 ? q / 2 : 1);
+
+    using LBasis = typename BasisInfo::template LevelBasis<q>;
+    using ElemVec = ElementVector_Serial<T, LBasis, Vec_t>;
+    using MatFree = MatrixFree<T, FEVarType::STATE, FEVarType::STATE,
+                               Integrand, Quadrature, DataBasis, GeoBasis,
+                               LBasis>;
+    using MatFreeOp = MatrixFreeOperator<T, block_size, MatFree, ElemVec>;
+    using FE = FiniteElement<T, Integrand, Quadrature, DataBasis, GeoBasis,
+                             LBasis>;
+    using Next = Level<coarse_degree>;
+    using Transfer =
+        LagrangeH1HypercubeTransfer<T, dim, block_size, coarse_degree, q,
+                                    BasisInfo::interp_type>;
+
+    Level(PMGPreconditioner& pmg, ElementMesh<LBasis>* fine_mesh = nullptr)
+        : pmg(pmg),
+          owned_mesh(fine_mesh ? nullptr
+                               : std::make_unique<ElementMesh<LBasis>>(
+                                     pmg.conn)),
+          mesh(fine_mesh ? *fine_mesh : *owned_mesh),
+          bcs(pmg.conn, mesh, pmg.bcinfo),
+          ndof(mesh.get_num_dof()),
+          sol(ndof),
+          elem_sol(mesh, sol),
+          matfree(pmg.options.storage),
+          dinv(ndof),
+          weights(ndof),
+          b(ndof),
+          x(ndof),
+          r(ndof),
+          d(ndof),
+          t(ndof) {
+      nbcs = bcs.get_bcs(&bc_dofs, nullptr);
+      op = std::make_unique<MatFreeOp>(matfree, mesh, nbcs, bc_dofs);
+
+      // Each dof is shared by count elements, the weights 1 / count average
+      // the contributions from the elements in the transfer
+      ElemVec elem_weights(mesh, weights);
+      for (index_t i = 0; i < mesh.get_num_elements(); i++) {
+        typename ElemVec::FEDof dof(i, elem_weights);
+        for (index_t k = 0; k < LBasis::ndof; k++) {
+          dof[k] = 1.0;
+        }
+        elem_weights.add_element_values(i, dof);
+      }
+      for (index_t i = 0; i < ndof; i++) {
+        weights[i] = 1.0 / weights[i];
+      }
+
+      if constexpr (is_coarse) {
+        std::set<std::pair<index_t, index_t>> pairs;
+        mesh.add_matrix_pairs(block_size, pairs);
+
+        index_t nrows;
+        std::vector<index_t> rowp, cols;
+        ElementMeshBase::create_block_csr(pairs, nrows, rowp, cols);
+        mat = std::make_shared<Mat_t>(nrows, nrows, cols.size(), rowp, cols);
+        B = MultiArrayNew<T* [block_size][null_size]>("B", nrows);
+      } else {
+        next = std::make_unique<Next>(pmg);
+      }
+    }
+
+    // Set the column j of the near null-space from the values on this level
+    void set_null_space(index_t j, Vec_t& vec) {
+      if constexpr (is_coarse) {
+        for (index_t i = 0; i < ndof; i++) {
+          B(i / block_size, i % block_size, j) = vec[i];
+        }
+        for (index_t i = 0; i < nbcs; i++) {
+          B(bc_dofs[i] / block_size, bc_dofs[i] % block_size, j) = 0.0;
+        }
+      } else {
+        Vec_t coarse(next->ndof);
+        injection(vec, coarse);
+        next->set_null_space(j, coarse);
+      }
+    }
+
+    bool is_ready() const {
+      if constexpr (is_coarse) {
+        return amg != nullptr;
+      } else {
+        return next->is_ready();
+      }
+    }
+
+    // Form the operators on this level and the coarser levels
+    void update(bool rebuild) {
+      StopWatch watch;
+      matfree.initialize(pmg.integrand, pmg.elem_data, pmg.elem_geo,
+                         elem_sol);
+
+      if constexpr (is_coarse) {
+        ElementMat_Serial<T, LBasis, Mat_t> elem_mat(mesh, *mat);
+        mat->zero();
+        fe.template add_jacobian<FEVarType::STATE, FEVarType::STATE>(
+            pmg.integrand, T(1.0), pmg.elem_data, pmg.elem_geo, elem_sol,
+            elem_mat);
+        mat->zero_rows(nbcs, bc_dofs);
+
+        if (!amg || rebuild) {
+          amg.reset();
+          amg = std::make_unique<Amg_t>(pmg.options.amg_levels,
+                                        pmg.options.omega,
+                                        pmg.options.epsilon, mat, B,
+                                        pmg.options.print_info);
+          pmg.stats.amg_builds++;
+        } else {
+          amg->update();
+          pmg.stats.amg_updates++;
+        }
+        pmg.stats.t_amg += watch.lap();
+      } else {
+        // Inverse of the diagonal, set to one for the boundary conditions
+        Vec_t diag(ndof);
+        ElementMat_Diagonal<T, LBasis, Vec_t> elem_diag(mesh, diag);
+        fe.template add_jacobian<FEVarType::STATE, FEVarType::STATE>(
+            pmg.integrand, T(1.0), pmg.elem_data, pmg.elem_geo, elem_sol,
+            elem_diag);
+        for (index_t i = 0; i < ndof; i++) {
+          dinv[i] = 1.0 / diag[i];
+        }
+        for (index_t i = 0; i < nbcs; i++) {
+          dinv[bc_dofs[i]] = 1.0;
+        }
+        double t_operator = watch.lap();
+        pmg.stats.t_operator += t_operator;
+
+        estimate_max_eigenvalue();
+        pmg.stats.t_eig += watch.lap() - t_operator;
+
+        injection(sol, next->sol);
+        next->update(rebuild);
+      }
+    }
+
+    // Compute x = P^{-1} b with a V-cycle that starts from this level
+    void vcycle(BlockVec_t& bv, BlockVec_t& xv) {
+      if constexpr (is_coarse) {
+        StopWatch watch;
+        amg->applyFactor(bv, xv);
+        pmg.stats.t_coarse += watch.lap();
+      } else {
+        auto rv = r.template get_block_view<block_size>();
+        auto nbv = next->b.template get_block_view<block_size>();
+        auto nxv = next->x.template get_block_view<block_size>();
+
+        // Pre-smoothing from a zero initial guess
+        StopWatch watch;
+        BLAS::zero(xv);
+        chebyshev(bv, xv, true);
+        double t_smooth = watch.lap();
+
+        // Restrict the residual r = b - A * x to the coarse level
+        (*op)(xv, rv);
+        BLAS::axpby(rv, T(1.0), T(-1.0), bv);
+        restriction(r, next->b);
+        for (index_t i = 0; i < next->nbcs; i++) {
+          next->b[next->bc_dofs[i]] = 0.0;
+        }
+        double t_restrict = watch.lap();
+
+        next->vcycle(nbv, nxv);
+        double t_next = watch.lap();
+
+        // Add the prolongated correction
+        prolongation(next->x, r);
+        BLAS::axpy(xv, T(1.0), rv);
+        double t_prolong = watch.lap();
+
+        // Post-smoothing
+        chebyshev(bv, xv, false);
+        double t_total = watch.lap();
+
+        pmg.stats.t_smooth += t_smooth + (t_total - t_prolong);
+        pmg.stats.t_transfer += (t_restrict - t_smooth) + (t_prolong - t_next);
+      }
+    }
+
+    void report() const {
+      std::printf("PMG level degree %2d: %9d dof", q, ndof);
+      if constexpr (is_coarse) {
+        std::printf(", AMG with %d levels\n", amg ? amg->get_num_levels() : 0);
+      } else {
+        std::printf(", lmax(D^-1 A) = %12.5e\n", lmax);
+        next->report();
+      }
+    }
+
+    PMGPreconditioner& pmg;
+    std::unique_ptr<ElementMesh<LBasis>> owned_mesh;
+    ElementMesh<LBasis>& mesh;
+    DirichletBasis<T, LBasis> bcs;
+    index_t nbcs;
+    const index_t* bc_dofs;
+    const index_t ndof;
+
+    // Linearization point, operator and smoother
+    Vec_t sol;
+    ElemVec elem_sol;
+    FE fe;
+    MatFree matfree;
+    std::unique_ptr<MatFreeOp> op;
+    Vec_t dinv;
+    T lmax = 1.0;
+
+    // Inverse of the number of elements that share each dof
+    Vec_t weights;
+
+    // Right-hand-side, correction and work vectors
+    Vec_t b, x, r, d, t;
+
+    // The next coarser level
+    std::unique_ptr<Next> next;
+
+    // Matrix, near null-space and AMG for the degree 1 level
+    std::shared_ptr<Mat_t> mat;
+    MultiArrayNew<T* [block_size][null_size]> B;
+    std::unique_ptr<Amg_t> amg;
+
+   private:
+    // Compute vf = P * vc from the next level, the element contributions are
+    // averaged with the weights
+    void prolongation(Vec_t& vc, Vec_t& vf) {
+      typename Next::ElemVec elem_coarse(next->mesh, vc);
+      ElemVec elem_fine(mesh, vf);
+      vf.zero();
+      for (index_t i = 0; i < mesh.get_num_elements(); i++) {
+        typename Next::ElemVec::FEDof coarse_dof(i, elem_coarse);
+        typename ElemVec::FEDof fine_dof(i, elem_fine);
+        elem_coarse.get_element_values(i, coarse_dof);
+        Transfer::prolongation(coarse_dof, fine_dof);
+        elem_fine.add_element_values(i, fine_dof);
+      }
+      for (index_t i = 0; i < ndof; i++) {
+        vf[i] *= weights[i];
+      }
+    }
+
+    // Compute vc = P^T * vf to the next level
+    void restriction(Vec_t& vf, Vec_t& vc) {
+      typename Next::ElemVec elem_coarse(next->mesh, vc);
+      ElemVec elem_fine(mesh, vf);
+      vc.zero();
+      for (index_t i = 0; i < mesh.get_num_elements(); i++) {
+        typename Next::ElemVec::FEDof coarse_dof(i, elem_coarse);
+        typename ElemVec::FEDof fine_dof(i, elem_fine);
+        elem_fine.get_element_values(i, fine_dof);
+
+        const index_t* dof;
+        mesh.get_element_dof(i, &dof);
+        for (index_t k = 0; k < LBasis::ndof; k++) {
+          fine_dof[k] *= weights[dof[k]];
+        }
+        Transfer::restriction(fine_dof, coarse_dof);
+        elem_coarse.add_element_values(i, coarse_dof);
+      }
+    }
+
+    // Evaluate the values vf of this level at the nodes of the next level
+    void injection(Vec_t& vf, Vec_t& vc) {
+      typename Next::ElemVec elem_coarse(next->mesh, vc);
+      ElemVec elem_fine(mesh, vf);
+      vc.zero();
+      for (index_t i = 0; i < mesh.get_num_elements(); i++) {
+        typename Next::ElemVec::FEDof coarse_dof(i, elem_coarse);
+        typename ElemVec::FEDof fine_dof(i, elem_fine);
+        elem_fine.get_element_values(i, fine_dof);
+        Transfer::injection(fine_dof, coarse_dof);
+        elem_coarse.add_element_values(i, coarse_dof);
+      }
+      for (index_t i = 0; i < next->ndof; i++) {
+        vc[i] *= next->weights[i];
+      }
+    }
+
+    // Power iterations for the largest eigenvalue of D^{-1} A, stopped when
+    // the relative change of the estimate is below eig_rtol
+    void estimate_max_eigenvalue() {
+      auto rv = r.template get_block_view<block_size>();
+      auto dv = d.template get_block_view<block_size>();
+      for (index_t i = 0; i < ndof; i++) {
+        d[i] = 1.0 + 0.5 * std::sin(1.0 + i);
+      }
+
+      T lam = 0.0;
+      for (index_t k = 0; k < pmg.options.eig_iters; k++) {
+        T dnorm = BLAS::norm(dv);
+        BLAS::scale(dv, T(1.0) / dnorm);
+        (*op)(dv, rv);
+        for (index_t i = 0; i < ndof; i++) {
+          r[i] *= dinv[i];
+        }
+        T lam_prev = lam;
+        lam = BLAS::norm(rv);
+        BLAS::copy(dv, rv);
+        pmg.stats.power_iters++;
+
+        if (k > 0 &&
+            absfunc(lam - lam_prev) < pmg.options.eig_rtol * absfunc(lam)) {
+          break;
+        }
+      }
+      lmax = pmg.options.eig_safety * lam;
+    }
+
+    // Chebyshev smoothing of A * x = b with the Jacobi preconditioner, the
+    // eigenvalues of D^{-1} A in [lmax / range, lmax] are damped
+    void chebyshev(BlockVec_t& bv, BlockVec_t& xv, bool zero_guess) {
+      auto rv = r.template get_block_view<block_size>();
+      auto dv = d.template get_block_view<block_size>();
+      auto tv = t.template get_block_view<block_size>();
+
+      const T lmin = lmax / pmg.options.smoothing_range;
+      const T theta = 0.5 * (lmax + lmin);
+      const T delta = 0.5 * (lmax - lmin);
+      const T sigma = theta / delta;
+      T rho = 1.0 / sigma;
+
+      // r = b - A * x and d = D^{-1} r / theta
+      if (zero_guess) {
+        BLAS::copy(rv, bv);
+      } else {
+        (*op)(xv, rv);
+        BLAS::axpby(rv, T(1.0), T(-1.0), bv);
+      }
+      for (index_t i = 0; i < ndof; i++) {
+        d[i] = dinv[i] * r[i] / theta;
+      }
+
+      for (index_t k = 0; k < pmg.options.smoothing_degree; k++) {
+        BLAS::axpy(xv, T(1.0), dv);
+        if (k + 1 == pmg.options.smoothing_degree) {
+          break;
+        }
+
+        (*op)(dv, tv);
+        BLAS::axpy(rv, T(-1.0), tv);
+
+        T rho_next = 1.0 / (2.0 * sigma - rho);
+        T alpha = rho_next * rho;
+        T beta = 2.0 * rho_next / delta;
+        for (index_t i = 0; i < ndof; i++) {
+          d[i] = alpha * d[i] + beta * dinv[i] * r[i];
+        }
+        rho = rho_next;
+      }
+    }
+  };
+
+  std::function<void(BlockVec_t&, BlockVec_t&)> get_mat_vec() {
+    return [this](BlockVec_t& in, BlockVec_t& out) { mat_vec(in, out); };
+  }
+
+  std::function<void(BlockVec_t&, BlockVec_t&)> get_apply_factor() {
+    return [this](BlockVec_t& in, BlockVec_t& out) { apply_factor(in, out); };
+  }
+
+  Integrand integrand;
+  MeshConnectivityBase& conn;
+  DirichletBCInfo& bcinfo;
+  PMGPreconditionerOptions options;
+  Vec_t& sol;
+  DataElemVec elem_data;
+  GeoElemVec elem_geo;
+  std::unique_ptr<Level<degree>> fine;
+  PMGPreconditionerStats stats;
+};
+
+}  // namespace A2D
+
+#endif  // FE_PRECONDITIONER_H
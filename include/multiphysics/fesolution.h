@@ -1,9 +1,14 @@
 #ifndef A2D_FE_SOLUTION_H
 #define A2D_FE_SOLUTION_H
 
+#include <cstdio>
+#include <stdexcept>
+#include <string>
 #include <vector>
 
 #include "a2ddefs.h"
+#include "array.h"
+#include "utils/a2dcheckpoint.h"
 
 namespace A2D {
 
@@ -15,6 +20,52 @@ template <typename T>
 class SolutionVector {
  public:
   SolutionVector(index_t ndof) : ndof(ndof), array("array", ndof) { zero(); }
+
+  /**
+   * @brief Wrap an existing buffer of length ndof without copying
+   *
+   * The buffer is not owned by this object and must remain valid while it is
+   * in use.
+   */
+  SolutionVector(index_t ndof, T* data) : ndof(ndof), array(data, ndof) {}
+
+  /**
+   * @brief Wrap the first ndof entries of a blocked vector without copying
+   */
+  template <index_t M>
+  SolutionVector(MultiArrayNew<T* [M]>& vec, index_t ndof)
+      : ndof(ndof), array(vec.data(), ndof) {
+    check_size(vec.extent(0) * M);
+  }
+
+  /**
+   * @brief Point this vector at the entries of a blocked vector
+   *
+   * Element vectors that reference this object read and write the new
+   * entries, so one set of element vectors can be applied to different input
+   * and output vectors without copying.
+   */
+  template <index_t M>
+  void alias(MultiArrayNew<T* [M]>& vec) {
+    check_size(vec.extent(0) * M);
+    array = MultiArrayNew<T*>(vec.data(), ndof);
+  }
+
+  /**
+   * @brief Get a blocked view of the entries of this vector without copying
+   */
+  template <index_t M>
+  MultiArrayNew<T* [M]> get_block_view() {
+    if (ndof % M != 0) {
+      char msg[256];
+      std::snprintf(msg, sizeof(msg),
+                    "SolutionVector: %d dof is not a multiple of the block "
+                    "size %d.",
+                    ndof, M);
+      throw std::runtime_error(msg);
+    }
+    return MultiArrayNew<T* [M]>(array.data(), ndof / M);
+  }
   KOKKOS_FUNCTION T& operator[](index_t index) { return array(index); }
   KOKKOS_FUNCTION const T& operator[](index_t index) const {
     return array(index);
@@ -23,6 +74,16 @@ class SolutionVector {
   KOKKOS_FUNCTION index_t get_num_dof() const { return ndof; }
   KOKKOS_FUNCTION index_t size() const { return ndof; }
 
+  // Save the entries to a checkpoint
+  void save(CheckpointWriter& ckpt, const std::string& name) const {
+    ckpt.write(name, array.data(), ndof);
+  }
+
+  // Load the entries from a checkpoint, the number of dof must match
+  void load(const CheckpointReader& ckpt, const std::string& name) {
+    ckpt.read(name, array.data(), ndof);
+  }
+
   KOKKOS_FUNCTION void zero() { BLAS::zero(array); }
   KOKKOS_FUNCTION void axpy(T alpha, SolutionVector<T>& x) {
     for (int i = 0; i < ndof; i++) {
@@ -30,9 +91,24 @@ class SolutionVector {
     }
   }
   KOKKOS_FUNCTION void fill(T val) { BLAS::fill(array, val); }
+  KOKKOS_FUNCTION void copy(SolutionVector<T>& x) {
+    BLAS::copy(array, x.array);
+  }
+  KOKKOS_FUNCTION T norm() const { return BLAS::norm(array); }
   KOKKOS_FUNCTION T* data() { return array.data(); }
 
  private:
+  void check_size(index_t size) const {
+    if (size < ndof) {
+      char msg[256];
+      std::snprintf(msg, sizeof(msg),
+                    "SolutionVector: blocked vector of size %d is smaller "
+                    "than the %d dof.",
+                    size, ndof);
+      throw std::runtime_error(msg);
+    }
+  }
+
   const index_t ndof;
   MultiArrayNew<T*> array;
 };
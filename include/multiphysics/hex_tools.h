@@ -5,6 +5,7 @@
 
 #include "multiphysics/feelementvector.h"
 #include "multiphysics/fequadrature.h"
+#include "multiphysics/fespace.h"
 #include "utils/a2dprofiler.h"
 #include "utils/a2dvtk.h"
 
@@ -108,12 +109,60 @@ void set_geo_from_quad_nodes(const index_t nquad, const I quad[],
   // }
 }
 
+/**
+ * @brief Write the mesh and the nodal outputs to a VTK file
+ *
+ * Files ending in ".vtu" are written in the binary VTU format with the given
+ * format and compression, all others in the legacy ASCII format.
+ */
+template <index_t outputs, class ConnArray, class NodeArray, class OutputArray>
+void write_vtk_outputs(const std::string filename, ConnArray &vtk_conn,
+                       NodeArray &vtk_nodes, OutputArray &vtk_outputs,
+                       VTUFormat format = VTUFormat::APPENDED,
+                       VTUCompression compression = VTUCompression::NONE) {
+  using T = typename OutputArray::value_type;
+  const index_t nvtk_nodes = vtk_nodes.extent(0);
+  const std::string ext = ".vtu";
+  bool is_vtu = filename.size() >= ext.size() &&
+                filename.compare(filename.size() - ext.size(), ext.size(),
+                                 ext) == 0;
+
+  MultiArrayNew<T *> vtk_vec("vtk_vec", nvtk_nodes);
+  auto extract = [&](index_t i) {
+    for (index_t j = 0; j < nvtk_nodes; j++) {
+      vtk_vec(j) = vtk_outputs(j, i);
+    }
+  };
+
+  if (is_vtu) {
+    ToVTU vtu(filename, format, compression);
+    vtu.write_mesh(vtk_conn, vtk_nodes);
+    for (index_t i = 0; i < outputs; i++) {
+      extract(i);
+      char name[256];
+      std::snprintf(name, sizeof(name), "solution%d", i + 1);
+      vtu.write_sol(name, vtk_vec);
+    }
+  } else {
+    ToVTK vtk(vtk_conn, vtk_nodes, -1, filename);
+    vtk.write_mesh();
+    for (index_t i = 0; i < outputs; i++) {
+      extract(i);
+      char name[256];
+      std::snprintf(name, sizeof(name), "solution%d", i + 1);
+      vtk.write_sol(name, vtk_vec);
+    }
+  }
+}
+
 template <index_t outputs, index_t degree, typename T, class DataBasis,
           class GeoBasis, class Basis, class Integrand, class DataElemVec,
           class GeoElemVec, class ElemVec, class FunctorType>
 void write_hex_to_vtk(DataElemVec &elem_data, GeoElemVec &elem_geo,
                       ElemVec &elem_sol, const std::string filename,
-                      const FunctorType &func) {
+                      const FunctorType &func,
+                      VTUFormat format = VTUFormat::APPENDED,
+                      VTUCompression compression = VTUCompression::NONE) {
   Timer timer("write_hex_to_vtk()");
   using ET = ElementTypes;
   const index_t nex = degree;
@@ -188,18 +237,8 @@ void write_hex_to_vtk(DataElemVec &elem_data, GeoElemVec &elem_geo,
     }
   }
 
-  ToVTK vtk(vtk_conn, vtk_nodes, -1, filename);
-  vtk.write_mesh();
-
-  MultiArrayNew<T *> vtk_vec("vtk_vec", nvtk_nodes);
-  for (index_t i = 0; i < outputs; i++) {
-    for (index_t j = 0; j < nvtk_nodes; j++) {
-      vtk_vec(j) = vtk_outputs(j, i);
-    }
-    char name[256];
-    std::snprintf(name, sizeof(name), "solution%d", i + 1);
-    vtk.write_sol(name, vtk_vec);
-  }
+  write_vtk_outputs<outputs>(filename, vtk_conn, vtk_nodes, vtk_outputs,
+                             format, compression);
 }
 
 template <index_t outputs, index_t degree, typename T, class DataBasis,
@@ -207,7 +246,9 @@ template <index_t outputs, index_t degree, typename T, class DataBasis,
           class GeoElemVec, class ElemVec, class FunctorType>
 void write_quad_to_vtk(DataElemVec &elem_data, GeoElemVec &elem_geo,
                        ElemVec &elem_sol, const std::string filename,
-                       const FunctorType &func) {
+                       const FunctorType &func,
+                       VTUFormat format = VTUFormat::APPENDED,
+                       VTUCompression compression = VTUCompression::NONE) {
   Timer timer("write_quad_to_vtk()");
   using ET = ElementTypes;
   const index_t nex = degree;
@@ -274,18 +315,8 @@ void write_quad_to_vtk(DataElemVec &elem_data, GeoElemVec &elem_geo,
     }
   }
 
-  ToVTK vtk(vtk_conn, vtk_nodes, -1, filename);
-  vtk.write_mesh();
-
-  MultiArrayNew<T *> vtk_vec("vtk_vec", nvtk_nodes);
-  for (index_t i = 0; i < outputs; i++) {
-    for (index_t j = 0; j < nvtk_nodes; j++) {
-      vtk_vec(j) = vtk_outputs(j, i);
-    }
-    char name[256];
-    std::snprintf(name, sizeof(name), "solution%d", i + 1);
-    vtk.write_sol(name, vtk_vec);
-  }
+  write_vtk_outputs<outputs>(filename, vtk_conn, vtk_nodes, vtk_outputs,
+                             format, compression);
 }
 
 }  // namespace A2D
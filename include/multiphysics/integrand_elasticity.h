@@ -228,6 +228,201 @@ class TopoElasticityIntegrand {
     // Extract the Jacobian
     ExtractJacobian<of, wrt>(stack, data, geo, sref, jac);
   }
+
+  /**
+   * @brief Compute the residual and the Jacobian at a quadrature point
+   *
+   * The Jacobian extraction performs the first-order reverse pass through the
+   * stack, so the residual is available from the same stack without any
+   * additional evaluation.
+   *
+   * @tparam wrt Variable type (DATA, GEOMETRY, STATE)
+   * @param weight Quadrature weight
+   * @param data Data at the quadrature point
+   * @param geo_ Geometry data at the quadrature point
+   * @param sref_ State at the quadrature point
+   * @param res Residual contribution
+   * @param jac The Jacobian output
+   */
+  template <FEVarType wrt>
+  KOKKOS_FUNCTION void residual_and_jacobian(
+      T weight, const DataSpace& data0, const FiniteElementGeometry& geo0,
+      const FiniteElementSpace& sref0, FiniteElementVar<wrt>& res,
+      FiniteElementJacobian<wrt, wrt>& jac) const {
+    A2DObj<DataSpace> data(data0);
+    A2DObj<FiniteElementSpace> sref(sref0);
+    A2DObj<FiniteElementGeometry> geo(geo0);
+
+    // Intermediate variables
+    A2DObj<T> detJ, penalty, mu, lambda, energy, output;
+    A2DObj<FiniteElementSpace> s;
+    A2DObj<SymMat<T, dim>> E, S;
+
+    // Set the derivative of the solution
+    A2DObj<T&> rho = get_value<0>(data);
+    A2DObj<Mat<T, dim, dim>&> Ux = get_grad<0>(s);
+
+    // Make a stack of the operations
+    auto stack = MakeStack(
+        RefElementTransform(geo, sref, detJ, s),       // transform
+        Eval(1.0 / (1.0 + q * (1.0 - rho)), penalty),  // penalty parameter
+        Eval(penalty * mu0, mu), Eval(penalty * lambda0, lambda),
+        MatGreenStrain<etype>(Ux, E),
+        SymIsotropic(mu, lambda, E, S),               // Evaluate the stress
+        SymMatMultTrace(E, S, energy),                // Compute the energy
+        Eval(0.5 * weight * detJ * energy, output));  // Compute the output
+
+    output.bvalue() = 1.0;
+
+    // Extract the Jacobian
+    ExtractJacobian<wrt, wrt>(stack, data, geo, sref, jac);
+
+    // Copy the residual from the reverse pass
+    if constexpr (wrt == FEVarType::DATA) {
+      res[0] = rho.bvalue();
+    } else if constexpr (wrt == FEVarType::GEOMETRY) {
+      res.copy(geo.bvalue());
+    } else if constexpr (wrt == FEVarType::STATE) {
+      res.copy(sref.bvalue());
+    }
+  }
+
+  // Quadrature point data for the state Jacobian-vector product with the
+  // linear strain
+  struct LinearJacobianProductData {
+    Mat<T, dim, dim> Jinv;  // Inverse of the reference element Jacobian
+    T scale;                // Quadrature weight times det(J)
+    T mu, lambda;           // Penalized Lame parameters
+  };
+
+  // With the nonlinear strain, the product also depends on the deformation
+  // gradient and the stress at the quadrature point
+  struct NonlinearJacobianProductData : LinearJacobianProductData {
+    Mat<T, dim, dim> F;  // Deformation gradient I + Ux
+    SymMat<T, dim> S;    // Second Piola-Kirchhoff stress
+  };
+
+  using JacobianProductData =
+      std::conditional_t<etype == GreenStrainType::LINEAR,
+                         LinearJacobianProductData,
+                         NonlinearJacobianProductData>;
+
+  /**
+   * @brief Compute the data needed by cached_jacobian_product() at a
+   * quadrature point
+   *
+   * @param weight Quadrature weight
+   * @param data Data at the quadrature point
+   * @param geo Geometry data at the quadrature point
+   * @param sref State at the quadrature point
+   * @param qdata The quadrature point data
+   */
+  KOKKOS_FUNCTION void jacobian_product_data(T weight, const DataSpace& data,
+                                             const FiniteElementGeometry& geo,
+                                             const FiniteElementSpace& sref,
+                                             JacobianProductData& qdata) const {
+    const Mat<T, dim, dim>& J = get_grad<0>(geo);
+    T detJ;
+    MatInv(J, qdata.Jinv);
+    MatDet(J, detJ);
+    qdata.scale = weight * detJ;
+
+    T rho = data[0];
+    T penalty = 1.0 / (1.0 + q * (1.0 - rho));
+    qdata.mu = penalty * mu0;
+    qdata.lambda = penalty * lambda0;
+
+    if constexpr (etype == GreenStrainType::NONLINEAR) {
+      FiniteElementSpace s;
+      RefElementTransform(geo, sref, detJ, s);
+      const Mat<T, dim, dim>& Ux = get_grad<0>(s);
+
+      SymMat<T, dim> E;
+      MatGreenStrain<etype>(Ux, E);
+      SymIsotropic(qdata.mu, qdata.lambda, E, qdata.S);
+      for (index_t i = 0; i < dim; i++) {
+        for (index_t j = 0; j < dim; j++) {
+          qdata.F(i, j) = Ux(i, j) + (i == j ? 1.0 : 0.0);
+        }
+      }
+    }
+  }
+
+  /**
+   * @brief Compute the state Jacobian-vector product from the quadrature
+   * point data, without the AD stack
+   *
+   * With the strain energy W(Ux) = 0.5 * E : S, dW/dUx = F * S, so the
+   * product with the direction Px is F * dS + Px * S, where
+   * dS = C : sym(F^{T} * Px). With the linear strain, F = I and the second
+   * term vanishes.
+   *
+   * @param qdata The quadrature point data from jacobian_product_data()
+   * @param p Direction for the Jacobian-vector product
+   * @param res Output product
+   */
+  KOKKOS_FUNCTION void cached_jacobian_product(
+      const JacobianProductData& qdata, const FiniteElementSpace& p,
+      FiniteElementSpace& res) const {
+    // Px = Pxi * Jinv
+    const Mat<T, dim, dim>& Pxi = get_grad<0>(p);
+    Mat<T, dim, dim> Px;
+    for (index_t i = 0; i < dim; i++) {
+      for (index_t j = 0; j < dim; j++) {
+        T value = 0.0;
+        for (index_t k = 0; k < dim; k++) {
+          value += Pxi(i, k) * qdata.Jinv(k, j);
+        }
+        Px(i, j) = value;
+      }
+    }
+
+    // The strain direction dE = sym(F^{T} * Px) and the stress direction
+    SymMat<T, dim> dE, dS;
+    if constexpr (etype == GreenStrainType::LINEAR) {
+      MatGreenStrain<etype>(Px, dE);
+    } else {
+      for (index_t i = 0; i < dim; i++) {
+        for (index_t j = 0; j <= i; j++) {
+          T value = 0.0;
+          for (index_t k = 0; k < dim; k++) {
+            value += qdata.F(k, i) * Px(k, j) + qdata.F(k, j) * Px(k, i);
+          }
+          dE(i, j) = 0.5 * value;
+        }
+      }
+    }
+    SymIsotropic(qdata.mu, qdata.lambda, dE, dS);
+
+    // Gx = scale * (F * dS + Px * S)
+    Mat<T, dim, dim> Gx;
+    for (index_t i = 0; i < dim; i++) {
+      for (index_t j = 0; j < dim; j++) {
+        T value = 0.0;
+        if constexpr (etype == GreenStrainType::LINEAR) {
+          value = dS(i, j);
+        } else {
+          for (index_t k = 0; k < dim; k++) {
+            value += qdata.F(i, k) * dS(k, j) + Px(i, k) * qdata.S(k, j);
+          }
+        }
+        Gx(i, j) = qdata.scale * value;
+      }
+    }
+
+    // Transform back to the reference element, res = Gx * Jinv^{T}
+    res.zero();
+    Mat<T, dim, dim>& Rxi = get_grad<0>(res);
+    for (index_t i = 0; i < dim; i++) {
+      for (index_t j = 0; j < dim; j++) {
+        T value = 0.0;
+        for (index_t k = 0; k < dim; k++) {
+          value += Gx(i, k) * qdata.Jinv(j, k);
+        }
+        Rxi(i, j) = value;
+      }
+    }
+  }
 };
 
 template <class Impl, GreenStrainType etype, index_t degree>
@@ -1687,7 +1687,7 @@ KOKKOS_FUNCTION void interpolation_basis(const double pt, double N[],
     lagrange_basis<order>(knots, pt, N, Nx);
   } else if constexpr (interp_type == GAUSS_INTERPOLATION) {
     const double* knots = get_gauss_quadrature_pts<order>();
-    lagrange_basis<order>(knots, pt, N);
+    lagrange_basis<order>(knots, pt, N, Nx);
   } else {  // interp_type == BERNSTEIN_INTERPOLATION
     bernstein_basis<order>(pt, N, Nx);
   }
@@ -1704,6 +1704,129 @@ KOKKOS_FUNCTION const double* get_interpolation_pts() {
   }
 }
 
+/**
+ * @brief Interpolation basis and derivatives tabulated at the points of a
+ * quadrature scheme
+ *
+ * The quadrature points and the knots are fixed by the template parameters, so
+ * the 1D basis values are computed once, on first use, and shared by all the
+ * elements. For a tensor-product quadrature, the table holds the values at
+ * the points along each direction. Otherwise it holds the values at each
+ * coordinate of each quadrature point.
+ *
+ * @tparam Quadrature The quadrature scheme
+ * @tparam dim Number of coordinates of the quadrature points
+ * @tparam order Number of 1D basis functions
+ * @tparam interp_type The interpolation type
+ */
+template <class Quadrature, index_t dim, index_t order,
+          InterpolationType interp_type = GLL_INTERPOLATION>
+class InterpolationTable {
+ public:
+  static constexpr bool is_tensor_product =
+      Quadrature::is_tensor_product && dim >= 2;
+
+  /**
+   * @brief Basis values at the q-th point along the direction d of a
+   * tensor-product quadrature
+   */
+  KOKKOS_FUNCTION static const double* tensor_values(index_t d, index_t q) {
+    static_assert(is_tensor_product, "Quadrature is not a tensor product");
+    return get_table().N[d * npts + q];
+  }
+
+  // Basis derivatives at the q-th point along the direction d
+  KOKKOS_FUNCTION static const double* tensor_derivs(index_t d, index_t q) {
+    static_assert(is_tensor_product, "Quadrature is not a tensor product");
+    return get_table().Nx[d * npts + q];
+  }
+
+  /**
+   * @brief Basis values at the coordinate d of the quadrature point q
+   */
+  KOKKOS_FUNCTION static const double* values(index_t q, index_t d) {
+    return get_table().N[get_row(q, d)];
+  }
+
+  // Basis derivatives at the coordinate d of the quadrature point q
+  KOKKOS_FUNCTION static const double* derivs(index_t q, index_t d) {
+    return get_table().Nx[get_row(q, d)];
+  }
+
+ private:
+  static constexpr index_t get_num_points() {
+    if constexpr (is_tensor_product) {
+      return Quadrature::tensor_dim0;
+    } else {
+      return Quadrature::num_quad_points;
+    }
+  }
+
+  // The table stores a single set of 1D points for all the directions
+  static constexpr bool has_equal_tensor_dims() {
+    if constexpr (!is_tensor_product) {
+      return true;
+    } else if constexpr (dim == 2) {
+      return Quadrature::tensor_dim0 == Quadrature::tensor_dim1;
+    } else {
+      return Quadrature::tensor_dim0 == Quadrature::tensor_dim1 &&
+             Quadrature::tensor_dim1 == Quadrature::tensor_dim2;
+    }
+  }
+  static_assert(has_equal_tensor_dims(),
+                "The tensor-product quadrature must have the same number of "
+                "points in each direction");
+
+  static constexpr index_t npts = get_num_points();
+  static constexpr index_t nrows = dim * npts;
+
+  struct Table {
+    Table() {
+      if constexpr (is_tensor_product) {
+        for (index_t d = 0; d < dim; d++) {
+          for (index_t q = 0; q < npts; q++) {
+            double pt = Quadrature::get_tensor_point(d, q);
+            interpolation_basis<order, interp_type>(pt, N[d * npts + q],
+                                                    Nx[d * npts + q]);
+          }
+        }
+      } else {
+        for (index_t q = 0; q < npts; q++) {
+          double pt[dim];
+          Quadrature::get_point(q, pt);
+          for (index_t d = 0; d < dim; d++) {
+            interpolation_basis<order, interp_type>(pt[d], N[dim * q + d],
+                                                    Nx[dim * q + d]);
+          }
+        }
+      }
+    }
+
+    double N[nrows][order];
+    double Nx[nrows][order];
+  };
+
+  KOKKOS_FUNCTION static const Table& get_table() {
+    static const Table table;
+    return table;
+  }
+
+  // Row of the table for the coordinate d of the quadrature point q, the
+  // tensor-product points are ordered as q = q0 + n * (q1 + n * q2)
+  KOKKOS_FUNCTION static index_t get_row(index_t q, index_t d) {
+    if constexpr (is_tensor_product) {
+      if (d == 0) {
+        return q % npts;
+      } else if (d == 1) {
+        return npts + (q / npts) % npts;
+      }
+      return 2 * npts + q / (npts * npts);
+    } else {
+      return dim * q + d;
+    }
+  }
+};
+
 }  // namespace A2D
 
 #endif  //  A2D_LAGRANGE_TOOLS
\ No newline at end of file
@@ -1,6 +1,8 @@
 #ifndef A2D_QHDIV_HEX_BASIS_H
 #define A2D_QHDIV_HEX_BASIS_H
 
+#include <algorithm>
+
 #include "multiphysics/febasis.h"
 #include "multiphysics/feelementtypes.h"
 #include "multiphysics/lagrange_tools.h"
@@ -380,10 +382,6 @@ class QHdivHexBasis {
   static void interp(const SolnType& sol,
                      QptSpace<Quadrature, FiniteElementSpace>& out) {
     for (index_t q = 0; q < Quadrature::get_num_points(); q++) {
-      // Get the quadrature point
-      double pt[dim];
-      Quadrature::get_point(q, pt);
-
       FiniteElementSpace& s = out.get(q);
       HdivSpace<T, dim>& hdiv = s.template get<space>();
       Vec<T, dim>& u = hdiv.get_value();
@@ -392,14 +390,13 @@ class QHdivHexBasis {
       u.zero();
       div = 0.0;
 
-      const double* knots = get_gauss_quadrature_pts<degree>();
 
       // Evaluate the basis functions
       double dx[order];
       double n1[order], n2[order], n3[order];
-      lagrange_basis<order>(pt[0], n1, dx);
-      lagrange_basis<order - 1>(knots, pt[1], n2);
-      lagrange_basis<order - 1>(knots, pt[2], n3);
+      get_normal_basis<Quadrature>(q, 0, n1, dx);
+      get_tangent_basis<Quadrature>(q, 1, n2);
+      get_tangent_basis<Quadrature>(q, 2, n3);
 
       // Flip the first basis function on the negative bound
       n1[0] *= -1.0;
@@ -415,9 +412,9 @@ class QHdivHexBasis {
         }
       }
 
-      lagrange_basis<order - 1>(knots, pt[0], n1);
-      lagrange_basis<order>(pt[1], n2, dx);
-      lagrange_basis<order - 1>(knots, pt[2], n3);
+      get_tangent_basis<Quadrature>(q, 0, n1);
+      get_normal_basis<Quadrature>(q, 1, n2, dx);
+      get_tangent_basis<Quadrature>(q, 2, n3);
 
       // Flip the first basis function on the negative bound
       n2[0] *= -1.0;
@@ -432,9 +429,9 @@ class QHdivHexBasis {
         }
       }
 
-      lagrange_basis<order - 1>(knots, pt[0], n1);
-      lagrange_basis<order - 1>(knots, pt[1], n2);
-      lagrange_basis<order>(pt[2], n3, dx);
+      get_tangent_basis<Quadrature>(q, 0, n1);
+      get_tangent_basis<Quadrature>(q, 1, n2);
+      get_normal_basis<Quadrature>(q, 2, n3, dx);
 
       // Flip the first basis function on the negative bound
       n3[0] *= -1.0;
@@ -488,23 +485,18 @@ class QHdivHexBasis {
   static void add(const QptSpace<Quadrature, FiniteElementSpace>& in,
                   SolnType& res) {
     for (index_t q = 0; q < Quadrature::get_num_points(); q++) {
-      // Get the quadrature point
-      double pt[dim];
-      Quadrature::get_point(q, pt);
-
       const FiniteElementSpace& s = in.get(q);
       const HdivSpace<T, dim>& hdiv = s.template get<space>();
       const Vec<T, dim>& u = hdiv.get_value();
       const T& div = hdiv.get_div();
 
-      const double* knots = get_gauss_quadrature_pts<degree>();
 
       // Evaluate the basis functions
       double dx[order];
       double n1[order], n2[order], n3[order];
-      lagrange_basis<order>(pt[0], n1, dx);
-      lagrange_basis<order - 1>(knots, pt[1], n2);
-      lagrange_basis<order - 1>(knots, pt[2], n3);
+      get_normal_basis<Quadrature>(q, 0, n1, dx);
+      get_tangent_basis<Quadrature>(q, 1, n2);
+      get_tangent_basis<Quadrature>(q, 2, n3);
 
       // Flip the first basis function on the negative bound
       n1[0] *= -1.0;
@@ -520,9 +512,9 @@ class QHdivHexBasis {
         }
       }
 
-      lagrange_basis<order - 1>(knots, pt[0], n1);
-      lagrange_basis<order>(pt[1], n2, dx);
-      lagrange_basis<order - 1>(knots, pt[2], n3);
+      get_tangent_basis<Quadrature>(q, 0, n1);
+      get_normal_basis<Quadrature>(q, 1, n2, dx);
+      get_tangent_basis<Quadrature>(q, 2, n3);
 
       // Flip the first basis function on the negative bound
       n2[0] *= -1.0;
@@ -537,9 +529,9 @@ class QHdivHexBasis {
         }
       }
 
-      lagrange_basis<order - 1>(knots, pt[0], n1);
-      lagrange_basis<order - 1>(knots, pt[1], n2);
-      lagrange_basis<order>(pt[2], n3, dx);
+      get_tangent_basis<Quadrature>(q, 0, n1);
+      get_tangent_basis<Quadrature>(q, 1, n2);
+      get_normal_basis<Quadrature>(q, 2, n3, dx);
 
       // Flip the first basis function on the negative bound
       n3[0] *= -1.0;
@@ -571,17 +563,13 @@ class QHdivHexBasis {
   // Compute the full matrix of basis functions
   template <class Quadrature, class BasisType>
   static void basis(index_t n, BasisType N) {
-    double pt[dim];
-    Quadrature::get_point(n, pt);
-
-    const double* knots = get_gauss_quadrature_pts<degree>();
 
     // Evaluate the basis functions
     double dx[order];
     double n1[order], n2[order], n3[order];
-    lagrange_basis<order>(pt[0], n1, dx);
-    lagrange_basis<order - 1>(knots, pt[1], n2);
-    lagrange_basis<order - 1>(knots, pt[2], n3);
+    get_normal_basis<Quadrature>(n, 0, n1, dx);
+    get_tangent_basis<Quadrature>(n, 1, n2);
+    get_tangent_basis<Quadrature>(n, 2, n3);
 
     // Flip the first basis function on the negative bound
     n1[0] *= -1.0;
@@ -599,9 +587,9 @@ class QHdivHexBasis {
       }
     }
 
-    lagrange_basis<order - 1>(knots, pt[0], n1);
-    lagrange_basis<order>(pt[1], n2, dx);
-    lagrange_basis<order - 1>(knots, pt[2], n3);
+    get_tangent_basis<Quadrature>(n, 0, n1);
+    get_normal_basis<Quadrature>(n, 1, n2, dx);
+    get_tangent_basis<Quadrature>(n, 2, n3);
 
     // Flip the first basis function on the negative bound
     n2[0] *= -1.0;
@@ -618,9 +606,9 @@ class QHdivHexBasis {
       }
     }
 
-    lagrange_basis<order - 1>(knots, pt[0], n1);
-    lagrange_basis<order - 1>(knots, pt[1], n2);
-    lagrange_basis<order>(pt[2], n3, dx);
+    get_tangent_basis<Quadrature>(n, 0, n1);
+    get_tangent_basis<Quadrature>(n, 1, n2);
+    get_normal_basis<Quadrature>(n, 2, n3, dx);
 
     // Flip the first basis function on the negative bound
     n3[0] *= -1.0;
@@ -637,6 +625,24 @@ class QHdivHexBasis {
       }
     }
   }
+
+ private:
+  // Copy the tabulated basis of the normal direction at the point q into N
+  // and Nx, these are modified in place for the sign of the first function
+  template <class Quadrature>
+  static void get_normal_basis(index_t q, index_t d, double N[], double Nx[]) {
+    using Table = InterpolationTable<Quadrature, dim, order, GLL_INTERPOLATION>;
+    std::copy_n(Table::values(q, d), order, N);
+    std::copy_n(Table::derivs(q, d), order, Nx);
+  }
+
+  // Copy the tabulated basis of a tangential direction at the point q into N
+  template <class Quadrature>
+  static void get_tangent_basis(index_t q, index_t d, double N[]) {
+    using Table =
+        InterpolationTable<Quadrature, dim, order - 1, GAUSS_INTERPOLATION>;
+    std::copy_n(Table::values(q, d), order - 1, N);
+  }
 };
 
 }  // namespace A2D
@@ -1,10 +1,15 @@
 #ifndef A2D_FE_STATIC_CONDENSATION_H
 #define A2D_FE_STATIC_CONDENSATION_H
 
+#include <set>
+#include <utility>
+#include <vector>
+
 #include "block_numeric.h"
 #include "multiphysics/febasis.h"
 #include "multiphysics/feelement.h"
 #include "multiphysics/femesh.h"
+#include "parallel.h"
 #include "sparse/sparse_amg.h"
 
 namespace A2D {
@@ -19,6 +24,11 @@ namespace A2D {
  * assumed to be element-independent - for instance from an L2 space with only
  * bubble dof.
  *
+ * The element C matrices are factored in parallel. When C is symmetric and
+ * positive definite, its Cholesky factor is stored, otherwise the explicit
+ * inverse is stored. The elements are colored so that contributions to the
+ * global matrix and right-hand-side can be added in parallel within a color.
+ *
  * @tparam T
  * @tparam block_size
  * @tparam basis_offset
@@ -52,10 +62,31 @@ class StaticCondensationMat {
         B(mesh.get_num_elements()),
         C(mesh.get_num_elements()),
         E(mesh.get_num_elements()),
-        F(mesh.get_num_elements()) {
+        F(mesh.get_num_elements()),
+        use_cholesky(mesh.get_num_elements(), 0) {
+    // Create the non-zero pattern of the condensed matrix from the first bsize
+    // dof of each element
+    std::set<std::pair<I, I>> pairs;
+    for (I elem = 0; elem < mesh.get_num_elements(); elem++) {
+      I dof[Basis::ndof];
+      int sign[Basis::ndof];
+      if constexpr (Basis::nbasis > 0) {
+        get_dof<0>(elem, dof, sign);
+      }
+      for (I i = 0; i < bsize; i++) {
+        for (I j = 0; j < bsize; j++) {
+          pairs.insert(
+              std::make_pair(dof[i] / block_size, dof[j] / block_size));
+        }
+      }
+    }
+
     I nrows;
     std::vector<I> rowp, cols;
-    mesh.template create_block_csr<block_size, basis_offset>(nrows, rowp, cols);
+    ElementMeshBase::create_block_csr(pairs, nrows, rowp, cols);
+
+    // Color the elements for the parallel assembly
+    color_elements(nrows);
 
     // Create the shared pointer
     mat = std::make_shared<BSRMatType>(nrows, nrows, cols.size(), rowp, cols);
@@ -212,27 +243,26 @@ class StaticCondensationMat {
 
   void factor() {
     mat->zero();
-    for (I elem = 0; elem < mesh.get_num_elements(); elem++) {
-      I dof[Basis::ndof];
-      int sign[Basis::ndof];
-      if constexpr (Basis::nbasis > 0) {
-        get_dof<0>(elem, dof, sign);
-      }
-
-      // Form B - E * C^{-1} * F before assembling it into the global matrix
-      // Compute and store C^{-1} in the C array of matrices
-      CMatType copy(C[elem]);
-      Vec<I, csize> ipiv;
-      blockInverse<T, csize>(copy, C[elem], ipiv);
-
-      // Mulitply temp = C^{-1} * F
-      Mat<T, csize, bsize> temp;
-      blockGemm<T, csize, csize, bsize>(C[elem], F[elem], temp);
 
-      // Compute B = B - E * temp = B - E * C^{-1} * F
-      blockGemmSub<T, bsize, csize, bsize>(E[elem], temp, B[elem]);
+    // Factor the C matrices and form B - E * C^{-1} * F for all elements
+    parallel_for(
+        mesh.get_num_elements(),
+        KOKKOS_LAMBDA(I elem)->void { factor_element(elem); });
+
+    // Assemble the condensed matrices one color at a time
+    for (I color = 0; color < num_colors; color++) {
+      const I offset = color_ptr[color];
+      parallel_for(
+          color_ptr[color + 1] - offset, KOKKOS_LAMBDA(I k)->void {
+            I elem = color_elems[offset + k];
+            I dof[Basis::ndof];
+            int sign[Basis::ndof];
+            if constexpr (Basis::nbasis > 0) {
+              get_dof<0>(elem, dof, sign);
+            }
 
-      mat->add_values(bsize, dof, bsize, dof, B[elem]);
+            mat->add_values(bsize, dof, bsize, dof, B[elem]);
+          });
     }
 
     // Allocate the solver - we should add some of these as solver options
@@ -267,86 +297,248 @@ class StaticCondensationMat {
    */
   void apply_factor(MultiArrayNew<T *[block_size]> &in,
                     MultiArrayNew<T *[block_size]> &out) {
-    // Compute f = b - E * C^{-1} * d
+    // Compute f = b - E * C^{-1} * d, one color at a time
     BLAS::zero(f);
-    for (I elem = 0; elem < mesh.get_num_elements(); elem++) {
-      I dof[Basis::ndof];
-      int sign[Basis::ndof];
-      if constexpr (Basis::nbasis > 0) {
-        get_dof<0>(elem, dof, sign);
-      }
+    for (I color = 0; color < num_colors; color++) {
+      const I offset = color_ptr[color];
+      parallel_for(
+          color_ptr[color + 1] - offset, KOKKOS_LAMBDA(I k)->void {
+            I elem = color_elems[offset + k];
+            I dof[Basis::ndof];
+            int sign[Basis::ndof];
+            if constexpr (Basis::nbasis > 0) {
+              get_dof<0>(elem, dof, sign);
+            }
 
-      // Extract b and d
-      Vec<T, bsize> b;
-      for (I i = 0; i < bsize; i++) {
-        b(i) = in(dof[i] / block_size, dof[i] % block_size);
-      }
+            // Extract b and d
+            Vec<T, bsize> b;
+            for (I i = 0; i < bsize; i++) {
+              b(i) = in(dof[i] / block_size, dof[i] % block_size);
+            }
 
-      Vec<T, csize> d;
-      for (I i = 0; i < csize; i++) {
-        d(i) = in(dof[i + bsize] / block_size, dof[i + bsize] % block_size);
-      }
+            Vec<T, csize> d;
+            for (I i = 0; i < csize; i++) {
+              d(i) = in(dof[i + bsize] / block_size,
+                        dof[i + bsize] % block_size);
+            }
 
-      Vec<T, csize> t;  // t = C^{-1} * d
-      blockGemv<T, csize, csize>(C[elem], d, t);
+            Vec<T, csize> t;  // t = C^{-1} * d
+            apply_cinv(elem, d, t);
 
-      // b = b - E * t = b - E * C^{-1} * d
-      blockGemvSub<T, bsize, csize>(E[elem], t, b);
+            // b = b - E * t = b - E * C^{-1} * d
+            blockGemvSub<T, bsize, csize>(E[elem], t, b);
 
-      // Set the values into the right-hand-size
-      for (I i = 0; i < bsize; i++) {
-        f(dof[i] / block_size, dof[i] % block_size) += b(i);
-      }
+            // Set the values into the right-hand-size
+            for (I i = 0; i < bsize; i++) {
+              f(dof[i] / block_size, dof[i] % block_size) += b(i);
+            }
+          });
     }
 
     // Apply the preconditioner B * x = f
     BLAS::zero(x);
     amg->applyFactor(f, x);
 
-    // Solve for the remaining dof: y = C^{-1} * (d - F * x)
-    for (I elem = 0; elem < mesh.get_num_elements(); elem++) {
+    // Set the condensed dof into the solution
+    parallel_for(
+        mat->nbrows, KOKKOS_LAMBDA(I i)->void {
+          for (I j = 0; j < block_size; j++) {
+            out(i, j) = x(i, j);
+          }
+        });
+
+    // Solve for the remaining dof: y = C^{-1} * (d - F * x). The remaining
+    // dof are local to each element so no coloring is required.
+    parallel_for(
+        mesh.get_num_elements(), KOKKOS_LAMBDA(I elem)->void {
+          I dof[Basis::ndof];
+          int sign[Basis::ndof];
+          if constexpr (Basis::nbasis > 0) {
+            get_dof<0>(elem, dof, sign);
+          }
+
+          // Extract the element solution xelem
+          Vec<T, bsize> xelem;
+          for (I i = 0; i < bsize; i++) {
+            xelem(i) = x(dof[i] / block_size, dof[i] % block_size);
+          }
+
+          Vec<T, csize> d;
+          for (I i = 0; i < csize; i++) {
+            d(i) =
+                in(dof[i + bsize] / block_size, dof[i + bsize] % block_size);
+          }
+
+          // Compute d = d - F * xe
+          blockGemvSub<T, csize, bsize>(F[elem], xelem, d);
+
+          // Compute y = C^{-1} * (d - F * xe)
+          Vec<T, csize> yelem;
+          apply_cinv(elem, d, yelem);
+
+          for (I i = 0; i < csize; i++) {
+            out(dof[i + bsize] / block_size, dof[i + bsize] % block_size) =
+                yelem(i);
+          }
+        });
+  }
+
+  /**
+   * @brief Get the number of element colors used for the parallel assembly
+   */
+  index_t get_num_colors() const { return num_colors; }
+
+  /**
+   * @brief Get the condensed matrix B - E * C^{-1} * F, set by factor()
+   */
+  std::shared_ptr<BSRMatType> get_condensed_mat() { return mat; }
+
+  BMatType &get_bmat(I index) { return B[index]; }
+  EMatType &get_emat(I index) { return E[index]; }
+  FMatType &get_fmat(I index) { return F[index]; }
+  CMatType &get_cmat(I index) { return C[index]; }
+
+ private:
+  /**
+   * @brief Factor C and compute B = B - E * C^{-1} * F for one element
+   */
+  void factor_element(I elem) {
+    // Compute temp = C^{-1} * F using the Cholesky factorization when C is
+    // symmetric and positive definite
+    Mat<T, csize, bsize> temp(F[elem]);
+    use_cholesky[elem] = 0;
+    if (is_symmetric(C[elem])) {
+      CMatType L(C[elem]);
+      if (blockCholesky<T, csize>(L) == 0) {
+        use_cholesky[elem] = 1;
+        C[elem] = L;
+        blockCholeskySolveMat<T, csize, bsize>(C[elem], temp);
+      }
+    }
+
+    // Otherwise compute and store C^{-1} in the C array of matrices
+    if (!use_cholesky[elem]) {
+      CMatType copy(C[elem]);
+      Vec<I, csize> ipiv;
+      blockInverse<T, csize>(copy, C[elem], ipiv);
+      blockGemm<T, csize, csize, bsize>(C[elem], F[elem], temp);
+    }
+
+    // Compute B = B - E * temp = B - E * C^{-1} * F
+    blockGemmSub<T, bsize, csize, bsize>(E[elem], temp, B[elem]);
+  }
+
+  /**
+   * @brief Compute t = C^{-1} * d using the factored C matrix
+   */
+  void apply_cinv(I elem, const Vec<T, csize> &d, Vec<T, csize> &t) const {
+    if (use_cholesky[elem]) {
+      t = d;
+      blockCholeskySolve<T, csize>(C[elem], t);
+    } else {
+      blockGemv<T, csize, csize>(C[elem], d, t);
+    }
+  }
+
+  /**
+   * @brief Check whether the matrix is symmetric to a relative tolerance
+   */
+  static bool is_symmetric(const CMatType &A) {
+    double amax = 0.0;
+    for (I i = 0; i < csize; i++) {
+      for (I j = 0; j < csize; j++) {
+        amax = std::max(amax, absfunc(A(i, j)));
+      }
+    }
+
+    const double tol = 1e-12 * amax;
+    for (I i = 0; i < csize; i++) {
+      for (I j = 0; j < i; j++) {
+        if (absfunc(A(i, j) - A(j, i)) > tol) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  /**
+   * @brief Parallel coloring of the elements such that no two elements with
+   * the same color share a block row of the condensed matrix
+   */
+  void color_elements(I nrows) {
+    const I num_elements = mesh.get_num_elements();
+
+    // Create the block row to element data structure
+    std::vector<I> row_ptr(nrows + 1, 0);
+    for (I elem = 0; elem < num_elements; elem++) {
       I dof[Basis::ndof];
       int sign[Basis::ndof];
       if constexpr (Basis::nbasis > 0) {
         get_dof<0>(elem, dof, sign);
       }
-
-      // Extract the element solution xelem
-      Vec<T, bsize> xelem;
       for (I i = 0; i < bsize; i++) {
-        xelem(i) = x(dof[i] / block_size, dof[i] % block_size);
+        row_ptr[dof[i] / block_size + 1]++;
       }
+    }
+    for (I i = 0; i < nrows; i++) {
+      row_ptr[i + 1] += row_ptr[i];
+    }
 
-      Vec<T, csize> d;
-      for (I i = 0; i < csize; i++) {
-        d(i) = in(dof[i + bsize] / block_size, dof[i + bsize] % block_size);
+    std::vector<I> row_elems(row_ptr[nrows]);
+    for (I elem = 0; elem < num_elements; elem++) {
+      I dof[Basis::ndof];
+      int sign[Basis::ndof];
+      if constexpr (Basis::nbasis > 0) {
+        get_dof<0>(elem, dof, sign);
       }
-
-      // Compute d = d - F * xe
-      blockGemvSub<T, csize, bsize>(F[elem], xelem, d);
-
-      // Compute y = C^{-1} * (d - F * xe)
-      Vec<T, csize> yelem;
-      blockGemv<T, csize, csize>(C[elem], d, yelem);
-
-      // Set the variables into the solution
       for (I i = 0; i < bsize; i++) {
-        out(dof[i] / block_size, dof[i] % block_size) = xelem(i);
+        row_elems[row_ptr[dof[i] / block_size]++] = elem;
       }
+    }
+    for (I i = nrows; i > 0; i--) {
+      row_ptr[i] = row_ptr[i - 1];
+    }
+    row_ptr[0] = 0;
 
-      for (I i = 0; i < csize; i++) {
-        out(dof[i + bsize] / block_size, dof[i + bsize] % block_size) =
-            yelem(i);
+    // Create the element to block row data structure
+    std::vector<I> elem_ptr(num_elements + 1);
+    std::vector<I> elem_rows(num_elements * bsize);
+    for (I elem = 0; elem < num_elements; elem++) {
+      I dof[Basis::ndof];
+      int sign[Basis::ndof];
+      if constexpr (Basis::nbasis > 0) {
+        get_dof<0>(elem, dof, sign);
+      }
+      elem_ptr[elem] = elem * bsize;
+      for (I i = 0; i < bsize; i++) {
+        elem_rows[elem * bsize + i] = dof[i] / block_size;
       }
     }
+    elem_ptr[num_elements] = num_elements * bsize;
+
+    // Color the elements such that no two elements with the same color share
+    // a block row
+    std::vector<I> elem_color(num_elements);
+    num_colors = CSRBipartiteColorOrderParallel(
+        num_elements, elem_ptr.data(), elem_rows.data(), row_ptr.data(),
+        row_elems.data(), elem_color.data(), (I *)nullptr);
+
+    // Sort the elements by color
+    color_ptr.assign(num_colors + 1, 0);
+    for (I elem = 0; elem < num_elements; elem++) {
+      color_ptr[elem_color[elem] + 1]++;
+    }
+    for (I c = 0; c < num_colors; c++) {
+      color_ptr[c + 1] += color_ptr[c];
+    }
+    color_elems.resize(num_elements);
+    std::vector<I> count(color_ptr.begin(), color_ptr.end() - 1);
+    for (I elem = 0; elem < num_elements; elem++) {
+      color_elems[count[elem_color[elem]]++] = elem;
+    }
   }
 
-  BMatType &get_bmat(I index) { return B[index]; }
-  EMatType &get_emat(I index) { return E[index]; }
-  FMatType &get_fmat(I index) { return F[index]; }
-  CMatType &get_cmat(I index) { return C[index]; }
-
- private:
   template <index_t basis>
   void get_dof(index_t elem, index_t dof[], int sign[]) {
     for (index_t i = 0; i < Basis::template get_ndof<basis>(); i++) {
@@ -369,6 +561,13 @@ class StaticCondensationMat {
   std::vector<EMatType> E;
   std::vector<FMatType> F;
 
+  // Flag indicating whether C stores the Cholesky factor or the inverse
+  std::vector<char> use_cholesky;
+
+  // Element coloring
+  I num_colors;
+  std::vector<I> color_ptr, color_elems;
+
   std::shared_ptr<BSRMatType> mat;
   std::shared_ptr<BSRMatAmgType> amg;
 };
@@ -75,6 +75,26 @@ KOKKOS_FUNCTION void blockGemvAddSlice(const AType& A, const int Ai,
   }
 }
 
+/*
+  Compute y[k, :] += A[i, :, :]^{T} * x[j, :]
+
+  A is I x M x N
+  x is J x M
+  y is K x N
+*/
+template <typename T, int M, int N, class AType, class xType, class yType>
+KOKKOS_FUNCTION void blockGemvTransposeAddSlice(const AType& A, const int Ai,
+                                                const xType& x, const int xj,
+                                                yType& y, const int yk) {
+  for (int j = 0; j < N; j++) {
+    T prod = 0.0;
+    for (int i = 0; i < M; i++) {
+      prod += A(Ai, i, j) * x(xj, i);
+    }
+    y(yk, j) += prod;
+  }
+}
+
 /*
   Compute y[k, :] += scale * A[i, :, :] * x[j, :]
 
@@ -4,12 +4,15 @@
 #include <iomanip>
 #include <iostream>
 #include <memory>
+#include <string>
 
 #include "array.h"
 #include "block_numeric.h"
 #include "sparse_matrix.h"
 #include "sparse_numeric.h"
 #include "sparse_symbolic.h"
+#include "sparse_utils.h"
+#include "utils/a2dcheckpoint.h"
 #include "utils/a2dprofiler.h"
 
 namespace A2D {
@@ -431,12 +434,53 @@ class BSRMatAmg {
         rho(0.0),
         Dinv(NULL),
         Afact(NULL),
+        Ac(NULL),
+        Pc(NULL),
+        PTc(NULL),
         x(NULL),
         b(NULL),
         r(NULL),
         next(NULL) {
     makeAmgLevels(0, num_levels, print_info);
   }
+
+  /*
+    Restore the multigrid hierarchy from the prolongation operators saved in a
+    checkpoint. This skips the aggregation and prolongation smoothing, only
+    the Galerkin products and the coarse factorization are recomputed.
+  */
+  BSRMatAmg(int num_levels, T omega, T epsilon,
+            std::shared_ptr<BSRMat<T, M, M>> A, MultiArrayNew<T* [M][N]> B,
+            const CheckpointReader& ckpt, const std::string& prefix = "amg",
+            bool print_info = false)
+      : level(-1),
+        A(A),
+        B(B),
+        P(NULL),
+        PT(NULL),
+        omega(omega),
+        epsilon(epsilon),
+        rho(0.0),
+        Dinv(NULL),
+        Afact(NULL),
+        Ac(NULL),
+        Pc(NULL),
+        PTc(NULL),
+        x(NULL),
+        b(NULL),
+        r(NULL),
+        next(NULL) {
+    int saved_levels = ckpt.read_scalar<index_t>(prefix + "/num_levels");
+    if (saved_levels != num_levels) {
+      char msg[256];
+      std::snprintf(msg, sizeof(msg),
+                    "BSRMatAmg: checkpoint %s has %d levels, expected %d",
+                    prefix.c_str(), saved_levels, num_levels);
+      throw std::runtime_error(msg);
+    }
+    makeAmgLevels(0, num_levels, print_info, &ckpt, prefix);
+  }
+
   ~BSRMatAmg() {
     if (P) {
       delete P;
@@ -450,6 +494,7 @@ class BSRMatAmg {
     if (Afact) {
       delete Afact;
     }
+    deleteCompressedIndex();
     if (x) {
       delete x;
     }
@@ -654,6 +699,36 @@ class BSRMatAmg {
     }
   }
 
+  // Get the number of levels in the hierarchy starting from this level
+  int get_num_levels() const { return next ? next->get_num_levels() + 1 : 1; }
+
+  /*
+    Use matrices with compressed column indices for the smoothing, residual,
+    restriction and interpolation on all the levels. The compressed matrices
+    share the values with A, P and PT, so update() keeps them current. This
+    reduces the memory traffic of the cycle, most notably for small blocks.
+  */
+  void compressIndex(bool compress = true) {
+    deleteCompressedIndex();
+    if (compress && next) {
+      Ac = BSRMatCompressIndex(*A);
+      Pc = BSRMatCompressIndex(*P);
+      PTc = BSRMatCompressIndex(*PT);
+    }
+    if (next) {
+      next->compressIndex(compress);
+    }
+  }
+
+  /*
+    Save the prolongation operators and spectral radius estimates for each
+    level to a checkpoint
+  */
+  void save(CheckpointWriter& ckpt, const std::string& prefix = "amg") {
+    ckpt.write_scalar<index_t>(prefix + "/num_levels", get_num_levels());
+    saveLevels(ckpt, prefix);
+  }
+
   /*
     Test the accuracy of the Galerkin operator
   */
@@ -703,6 +778,9 @@ class BSRMatAmg {
         rho(0.0),
         Dinv(NULL),
         Afact(NULL),
+        Ac(NULL),
+        Pc(NULL),
+        PTc(NULL),
         x(NULL),
         b(NULL),
         r(NULL),
@@ -713,8 +791,27 @@ class BSRMatAmg {
   template <typename UT, index_t UM, index_t UN>
   friend class BSRMatAmg;
 
-  // Make the different multigrid levels
-  void makeAmgLevels(int _level, int num_levels, bool print_info) {
+  // Free the matrices with compressed indices on this level
+  void deleteCompressedIndex() {
+    if (Ac) {
+      delete Ac;
+      Ac = NULL;
+    }
+    if (Pc) {
+      delete Pc;
+      Pc = NULL;
+    }
+    if (PTc) {
+      delete PTc;
+      PTc = NULL;
+    }
+  }
+
+  // Make the different multigrid levels, restoring the prolongation from the
+  // checkpoint if one is provided
+  void makeAmgLevels(int _level, int num_levels, bool print_info,
+                     const CheckpointReader* ckpt = nullptr,
+                     const std::string& prefix = "") {
     // Set the multigrid level
     level = _level;
 
@@ -756,8 +853,12 @@ class BSRMatAmg {
       MultiArrayNew<T* [N][N]> Br;
 
       // Find the new level
-      BSRMatSmoothedAmgLevel<T, M, N>(omega, epsilon, *A, B, &Dinv, &P, &PT,
-                                      &Ar, Br, &rho);
+      if (ckpt) {
+        restoreAmgLevel(*ckpt, prefix, &Ar);
+      } else {
+        BSRMatSmoothedAmgLevel<T, M, N>(omega, epsilon, *A, B, &Dinv, &P, &PT,
+                                        &Ar, Br, &rho);
+      }
 
       // Allocate the next level
       auto Anext = std::shared_ptr<BSRMat<T, N, N>>(Ar);
@@ -773,7 +874,42 @@ class BSRMatAmg {
                fmt(rho));
       }
 
-      next->makeAmgLevels(level + 1, num_levels, print_info);
+      next->makeAmgLevels(level + 1, num_levels, print_info, ckpt, prefix);
+    }
+  }
+
+  // Load the prolongation for this level and form the other level operators
+  void restoreAmgLevel(const CheckpointReader& ckpt, const std::string& prefix,
+                       BSRMat<T, N, N>** Ar) {
+    std::string name = prefix + "/level" + std::to_string(level);
+    P = BSRMatLoad<T, M, N>(ckpt, name + "/P");
+    rho = ckpt.read_scalar<T>(name + "/rho");
+    if (P->nbrows != A->nbrows) {
+      char msg[256];
+      std::snprintf(msg, sizeof(msg),
+                    "BSRMatAmg: %s has %d rows, the matrix has %d",
+                    name.c_str(), P->nbrows, A->nbrows);
+      throw std::runtime_error(msg);
+    }
+
+    bool inverse = true;
+    Dinv = BSRMatExtractBlockDiagonal(*A, inverse);
+    PT = BSRMatMakeTranspose(*P);
+
+    // Ar = PT * A * P
+    BSRMat<T, M, N>* AP = BSRMatMatMultSymbolic(*A, *P);
+    BSRMatMatMult(*A, *P, *AP);
+    *Ar = BSRMatMatMultSymbolic(*PT, *AP);
+    BSRMatMatMult(*PT, *AP, **Ar);
+    delete AP;
+  }
+
+  void saveLevels(CheckpointWriter& ckpt, const std::string& prefix) {
+    if (next) {
+      std::string name = prefix + "/level" + std::to_string(level);
+      BSRMatSave(ckpt, name + "/P", *P);
+      ckpt.write_scalar(name + "/rho", rho);
+      next->saveLevels(ckpt, prefix);
     }
   }
 
@@ -786,26 +922,46 @@ class BSRMatAmg {
         BLAS::zero(*x);
       }
       T omega0 = 1.0;
-      BSRApplySSOR(*Dinv, *A, omega0, *b, *x);
+      if (Ac) {
+        CompressedBSRApplySSOR(*Dinv, *Ac, omega0, *b, *x);
+      } else {
+        BSRApplySSOR(*Dinv, *A, omega0, *b, *x);
+      }
 
       // Compute the residuals r = b - A * x
       BLAS::copy(*r, *b);
-      BSRMatVecMultSub(*A, *x, *r);
+      if (Ac) {
+        CompressedBSRMatVecMultSub(*Ac, *x, *r);
+      } else {
+        BSRMatVecMultSub(*A, *x, *r);
+      }
 
       // Now zero the solution on all subsequent levels
       zero_solution = true;
 
       // Restrict the residual to the next lowest level
-      BSRMatVecMult(*PT, *r, *next->b);
+      if (PTc) {
+        CompressedBSRMatVecMult(*PTc, *r, *next->b);
+      } else {
+        BSRMatVecMult(*PT, *r, *next->b);
+      }
 
       // Apply multigrid on the next lowest level
       next->applyMg(zero_solution);
 
       // Interpolate up from the next lowest grid level
-      BSRMatVecMultAdd(*P, *next->x, *x);
+      if (Pc) {
+        CompressedBSRMatVecMultAdd(*Pc, *next->x, *x);
+      } else {
+        BSRMatVecMultAdd(*P, *next->x, *x);
+      }
 
       // Post-smooth
-      BSRApplySSOR(*Dinv, *A, omega0, *b, *x);
+      if (Ac) {
+        CompressedBSRApplySSOR(*Dinv, *Ac, omega0, *b, *x);
+      } else {
+        BSRApplySSOR(*Dinv, *A, omega0, *b, *x);
+      }
     }
   }
 
@@ -831,6 +987,12 @@ class BSRMatAmg {
   // Data for the full factorization (on the lowest level only)
   BSRMat<T, M, M>* Afact;
 
+  // Matrices with compressed column indices used in the cycle, not allocated
+  // by default
+  CompressedBSRMat<T, M, M>* Ac;
+  CompressedBSRMat<T, M, N>* Pc;
+  CompressedBSRMat<T, N, M>* PTc;
+
   // Data for the solution
   MultiArrayNew<T* [M]>* x;
   MultiArrayNew<T* [M]>* b;
@@ -526,6 +526,11 @@ void SparseCholesky<T>::solveDiagTranspose(int diag_size, T *L, int nrhs,
 */
 template <typename T>
 int SparseCholesky<T>::factor() {
+  Timer timer("SparseCholesky::factor()");
+
+  // Flops of the dense operations on the supernodes
+  double flops = 0.0;
+
   int *list = new int[num_snodes];  // List pointer
   int *first = new int[num_snodes];
 
@@ -601,6 +606,7 @@ int SparseCholesky<T>::factor() {
       // updateColumn(nkrows, iremain, &rows[ip_next], work_temp, jrows, jptr);
       updateColumn(diag_size, nkrows, jfirst_var, krows, iremain,
                    &rows[ip_next], work_temp, jrows, jptr);
+      flops += double(ksize) * nkrows * (nkrows + 1 + 2.0 * iremain);
 
       // Move to the next k non-zero
       k = next_k;
@@ -612,6 +618,7 @@ int SparseCholesky<T>::factor() {
     // Compute (A32 - L32 * L21 ) * L21^{-T}
     int nrhs = colp[j + 1] - colp[j];
     solveDiag(diag_size, diag, nrhs, jptr);
+    flops += double(diag_size) * diag_size * (diag_size / 3.0 + nrhs);
 
     // Update the list for this column
     if (colp[j] < colp[j + 1]) {
@@ -626,6 +633,10 @@ int SparseCholesky<T>::factor() {
   delete[] first;
   delete[] work_temp;
 
+  // Each entry of the factor is read and written at least once
+  Timer::count(PerfCounter::FLOPS, flops);
+  Timer::count(PerfCounter::BYTES, 2.0 * data_ptr[num_snodes] * sizeof(T));
+
   return 0;
 }
 
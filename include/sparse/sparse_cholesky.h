@@ -5,6 +5,7 @@
 #include "sparse/sparse_matrix.h"
 #include "sparse/sparse_utils.h"
 #include "utils/a2dlapack.h"
+#include "utils/a2dprofiler.h"
 
 // Include METIS
 extern "C" {
@@ -0,0 +1,721 @@
+#ifndef A2D_SPARSE_EIGEN_H
+#define A2D_SPARSE_EIGEN_H
+
+#include <omp.h>
+
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "array.h"
+#include "parallel.h"
+#include "utils/a2dlapack.h"
+#include "utils/a2dprofiler.h"
+
+namespace A2D {
+
+/*
+  Compute the K x L Gram matrix G = X^{T} * Y of two block vectors, where G is
+  stored in row-major order with leading dimension ldg
+*/
+template <typename T, index_t M, index_t K, index_t L>
+void BlockVecGram(const MultiArrayNew<T* [M][K]>& X,
+                  const MultiArrayNew<T* [M][L]>& Y, T G[], index_t ldg = L) {
+  const index_t nrows = X.extent(0);
+  for (index_t i = 0; i < K; i++) {
+    for (index_t j = 0; j < L; j++) {
+      G[ldg * i + j] = 0.0;
+    }
+  }
+
+#pragma omp parallel
+  {
+    T part[K * L];
+    for (index_t i = 0; i < K * L; i++) {
+      part[i] = 0.0;
+    }
+
+#pragma omp for
+    for (index_t n = 0; n < nrows; n++) {
+      for (index_t m = 0; m < M; m++) {
+        for (index_t i = 0; i < K; i++) {
+          for (index_t j = 0; j < L; j++) {
+            part[L * i + j] += X(n, m, i) * Y(n, m, j);
+          }
+        }
+      }
+    }
+
+#pragma omp critical
+    {
+      for (index_t i = 0; i < K; i++) {
+        for (index_t j = 0; j < L; j++) {
+          G[ldg * i + j] += part[L * i + j];
+        }
+      }
+    }
+  }
+}
+
+/*
+  Compute Y = alpha * X * C + beta * Y for block vectors X and Y, where the
+  K x L matrix C is stored in row-major order with leading dimension ldc
+*/
+template <typename T, index_t M, index_t K, index_t L>
+void BlockVecMult(T alpha, const MultiArrayNew<T* [M][K]>& X, const T C[],
+                  T beta, MultiArrayNew<T* [M][L]>& Y, index_t ldc = L) {
+  parallel_for(
+      X.extent(0), KOKKOS_LAMBDA(index_t n)->void {
+        for (index_t m = 0; m < M; m++) {
+          for (index_t j = 0; j < L; j++) {
+            T value = 0.0;
+            for (index_t i = 0; i < K; i++) {
+              value += X(n, m, i) * C[ldc * i + j];
+            }
+            Y(n, m, j) = alpha * value + beta * Y(n, m, j);
+          }
+        }
+      });
+}
+
+/*
+  Copy column j of the block vector X to x
+*/
+template <typename T, index_t M, index_t K>
+void BlockVecGetColumn(const MultiArrayNew<T* [M][K]>& X, index_t j,
+                       MultiArrayNew<T* [M]>& x) {
+  parallel_for(
+      X.extent(0), KOKKOS_LAMBDA(index_t n)->void {
+        for (index_t m = 0; m < M; m++) {
+          x(n, m) = X(n, m, j);
+        }
+      });
+}
+
+/*
+  Copy x to column j of the block vector X
+*/
+template <typename T, index_t M, index_t K>
+void BlockVecSetColumn(const MultiArrayNew<T* [M]>& x, index_t j,
+                       MultiArrayNew<T* [M][K]>& X) {
+  parallel_for(
+      X.extent(0), KOKKOS_LAMBDA(index_t n)->void {
+        for (index_t m = 0; m < M; m++) {
+          X(n, m, j) = x(n, m);
+        }
+      });
+}
+
+/**
+ * @brief Counters and timing collected by the LOBPCG eigensolver
+ */
+struct LOBPCGStats {
+  bool converged = false;
+  index_t iterations = 0;
+  index_t k_products = 0;     // Products with the stiffness operator
+  index_t m_products = 0;     // Products with the mass operator
+  index_t applications = 0;   // Applications of the preconditioner
+  index_t restarts = 0;       // Iterations that dropped the search directions
+  double t_operator = 0.0;    // Time in the K and M products
+  double t_factor = 0.0;      // Time in the preconditioner
+  double t_subspace = 0.0;    // Time in the Gram and Rayleigh-Ritz steps
+  double t_solve = 0.0;
+
+  void report() const {
+    std::printf("LOBPCG %s in %d iterations\n",
+                converged ? "converged" : "did not converge", iterations);
+    std::printf("  K / M products:      %8d / %d\n", k_products, m_products);
+    std::printf("  preconditioner:      %8d\n", applications);
+    std::printf("  restarts:            %8d\n", restarts);
+    std::printf("  time operators:      %12.4e s\n", t_operator);
+    std::printf("  time preconditioner: %12.4e s\n", t_factor);
+    std::printf("  time subspace:       %12.4e s\n", t_subspace);
+    std::printf("  time solve:          %12.4e s\n", t_solve);
+  }
+};
+
+/**
+ * @brief Locally optimal block preconditioned conjugate gradient (LOBPCG)
+ * eigensolver for the K smallest eigenpairs of K * x = lambda * M * x
+ *
+ * K must be symmetric and M symmetric positive definite on the unconstrained
+ * dofs. The operators are only accessed through products with vectors, so
+ * either an assembled BSRMat or a MatrixFree operator can be used, and the
+ * preconditioner is typically an AMG V-cycle or a sparse Cholesky solve with
+ * K (or a shifted K - sigma * M). Constrained dofs are kept at zero in all the
+ * search directions. The eigenvectors are M-orthonormal on exit.
+ *
+ * For buckling, (K_s + lambda * K_G) * u = 0, pass the geometric stiffness
+ * matrix K_G as K and the stiffness matrix K_s as M. The eigenvalues are
+ * mu = -1/lambda, so the smallest (most negative) mu give the smallest
+ * positive critical load factors lambda = -1/mu.
+ *
+ * @tparam T Scalar type
+ * @tparam M Block size of the vectors
+ * @tparam K Number of eigenpairs
+ */
+template <typename T, index_t M, index_t K>
+class LOBPCG {
+ public:
+  static_assert(std::is_same<T, double>::value,
+                "LOBPCG is only implemented for real double precision");
+
+  using Vec_t = MultiArrayNew<T* [M]>;
+  using BlockVec_t = MultiArrayNew<T* [M][K]>;
+  using Op_t = std::function<void(Vec_t&, Vec_t&)>;
+
+  /**
+   * @param nrows Number of block rows of the vectors
+   * @param kmat Product with the stiffness operator y = K * x
+   * @param mmat Product with the mass operator y = M * x, identity if empty
+   * @param prec Preconditioner y = P^{-1} * x, identity if empty
+   * @param nbcs Number of constrained dofs
+   * @param bc_dofs The constrained dofs
+   */
+  LOBPCG(index_t nrows, Op_t kmat, Op_t mmat = nullptr, Op_t prec = nullptr,
+         index_t nbcs = 0, const index_t* bc_dofs = nullptr)
+      : nrows(nrows),
+        kmat(kmat),
+        mmat(mmat),
+        prec(prec),
+        bc_dofs(bc_dofs, bc_dofs + nbcs),
+        x("x", nrows),
+        y("y", nrows),
+        X("X", nrows),
+        KX("KX", nrows),
+        MX("MX", nrows),
+        W("W", nrows),
+        KW("KW", nrows),
+        MW("MW", nrows),
+        P("P", nrows),
+        KP("KP", nrows),
+        MP("MP", nrows),
+        Pn("Pn", nrows),
+        KPn("KPn", nrows),
+        MPn("MPn", nrows) {
+    for (index_t i = 0; i < K; i++) {
+      lambda[i] = 0.0;
+      res_norms[i] = 0.0;
+    }
+  }
+
+  /**
+   * @brief Compute the eigenpairs
+   *
+   * Converged pairs are soft locked: they stay in the Rayleigh-Ritz
+   * projection, but their residual and search directions are dropped, so the
+   * iterations continue on the active pairs only.
+   *
+   * @param max_iters Maximum number of iterations
+   * @param rtol Tolerance on |K * x - lambda * M * x| / |K * x| for every pair
+   * @param monitor Print the residual norms every monitor iterations
+   * @param use_initial Start from the values in get_eigenvectors() instead of
+   * a random block
+   * @return true if all the eigenpairs converged
+   */
+  bool solve(index_t max_iters = 200, double rtol = 1e-8, index_t monitor = 0,
+             bool use_initial = false) {
+    Timer timer("LOBPCG::solve()");
+    StopWatch watch;
+    stats.converged = false;
+
+    if (!use_initial) {
+      BLAS::random(X);
+    }
+    zero_bcs(X);
+    apply_mass(X, MX, K);
+    if (orthonormalize(X, MX, nullptr, K) < K) {
+      throw std::runtime_error(
+          "LOBPCG: the initial block is rank deficient in the M-norm");
+    }
+    apply_stiffness(X, KX, K);
+
+    // Rotate the initial block to the Ritz vectors
+    std::vector<T> A(K * K), B(K * K), Y(K * K);
+    BlockVecGram(X, KX, A.data());
+    BlockVecGram(X, MX, B.data());
+    if (!rayleigh_ritz(K, A, B, Y)) {
+      throw std::runtime_error("LOBPCG: initial Rayleigh-Ritz step failed");
+    }
+    rotate(X, Y.data());
+    rotate(KX, Y.data());
+    rotate(MX, Y.data());
+
+    // Diagonal matrix for forming the residuals
+    T C[K * K];
+    for (index_t i = 0; i < K * K; i++) {
+      C[i] = 0.0;
+    }
+
+    // The active (unconverged) pairs and the number of columns of P
+    bool active[K];
+    for (index_t j = 0; j < K; j++) {
+      active[j] = true;
+    }
+    index_t np = 0;
+
+    // KX and MX are updated with the same recurrence as X and drift from the
+    // products with X. Recompute them explicitly once the residuals approach
+    // the tolerance, where the drift would stall the convergence.
+    bool refresh = false;
+
+    index_t iter = 0;
+    for (; iter < max_iters; iter++) {
+      if (refresh) {
+        apply_stiffness(X, KX, K);
+        apply_mass(X, MX, K);
+      }
+
+      // W = K * X - M * X * diag(lambda)
+      BLAS::copy(W, KX);
+      for (index_t j = 0; j < K; j++) {
+        C[(K + 1) * j] = -lambda[j];
+      }
+      BlockVecMult(T(1.0), MX, C, T(1.0), W);
+      zero_bcs(W);
+
+      T rr[K * K], kk[K * K];
+      BlockVecGram(W, W, rr);
+      BlockVecGram(KX, KX, kk);
+      double max_res = 0.0;
+      index_t nact = 0;
+      for (index_t j = 0; j < K; j++) {
+        res_norms[j] = std::sqrt(std::fabs(rr[(K + 1) * j]) /
+                                 std::fabs(kk[(K + 1) * j]));
+        max_res = std::max(max_res, res_norms[j]);
+        active[j] = active[j] && !(res_norms[j] < rtol);
+        nact += active[j];
+      }
+
+      if (monitor && iter % monitor == 0) {
+        std::printf(
+            "LOBPCG |r|/|K * x|[%3d]: %15.6e  lambda[0]: %15.6e  active: %d\n",
+            iter, max_res, lambda[0], nact);
+      }
+      if (nact == 0) {
+        stats.converged = true;
+        break;
+      }
+      refresh = max_res < std::sqrt(rtol);
+
+      // Keep the residual and search directions of the active pairs
+      select_active(active, W);
+      if (np > 0) {
+        select_active(active, P);
+        select_active(active, KP);
+        select_active(active, MP);
+        np = nact;
+      }
+
+      // Precondition the residuals and make them M-orthogonal to X
+      apply_prec(W, Pn, nact);
+      zero_bcs(Pn);
+      T xw[K * K];
+      BlockVecGram(MX, Pn, xw);
+      BLAS::copy(W, Pn);
+      BlockVecMult(T(-1.0), X, xw, T(1.0), W);
+      apply_mass(W, MW, nact);
+      const index_t nw = orthonormalize(W, MW, nullptr, nact);
+      if (nw == 0 && np == 0) {
+        break;
+      }
+      apply_stiffness(W, KW, nw);
+
+      if (np > 0) {
+        const index_t rank = orthonormalize(P, MP, &KP, np);
+        if (rank < np) {
+          stats.restarts++;
+        }
+        np = rank;
+      }
+
+      // Solve the projected problem on span{X, W, P}, dropping P if the
+      // basis is numerically dependent
+      StopWatch subspace_watch;
+      bool flag = false;
+      while (!flag) {
+        const index_t nblocks = np > 0 ? 3 : 2;
+        const index_t size[3] = {K, nw, np};
+        const index_t offset[3] = {0, K, K + nw};
+        const index_t ns = K + nw + np;
+        const BlockVec_t* S[3] = {&X, &W, &P};
+        const BlockVec_t* KS[3] = {&KX, &KW, &KP};
+        const BlockVec_t* MS[3] = {&MX, &MW, &MP};
+
+        A.resize(ns * ns);
+        B.resize(ns * ns);
+        Y.resize(ns * K);
+        T ga[K * K], gb[K * K];
+        for (index_t bi = 0; bi < nblocks; bi++) {
+          for (index_t bj = bi; bj < nblocks; bj++) {
+            BlockVecGram(*S[bi], *KS[bj], ga);
+            BlockVecGram(*S[bi], *MS[bj], gb);
+            for (index_t i = 0; i < size[bi]; i++) {
+              for (index_t j = 0; j < size[bj]; j++) {
+                const index_t ij = ns * (offset[bi] + i) + offset[bj] + j;
+                A[ij] = ga[K * i + j];
+                B[ij] = gb[K * i + j];
+              }
+            }
+          }
+        }
+        for (index_t i = 0; i < ns; i++) {
+          for (index_t j = 0; j < i; j++) {
+            A[ns * i + j] = A[ns * j + i];
+            B[ns * i + j] = B[ns * j + i];
+          }
+        }
+
+        flag = rayleigh_ritz(ns, A, B, Y);
+        if (!flag) {
+          if (np == 0) {
+            break;
+          }
+          np = 0;
+          stats.restarts++;
+        }
+      }
+      stats.t_subspace += subspace_watch.lap();
+      if (!flag) {
+        break;
+      }
+
+      // Split Y into the coefficients of X, W and P, padded with zero rows
+      T Yx[K * K], Yw[K * K], Yp[K * K];
+      for (index_t i = 0; i < K; i++) {
+        for (index_t j = 0; j < K; j++) {
+          Yx[K * i + j] = Y[K * i + j];
+          Yw[K * i + j] = (i < nw ? Y[K * (K + i) + j] : 0.0);
+          Yp[K * i + j] = (i < np ? Y[K * (K + nw + i) + j] : 0.0);
+        }
+      }
+
+      // P = W * Yw + P * Yp and X = X * Yx + P
+      BlockVecMult(T(1.0), W, Yw, T(0.0), Pn);
+      BlockVecMult(T(1.0), KW, Yw, T(0.0), KPn);
+      BlockVecMult(T(1.0), MW, Yw, T(0.0), MPn);
+      if (np > 0) {
+        BlockVecMult(T(1.0), P, Yp, T(1.0), Pn);
+        BlockVecMult(T(1.0), KP, Yp, T(1.0), KPn);
+        BlockVecMult(T(1.0), MP, Yp, T(1.0), MPn);
+      }
+      std::swap(P, Pn);
+      std::swap(KP, KPn);
+      std::swap(MP, MPn);
+      np = K;
+
+      BlockVecMult(T(1.0), X, Yx, T(0.0), Pn);
+      BlockVecMult(T(1.0), KX, Yx, T(0.0), KPn);
+      BlockVecMult(T(1.0), MX, Yx, T(0.0), MPn);
+      std::swap(X, Pn);
+      std::swap(KX, KPn);
+      std::swap(MX, MPn);
+      BLAS::axpy(X, T(1.0), P);
+      BLAS::axpy(KX, T(1.0), KP);
+      BLAS::axpy(MX, T(1.0), MP);
+    }
+
+    stats.iterations += iter;
+    stats.t_solve += watch.lap();
+    return stats.converged;
+  }
+
+  /**
+   * @brief Get the i-th eigenvalue in ascending order
+   */
+  T get_eigenvalue(index_t i) const { return lambda[i]; }
+
+  /**
+   * @brief Get the relative residual norm of the i-th eigenpair from the
+   * last iteration
+   */
+  double get_residual_norm(index_t i) const { return res_norms[i]; }
+
+  /**
+   * @brief Get the block of M-orthonormal eigenvectors
+   */
+  BlockVec_t& get_eigenvectors() { return X; }
+
+  /**
+   * @brief Copy the i-th eigenvector to vec
+   */
+  void get_eigenvector(index_t i, Vec_t& vec) { BlockVecGetColumn(X, i, vec); }
+
+  const LOBPCGStats& get_stats() const { return stats; }
+  void report() const { stats.report(); }
+
+ private:
+  // Zero the constrained dofs in all the columns of V
+  void zero_bcs(BlockVec_t& V) {
+    for (index_t dof : bc_dofs) {
+      for (index_t j = 0; j < K; j++) {
+        V(dof / M, dof % M, j) = 0.0;
+      }
+    }
+  }
+
+  // Apply an operator to the first n columns of V and zero the rest of U
+  void apply_columns(const Op_t& op, BlockVec_t& V, BlockVec_t& U,
+                     index_t n) {
+    for (index_t j = 0; j < n; j++) {
+      BlockVecGetColumn(V, j, x);
+      op(x, y);
+      BlockVecSetColumn(y, j, U);
+    }
+    if (n < K) {
+      BLAS::zero(y);
+      for (index_t j = n; j < K; j++) {
+        BlockVecSetColumn(y, j, U);
+      }
+    }
+  }
+
+  void apply_stiffness(BlockVec_t& V, BlockVec_t& U, index_t n) {
+    StopWatch watch;
+    apply_columns(kmat, V, U, n);
+    stats.k_products += n;
+    stats.t_operator += watch.lap();
+  }
+
+  void apply_mass(BlockVec_t& V, BlockVec_t& U, index_t n) {
+    StopWatch watch;
+    if (mmat) {
+      apply_columns(mmat, V, U, n);
+      stats.m_products += n;
+    } else {
+      BLAS::copy(U, V);
+    }
+    stats.t_operator += watch.lap();
+  }
+
+  void apply_prec(BlockVec_t& V, BlockVec_t& U, index_t n) {
+    StopWatch watch;
+    if (prec) {
+      apply_columns(prec, V, U, n);
+      stats.applications += n;
+    } else {
+      BLAS::copy(U, V);
+    }
+    stats.t_factor += watch.lap();
+  }
+
+  // Move the columns of the active pairs to the front of V and zero the rest
+  void select_active(const bool active[], BlockVec_t& V) {
+    T C[K * K];
+    for (index_t i = 0; i < K * K; i++) {
+      C[i] = 0.0;
+    }
+    for (index_t i = 0, n = 0; i < K; i++) {
+      if (active[i]) {
+        C[K * i + n] = 1.0;
+        n++;
+      }
+    }
+    rotate(V, C);
+  }
+
+  /*
+    M-orthonormalize the first n columns of the block V with two Cholesky QR
+    passes. Each pass scales the columns to unit M-norm and factors
+    V^{T} * M * V = D * L * L^{T} * D one column at a time, dropping the
+    columns whose pivot shows they are numerically dependent on the previous
+    ones. The retained columns are replaced by V * D^{-1} * L^{-T} and moved to
+    the front, and the remaining columns are zeroed. The same transformation
+    is applied to MV and KV. Returns the number of retained columns.
+  */
+  index_t orthonormalize(BlockVec_t& V, BlockVec_t& MV, BlockVec_t* KV,
+                         index_t n) {
+    for (index_t pass = 0; pass < 2 && n > 0; pass++) {
+      std::vector<T> G(K * K);
+      BlockVecGram(V, MV, G.data());
+
+      T scale[K], L[K * K];
+      index_t index[K];
+      index_t rank = 0;
+      for (index_t i = 0; i < n; i++) {
+        if (!(G[(K + 1) * i] > 0.0)) {
+          continue;
+        }
+        scale[i] = 1.0 / std::sqrt(G[(K + 1) * i]);
+
+        // Row of L for column i against the retained columns
+        T d = 1.0;
+        for (index_t k = 0; k < rank; k++) {
+          const index_t c = index[k];
+          T value = scale[i] * scale[c] * G[K * c + i];
+          for (index_t m = 0; m < k; m++) {
+            value -= L[K * k + m] * L[K * rank + m];
+          }
+          L[K * rank + k] = value / L[K * k + k];
+          d -= L[K * rank + k] * L[K * rank + k];
+        }
+        if (d > drop_tol) {
+          L[K * rank + rank] = std::sqrt(d);
+          index[rank] = i;
+          rank++;
+        }
+      }
+
+      // Form C = D^{-1} * L^{-T} column by column in the retained rows
+      T C[K * K];
+      for (index_t i = 0; i < K * K; i++) {
+        C[i] = 0.0;
+      }
+      for (index_t j = 0; j < rank; j++) {
+        T z[K];
+        for (index_t i = rank; i-- > 0;) {
+          T value = (i == j ? 1.0 : 0.0);
+          for (index_t k = i + 1; k < rank; k++) {
+            value -= L[K * k + i] * z[k];
+          }
+          z[i] = value / L[K * i + i];
+        }
+        for (index_t i = 0; i < rank; i++) {
+          C[K * index[i] + j] = scale[index[i]] * z[i];
+        }
+      }
+
+      rotate(V, C);
+      rotate(MV, C);
+      if (KV) {
+        rotate(*KV, C);
+      }
+      n = rank;
+    }
+
+    return n;
+  }
+
+  // Replace V <- V * C
+  void rotate(BlockVec_t& V, const T C[]) {
+    BlockVecMult(T(1.0), V, C, T(0.0), Pn);
+    BLAS::copy(V, Pn);
+  }
+
+  /*
+    Compute the Cholesky factorization A = L * L^{T} in place for a dense
+    row-major matrix. Returns false if a pivot is not sufficiently positive.
+  */
+  static bool cholesky(index_t n, std::vector<T>& A) {
+    double max_diag = 0.0;
+    for (index_t i = 0; i < n; i++) {
+      max_diag = std::max(max_diag, std::fabs(A[n * i + i]));
+    }
+
+    for (index_t k = 0; k < n; k++) {
+      T d = A[n * k + k];
+      for (index_t j = 0; j < k; j++) {
+        d -= A[n * k + j] * A[n * k + j];
+      }
+      if (!(d > 1e-14 * max_diag)) {
+        return false;
+      }
+      A[n * k + k] = std::sqrt(d);
+
+      for (index_t i = k + 1; i < n; i++) {
+        T t = A[n * i + k];
+        for (index_t j = 0; j < k; j++) {
+          t -= A[n * i + j] * A[n * k + j];
+        }
+        A[n * i + k] = t / A[n * k + k];
+      }
+    }
+
+    return true;
+  }
+
+  /*
+    Solve the dense problem A * y = theta * B * y of size n and store the K
+    smallest eigenvalues in lambda and their B-orthonormal eigenvectors in
+    the n x K row-major matrix Y. B is overwritten by its Cholesky factor.
+  */
+  bool rayleigh_ritz(index_t n, std::vector<T>& A, std::vector<T>& B,
+                     std::vector<T>& Y) {
+    if (!cholesky(n, B)) {
+      return false;
+    }
+
+    // A <- L^{-1} * A * L^{-T}, applied to the columns and then the rows
+    for (index_t j = 0; j < n; j++) {
+      for (index_t i = 0; i < n; i++) {
+        T value = A[n * i + j];
+        for (index_t k = 0; k < i; k++) {
+          value -= B[n * i + k] * A[n * k + j];
+        }
+        A[n * i + j] = value / B[n * i + i];
+      }
+    }
+    for (index_t i = 0; i < n; i++) {
+      for (index_t j = 0; j < n; j++) {
+        T value = A[n * i + j];
+        for (index_t k = 0; k < j; k++) {
+          value -= B[n * j + k] * A[n * i + k];
+        }
+        A[n * i + j] = value / B[n * j + j];
+      }
+    }
+
+    // Pack the upper triangle in column-major order for LAPACK
+    std::vector<double> ap(n * (n + 1) / 2), w(n), z(n * n), work(3 * n);
+    for (index_t j = 0; j < n; j++) {
+      for (index_t i = 0; i <= j; i++) {
+        ap[i + j * (j + 1) / 2] = 0.5 * (A[n * i + j] + A[n * j + i]);
+      }
+    }
+
+    int size = n, ldz = n, info = 0;
+    LAPACKdspev("V", "U", &size, ap.data(), w.data(), z.data(), &ldz,
+                work.data(), &info);
+    if (info != 0) {
+      return false;
+    }
+
+    // Y = L^{-T} * Z for the first K eigenvectors
+    for (index_t j = 0; j < K; j++) {
+      lambda[j] = w[j];
+      for (index_t i = n; i-- > 0;) {
+        T value = z[n * j + i];
+        for (index_t k = i + 1; k < n; k++) {
+          value -= B[n * k + i] * Y[K * k + j];
+        }
+        Y[K * i + j] = value / B[n * i + i];
+      }
+    }
+
+    return true;
+  }
+
+  // Number of block rows
+  index_t nrows;
+
+  // The operators
+  Op_t kmat, mmat, prec;
+
+  // The constrained dofs
+  std::vector<index_t> bc_dofs;
+
+  // Vectors for the column-wise operator products
+  Vec_t x, y;
+
+  // The eigenvectors, residual directions, search directions and products
+  BlockVec_t X, KX, MX;
+  BlockVec_t W, KW, MW;
+  BlockVec_t P, KP, MP;
+  BlockVec_t Pn, KPn, MPn;
+
+  // Relative pivot below which a column is dropped in orthonormalize()
+  static constexpr double drop_tol = 1e-12;
+
+  // The eigenvalues and residual norms
+  T lambda[K];
+  double res_norms[K];
+
+  LOBPCGStats stats;
+};
+
+}  // namespace A2D
+
+#endif  // A2D_SPARSE_EIGEN_H
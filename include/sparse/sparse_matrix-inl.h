@@ -89,6 +89,98 @@ void BSRMat<T, M, N>::to_dense(index_t *m_, index_t *n_, T **A_) {
   *n_ = n;
 }
 
+// Find the value index of the stored block (row, col) with row <= col
+template <typename T, index_t M>
+index_t SymBSRMat<T, M>::find_value_index(index_t row, index_t col) {
+  for (index_t jp = rowp[row]; jp < rowp[row + 1]; jp++) {
+    if (cols[jp] == col) {
+      return jp;
+    }
+  }
+
+  return NO_INDEX;
+}
+
+// Add the entries of a symmetric element matrix in the stored blocks
+template <typename T, index_t M>
+template <class Mat>
+void SymBSRMat<T, M>::add_values(const index_t m, const index_t i[],
+                                 const index_t n, const index_t j[],
+                                 Mat &mat) {
+  for (index_t ii = 0; ii < m; ii++) {
+    index_t block_row = i[ii] / M;
+    index_t local_row = i[ii] % M;
+
+    for (index_t jj = 0; jj < n; jj++) {
+      index_t block_col = j[jj] / M;
+      index_t local_col = j[jj] % M;
+
+      if (block_row <= block_col) {
+        index_t jp = find_value_index(block_row, block_col);
+        if (jp != NO_INDEX) {
+          vals(jp, local_row, local_col) += mat(ii, jj);
+        }
+      }
+    }
+  }
+}
+
+// Zero out rows and columns and set diagonal entry to one for each dof
+template <typename T, index_t M>
+void SymBSRMat<T, M>::zero_rows(const index_t nbcs, const index_t dof[]) {
+  std::vector<char> flag(M * nbrows, 0);
+  for (index_t ii = 0; ii < nbcs; ii++) {
+    flag[dof[ii]] = 1;
+  }
+
+  for (index_t i = 0; i < nbrows; i++) {
+    for (index_t jp = rowp[i]; jp < rowp[i + 1]; jp++) {
+      index_t j = cols[jp];
+
+      for (index_t ii = 0; ii < M; ii++) {
+        for (index_t jj = 0; jj < M; jj++) {
+          if (flag[M * i + ii] || flag[M * j + jj]) {
+            vals(jp, ii, jj) = 0.0;
+          }
+        }
+      }
+
+      if (i == j) {
+        for (index_t ii = 0; ii < M; ii++) {
+          if (flag[M * i + ii]) {
+            vals(jp, ii, ii) = 1.0;
+          }
+        }
+      }
+    }
+  }
+}
+
+// Convert to a dense matrix
+template <typename T, index_t M>
+void SymBSRMat<T, M>::to_dense(index_t *m_, index_t *n_, T **A_) {
+  index_t n = M * nbrows;
+  T *A = new T[n * n];
+  std::fill(A, A + n * n, T(0.0));
+
+  for (index_t i = 0; i < nbrows; i++) {
+    for (index_t jp = rowp[i]; jp < rowp[i + 1]; jp++) {
+      index_t j = cols[jp];
+
+      for (index_t ii = 0; ii < M; ii++) {
+        for (index_t jj = 0; jj < M; jj++) {
+          A[n * (M * i + ii) + M * j + jj] = vals(jp, ii, jj);
+          A[n * (M * j + jj) + M * i + ii] = vals(jp, ii, jj);
+        }
+      }
+    }
+  }
+
+  *A_ = A;
+  *m_ = n;
+  *n_ = n;
+}
+
 // Export the matrix as mtx format
 template <typename T, index_t M, index_t N>
 void BSRMat<T, M, N>::write_mtx(const std::string mtx_name, double epsilon) {
@@ -1,7 +1,9 @@
 #ifndef A2D_SPARSE_MATRIX_H
 #define A2D_SPARSE_MATRIX_H
 
+#include <algorithm>
 #include <string>
+#include <vector>
 
 #include "a2ddefs.h"
 #include "array.h"
@@ -173,6 +175,256 @@ class BSRMat {
   MultiArrayNew<T *[M][N]> vals;
 };
 
+/**
+ * @brief Symmetric block compressed sparse row matrix
+ *
+ * Only the diagonal blocks and the blocks above the diagonal (cols[jp] >= row)
+ * are stored, which halves the memory and bandwidth of the off-diagonal part
+ * of a symmetric matrix. The diagonal blocks, when present, are stored in
+ * full. Use SymBSRMatFromBSRMat() to create the matrix from the non-zero
+ * pattern of a full BSRMat.
+ *
+ * @tparam T data type
+ * @tparam M number of rows and columns for each block
+ */
+template <typename T, index_t M>
+class SymBSRMat {
+ public:
+  /**
+   * @brief Constructor
+   *
+   * @tparam VecType a vector type
+   * @param nbrows number of rows (and columns) of blocks
+   * @param nnz number of stored non-zero blocks
+   * @param rowp_ vector of row pointers
+   * @param cols_ vector of column indices, cols_[jp] >= row for each row
+   */
+  template <class VecType>
+  SymBSRMat(index_t nbrows, index_t nnz, const VecType &rowp_,
+            const VecType &cols_)
+      : nbrows(nbrows),
+        nbcols(nbrows),
+        nnz(nnz),
+        num_diag(0),
+        rowp("rowp", nbrows + 1),
+        cols("cols", nnz),
+        num_colors(0),
+        vals("vals", nnz) {
+    for (index_t i = 0; i < nbrows + 1; i++) {
+      rowp[i] = rowp_[i];
+    }
+
+    for (index_t i = 0; i < nnz; i++) {
+      cols[i] = cols_[i];
+    }
+
+    for (index_t i = 0; i < nbrows; i++) {
+      for (index_t jp = rowp[i]; jp < rowp[i + 1]; jp++) {
+        if (cols[jp] == i) {
+          num_diag++;
+        }
+      }
+    }
+  }
+
+  SymBSRMat() = default;
+
+  /**
+   * @brief Copy constructor (shallow copy)
+   */
+  KOKKOS_FUNCTION SymBSRMat(const SymBSRMat &src)
+      : nbrows(src.nbrows),
+        nbcols(src.nbcols),
+        nnz(src.nnz),
+        num_diag(src.num_diag),
+        rowp(src.rowp),
+        cols(src.cols),
+        perm(src.perm),
+        num_colors(src.num_colors),
+        color_count(src.color_count),
+        vals(src.vals) {}
+
+  KOKKOS_FUNCTION ~SymBSRMat() = default;
+
+  // Zero the entries of the matrix
+  KOKKOS_FUNCTION void zero() { BLAS::zero(vals); }
+
+  /**
+   * @brief Find the value index of the stored block (row, col), row <= col
+   *
+   * @return the index jp such that vals[jp] is the block or NO_INDEX
+   */
+  index_t find_value_index(index_t row, index_t col);
+
+  /**
+   * @brief Add values from a symmetric element matrix mat of shape (m, n)
+   *
+   * Only the entries that fall into the stored blocks are added, so the
+   * element matrix must be symmetric.
+   */
+  template <class Mat>
+  void add_values(const index_t m, const index_t i[], const index_t n,
+                  const index_t j[], Mat &mat);
+
+  /**
+   * @brief Zero out the rows and columns and set the diagonal entry to one
+   * for each constrained dof, which preserves the symmetry
+   *
+   * @param nbcs number of global rows and columns to zero-out
+   * @param dof global dof indices
+   */
+  void zero_rows(const index_t nbcs, const index_t dof[]);
+
+  /**
+   * @brief Convert to a dense matrix with both triangles
+   */
+  void to_dense(index_t *m_, index_t *n_, T **A_);
+
+  // Number of block rows and block columns
+  index_t nbrows, nbcols;
+
+  // Number of stored non-zero blocks
+  index_t nnz;
+
+  // Number of stored diagonal blocks
+  index_t num_diag;
+
+  // rowp and cols array
+  IdxArray1D_t rowp;  // length: nbrows + 1
+  IdxArray1D_t cols;  // length: nnz = rowp[nbrows]
+
+  // Rows sorted by color such that rows of the same color do not update the
+  // same entries in the product with the matrix, not allocated by default
+  IdxArray1D_t perm;
+  index_t num_colors;
+  IdxArray1D_t color_count;
+
+  // A multi-dimensional array that stores entries, shape: (nnz, M, M)
+  MultiArrayNew<T *[M][M]> vals;
+};
+
+/**
+ * @brief Block compressed sparse row matrix with compressed column indices
+ *
+ * The block column indices of each row are stored as the smallest column
+ * index of the row and the offsets of the columns from it. The offsets are
+ * stored as 16-bit integers when the column span of every row is less than
+ * 2^16, otherwise they fall back to 32-bit integers. For small blocks, where
+ * the column indices are a large part of the data streamed by the
+ * matrix-vector product, this reduces the memory traffic. Use
+ * BSRMatCompressIndex() to create the matrix from a BSRMat.
+ *
+ * @tparam T data type
+ * @tparam M number of rows for each block
+ * @tparam N number of columns for each block
+ */
+template <typename T, index_t M, index_t N>
+class CompressedBSRMat {
+ public:
+  /**
+   * @brief Constructor
+   *
+   * @tparam VecType a vector type
+   * @param nbrows number of rows of blocks
+   * @param nbcols number of columns of blocks
+   * @param nnz number of non-zero blocks
+   * @param rowp_ vector of row pointers
+   * @param cols_ vector of column indices
+   * @param vals_ the values with shape (nnz, M, N), shared with the matrix
+   */
+  template <class VecType>
+  CompressedBSRMat(index_t nbrows, index_t nbcols, index_t nnz,
+                   const VecType &rowp_, const VecType &cols_,
+                   MultiArrayNew<T *[M][N]> vals_)
+      : nbrows(nbrows),
+        nbcols(nbcols),
+        nnz(nnz),
+        rowp("rowp", nbrows + 1),
+        base("base", nbrows),
+        num_colors(0),
+        vals(vals_) {
+    index_t max_offset = 0;
+    for (index_t i = 0; i < nbrows; i++) {
+      rowp[i] = rowp_[i];
+
+      // Empty rows have a zero base
+      index_t col_min = rowp_[i] < rowp_[i + 1] ? cols_[rowp_[i]] : 0;
+      index_t col_max = col_min;
+      for (index_t jp = rowp_[i]; jp < rowp_[i + 1]; jp++) {
+        col_min = std::min(col_min, index_t(cols_[jp]));
+        col_max = std::max(col_max, index_t(cols_[jp]));
+      }
+      base[i] = col_min;
+      max_offset = std::max(max_offset, col_max - col_min);
+    }
+    rowp[nbrows] = rowp_[nbrows];
+
+    if (max_offset <= 0xffff) {
+      offsets16 = MultiArrayNew<uint16_t *>("offsets16", nnz);
+    } else {
+      offsets32 = IdxArray1D_t("offsets32", nnz);
+    }
+    for (index_t i = 0; i < nbrows; i++) {
+      for (index_t jp = rowp_[i]; jp < rowp_[i + 1]; jp++) {
+        if (offsets16.is_allocated()) {
+          offsets16[jp] = cols_[jp] - base[i];
+        } else {
+          offsets32[jp] = cols_[jp] - base[i];
+        }
+      }
+    }
+  }
+
+  CompressedBSRMat() = default;
+
+  /**
+   * @brief Copy constructor (shallow copy)
+   */
+  KOKKOS_FUNCTION CompressedBSRMat(const CompressedBSRMat &src)
+      : nbrows(src.nbrows),
+        nbcols(src.nbcols),
+        nnz(src.nnz),
+        rowp(src.rowp),
+        base(src.base),
+        offsets16(src.offsets16),
+        offsets32(src.offsets32),
+        perm(src.perm),
+        num_colors(src.num_colors),
+        color_count(src.color_count),
+        vals(src.vals) {}
+
+  KOKKOS_FUNCTION ~CompressedBSRMat() = default;
+
+  // Number of bytes of the row pointers, base columns and column offsets
+  double get_index_bytes() const {
+    double offset_size =
+        offsets16.is_allocated() ? sizeof(uint16_t) : sizeof(index_t);
+    return (2.0 * nbrows + 1.0) * sizeof(index_t) + nnz * offset_size;
+  }
+
+  // Number of block rows and block columns
+  index_t nbrows, nbcols;
+
+  // Number of non-zero blocks
+  index_t nnz;
+
+  // Row pointers and the smallest column index of each row
+  IdxArray1D_t rowp;  // length: nbrows + 1
+  IdxArray1D_t base;  // length: nbrows
+
+  // Column offsets from the base, only one of the two is allocated
+  MultiArrayNew<uint16_t *> offsets16;  // length: nnz
+  IdxArray1D_t offsets32;               // length: nnz
+
+  // Coloring of the rows copied from the BSRMat, not allocated by default
+  IdxArray1D_t perm;
+  index_t num_colors;
+  IdxArray1D_t color_count;
+
+  // A multi-dimensional array that stores entries, shape: (nnz, M, N)
+  MultiArrayNew<T *[M][N]> vals;
+};
+
 /**
  * @brief Compressed sparse row matrix
  */
@@ -1,6 +1,7 @@
 #ifndef A2D_SPARSE_NUMERIC_H
 #define A2D_SPARSE_NUMERIC_H
 
+#include <limits>
 #include <stdexcept>
 
 #include "array.h"
@@ -84,41 +85,96 @@ void BSRMatAddElementMatrices(ConnArray &conn, JacArray &jac,
 }
 
 /*
-  Compute the matrix-vector product: y = A * x
+  Count the blocks, flops and bytes of a product with the BSR matrix for the
+  profiler. The output vector is accessed y_access times.
 */
 template <typename T, index_t M, index_t N>
-void BSRMatVecMult(BSRMat<T, M, N> &A, MultiArrayNew<T *[N]> &x,
-                   MultiArrayNew<T *[M]> &y) {
+void BSRMatVecMultCount(BSRMat<T, M, N> &A, index_t y_access) {
+  Timer::count(PerfCounter::BLOCKS, A.nnz);
+  Timer::count(PerfCounter::FLOPS, 2.0 * M * N * A.nnz);
+  Timer::count(PerfCounter::BYTES,
+               double(A.nnz) * (M * N * sizeof(T) + sizeof(index_t)) +
+                   (A.nbrows + 1.0) * sizeof(index_t) +
+                   (double(A.nbcols) * N + y_access * A.nbrows * M) *
+                       sizeof(T));
+}
+
+/*
+  Column accessor of BSRMat for the shared kernels, col(i, jp) returns the
+  block column of the jp-th block, which is in row i
+*/
+struct BSRColumns {
+  KOKKOS_FUNCTION index_t operator()(index_t i, index_t jp) const {
+    return cols[jp];
+  }
+
+  IdxArray1D_t cols;
+};
+
+/*
+  Column accessor of CompressedBSRMat, the columns are stored as offsets from
+  the smallest column of each row
+*/
+template <class OffsetArray>
+struct CompressedBSRColumns {
+  KOKKOS_FUNCTION index_t operator()(index_t i, index_t jp) const {
+    return base[i] + offsets[jp];
+  }
+
+  IdxArray1D_t base;
+  OffsetArray offsets;
+};
+
+/*
+  Compute y = A * x (sign = 0), y += A * x (sign = 1) or y -= A * x
+  (sign = -1) for a BSRMat or a CompressedBSRMat A, where col gives the
+  column of each block
+*/
+template <int sign, typename T, index_t M, index_t N, class MatType,
+          class ColAccessor>
+void BSRMatVecMultImpl(MatType &A, const ColAccessor col,
+                       MultiArrayNew<T *[N]> &x, MultiArrayNew<T *[M]> &y) {
   parallel_for(
       A.nbrows, KOKKOS_LAMBDA(index_t i)->void {
-        for (index_t ii = 0; ii < M; ii++) {
-          y(i, ii) = T(0);
+        if constexpr (sign == 0) {
+          for (index_t ii = 0; ii < M; ii++) {
+            y(i, ii) = T(0);
+          }
         }
 
         const index_t jp_end = A.rowp[i + 1];
         for (index_t jp = A.rowp[i]; jp < jp_end; jp++) {
-          index_t j = A.cols[jp];
+          index_t j = col(i, jp);
 
-          blockGemvAddSlice<T, M, N>(A.vals, jp, x, j, y, i);
+          if constexpr (sign >= 0) {
+            blockGemvAddSlice<T, M, N>(A.vals, jp, x, j, y, i);
+          } else {
+            blockGemvSubSlice<T, M, N>(A.vals, jp, x, j, y, i);
+          }
         }
       });
 }
 
+/*
+  Compute the matrix-vector product: y = A * x
+*/
+template <typename T, index_t M, index_t N>
+void BSRMatVecMult(BSRMat<T, M, N> &A, MultiArrayNew<T *[N]> &x,
+                   MultiArrayNew<T *[M]> &y) {
+  Timer t("BSRMatVecMult()");
+  BSRMatVecMultCount(A, 1);
+  BSRMatVecMultImpl<0, T, M, N>(A, BSRColumns{A.cols}, x, y);
+}
+
 /*
   Compute the matrix-vector product: y += A * x
 */
 template <typename T, index_t M, index_t N>
 void BSRMatVecMultAdd(BSRMat<T, M, N> &A, MultiArrayNew<T *[N]> &x,
                       MultiArrayNew<T *[M]> &y) {
-  parallel_for(
-      A.nbrows, KOKKOS_LAMBDA(index_t i)->void {
-        const index_t jp_end = A.rowp[i + 1];
-        for (index_t jp = A.rowp[i]; jp < jp_end; jp++) {
-          index_t j = A.cols[jp];
-
-          blockGemvAddSlice<T, M, N>(A.vals, jp, x, j, y, i);
-        }
-      });
+  Timer t("BSRMatVecMultAdd()");
+  BSRMatVecMultCount(A, 2);
+  BSRMatVecMultImpl<1, T, M, N>(A, BSRColumns{A.cols}, x, y);
 }
 
 /*
@@ -127,15 +183,134 @@ void BSRMatVecMultAdd(BSRMat<T, M, N> &A, MultiArrayNew<T *[N]> &x,
 template <typename T, index_t M, index_t N>
 void BSRMatVecMultSub(BSRMat<T, M, N> &A, MultiArrayNew<T *[N]> &x,
                       MultiArrayNew<T *[M]> &y) {
-  parallel_for(
-      A.nbrows, KOKKOS_LAMBDA(index_t i)->void {
-        const index_t jp_end = A.rowp[i + 1];
-        for (index_t jp = A.rowp[i]; jp < jp_end; jp++) {
-          index_t j = A.cols[jp];
+  Timer t("BSRMatVecMultSub()");
+  BSRMatVecMultCount(A, 2);
+  BSRMatVecMultImpl<-1, T, M, N>(A, BSRColumns{A.cols}, x, y);
+}
 
-          blockGemvSubSlice<T, M, N>(A.vals, jp, x, j, y, i);
-        }
-      });
+/*
+  Compute the matrix-vector product y = A * x with a symmetric BSR matrix
+
+  Each stored block A[i, j] adds A[i, j] * x[j] to y[i] and, above the
+  diagonal, A[i, j]^{T} * x[i] to y[j]. The diagonal blocks may be missing.
+
+  The transposed contributions make rows write to each other's entries of y,
+  so without a coloring the product is computed serially. The matrix must be
+  colored with SymBSRMatMultiColorOrder() for a parallel product, the rows of
+  each color are then processed in parallel.
+*/
+template <typename T, index_t M>
+void SymBSRMatVecMult(SymBSRMat<T, M> &A, MultiArrayNew<T *[M]> &x,
+                      MultiArrayNew<T *[M]> &y) {
+  Timer t("SymBSRMatVecMult()");
+  Timer::count(PerfCounter::BLOCKS, A.nnz);
+  Timer::count(PerfCounter::FLOPS, 2.0 * M * M * (2.0 * A.nnz - A.num_diag));
+  Timer::count(PerfCounter::BYTES,
+               double(A.nnz) * (M * M * sizeof(T) + sizeof(index_t)) +
+                   (A.nbrows + 1.0) * sizeof(index_t) +
+                   3.0 * A.nbrows * M * sizeof(T));
+
+  BLAS::zero(y);
+
+  auto row_product = KOKKOS_LAMBDA(index_t i)->void {
+    const index_t jp_end = A.rowp[i + 1];
+    for (index_t jp = A.rowp[i]; jp < jp_end; jp++) {
+      index_t j = A.cols[jp];
+
+      blockGemvAddSlice<T, M, M>(A.vals, jp, x, j, y, i);
+      if (j != i) {
+        blockGemvTransposeAddSlice<T, M, M>(A.vals, jp, x, i, y, j);
+      }
+    }
+  };
+
+  if (A.perm.is_allocated()) {
+    for (index_t color = 0, offset = 0; color < A.num_colors; color++) {
+      const index_t count = A.color_count[color];
+      parallel_for(
+          count, KOKKOS_LAMBDA(index_t irow)->void {
+            row_product(A.perm[irow + offset]);
+          });
+      offset += count;
+    }
+  } else {
+    for (index_t i = 0; i < A.nbrows; i++) {
+      row_product(i);
+    }
+  }
+}
+
+/*
+  Count the blocks, flops and bytes of a product with the compressed BSR
+  matrix for the profiler. The output vector is accessed y_access times.
+*/
+template <typename T, index_t M, index_t N>
+void CompressedBSRMatVecMultCount(CompressedBSRMat<T, M, N> &A,
+                                  index_t y_access) {
+  Timer::count(PerfCounter::BLOCKS, A.nnz);
+  Timer::count(PerfCounter::FLOPS, 2.0 * M * N * A.nnz);
+  Timer::count(PerfCounter::BYTES,
+               double(A.nnz) * M * N * sizeof(T) + A.get_index_bytes() +
+                   (double(A.nbcols) * N + y_access * A.nbrows * M) *
+                       sizeof(T));
+}
+
+/*
+  Call f(col) with the column accessor of the compressed BSR matrix. The
+  width of the offsets is dispatched once, outside of the kernels.
+*/
+template <typename T, index_t M, index_t N, class Functor>
+void CompressedBSRMatWithColumns(CompressedBSRMat<T, M, N> &A,
+                                 const Functor &f) {
+  if (A.offsets16.is_allocated()) {
+    using Columns = CompressedBSRColumns<MultiArrayNew<uint16_t *>>;
+    f(Columns{A.base, A.offsets16});
+  } else {
+    using Columns = CompressedBSRColumns<IdxArray1D_t>;
+    f(Columns{A.base, A.offsets32});
+  }
+}
+
+/*
+  Compute the matrix-vector product with the compressed BSR matrix: y = A * x
+*/
+template <typename T, index_t M, index_t N>
+void CompressedBSRMatVecMult(CompressedBSRMat<T, M, N> &A,
+                             MultiArrayNew<T *[N]> &x,
+                             MultiArrayNew<T *[M]> &y) {
+  Timer t("CompressedBSRMatVecMult()");
+  CompressedBSRMatVecMultCount(A, 1);
+  CompressedBSRMatWithColumns(A, [&](const auto &col) {
+    BSRMatVecMultImpl<0, T, M, N>(A, col, x, y);
+  });
+}
+
+/*
+  Compute the matrix-vector product with the compressed BSR matrix: y += A * x
+*/
+template <typename T, index_t M, index_t N>
+void CompressedBSRMatVecMultAdd(CompressedBSRMat<T, M, N> &A,
+                                MultiArrayNew<T *[N]> &x,
+                                MultiArrayNew<T *[M]> &y) {
+  Timer t("CompressedBSRMatVecMultAdd()");
+  CompressedBSRMatVecMultCount(A, 2);
+  CompressedBSRMatWithColumns(A, [&](const auto &col) {
+    BSRMatVecMultImpl<1, T, M, N>(A, col, x, y);
+  });
+}
+
+/*
+  Compute the matrix-vector product with the compressed BSR matrix: y -= A * x
+*/
+template <typename T, index_t M, index_t N>
+void CompressedBSRMatVecMultSub(CompressedBSRMat<T, M, N> &A,
+                                MultiArrayNew<T *[N]> &x,
+                                MultiArrayNew<T *[M]> &y) {
+  Timer t("CompressedBSRMatVecMultSub()");
+  CompressedBSRMatVecMultCount(A, 2);
+  CompressedBSRMatWithColumns(A, [&](const auto &col) {
+    BSRMatVecMultImpl<-1, T, M, N>(A, col, x, y);
+  });
 }
 
 /*
@@ -401,7 +576,8 @@ void BSRMatFactor(BSRMat<T, M, M> &A) {
     diag[i] = jp;
 
     // Invert the diagonal matrix component -- Invert( &A[b2*diag[i] )
-    int fail = blockInverseSlice<T, M>(A.vals, jp, D, ipiv);
+    auto Ajp = Kokkos::subview(A.vals, jp, Kokkos::ALL, Kokkos::ALL);
+    int fail = blockInverse<T, M>(Ajp, D, ipiv);
 
     if (fail) {
       std::cerr << "BSRMatFactor: Failure in factorization of block row " << i
@@ -534,50 +710,84 @@ BSRMat<T, M, M> *BSRMatExtractBlockDiagonal(BSRMat<T, M, M> &A,
 
   BSRMat<T, M, M> *D = new BSRMat<T, M, M>(nrows, ncols, nnz, rowp, cols);
 
-  // Now extract the real matrix and set the true non-zero pattern
-  Mat<T, M, M> Dinv;
-  Vec<index_t, M> ipiv;
+  // Set the true non-zero pattern and record the source of each block
+  MultiArrayNew<index_t *> src("src", nrows);
 
   D->nnz = 0;
   D->rowp[0] = 0;
   for (index_t i = 0; i < nrows; i++) {
     index_t jp = A.find_value_index(i, i);
     if (jp != NO_INDEX) {
-      // Copy the values
-      for (index_t k1 = 0; k1 < M; k1++) {
-        for (index_t k2 = 0; k2 < M; k2++) {
-          D->vals(D->nnz, k1, k2) = A.vals(jp, k1, k2);
-        }
-      }
+      src(D->nnz) = jp;
+      D->cols[D->nnz] = i;
+      D->nnz++;
+    } else {
+      std::cerr << "BSRMatExtractBlockDiagonal: No block diagonal for row " << i
+                << std::endl;
+    }
+    D->rowp[i + 1] = D->nnz;
+  }
 
-      if (inverse) {
-        auto D0 = Kokkos::subview(D->vals, D->nnz, Kokkos::ALL, Kokkos::ALL);
-        int fail = blockPseudoInverse(D0, Dinv);
-        // int fail = blockInverse<T, M>(D0, Dinv, ipiv);
-
-        if (fail) {
-          std::cerr << "BSRMatExtractBlockDiagonal: Failure in factorization "
-                       "of block row "
-                    << i << " local row " << fail << std::endl;
-          throw std::runtime_error(
-              "BSRMatExtractBlockDiagonal failed");  // TODO: maybe don't do
-                                                     // this
+  // Copy the values and invert each block with the inline LU kernel. Blocks
+  // with a pivot below the relative tolerance are treated as singular.
+  const double pivot_tol = M * std::numeric_limits<double>::epsilon();
+  MultiArrayNew<int *> failed("failed", D->nnz);
+  parallel_for(
+      D->nnz, KOKKOS_LAMBDA(index_t p)->void {
+        const index_t jp = src(p);
+        if (inverse) {
+          Mat<T, M, M> A0;
+          Vec<index_t, M> ipiv;
+          for (index_t k1 = 0; k1 < M; k1++) {
+            for (index_t k2 = 0; k2 < M; k2++) {
+              A0(k1, k2) = A.vals(jp, k1, k2);
+            }
+          }
+
+          auto D0 = Kokkos::subview(D->vals, p, Kokkos::ALL, Kokkos::ALL);
+          failed(p) = blockInverse<T, M>(A0, D0, ipiv, pivot_tol);
         } else {
           for (index_t k1 = 0; k1 < M; k1++) {
             for (index_t k2 = 0; k2 < M; k2++) {
-              D->vals(D->nnz, k1, k2) = Dinv(k1, k2);
+              D->vals(p, k1, k2) = A.vals(jp, k1, k2);
             }
           }
         }
+      });
+
+  // Fall back to the pseudo-inverse for the singular blocks
+  if (inverse) {
+    Mat<T, M, M> Dinv;
+    for (index_t i = 0; i < nrows; i++) {
+      if (D->rowp[i] == D->rowp[i + 1] || !failed(D->rowp[i])) {
+        continue;
       }
 
-      D->cols[D->nnz] = i;
-      D->nnz++;
-    } else {
-      std::cerr << "BSRMatExtractBlockDiagonal: No block diagonal for row " << i
-                << std::endl;
+      const index_t p = D->rowp[i];
+      const index_t jp = src(p);
+      for (index_t k1 = 0; k1 < M; k1++) {
+        for (index_t k2 = 0; k2 < M; k2++) {
+          D->vals(p, k1, k2) = A.vals(jp, k1, k2);
+        }
+      }
+
+      auto D0 = Kokkos::subview(D->vals, p, Kokkos::ALL, Kokkos::ALL);
+      Dinv.zero();
+      int fail = blockPseudoInverse(D0, Dinv);
+
+      if (fail) {
+        std::cerr << "BSRMatExtractBlockDiagonal: Failure in factorization "
+                     "of block row "
+                  << i << " local row " << fail << std::endl;
+        throw std::runtime_error("BSRMatExtractBlockDiagonal failed");
+      } else {
+        for (index_t k1 = 0; k1 < M; k1++) {
+          for (index_t k2 = 0; k2 < M; k2++) {
+            D->vals(p, k1, k2) = Dinv(k1, k2);
+          }
+        }
+      }
     }
-    D->rowp[i + 1] = D->nnz;
   }
 
   return D;
@@ -653,75 +863,52 @@ void BSRApplySOR(BSRMat<T, M, M> &Dinv, BSRMat<T, M, M> &A, T omega,
 }
 
 /*
-  Apply a step of Symmetric SOR to the system A*x = b for non-zero x.
+  Apply a step of Symmetric SOR for a BSRMat or a CompressedBSRMat A, where
+  col gives the column of each block
 */
-template <typename T, index_t M>
-void BSRApplySSOR(BSRMat<T, M, M> &Dinv, BSRMat<T, M, M> &A, T omega,
-                  MultiArrayNew<T *[M]> &b, MultiArrayNew<T *[M]> &x) {
-  index_t nrows = A.nbrows;
+template <typename T, index_t M, class MatType, class ColAccessor>
+void BSRApplySSORImpl(BSRMat<T, M, M> &Dinv, MatType &A,
+                      const ColAccessor col, T omega,
+                      MultiArrayNew<T *[M]> &b, MultiArrayNew<T *[M]> &x) {
+  auto relax_row = KOKKOS_LAMBDA(index_t i)->void {
+    // Copy over the values
+    Vec<T, M> t;
+    for (index_t m = 0; m < M; m++) {
+      t(m) = b(i, m);
+    }
+
+    const index_t jp_end = A.rowp[i + 1];
+    for (index_t jp = A.rowp[i]; jp < jp_end; jp++) {
+      index_t j = col(i, jp);
+
+      if (i != j) {
+        blockGemvSubSlice<T, M, M>(A.vals, jp, x, j, t);
+      }
+    }
+
+    // x = (1 - omega) * x + omega * D^{-1} * t
+    for (index_t m = 0; m < M; m++) {
+      x(i, m) = (1.0 - omega) * x(i, m);
+    }
+    blockGemvAddScaleSlice<T, M, M>(omega, Dinv.vals, i, t, x, i);
+  };
 
   if (A.perm.is_allocated()) {
     for (index_t color = 0, offset = 0; color < A.num_colors; color++) {
       const index_t count = A.color_count[color];
-
       parallel_for(
           count, KOKKOS_LAMBDA(index_t irow)->void {
-            index_t i = A.perm[irow + offset];
-
-            // Copy over the values
-            Vec<T, M> t;
-            for (index_t m = 0; m < M; m++) {
-              t(m) = b(i, m);
-            }
-
-            const int jp_end = A.rowp[i + 1];
-            for (index_t jp = A.rowp[i]; jp < jp_end; jp++) {
-              index_t j = A.cols[jp];
-
-              if (i != j) {
-                blockGemvSubSlice<T, M, M>(A.vals, jp, x, j, t);
-              }
-            }
-
-            // x = (1 - omega) * x + omega * D^{-1} * t
-            for (index_t m = 0; m < M; m++) {
-              x(i, m) = (1.0 - omega) * x(i, m);
-            }
-
-            blockGemvAddScaleSlice<T, M, M>(omega, Dinv.vals, i, t, x, i);
+            relax_row(A.perm[irow + offset]);
           });
-
       offset += count;
     }
 
     index_t offset = A.nbrows - A.color_count[A.num_colors - 1];
     for (index_t color = A.num_colors; color > 0; color--) {
       const index_t count = A.color_count[color - 1];
-
       parallel_for(
           count, KOKKOS_LAMBDA(index_t irow)->void {
-            index_t i = A.perm[irow + offset];
-
-            // Copy over the values
-            Vec<T, M> t;
-            for (index_t m = 0; m < M; m++) {
-              t(m) = b(i, m);
-            }
-
-            const int jp_end = A.rowp[i + 1];
-            for (index_t jp = A.rowp[i]; jp < jp_end; jp++) {
-              index_t j = A.cols[jp];
-
-              if (i != j) {
-                blockGemvSubSlice<T, M, M>(A.vals, jp, x, j, t);
-              }
-            }
-
-            // x = (1 - omega) * x + omega * D^{-1} * t
-            for (index_t m = 0; m < M; m++) {
-              x(i, m) = (1.0 - omega) * x(i, m);
-            }
-            blockGemvAddScaleSlice<T, M, M>(omega, Dinv.vals, i, t, x, i);
+            relax_row(A.perm[irow + offset]);
           });
 
       if (color >= 2) {
@@ -729,54 +916,58 @@ void BSRApplySSOR(BSRMat<T, M, M> &Dinv, BSRMat<T, M, M> &A, T omega,
       }
     }
   } else {
-    Vec<T, M> t;
-
-    for (index_t i = 0; i < nrows; i++) {
-      // Copy over the values
-      for (index_t m = 0; m < M; m++) {
-        t(m) = b(i, m);
-      }
-
-      const int jp_end = A.rowp[i + 1];
-      for (index_t jp = A.rowp[i]; jp < jp_end; jp++) {
-        index_t j = A.cols[jp];
-
-        if (i != j) {
-          blockGemvSubSlice<T, M, M>(A.vals, jp, x, j, t);
-        }
-      }
-
-      // x = (1 - omega) * x + omega * D^{-1} * t
-      for (index_t m = 0; m < M; m++) {
-        x(i, m) = (1.0 - omega) * x(i, m);
-      }
-      blockGemvAddScaleSlice<T, M, M>(omega, Dinv.vals, i, t, x, i);
+    for (index_t i = 0; i < A.nbrows; i++) {
+      relax_row(i);
     }
+    for (index_t i = A.nbrows; i > 0; i--) {
+      relax_row(i - 1);
+    }
+  }
+}
 
-    for (index_t index = nrows; index > 0; index--) {
-      index_t i = index - 1;
+/*
+  Apply a step of Symmetric SOR to the system A*x = b for non-zero x.
+*/
+template <typename T, index_t M>
+void BSRApplySSOR(BSRMat<T, M, M> &Dinv, BSRMat<T, M, M> &A, T omega,
+                  MultiArrayNew<T *[M]> &b, MultiArrayNew<T *[M]> &x) {
+  Timer timer("BSRApplySSOR()");
+  index_t nrows = A.nbrows;
 
-      // Copy over the values
-      for (index_t m = 0; m < M; m++) {
-        t(m) = b(i, m);
-      }
+  // Each of the two sweeps visits every block of A and the diagonal inverse
+  // and reads b and x and writes x
+  Timer::count(PerfCounter::BLOCKS, 2.0 * (A.nnz + nrows));
+  Timer::count(PerfCounter::FLOPS, 2.0 * 2.0 * M * M * (A.nnz + nrows));
+  Timer::count(PerfCounter::BYTES,
+               2.0 * ((A.nnz + nrows) * (M * M * sizeof(T) + sizeof(index_t)) +
+                      3.0 * nrows * M * sizeof(T)));
 
-      const int jp_end = A.rowp[i + 1];
-      for (index_t jp = A.rowp[i]; jp < jp_end; jp++) {
-        index_t j = A.cols[jp];
+  BSRApplySSORImpl(Dinv, A, BSRColumns{A.cols}, omega, b, x);
+}
 
-        if (i != j) {
-          blockGemvSubSlice<T, M, M>(A.vals, jp, x, j, t);
-        }
-      }
+/*
+  Apply a step of Symmetric SOR to the system A*x = b for non-zero x with the
+  compressed BSR matrix
+*/
+template <typename T, index_t M>
+void CompressedBSRApplySSOR(BSRMat<T, M, M> &Dinv,
+                            CompressedBSRMat<T, M, M> &A, T omega,
+                            MultiArrayNew<T *[M]> &b,
+                            MultiArrayNew<T *[M]> &x) {
+  Timer timer("CompressedBSRApplySSOR()");
+  index_t nrows = A.nbrows;
 
-      // x = (1 - omega) * x + omega * D^{-1} * t
-      for (index_t m = 0; m < M; m++) {
-        x(i, m) = (1.0 - omega) * x(i, m);
-      }
-      blockGemvAddScaleSlice<T, M, M>(omega, Dinv.vals, i, t, x, i);
-    }
-  }
+  // Each of the two sweeps visits every block of A and the diagonal inverse
+  // and reads b and x and writes x
+  Timer::count(PerfCounter::BLOCKS, 2.0 * (A.nnz + nrows));
+  Timer::count(PerfCounter::FLOPS, 2.0 * 2.0 * M * M * (A.nnz + nrows));
+  Timer::count(PerfCounter::BYTES,
+               2.0 * ((A.nnz + nrows) * M * M * sizeof(T) +
+                      A.get_index_bytes() + 3.0 * nrows * M * sizeof(T)));
+
+  CompressedBSRMatWithColumns(A, [&](const auto &col) {
+    BSRApplySSORImpl(Dinv, A, col, omega, b, x);
+  });
 }
 
 /*
@@ -2,10 +2,12 @@
 #define A2D_SPARSE_SYMBOLIC_H
 
 #include <algorithm>
+#include <cstdint>
 #include <limits>
 #include <set>
 #include <vector>
 
+#include "parallel.h"
 #include "sparse_amd.h"
 #include "sparse_matrix.h"
 #include "utils/a2dprofiler.h"
@@ -755,15 +757,349 @@ index_t CSRMultiColorOrder(const index_t nvars, const index_t rowp[],
   return num_colors;
 }
 
+/*
+  Sort the variables by color, perm[k] is the k-th variable in color order
+*/
+template <class VecType>
+void CSRColorPermutation(const index_t nvars, const index_t num_colors,
+                         const VecType colors, VecType perm) {
+  std::vector<index_t> offset(num_colors + 1, 0);
+  for (index_t i = 0; i < nvars; i++) {
+    offset[colors[i] + 1]++;
+  }
+  for (index_t c = 0; c < num_colors; c++) {
+    offset[c + 1] += offset[c];
+  }
+  for (index_t i = 0; i < nvars; i++) {
+    perm[offset[colors[i]]++] = i;
+  }
+}
+
+/*
+  Conflict visitors for the parallel coloring: visit(i, f) calls f(j) for
+  every vertex j that may not share the color of vertex i
+*/
+
+// Adjacent vertices of a graph in CSR format
+struct CSRDistance1Visitor {
+  const index_t *rowp, *cols;
+
+  template <class Func>
+  KOKKOS_FUNCTION void operator()(const index_t i, const Func& f) const {
+    for (index_t jp = rowp[i]; jp < rowp[i + 1]; jp++) {
+      if (cols[jp] != i) {
+        f(cols[jp]);
+      }
+    }
+  }
+};
+
+// Vertices within a distance of two of a graph in CSR format
+struct CSRDistance2Visitor {
+  const index_t *rowp, *cols;
+
+  template <class Func>
+  KOKKOS_FUNCTION void operator()(const index_t i, const Func& f) const {
+    for (index_t jp = rowp[i]; jp < rowp[i + 1]; jp++) {
+      const index_t j = cols[jp];
+      if (j != i) {
+        f(j);
+      }
+      for (index_t kp = rowp[j]; kp < rowp[j + 1]; kp++) {
+        if (cols[kp] != i) {
+          f(cols[kp]);
+        }
+      }
+    }
+  }
+};
+
+// Rows of a bipartite graph that share a column, where (colp, rows) is the
+// transpose of (rowp, cols). For an element to node graph, elements with
+// different colors never write to the same node.
+struct CSRBipartiteVisitor {
+  const index_t *rowp, *cols;
+  const index_t *colp, *rows;
+
+  template <class Func>
+  KOKKOS_FUNCTION void operator()(const index_t i, const Func& f) const {
+    for (index_t jp = rowp[i]; jp < rowp[i + 1]; jp++) {
+      const index_t j = cols[jp];
+      for (index_t kp = colp[j]; kp < colp[j + 1]; kp++) {
+        if (rows[kp] != i) {
+          f(rows[kp]);
+        }
+      }
+    }
+  }
+};
+
+/*
+  Mark the colors in [base, base + 256) used by the vertices that conflict
+  with vertex i. Vertices without a color are ignored. The colors are read
+  with relaxed atomic loads since other threads may be writing them.
+*/
+template <class Visitor>
+KOKKOS_FUNCTION void ColorMarkWindow(const index_t i, const Visitor& visit,
+                                     index_t colors[], index_t base,
+                                     uint64_t mask[4]) {
+  const index_t empty = MAX_INDEX;
+  for (index_t k = 0; k < 4; k++) {
+    mask[k] = 0;
+  }
+  visit(i, [&](index_t j) {
+    const index_t c = Kokkos::atomic_load(&colors[j]);
+    if (c != empty && c >= base && c - base < 256) {
+      mask[(c - base) / 64] |= uint64_t(1) << ((c - base) % 64);
+    }
+  });
+}
+
+/*
+  Speculative parallel greedy coloring (Gebremedhin-Manne)
+
+  In each round the vertices in the work list are colored concurrently with
+  the smallest color not used by any of their neighbors, reading the colors
+  that other threads may be writing at the same time. The conflicts this
+  creates are detected in a separate read-only pass where the vertex with
+  the larger index of each conflicting pair is put back on the work list.
+  The colors are read and written with relaxed atomics in the coloring pass.
+  The conflict pass starts once the coloring pass is complete, so it uses
+  plain reads.
+  With a single thread this reduces to the sequential greedy algorithm.
+  Returns the number of colors.
+*/
+template <class Visitor>
+index_t ParallelColorSpeculative(const index_t nvars, const Visitor& visit,
+                                 index_t colors[]) {
+  const index_t empty = MAX_INDEX;
+  IdxArray1D_t work("work", nvars);
+  MultiArrayNew<int*> conflict("conflict", nvars);
+
+  parallel_for(
+      nvars, KOKKOS_LAMBDA(index_t i)->void {
+        colors[i] = empty;
+        work[i] = i;
+      });
+
+  index_t nwork = nvars;
+  while (nwork > 0) {
+    // Color the vertices in the work list
+    parallel_for(
+        nwork, KOKKOS_LAMBDA(index_t w)->void {
+          const index_t i = work[w];
+          for (index_t base = 0;; base += 256) {
+            uint64_t mask[4];
+            ColorMarkWindow(i, visit, colors, base, mask);
+            for (index_t k = 0; k < 4; k++) {
+              if (~mask[k]) {
+                index_t bit = 0;
+                while (mask[k] & (uint64_t(1) << bit)) {
+                  bit++;
+                }
+                Kokkos::atomic_store(&colors[i], base + 64 * k + bit);
+                return;
+              }
+            }
+          }
+        });
+
+    // Detect the conflicts, the vertex with the larger index is recolored
+    parallel_for(
+        nwork, KOKKOS_LAMBDA(index_t w)->void {
+          const index_t i = work[w];
+          int flag = 0;
+          visit(i, [&](index_t j) {
+            if (j < i && colors[j] == colors[i]) {
+              flag = 1;
+            }
+          });
+          conflict[w] = flag;
+        });
+
+    index_t count = 0;
+    for (index_t w = 0; w < nwork; w++) {
+      if (conflict[w]) {
+        work[count] = work[w];
+        count++;
+      }
+    }
+    nwork = count;
+  }
+
+  index_t num_colors = 0;
+  for (index_t i = 0; i < nvars; i++) {
+    num_colors = std::max(num_colors, colors[i] + 1);
+  }
+
+  return num_colors;
+}
+
+/*
+  Balance the sizes of the color classes in parallel
+
+  The vertices of a color with more than ceil(nvars / num_colors) members
+  move to the first permissible color that is below this target size. The
+  classes are processed one at a time. A class is an independent set, so its
+  vertices can be recolored concurrently. Only the class sizes are updated
+  with atomics.
+*/
+template <class Visitor>
+void ParallelColorBalance(const index_t nvars, const Visitor& visit,
+                          const index_t num_colors, index_t colors[]) {
+  if (num_colors <= 1) {
+    return;
+  }
+  const int target = (nvars + num_colors - 1) / num_colors;
+
+  // Sort the vertices by color
+  std::vector<index_t> ptr(num_colors + 1, 0);
+  for (index_t i = 0; i < nvars; i++) {
+    ptr[colors[i] + 1]++;
+  }
+  for (index_t c = 0; c < num_colors; c++) {
+    ptr[c + 1] += ptr[c];
+  }
+  IdxArray1D_t vars("vars", nvars);
+  std::vector<index_t> offset(ptr.begin(), ptr.end() - 1);
+  for (index_t i = 0; i < nvars; i++) {
+    vars[offset[colors[i]]++] = i;
+  }
+
+  MultiArrayNew<int*> count("count", num_colors);
+  MultiArrayNew<int*> snapshot("snapshot", num_colors);
+  for (index_t c = 0; c < num_colors; c++) {
+    count[c] = ptr[c + 1] - ptr[c];
+  }
+
+  for (index_t c = 0; c < num_colors; c++) {
+    if (count[c] <= target) {
+      continue;
+    }
+    Kokkos::deep_copy(snapshot, count);
+
+    const index_t start = ptr[c];
+    parallel_for(
+        ptr[c + 1] - ptr[c], KOKKOS_LAMBDA(index_t k)->void {
+          const index_t i = vars[start + k];
+
+          // Reserve a departure from the over-full class
+          if (Kokkos::atomic_fetch_add(&count[c], -1) <= target) {
+            Kokkos::atomic_add(&count[c], 1);
+            return;
+          }
+
+          for (index_t base = 0; base < num_colors; base += 256) {
+            uint64_t mask[4];
+            ColorMarkWindow(i, visit, colors, base, mask);
+            for (index_t n = base; n < num_colors && n - base < 256; n++) {
+              const bool used =
+                  mask[(n - base) / 64] & (uint64_t(1) << ((n - base) % 64));
+              if (n != c && !used && snapshot[n] < target) {
+                if (Kokkos::atomic_fetch_add(&count[n], 1) < target) {
+                  colors[i] = n;
+                  return;
+                }
+                Kokkos::atomic_add(&count[n], -1);
+              }
+            }
+          }
+
+          Kokkos::atomic_add(&count[c], 1);
+        });
+  }
+}
+
+/*
+  Multicolor code using a parallel speculative greedy algorithm
+
+  With distance = 1, no two adjacent variables share a color, which is
+  required for the parallel SOR/SSOR sweeps. With distance = 2, variables
+  that share a neighbor also get different colors. If balance is true, a
+  recoloring pass evens out the number of variables per color. Returns the
+  number of colors. If perm is not null, it is filled with the variables
+  sorted by color.
+*/
+template <class VecType>
+index_t CSRMultiColorOrderParallel(const index_t nvars, const index_t rowp[],
+                                   const index_t cols[], VecType colors,
+                                   VecType perm, int distance = 1,
+                                   bool balance = true) {
+  index_t num_colors = 0;
+  if (distance == 1) {
+    CSRDistance1Visitor visit{rowp, cols};
+    num_colors = ParallelColorSpeculative(nvars, visit, colors);
+    if (balance) {
+      ParallelColorBalance(nvars, visit, num_colors, colors);
+    }
+  } else if (distance == 2) {
+    CSRDistance2Visitor visit{rowp, cols};
+    num_colors = ParallelColorSpeculative(nvars, visit, colors);
+    if (balance) {
+      ParallelColorBalance(nvars, visit, num_colors, colors);
+    }
+  } else {
+    char msg[256];
+    std::snprintf(msg, sizeof(msg),
+                  "CSRMultiColorOrderParallel: distance %d not supported",
+                  distance);
+    throw std::runtime_error(msg);
+  }
+
+  if (perm) {
+    CSRColorPermutation(nvars, num_colors, colors, perm);
+  }
+
+  return num_colors;
+}
+
+/*
+  Color the rows of a bipartite graph in parallel such that no two rows that
+  share a column have the same color. Here (colp, rows) is the transpose of
+  (rowp, cols). Applied to the element to node connectivity, each color is a
+  set of elements that can be assembled concurrently without atomics.
+*/
+template <class VecType>
+index_t CSRBipartiteColorOrderParallel(const index_t nrows,
+                                       const index_t rowp[],
+                                       const index_t cols[],
+                                       const index_t colp[],
+                                       const index_t rows[], VecType colors,
+                                       VecType perm, bool balance = true) {
+  CSRBipartiteVisitor visit{rowp, cols, colp, rows};
+  index_t num_colors = ParallelColorSpeculative(nrows, visit, colors);
+  if (balance) {
+    ParallelColorBalance(nrows, visit, num_colors, colors);
+  }
+
+  if (perm) {
+    CSRColorPermutation(nrows, num_colors, colors, perm);
+  }
+
+  return num_colors;
+}
+
+/*
+  Multicolor order the block rows of A such that no two coupled rows have the
+  same color
+
+  The default is the serial greedy coloring, which is deterministic. With
+  parallel = true, the speculative parallel coloring with balancing is used
+  instead, its colors depend on the thread scheduling.
+*/
 template <typename T, index_t M>
-void BSRMatMultiColorOrder(BSRMat<T, M, M>& A) {
+void BSRMatMultiColorOrder(BSRMat<T, M, M>& A, bool parallel = false) {
   A.perm = IdxArray1D_t("A.perm", A.nbrows);
 
   IdxArray1D_t colors("colors", A.nbrows);
 
-  // Use A->perm as a temporary variable to avoid double allocation
-  A.num_colors = CSRMultiColorOrder(A.nbrows, A.rowp.data(), A.cols.data(),
-                                    colors.data(), A.perm.data());
+  if (parallel) {
+    A.num_colors = CSRMultiColorOrderParallel(
+        A.nbrows, A.rowp.data(), A.cols.data(), colors.data(), A.perm.data());
+  } else {
+    A.num_colors = CSRMultiColorOrder(A.nbrows, A.rowp.data(), A.cols.data(),
+                                      colors.data(), A.perm.data());
+  }
 
   // Count up the number of nodes with each color
   A.color_count = IdxArray1D_t("A.color_count", A.num_colors);
@@ -773,6 +1109,114 @@ void BSRMatMultiColorOrder(BSRMat<T, M, M>& A) {
   }
 }
 
+/*
+  Create a symmetric BSR matrix from the diagonal and upper blocks of A and
+  copy their values
+*/
+template <typename T, index_t M>
+SymBSRMat<T, M>* SymBSRMatFromBSRMat(BSRMat<T, M, M>& A) {
+  std::vector<index_t> rowp(A.nbrows + 1), cols, src;
+  rowp[0] = 0;
+  for (index_t i = 0; i < A.nbrows; i++) {
+    for (index_t jp = A.rowp[i]; jp < A.rowp[i + 1]; jp++) {
+      if (A.cols[jp] >= i) {
+        cols.push_back(A.cols[jp]);
+        src.push_back(jp);
+      }
+    }
+    rowp[i + 1] = cols.size();
+  }
+
+  SymBSRMat<T, M>* S = new SymBSRMat<T, M>(A.nbrows, cols.size(), rowp, cols);
+  for (index_t jp = 0; jp < S->nnz; jp++) {
+    for (index_t ii = 0; ii < M; ii++) {
+      for (index_t jj = 0; jj < M; jj++) {
+        S->vals(jp, ii, jj) = A.vals(src[jp], ii, jj);
+      }
+    }
+  }
+
+  return S;
+}
+
+/*
+  Color the block rows of a symmetric BSR matrix such that the rows of the
+  same color do not share a stored column. In y = A * x, row i updates y at
+  all the columns of row i and at i itself, so the rows of one color can be
+  processed concurrently without atomics. Column i is added to the pattern
+  of row i when the diagonal block is not stored.
+*/
+template <typename T, index_t M>
+void SymBSRMatMultiColorOrder(SymBSRMat<T, M>& A) {
+  // Form the non-zero pattern with all the diagonal entries
+  std::vector<index_t> rowp(A.nbrows + 1), cols;
+  cols.reserve(A.nnz + A.nbrows - A.num_diag);
+  rowp[0] = 0;
+  for (index_t i = 0; i < A.nbrows; i++) {
+    bool has_diag = false;
+    for (index_t jp = A.rowp[i]; jp < A.rowp[i + 1]; jp++) {
+      has_diag = has_diag || (A.cols[jp] == i);
+      cols.push_back(A.cols[jp]);
+    }
+    if (!has_diag) {
+      cols.push_back(i);
+    }
+    rowp[i + 1] = cols.size();
+  }
+
+  // Form the transpose of the non-zero pattern
+  const index_t nnz = cols.size();
+  std::vector<index_t> colp(A.nbrows + 1, 0), rows(nnz);
+  for (index_t jp = 0; jp < nnz; jp++) {
+    colp[cols[jp] + 1]++;
+  }
+  for (index_t i = 0; i < A.nbrows; i++) {
+    colp[i + 1] += colp[i];
+  }
+  for (index_t i = 0; i < A.nbrows; i++) {
+    for (index_t jp = rowp[i]; jp < rowp[i + 1]; jp++) {
+      rows[colp[cols[jp]]++] = i;
+    }
+  }
+  for (index_t i = A.nbrows; i > 0; i--) {
+    colp[i] = colp[i - 1];
+  }
+  colp[0] = 0;
+
+  A.perm = IdxArray1D_t("A.perm", A.nbrows);
+  IdxArray1D_t colors("colors", A.nbrows);
+  A.num_colors = CSRBipartiteColorOrderParallel(
+      A.nbrows, rowp.data(), cols.data(), colp.data(), rows.data(),
+      colors.data(), A.perm.data());
+
+  A.color_count = IdxArray1D_t("A.color_count", A.num_colors);
+  for (index_t i = 0; i < A.nbrows; i++) {
+    A.color_count[colors[i]]++;
+  }
+}
+
+/*
+  Create a BSR matrix with compressed column indices from A
+
+  The values and the multicolor ordering, if any, are shared with A and not
+  copied, so later updates to the values of A are seen by the compressed
+  matrix. Color A with BSRMatMultiColorOrder() before the conversion to use
+  the parallel smoother.
+*/
+template <typename T, index_t M, index_t N>
+CompressedBSRMat<T, M, N>* BSRMatCompressIndex(BSRMat<T, M, N>& A) {
+  CompressedBSRMat<T, M, N>* C = new CompressedBSRMat<T, M, N>(
+      A.nbrows, A.nbcols, A.nnz, A.rowp, A.cols, A.vals);
+
+  if (A.perm.is_allocated() && A.color_count.is_allocated()) {
+    C->perm = A.perm;
+    C->num_colors = A.num_colors;
+    C->color_count = A.color_count;
+  }
+
+  return C;
+}
+
 }  // namespace A2D
 
 #endif  // A2D_SPARSE_SYMBOLIC_H
@@ -363,7 +363,7 @@ CSRMat<T> bsr_to_csr(BSRMat<T, M, N> bsr_mat) {
       csr_mat.rowp(i) = MN * bsr_mat.rowp(ib) + ii * num_entries;
       for (nb = bsr_mat.rowp(ib), index = 0; nb < bsr_mat.rowp(ib + 1);
            nb++, index++) {
-        for (index_t jj = 0; jj < M; jj++) {
+        for (index_t jj = 0; jj < N; jj++) {
           n = csr_mat.rowp(i) + index * N + jj;
           csr_mat.vals(n) = bsr_mat.vals(nb, ii, jj);
           csr_mat.cols(n) = N * bsr_mat.cols(nb) + jj;
@@ -447,6 +447,162 @@ CSCMat<T> bsr_to_csc(BSRMat<T, M, N> bsr_mat) {
   return csc_mat;
 }
 
+/**
+ * @brief Convert SymBSRMat to an unblocked CSC format with both triangles
+ *
+ * The block column jb of the full matrix consists of the stored blocks
+ * (kb, jb) with kb <= jb, followed by the transposes of the stored blocks
+ * (jb, kb) with kb > jb, so the rows in each column are generated in
+ * ascending order directly from the upper storage.
+ */
+template <typename T, index_t M>
+CSCMat<T> bsr_to_csc(SymBSRMat<T, M> bsr_mat) {
+  const index_t nbrows = bsr_mat.nbrows;
+  const index_t n = nbrows * M;
+
+  // Form the transpose of the block non-zero pattern
+  std::vector<index_t> bcolp(nbrows + 1, 0), brows(bsr_mat.nnz),
+      bptr(bsr_mat.nnz);
+  for (index_t jp = 0; jp < bsr_mat.nnz; jp++) {
+    bcolp[bsr_mat.cols(jp) + 1]++;
+  }
+  for (index_t i = 0; i < nbrows; i++) {
+    bcolp[i + 1] += bcolp[i];
+  }
+  for (index_t i = 0; i < nbrows; i++) {
+    for (index_t jp = bsr_mat.rowp(i); jp < bsr_mat.rowp(i + 1); jp++) {
+      const index_t kp = bcolp[bsr_mat.cols(jp)]++;
+      brows[kp] = i;
+      bptr[kp] = jp;
+    }
+  }
+  for (index_t i = nbrows; i > 0; i--) {
+    bcolp[i] = bcolp[i - 1];
+  }
+  bcolp[0] = 0;
+
+  // Each block column has the blocks in its column and its row, counting the
+  // diagonal block once
+  index_t gnnz = M * M * (2 * bsr_mat.nnz - nbrows);
+  CSCMat<T> csc_mat(n, n, gnnz);
+
+  index_t m = 0;
+  for (index_t jb = 0; jb < nbrows; jb++) {
+    for (index_t jj = 0; jj < M; jj++) {
+      csc_mat.colp(M * jb + jj) = m;
+
+      // Stored blocks (kb, jb) with kb <= jb
+      for (index_t kp = bcolp[jb]; kp < bcolp[jb + 1]; kp++) {
+        const index_t kb = brows[kp];
+        const index_t jp = bptr[kp];
+        for (index_t ii = 0; ii < M; ii++) {
+          csc_mat.rows(m) = M * kb + ii;
+          csc_mat.vals(m) = bsr_mat.vals(jp, ii, jj);
+          m++;
+        }
+      }
+
+      // Transposes of the stored blocks (jb, kb) with kb > jb
+      for (index_t jp = bsr_mat.rowp(jb); jp < bsr_mat.rowp(jb + 1); jp++) {
+        const index_t kb = bsr_mat.cols(jp);
+        if (kb > jb) {
+          for (index_t ii = 0; ii < M; ii++) {
+            csc_mat.rows(m) = M * kb + ii;
+            csc_mat.vals(m) = bsr_mat.vals(jp, jj, ii);
+            m++;
+          }
+        }
+      }
+    }
+  }
+  csc_mat.colp(n) = m;
+
+  return csc_mat;
+}
+
+/**
+ * @brief Save a BSRMat to a checkpoint
+ *
+ * The row and column dimensions, the nonzero pattern, the diagonal pointer
+ * and the multicolor ordering are saved when they are allocated.
+ *
+ * @param ckpt the checkpoint writer
+ * @param prefix prefix for the names of the arrays in the checkpoint
+ * @param A the matrix
+ * @param save_values save the matrix entries as well as the pattern
+ */
+template <typename T, index_t M, index_t N>
+void BSRMatSave(CheckpointWriter &ckpt, const std::string &prefix,
+                BSRMat<T, M, N> &A, bool save_values) {
+  const index_t num_colors = A.color_count.is_allocated() ? A.num_colors : 0;
+  const index_t info[6] = {A.nbrows, A.nbcols, A.nnz, M, N, num_colors};
+  ckpt.write(prefix + "/info", info, 6);
+  ckpt.write_view(prefix + "/rowp", A.rowp);
+  ckpt.write_view(prefix + "/cols", A.cols);
+  ckpt.write_view(prefix + "/diag", A.diag);
+  ckpt.write_view(prefix + "/perm", A.perm);
+  ckpt.write_view(prefix + "/iperm", A.iperm);
+  ckpt.write_view(prefix + "/color_count", A.color_count);
+  if (save_values) {
+    ckpt.write_view(prefix + "/vals", A.vals);
+  }
+}
+
+/**
+ * @brief Load a BSRMat saved with BSRMatSave
+ *
+ * @param ckpt the checkpoint reader
+ * @param prefix the prefix used when the matrix was saved
+ * @return the matrix, owned by the caller
+ */
+template <typename T, index_t M, index_t N>
+BSRMat<T, M, N> *BSRMatLoad(const CheckpointReader &ckpt,
+                            const std::string &prefix) {
+  index_t info[6];
+  ckpt.read(prefix + "/info", info, 6);
+  if (info[3] != M || info[4] != N) {
+    char msg[256];
+    std::snprintf(msg, sizeof(msg),
+                  "BSRMatLoad: %s has %d x %d blocks, expected %d x %d",
+                  prefix.c_str(), info[3], info[4], M, N);
+    throw std::runtime_error(msg);
+  }
+
+  const index_t nbrows = info[0], nbcols = info[1], nnz = info[2];
+  const index_t *rowp = ckpt.get<index_t>(prefix + "/rowp");
+  const index_t *cols = ckpt.get<index_t>(prefix + "/cols");
+  if (ckpt.get_count<index_t>(prefix + "/rowp") != nbrows + 1 ||
+      ckpt.get_count<index_t>(prefix + "/cols") != nnz) {
+    char msg[256];
+    std::snprintf(msg, sizeof(msg), "BSRMatLoad: %s has an invalid pattern",
+                  prefix.c_str());
+    throw std::runtime_error(msg);
+  }
+  BSRMat<T, M, N> *A = new BSRMat<T, M, N>(nbrows, nbcols, nnz, rowp, cols);
+
+  // Load the optional arrays if they were allocated when saved
+  auto load_optional = [&](const char *name, IdxArray1D_t &array) {
+    std::size_t count = ckpt.get_count<index_t>(prefix + name);
+    if (count > 0) {
+      array = IdxArray1D_t(name + 1, count);
+      ckpt.read_view(prefix + name, array);
+    }
+  };
+  load_optional("/diag", A->diag);
+  load_optional("/perm", A->perm);
+  load_optional("/iperm", A->iperm);
+  load_optional("/color_count", A->color_count);
+  A->num_colors = info[5];
+
+  if (ckpt.has(prefix + "/vals")) {
+    ckpt.read_view(prefix + "/vals", A->vals);
+  } else {
+    A->zero();
+  }
+
+  return A;
+}
+
 }  // namespace A2D
 
 #endif  // A2D_SPARSE_UTILS_INL_H
\ No newline at end of file
@@ -2,9 +2,11 @@
 #define A2D_SPARSE_UTILS_H
 
 #include <algorithm>
+#include <string>
 
 #include "a2ddefs.h"
 #include "sparse/sparse_matrix.h"
+#include "utils/a2dcheckpoint.h"
 
 namespace A2D {
 
@@ -59,6 +61,21 @@ CSRMat<T> bsr_to_csr(BSRMat<T, M, N> bsr_mat);
 template <typename T, index_t M, index_t N>
 CSCMat<T> bsr_to_csc(BSRMat<T, M, N> bsr_mat);
 
+// Convert SymBSRMat to an unblocked CSC format with both triangles, suitable
+// as input for SparseCholesky
+template <typename T, index_t M>
+CSCMat<T> bsr_to_csc(SymBSRMat<T, M> bsr_mat);
+
+// Save the nonzero pattern, orderings and optionally the values of a BSRMat
+template <typename T, index_t M, index_t N>
+void BSRMatSave(CheckpointWriter &ckpt, const std::string &prefix,
+                BSRMat<T, M, N> &A, bool save_values = true);
+
+// Load a BSRMat saved with BSRMatSave, values are zero if not saved
+template <typename T, index_t M, index_t N>
+BSRMat<T, M, N> *BSRMatLoad(const CheckpointReader &ckpt,
+                            const std::string &prefix);
+
 }  // namespace A2D
 
 #include "sparse/sparse_utils-inl.h"
@@ -0,0 +1,367 @@
+#ifndef A2D_CHECKPOINT_H
+#define A2D_CHECKPOINT_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "a2ddefs.h"
+#include "utils/a2dmappedfile.h"
+
+namespace A2D {
+
+/**
+ * @brief Versioned binary checkpoint format
+ *
+ * A checkpoint is a collection of named arrays. The file layout is:
+ *
+ * header:   magic "A2DCKPT", format version, size of index_t, number of
+ *           sections and the offset of the table of contents
+ * sections: raw array data, each aligned to 64 bytes
+ * contents: name, kind, element size, count and offset of each section
+ *
+ * Data is written in the native byte order, the header records the byte
+ * order and the reader rejects files written with a different one.
+ */
+struct CheckpointFormat {
+  static constexpr char magic[8] = "A2DCKPT";
+  static constexpr uint32_t version = 1;
+  static constexpr uint32_t byte_order = 0x01020304;
+  static constexpr std::size_t alignment = 64;
+  static constexpr std::size_t max_name = 96;
+
+  struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t index_size;
+    uint32_t padding;
+    uint64_t nsections;
+    uint64_t contents_offset;
+  };
+
+  struct Section {
+    char name[max_name];
+    uint32_t kind;       // 'i', 'u', 'f' or 'c' for complex
+    uint32_t elem_size;  // size of each entry in bytes
+    uint64_t count;      // number of entries
+    uint64_t offset;     // offset of the data from the start of the file
+  };
+
+  template <typename T>
+  static uint32_t kind() {
+    if constexpr (std::is_integral_v<T>) {
+      return std::is_signed_v<T> ? 'i' : 'u';
+    } else if constexpr (std::is_floating_point_v<T>) {
+      return 'f';
+    } else {
+      return 'c';
+    }
+  }
+};
+
+/**
+ * @brief Write a checkpoint file
+ *
+ * Usage:
+ *
+ * CheckpointWriter ckpt("restart.a2d");
+ * conn.save(ckpt);
+ * mesh.save(ckpt);
+ * sol.save(ckpt, "sol");
+ * ckpt.close();
+ */
+class CheckpointWriter {
+ public:
+  CheckpointWriter(const std::string& filename) : filename(filename) {
+    fp = std::fopen(filename.c_str(), "wb");
+    if (!fp) {
+      char msg[256];
+      std::snprintf(msg, sizeof(msg), "CheckpointWriter: cannot open file %s",
+                    filename.c_str());
+      throw std::runtime_error(msg);
+    }
+
+    // Write a placeholder header, updated when the file is closed
+    CheckpointFormat::Header header = {};
+    std::fwrite(&header, sizeof(header), 1, fp);
+    offset = sizeof(header);
+  }
+
+  // Call close() to see write errors, the destructor can not report them
+  ~CheckpointWriter() {
+    try {
+      close();
+    } catch (const std::runtime_error&) {
+    }
+  }
+
+  CheckpointWriter(const CheckpointWriter&) = delete;
+  CheckpointWriter& operator=(const CheckpointWriter&) = delete;
+
+  /**
+   * @brief Write an array
+   *
+   * @param name unique name of the array
+   * @param data the array entries
+   * @param count the number of entries
+   */
+  template <typename T>
+  void write(const std::string& name, const T* data, std::size_t count) {
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "checkpoint data must be trivially copyable");
+    if (!fp) {
+      error("file is closed", name);
+    }
+    if (name.size() >= CheckpointFormat::max_name) {
+      error("name is too long", name);
+    }
+    for (const CheckpointFormat::Section& s : sections) {
+      if (name == s.name) {
+        error("duplicate section", name);
+      }
+    }
+
+    // Pad to the alignment
+    const std::size_t align = CheckpointFormat::alignment;
+    const std::size_t pad = (align - offset % align) % align;
+    const char zeros[CheckpointFormat::alignment] = {};
+    std::fwrite(zeros, 1, pad, fp);
+    offset += pad;
+
+    CheckpointFormat::Section s = {};
+    std::strncpy(s.name, name.c_str(), CheckpointFormat::max_name - 1);
+    s.kind = CheckpointFormat::kind<T>();
+    s.elem_size = sizeof(T);
+    s.count = count;
+    s.offset = offset;
+    sections.push_back(s);
+
+    if (count > 0 && std::fwrite(data, sizeof(T), count, fp) != count) {
+      error("write failed", name);
+    }
+    offset += count * sizeof(T);
+  }
+
+  template <typename T>
+  void write(const std::string& name, const std::vector<T>& data) {
+    write(name, data.data(), data.size());
+  }
+
+  // Write a contiguous Kokkos view
+  template <class ViewType>
+  void write_view(const std::string& name, const ViewType& view) {
+    write(name, view.data(), view.is_allocated() ? view.span() : 0);
+  }
+
+  template <typename T>
+  void write_scalar(const std::string& name, const T value) {
+    write(name, &value, 1);
+  }
+
+  /**
+   * @brief Write the table of contents and the header and close the file
+   */
+  void close() {
+    if (!fp) {
+      return;
+    }
+
+    CheckpointFormat::Header header = {};
+    std::memcpy(header.magic, CheckpointFormat::magic, sizeof(header.magic));
+    header.version = CheckpointFormat::version;
+    header.byte_order = CheckpointFormat::byte_order;
+    header.index_size = sizeof(index_t);
+    header.nsections = sections.size();
+    header.contents_offset = offset;
+
+    const char* what = nullptr;
+    if (std::fwrite(sections.data(), sizeof(CheckpointFormat::Section),
+                    sections.size(), fp) != sections.size()) {
+      what = "write failed";
+    } else if (std::fseek(fp, 0, SEEK_SET) != 0) {
+      what = "seek failed";
+    } else if (std::fwrite(&header, sizeof(header), 1, fp) != 1) {
+      what = "write failed";
+    }
+
+    // The file is closed even on failure, fclose flushes the buffered data
+    if (std::fclose(fp) != 0 && !what) {
+      what = "close failed";
+    }
+    fp = nullptr;
+    if (what) {
+      error(what, "header");
+    }
+  }
+
+ private:
+  [[noreturn]] void error(const char* what, const std::string& name) const {
+    char msg[512];
+    std::snprintf(msg, sizeof(msg), "CheckpointWriter: %s for %s in file %s",
+                  what, name.c_str(), filename.c_str());
+    throw std::runtime_error(msg);
+  }
+
+  std::string filename;
+  std::FILE* fp;
+  uint64_t offset;
+  std::vector<CheckpointFormat::Section> sections;
+};
+
+/**
+ * @brief Read a checkpoint file
+ *
+ * The file is mapped into memory so that get() returns pointers directly
+ * into the file without copying, and read() copies only the requested
+ * arrays.
+ */
+class CheckpointReader {
+ public:
+  CheckpointReader(const std::string& filename)
+      : filename(filename),
+        file(filename),
+        data(file.data()),
+        size(file.size()) {
+    read_contents();
+  }
+
+  CheckpointReader(const CheckpointReader&) = delete;
+  CheckpointReader& operator=(const CheckpointReader&) = delete;
+
+  uint32_t get_version() const { return version; }
+
+  bool has(const std::string& name) const {
+    return sections.find(name) != sections.end();
+  }
+
+  /**
+   * @brief Get a pointer to the array data in the file without copying
+   *
+   * @param name name of the array
+   * @param count on exit, the number of entries
+   * @return pointer to the entries, valid for the life of the reader
+   */
+  template <typename T>
+  const T* get(const std::string& name, std::size_t* count = nullptr) const {
+    const CheckpointFormat::Section& s = find<T>(name);
+    if (count) {
+      *count = s.count;
+    }
+    return reinterpret_cast<const T*>(data + s.offset);
+  }
+
+  template <typename T>
+  std::size_t get_count(const std::string& name) const {
+    return find<T>(name).count;
+  }
+
+  // Copy an array with the given number of entries
+  template <typename T>
+  void read(const std::string& name, T* dest, std::size_t count) const {
+    std::size_t n;
+    const T* src = get<T>(name, &n);
+    if (n != count) {
+      char msg[256];
+      std::snprintf(msg, sizeof(msg), "expected %zu entries, found %zu", count,
+                    n);
+      error(msg, name);
+    }
+    if (count > 0) {
+      std::memcpy(dest, src, count * sizeof(T));
+    }
+  }
+
+  template <typename T>
+  void read(const std::string& name, std::vector<T>& dest) const {
+    std::size_t n;
+    const T* src = get<T>(name, &n);
+    dest.assign(src, src + n);
+  }
+
+  // Copy into a contiguous Kokkos view that is already allocated
+  template <class ViewType>
+  void read_view(const std::string& name, ViewType& view) const {
+    read(name, view.data(), view.is_allocated() ? view.span() : 0);
+  }
+
+  template <typename T>
+  T read_scalar(const std::string& name) const {
+    T value;
+    read(name, &value, 1);
+    return value;
+  }
+
+ private:
+  [[noreturn]] void error(const char* what, const std::string& name) const {
+    char msg[512];
+    std::snprintf(msg, sizeof(msg), "CheckpointReader: %s for %s in file %s",
+                  what, name.c_str(), filename.c_str());
+    throw std::runtime_error(msg);
+  }
+
+  template <typename T>
+  const CheckpointFormat::Section& find(const std::string& name) const {
+    auto it = sections.find(name);
+    if (it == sections.end()) {
+      error("section not found", name);
+    }
+    const CheckpointFormat::Section& s = it->second;
+    if (s.elem_size != sizeof(T) || s.kind != CheckpointFormat::kind<T>()) {
+      error("data type does not match", name);
+    }
+    return s;
+  }
+
+  void read_contents() {
+    CheckpointFormat::Header header;
+    if (size < sizeof(header)) {
+      error("file is too small", "header");
+    }
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, CheckpointFormat::magic,
+                    sizeof(header.magic)) != 0) {
+      error("not a checkpoint file", "header");
+    }
+    if (header.version == 0 || header.version > CheckpointFormat::version) {
+      error("unsupported version", "header");
+    }
+    if (header.byte_order != CheckpointFormat::byte_order) {
+      error("byte order does not match", "header");
+    }
+    if (header.index_size != sizeof(index_t)) {
+      error("index size does not match", "header");
+    }
+    version = header.version;
+
+    const std::size_t ssize = sizeof(CheckpointFormat::Section);
+    if (header.contents_offset + header.nsections * ssize > size) {
+      error("file is truncated", "contents");
+    }
+    for (uint64_t i = 0; i < header.nsections; i++) {
+      CheckpointFormat::Section s;
+      std::memcpy(&s, data + header.contents_offset + i * ssize, ssize);
+      s.name[CheckpointFormat::max_name - 1] = '\0';
+      if (s.offset + s.count * s.elem_size > header.contents_offset) {
+        error("file is truncated", s.name);
+      }
+      sections[s.name] = s;
+    }
+  }
+
+  std::string filename;
+  MappedFile file;
+  const char* data;
+  std::size_t size;
+  uint32_t version;
+  std::map<std::string, CheckpointFormat::Section> sections;
+};
+
+}  // namespace A2D
+
+#endif  // A2D_CHECKPOINT_H
@@ -0,0 +1,99 @@
+#ifndef A2D_MAPPED_FILE_H
+#define A2D_MAPPED_FILE_H
+
+#include <cstddef>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace A2D {
+
+/**
+ * @brief Read-only view of the contents of a file
+ *
+ * The file is mapped into memory on POSIX systems. Otherwise, or when the
+ * mapping fails, the contents are read into a buffer. The mapping is released
+ * when the object is destroyed.
+ */
+class MappedFile {
+ public:
+  /**
+   * @brief Map the file into memory
+   *
+   * @param filename name of the file
+   * @param sequential advise the system that the file is read sequentially
+   */
+  MappedFile(const std::string& filename, bool sequential = false)
+      : contents(nullptr), nbytes(0), mapped(false) {
+    if (!std::filesystem::exists(filename)) {
+      char msg[256];
+      std::snprintf(msg, sizeof(msg), "file %s does not exists!",
+                    filename.c_str());
+      throw std::runtime_error(msg);
+    }
+    nbytes = std::filesystem::file_size(filename);
+
+#if defined(__unix__) || defined(__APPLE__)
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd >= 0 && nbytes > 0) {
+      void* ptr = ::mmap(nullptr, nbytes, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (ptr != MAP_FAILED) {
+        if (sequential) {
+          ::madvise(ptr, nbytes, MADV_SEQUENTIAL);
+        }
+        contents = static_cast<const char*>(ptr);
+        mapped = true;
+      }
+    }
+    if (fd >= 0) {
+      ::close(fd);
+    }
+#endif
+
+    if (!mapped) {
+      buffer.resize(nbytes);
+      std::ifstream ifs(filename, std::ios::binary);
+      if (!ifs.read(buffer.data(), nbytes)) {
+        char msg[256];
+        std::snprintf(msg, sizeof(msg), "cannot read file %s",
+                      filename.c_str());
+        throw std::runtime_error(msg);
+      }
+      contents = buffer.data();
+    }
+  }
+
+  ~MappedFile() {
+#if defined(__unix__) || defined(__APPLE__)
+    if (mapped) {
+      ::munmap(const_cast<char*>(contents), nbytes);
+    }
+#endif
+  }
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  const char* data() const { return contents; }
+  std::size_t size() const { return nbytes; }
+  bool is_mapped() const { return mapped; }
+
+ private:
+  const char* contents;
+  std::size_t nbytes;
+  bool mapped;
+  std::vector<char> buffer;
+};
+
+}  // namespace A2D
+
+#endif  // A2D_MAPPED_FILE_H
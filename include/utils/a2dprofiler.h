@@ -2,26 +2,237 @@
 #define A2D_PROFILER_H
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cstdint>
 #include <cstdio>
+#include <cstring>
 #include <ctime>
-#include <iomanip>
-#include <iostream>
+#include <limits>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <string_view>
 #include <vector>
 
+#if defined(__linux__) && !defined(A2D_DISABLE_PROFILER)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
 namespace A2D {
 
-struct TimerEntry {
-  std::string msg;
-  char type;  // '(' or ')'
-  double t;   // in ms
+/**
+ * @brief Work counted by the kernels and attributed to the innermost running
+ * Timer of the calling thread with Timer::count()
+ *
+ * FLOPS and BYTES are estimates from the known block sizes of each kernel,
+ * the profiler reports them as the achieved GFLOP/s and GB/s of each scope.
+ */
+enum class PerfCounter {
+  FLOPS,
+  BYTES,
+  ELEMENTS,
+  QUADRATURE_POINTS,
+  BLOCKS,
+  NUM_COUNTERS
 };
 
+#ifndef A2D_DISABLE_PROFILER
+
 /**
- * @brief A very simple scope-based timer that measures time between creation
- *        and destroy of the timer object.
+ * @brief Optional hardware counters of the calling thread (cycles,
+ * instructions and last-level cache misses) read with perf_event_open
+ *
+ * Only available on Linux when the kernel allows it (see
+ * /proc/sys/kernel/perf_event_paranoid), otherwise open() returns false.
+ */
+class HardwareCounters {
+ public:
+  static constexpr int NUM_EVENTS = 3;
+
+  HardwareCounters() : fd{-1, -1, -1} {}
+  ~HardwareCounters() { close(); }
+
+  HardwareCounters(const HardwareCounters&) = delete;
+  HardwareCounters& operator=(const HardwareCounters&) = delete;
+
+  bool is_open() const { return fd[0] >= 0; }
+
+  bool open() {
+#if defined(__linux__)
+    const uint64_t config[NUM_EVENTS] = {PERF_COUNT_HW_CPU_CYCLES,
+                                         PERF_COUNT_HW_INSTRUCTIONS,
+                                         PERF_COUNT_HW_CACHE_MISSES};
+    for (int i = 0; i < NUM_EVENTS; i++) {
+      perf_event_attr attr;
+      std::memset(&attr, 0, sizeof(attr));
+      attr.type = PERF_TYPE_HARDWARE;
+      attr.size = sizeof(attr);
+      attr.config = config[i];
+      attr.read_format = PERF_FORMAT_GROUP;
+      attr.disabled = (i == 0);
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+
+      // Count the calling thread on any cpu, events are grouped with the first
+      fd[i] = syscall(__NR_perf_event_open, &attr, 0, -1, i == 0 ? -1 : fd[0],
+                      0);
+      if (fd[i] < 0) {
+        close();
+        return false;
+      }
+    }
+    ioctl(fd[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(fd[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    return true;
+#else
+    return false;
+#endif
+  }
+
+  // Read the current values of the counters
+  void read(uint64_t values[]) const {
+#if defined(__linux__)
+    uint64_t buffer[1 + NUM_EVENTS];
+    if (::read(fd[0], buffer, sizeof(buffer)) == sizeof(buffer)) {
+      std::memcpy(values, &buffer[1], sizeof(uint64_t) * NUM_EVENTS);
+      return;
+    }
+#endif
+    std::fill(values, values + NUM_EVENTS, 0);
+  }
+
+ private:
+  void close() {
+#if defined(__linux__)
+    for (int i = 0; i < NUM_EVENTS; i++) {
+      if (fd[i] >= 0) {
+        ::close(fd[i]);
+        fd[i] = -1;
+      }
+    }
+#endif
+  }
+
+  int fd[NUM_EVENTS];
+};
+
+/**
+ * @brief Aggregated statistics of a timed scope at one position in the call
+ * tree. All times are inclusive and in ms.
+ */
+struct TimerNode {
+  TimerNode(std::string_view name, int parent) : name(name), parent(parent) {}
+
+  std::string name;
+  int parent;
+  std::vector<int> children;
+  std::size_t count = 0;
+  double total = 0.0;
+  double min = std::numeric_limits<double>::max();
+  double max = 0.0;
+  double child_total = 0.0;  // inclusive time of the children
+  double counters[int(PerfCounter::NUM_COUNTERS)] = {};
+  uint64_t hardware[HardwareCounters::NUM_EVENTS] = {};
+
+  double exclusive() const { return total - child_total; }
+  double mean() const { return count > 0 ? total / count : 0.0; }
+
+  void add(double t) {
+    count++;
+    total += t;
+    min = std::min(min, t);
+    max = std::max(max, t);
+  }
+};
+
+// A single timed call, only recorded when the trace is enabled
+struct TimerTraceEvent {
+  int node;
+  double start;  // in us from the start of the program
+  double duration;
+};
+
+/**
+ * @brief Call tree of the timed scopes of a single thread
+ *
+ * Only the owning thread modifies the tree, so no locking is required while
+ * timing. Node 0 is the root of the tree.
+ */
+class TimerThreadData {
+ public:
+  TimerThreadData(int tid) : tid(tid), current(0) {
+    nodes.emplace_back("root", -1);
+  }
+
+  // Enter the child of the current node with the given name
+  int enter(std::string_view name) {
+    for (int child : nodes[current].children) {
+      if (nodes[child].name == name) {
+        return current = child;
+      }
+    }
+    int node = nodes.size();
+    nodes.emplace_back(name, current);
+    nodes[current].children.push_back(node);
+    return current = node;
+  }
+
+  // Exit the node and record the elapsed time
+  void exit(int node, double start, double t) {
+    nodes[node].add(t);
+    current = nodes[node].parent;
+    nodes[current].child_total += t;
+    if (record_trace) {
+      events.push_back(TimerTraceEvent{node, start, 1e3 * t});
+    }
+  }
+
+  void count(PerfCounter counter, double value) {
+    nodes[current].counters[int(counter)] += value;
+  }
 
+  void reset() {
+    nodes.erase(nodes.begin() + 1, nodes.end());
+    nodes[0].children.clear();
+    nodes[0].child_total = 0.0;
+    current = 0;
+    events.clear();
+  }
+
+  const int tid;
+  int current;
+  bool record_trace = false;
+  HardwareCounters hardware;
+  std::vector<TimerNode> nodes;
+  std::vector<TimerTraceEvent> events;
+};
+
+/**
+ * @brief A scope-based timer that measures time between creation and destroy
+ *        of the timer object.
+ *
+ * Each thread records its timers in an in-memory call tree with the call
+ * counts and the min/mean/max, inclusive and exclusive times of each scope.
+ * Nothing is written while timing: the trees of all threads are merged and
+ * written to the log files once at exit, or on demand with flush().
+ *
+ * The long log contains the full call tree, the short log only contains the
+ * scopes with a total time above the threshold. If a trace path is set, each
+ * timed call is also recorded and exported in the Chrome trace-event format
+ * (viewable with chrome://tracing or Perfetto).
+ *
+ * Kernels attribute their work (flops, bytes, elements, ...) to the innermost
+ * running timer with count(), and the logs report the achieved GFLOP/s and
+ * GB/s of each scope. With enable_hardware_counters(), the cycles,
+ * instructions and cache misses of each scope are also recorded when the
+ * system allows it.
+ *
+ * Define A2D_DISABLE_PROFILER to compile the timers out entirely.
+ *
  * Usage:
  * {
  *   Timer t("Very brief info about what is timed");
@@ -32,147 +243,394 @@ struct TimerEntry {
  */
 class Timer {
  public:
-  Timer(std::string _fun_name = "unknown") {
-    if (TIMER_IS_ON) {
-      fun_name = _fun_name;
+  Timer(std::string_view fun_name = "unknown") {
+    if (TIMER_IS_ON.load(std::memory_order_relaxed)) {
+      data = &thread_data();
+      node = data->enter(fun_name);
+      if (data->hardware.is_open()) {
+        data->hardware.read(hw_start);
+      }
+      t_start = std::chrono::steady_clock::now();
+    }
+  }
+
+  ~Timer() {
+    if (data) {
+      auto t_end = std::chrono::steady_clock::now();
+      double t_elapse =
+          1e-6 *
+          (std::chrono::duration_cast<std::chrono::nanoseconds>(t_end - t_start)
+               .count());  // in ms
+      double start = 0.0;
+      if (data->record_trace) {
+        start = 1e-3 * std::chrono::duration_cast<std::chrono::nanoseconds>(
+                           t_start - registry().epoch)
+                           .count();  // in us
+      }
+      if (data->hardware.is_open()) {
+        uint64_t hw_end[HardwareCounters::NUM_EVENTS];
+        data->hardware.read(hw_end);
+        for (int i = 0; i < HardwareCounters::NUM_EVENTS; i++) {
+          data->nodes[node].hardware[i] += hw_end[i] - hw_start[i];
+        }
+      }
+      data->exit(node, start, t_elapse);
+    }
+  }
 
-      if (!timer_log_touched) {
-        timer_log_touched = true;
+  Timer(const Timer&) = delete;
+  Timer& operator=(const Timer&) = delete;
 
-        // Clean log files, if exist
-        fp = std::fopen(TIMER_OUTPUT_FILE.c_str(), "w+");
-        fp2 = std::fopen(TIMER_SHORT_OUTPUT_FILE.c_str(), "w+");
+  static void on() { TIMER_IS_ON = true; }
+  static void off() { TIMER_IS_ON = false; }
+
+  static void set_log_path(std::string log_path) {
+    TIMER_OUTPUT_FILE = log_path;
+  }
 
-        // Get time stamp
-        auto now = std::chrono::system_clock::now();
-        std::time_t now_time = std::chrono::system_clock::to_time_t(now);
+  static void set_short_log_path(std::string short_log_path) {
+    TIMER_SHORT_OUTPUT_FILE = short_log_path;
+  }
+
+  static void set_threshold_ms(double t) { TIMER_THRESHOLD_MS = t; }
+
+  /**
+   * @brief Add work to the innermost running timer of the calling thread
+   *
+   * Call from the thread that owns the timed scope, not from inside the
+   * parallel loop of the kernel.
+   */
+  static void count(PerfCounter counter, double value) {
+    if (TIMER_IS_ON.load(std::memory_order_relaxed)) {
+      thread_data().count(counter, value);
+    }
+  }
+
+  /**
+   * @brief Record the hardware counters for the timers of each thread that
+   * starts timing after this call, if perf_event_open is available
+   */
+  static void enable_hardware_counters() {
+    TIMER_HARDWARE_COUNTERS.store(true, std::memory_order_relaxed);
+  }
 
-        // Write header
+  /**
+   * @brief Record every timed call and write a Chrome trace to the given
+   * path when the timers are flushed. Only the threads that start timing
+   * after this call record their calls.
+   *
+   * Call outside of parallel regions.
+   */
+  static void set_trace_path(std::string trace_path) {
+    TIMER_TRACE_FILE = trace_path;
+    TIMER_RECORD_TRACE.store(!trace_path.empty(), std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Write the log files (and the trace) now. The files are written
+   * again at exit with the complete data.
+   *
+   * Call outside of parallel regions.
+   */
+  static void flush() { registry().flush(); }
+
+  // Print the merged call tree of all threads
+  static void report(std::FILE* fp = stdout, double threshold_ms = 0.0) {
+    registry().report(fp, threshold_ms);
+  }
+
+  // Write the recorded calls in the Chrome trace-event format
+  static void write_chrome_trace(const std::string& filename) {
+    registry().write_chrome_trace(filename);
+  }
+
+  // Discard all the recorded data, call when no timers are running
+  static void reset() { registry().reset(); }
+
+ private:
+  // Owns the data of all the threads and writes the logs at exit
+  class Registry {
+   public:
+    Registry() : epoch(std::chrono::steady_clock::now()) {}
+    ~Registry() { flush(); }
+
+    // Create the data of a new thread with the options at its creation
+    std::shared_ptr<TimerThreadData> add_thread(bool record_trace,
+                                                bool hardware) {
+      std::lock_guard<std::mutex> lock(mutex);
+      auto data = std::make_shared<TimerThreadData>(threads.size());
+      data->record_trace = record_trace;
+      if (hardware) {
+        data->hardware.open();
+      }
+      threads.push_back(data);
+      return data;
+    }
+
+    void flush() {
+      std::lock_guard<std::mutex> lock(mutex);
+      std::vector<TimerNode> merged = merge();
+      if (merged[0].children.empty()) {
+        return;
+      }
+
+      // Get time stamp
+      auto now = std::chrono::system_clock::now();
+      std::time_t now_time = std::chrono::system_clock::to_time_t(now);
+
+      std::FILE* fp = std::fopen(TIMER_OUTPUT_FILE.c_str(), "w");
+      if (fp) {
         std::fprintf(fp,
                      "========================\n%s========================\n",
                      std::ctime(&now_time));
-        std::fprintf(fp2,
+        write_tree(fp, merged, 0.0);
+        std::fclose(fp);
+      }
+
+      fp = std::fopen(TIMER_SHORT_OUTPUT_FILE.c_str(), "w");
+      if (fp) {
+        std::fprintf(fp,
                      "========================\n%sshort log, threshold: %.1f "
                      "ms\n========================\n",
                      std::ctime(&now_time), TIMER_THRESHOLD_MS);
-        std::fclose(fp2);
-
-      } else {
-        fp = std::fopen(TIMER_OUTPUT_FILE.c_str(), "a+");
+        write_tree(fp, merged, TIMER_THRESHOLD_MS);
+        std::fclose(fp);
       }
 
-      // Assemble the line of message
-      std::string message =
-          std::string(TIMER_TAB * counter, ' ') + fun_name + " executed";
-
-      // Flush the long log
-      std::fprintf(fp, "%s\n", message.c_str());
-      std::fclose(fp);
+      if (!TIMER_TRACE_FILE.empty()) {
+        write_trace(TIMER_TRACE_FILE);
+      }
+    }
 
-      // Save data for short log
-      buffer.push_back(TimerEntry{message, '(', 0.0});
+    void report(std::FILE* fp, double threshold_ms) {
+      std::lock_guard<std::mutex> lock(mutex);
+      write_tree(fp, merge(), threshold_ms);
+    }
 
-      counter++;
-      t_start = std::chrono::steady_clock::now();
+    void write_chrome_trace(const std::string& filename) {
+      std::lock_guard<std::mutex> lock(mutex);
+      write_trace(filename);
     }
 
-    return;
-  }
+    void reset() {
+      std::lock_guard<std::mutex> lock(mutex);
+      for (auto& data : threads) {
+        data->reset();
+      }
+    }
 
-  ~Timer() {
-    if (TIMER_IS_ON) {
-      auto t_end = std::chrono::steady_clock::now();
-      double t_elapse =
-          1e-6 *
-          (std::chrono::duration_cast<std::chrono::nanoseconds>(t_end - t_start)
-               .count());  // in ms
+    const std::chrono::time_point<std::chrono::steady_clock> epoch;
+
+   private:
+    // Merge the trees of all threads by the path of each node
+    std::vector<TimerNode> merge() const {
+      std::vector<TimerNode> merged;
+      merged.emplace_back("root", -1);
+
+      for (const auto& data : threads) {
+        const std::vector<TimerNode>& nodes = data->nodes;
+        std::vector<int> map(nodes.size(), 0);
+        for (std::size_t i = 1; i < nodes.size(); i++) {
+          // Parents are always created before their children
+          int parent = map[nodes[i].parent];
+          int node = -1;
+          for (int child : merged[parent].children) {
+            if (merged[child].name == nodes[i].name) {
+              node = child;
+            }
+          }
+          if (node < 0) {
+            node = merged.size();
+            merged.emplace_back(nodes[i].name, parent);
+            merged[parent].children.push_back(node);
+          }
+          map[i] = node;
+
+          TimerNode& m = merged[node];
+          m.count += nodes[i].count;
+          m.total += nodes[i].total;
+          m.min = std::min(m.min, nodes[i].min);
+          m.max = std::max(m.max, nodes[i].max);
+          m.child_total += nodes[i].child_total;
+          for (int k = 0; k < int(PerfCounter::NUM_COUNTERS); k++) {
+            m.counters[k] += nodes[i].counters[k];
+          }
+          for (int k = 0; k < HardwareCounters::NUM_EVENTS; k++) {
+            m.hardware[k] += nodes[i].hardware[k];
+          }
+        }
+      }
 
-      counter--;
+      return merged;
+    }
 
-      // Assemble line of message
-      char _message[256];
-      snprintf(
-          _message, 256, "%-80s(%.2f ms)",
-          (std::string(TIMER_TAB * counter, ' ') + fun_name + " exits").c_str(),
-          t_elapse);
-      std::string message(_message);
+    static void write_tree(std::FILE* fp, const std::vector<TimerNode>& nodes,
+                           double threshold_ms) {
+      // Only add the columns of the counters that were recorded
+      bool counts = false, hardware = false;
+      for (const TimerNode& n : nodes) {
+        for (double c : n.counters) {
+          counts = counts || c != 0.0;
+        }
+        hardware = hardware || n.hardware[0] != 0;
+      }
 
-      // Flush the long log
-      fp = std::fopen(TIMER_OUTPUT_FILE.c_str(), "a+");
-      std::fprintf(fp, "%s\n", message.c_str());
-      std::fclose(fp);
+      std::fprintf(fp, "%-60s %10s %12s %12s %10s %10s %10s", "scope",
+                   "calls", "total(ms)", "self(ms)", "min(ms)", "mean(ms)",
+                   "max(ms)");
+      if (counts) {
+        std::fprintf(fp, " %10s %10s %10s %10s %10s", "elems", "qpts",
+                     "blocks", "GFLOP/s", "GB/s");
+      }
+      if (hardware) {
+        std::fprintf(fp, " %10s %10s %10s", "Gcycles", "IPC", "LLC miss");
+      }
+      std::fprintf(fp, "\n");
+      write_node(fp, nodes, 0, 0, threshold_ms, counts, hardware);
+    }
 
-      // Save data for short log
-      buffer.push_back(TimerEntry{message, ')', t_elapse});
-
-      // Once the most outer function returns, we filter the buffer such
-      // that we only keep entry pairs whose elapse time is above threshold
-      // We assume that lines in buffer are all paired
-      if (counter == 0) {
-        std::vector<int> istart, keep;
-        int idx = 0;
-        for (auto it = buffer.begin(); it != buffer.end(); it++) {
-          if (it->type == '(') {
-            istart.push_back(idx);
-          }
-          if (it->type == ')') {
-            if (!istart.empty()) {
-              int start_idx = istart.back();
-              istart.pop_back();
-              if (it->t > TIMER_THRESHOLD_MS) {
-                keep.push_back(start_idx);
-                keep.push_back(idx);  // End idx
-              }
-            }
-          }
-          idx++;
+    static void write_node(std::FILE* fp, const std::vector<TimerNode>& nodes,
+                           int node, int depth, double threshold_ms,
+                           bool counts, bool hardware) {
+      for (int child : nodes[node].children) {
+        const TimerNode& n = nodes[child];
+        if (n.count == 0 || n.total < threshold_ms) {
+          continue;
         }
+        std::string name = std::string(TIMER_TAB * depth, ' ') + n.name;
+        std::fprintf(fp, "%-60s %10zu %12.3f %12.3f %10.3f %10.3f %10.3f",
+                     name.c_str(), n.count, n.total, n.exclusive(), n.min,
+                     n.mean(), n.max);
+
+        if (counts) {
+          for (PerfCounter c :
+               {PerfCounter::ELEMENTS, PerfCounter::QUADRATURE_POINTS,
+                PerfCounter::BLOCKS}) {
+            write_value(fp, n.counters[int(c)]);
+          }
 
-        //  Now, we only keep the entries for expensive function calls
-        std::sort(keep.begin(), keep.end());
-        fp2 = std::fopen(TIMER_SHORT_OUTPUT_FILE.c_str(), "a+");
-        for (auto ik = keep.begin(); ik != keep.end(); ik++) {
-          std::fprintf(fp2, "%s\n", buffer[*ik].msg.c_str());
+          // Rates over the inclusive time of the scope
+          double seconds = 1e-3 * n.total;
+          write_value(fp, 1e-9 * n.counters[int(PerfCounter::FLOPS)] / seconds);
+          write_value(fp, 1e-9 * n.counters[int(PerfCounter::BYTES)] / seconds);
+        }
+        if (hardware) {
+          write_value(fp, 1e-9 * n.hardware[0]);
+          write_value(fp, n.hardware[0] > 0
+                              ? double(n.hardware[1]) / n.hardware[0]
+                              : 0.0);
+          write_value(fp, n.hardware[2]);
         }
-        std::fclose(fp2);
+        std::fprintf(fp, "\n");
 
-        // Clean the buffer
-        buffer.clear();
+        write_node(fp, nodes, child, depth + 1, threshold_ms, counts,
+                   hardware);
       }
     }
 
-    return;
-  }
+    static void write_value(std::FILE* fp, double value) {
+      if (value != 0.0) {
+        std::fprintf(fp, " %10.4g", value);
+      } else {
+        std::fprintf(fp, " %10s", "-");
+      }
+    }
 
-  static void on() { TIMER_IS_ON = true; }
-  static void off() { TIMER_IS_ON = false; }
+    void write_trace(const std::string& filename) const {
+      std::FILE* fp = std::fopen(filename.c_str(), "w");
+      if (!fp) {
+        return;
+      }
 
-  static void set_log_path(std::string log_path) {
-    TIMER_OUTPUT_FILE = log_path;
-  }
+      std::fprintf(fp, "{\"traceEvents\":[");
+      bool first = true;
+      for (const auto& data : threads) {
+        for (const TimerTraceEvent& e : data->events) {
+          std::string name = escape(data->nodes[e.node].name);
+          std::fprintf(fp,
+                       "%s\n{\"name\":\"%s\",\"cat\":\"a2d\",\"ph\":\"X\","
+                       "\"ts\":%.3f,\"dur\":%.3f,\"pid\":0,\"tid\":%d}",
+                       first ? "" : ",", name.c_str(), e.start, e.duration,
+                       data->tid);
+          first = false;
+        }
+      }
+      std::fprintf(fp, "\n],\"displayTimeUnit\":\"ms\"}\n");
+      std::fclose(fp);
+    }
 
-  static void set_short_log_path(std::string short_log_path) {
-    TIMER_SHORT_OUTPUT_FILE = short_log_path;
+    static std::string escape(const std::string& s) {
+      std::string out;
+      for (char c : s) {
+        if (c == '"' || c == '\\') {
+          out.push_back('\\');
+          out.push_back(c);
+        } else if (static_cast<unsigned char>(c) >= 0x20) {
+          out.push_back(c);
+        }
+      }
+      return out;
+    }
+
+    std::mutex mutex;
+    std::vector<std::shared_ptr<TimerThreadData>> threads;
+  };
+
+  static Registry& registry() {
+    static Registry instance;
+    return instance;
   }
 
-  static void set_threshold_ms(double t) { TIMER_THRESHOLD_MS = t; }
+  static TimerThreadData& thread_data() {
+    thread_local std::shared_ptr<TimerThreadData> data =
+        registry().add_thread(
+            TIMER_RECORD_TRACE.load(std::memory_order_relaxed),
+            TIMER_HARDWARE_COUNTERS.load(std::memory_order_relaxed));
+    return *data;
+  }
 
- private:
-  std::FILE *fp, *fp2;
+  TimerThreadData* data = nullptr;
+  int node;
+  uint64_t hw_start[HardwareCounters::NUM_EVENTS];
   std::chrono::time_point<std::chrono::steady_clock> t_start;
-  std::string fun_name;
-  inline static int counter = 0;
-  inline static bool timer_log_touched = false;
-  inline static int TIMER_TAB = 4;
-  inline static std::vector<TimerEntry> buffer;
 
-  // Timer options
+  inline static const int TIMER_TAB = 4;
+
+  // Timer options. The paths and the threshold are only read when the logs
+  // are written and must be set outside of parallel regions. The flags are
+  // read by each thread when it creates its timer data.
   inline static std::string TIMER_OUTPUT_FILE = "profile.log";
   inline static std::string TIMER_SHORT_OUTPUT_FILE = "profile_short.log";
+  inline static std::string TIMER_TRACE_FILE = "";
   inline static double TIMER_THRESHOLD_MS = 1.0;
-  inline static bool TIMER_IS_ON = true;
+  inline static std::atomic<bool> TIMER_IS_ON = true;
+  inline static std::atomic<bool> TIMER_RECORD_TRACE = false;
+  inline static std::atomic<bool> TIMER_HARDWARE_COUNTERS = false;
+};
+
+#else
+
+// The profiler is compiled out, all the calls are empty
+class Timer {
+ public:
+  Timer(std::string_view fun_name = "unknown") {}
+
+  static void on() {}
+  static void off() {}
+  static void set_log_path(std::string log_path) {}
+  static void set_short_log_path(std::string short_log_path) {}
+  static void set_threshold_ms(double t) {}
+  static void set_trace_path(std::string trace_path) {}
+  static void count(PerfCounter counter, double value) {}
+  static void enable_hardware_counters() {}
+  static void flush() {}
+  static void report(std::FILE* fp = stdout, double threshold_ms = 0.0) {}
+  static void write_chrome_trace(const std::string& filename) {}
+  static void reset() {}
 };
 
+#endif  // A2D_DISABLE_PROFILER
+
 class StopWatch {
  public:
   StopWatch() { t_start = std::chrono::steady_clock::now(); }
@@ -192,4 +650,4 @@ class StopWatch {
 
 }  // namespace A2D
 
-#endif  // A2D_PROFILER_H
\ No newline at end of file
+#endif  // A2D_PROFILER_H
@@ -1,20 +1,30 @@
 #ifndef A2D_VTK_H
 #define A2D_VTK_H
 
+#include <algorithm>
+#include <charconv>
+#include <chrono>
 #include <complex>
+#include <cstdint>
 #include <cstdio>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <map>
+#include <memory>
 #include <set>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <type_traits>
+#include <vector>
 
 #include "a2ddefs.h"
 #include "array.h"
 #include "multiphysics/feelementtypes.h"
+#include "multiphysics/femesh_ordering.h"
+#include "utils/a2dmappedfile.h"
 
 namespace A2D {
 
@@ -285,13 +295,895 @@ class ToVTK3D {
   std::FILE* fp;
 };
 
+/**
+ * @brief Output format for the VTU writer
+ *
+ * APPENDED: Raw binary data appended after the XML description. The encoded
+ * arrays are held in memory until the file is closed.
+ *
+ * BINARY: Base64-encoded data written inline. Each nodal array is written to
+ * the file as soon as it is provided. Cell arrays are held in memory until the
+ * file is closed.
+ */
+enum class VTUFormat { APPENDED, BINARY };
+
+/**
+ * @brief Compression of the data arrays in the VTU writer
+ *
+ * LZ4 output uses the LZ4 block format read by vtkLZ4DataCompressor
+ */
+enum class VTUCompression { NONE, LZ4 };
+
+/**
+ * @brief A binary VTK XML unstructured grid (.vtu) writer
+ *
+ * The mesh must be written before the solution fields. Nodal and cell fields
+ * may be written in any order, the cell fields are placed in a single
+ * CellData section after the PointData section when the file is closed. Array
+ * conversion, compression and base64 encoding are performed in parallel over
+ * blocks of the data.
+ */
+class ToVTU {
+ public:
+  ToVTU(const std::string vtu_name = "result.vtu",
+        VTUFormat format = VTUFormat::APPENDED,
+        VTUCompression compression = VTUCompression::NONE)
+      : format(format),
+        compression(compression),
+        nnodes(0),
+        nelems(0),
+        offset(0),
+        point_data_open(false),
+        cell_data(nullptr) {
+    fp = std::fopen(vtu_name.c_str(), "wb");
+    if (!fp) {
+      char msg[256];
+      std::snprintf(msg, sizeof(msg), "ToVTU: cannot open file %s",
+                    vtu_name.c_str());
+      throw std::runtime_error(msg);
+    }
+  }
+
+  ~ToVTU() { close(); }
+
+  /**
+   * @brief Write the nodes and the connectivity
+   *
+   * @tparam ConnArray connectivity type, shape: (nelems, nnodes_per_elem)
+   * @tparam NodeArray nodal location type, shape: (nnodes, spatial_dim)
+   * @param vtk_elem_type VTK cell type, inferred from the connectivity if -1
+   */
+  template <class ConnArray, class NodeArray>
+  void write_mesh(const ConnArray& conn, const NodeArray& X,
+                  int vtk_elem_type = -1) {
+    nnodes = X.extent(0);
+    nelems = conn.extent(0);
+    const index_t spatial_dim = X.extent(1);
+    const index_t nnodes_per_elem = conn.extent(1);
+
+    if (spatial_dim != 2 and spatial_dim != 3) {
+      char msg[256];
+      std::snprintf(msg, sizeof(msg),
+                    "Invalid spatial_dim, got %d, expect 2 or 3", spatial_dim);
+      throw std::runtime_error(msg);
+    }
+
+    if (vtk_elem_type == -1) {
+      switch (nnodes_per_elem) {
+        case 4:
+          vtk_elem_type = VTKID::QUAD;
+          break;
+
+        case 8:
+          vtk_elem_type = VTKID::HEXAHEDRON;
+          break;
+
+        default:
+          char msg[256];
+          std::snprintf(msg, sizeof(msg),
+                        "nnodes_per_elem = %d is not supported",
+                        nnodes_per_elem);
+          throw std::runtime_error(msg);
+      }
+    }
+
+    // Write the file header
+    uint16_t one = 1;
+    bool little_endian = *reinterpret_cast<uint8_t*>(&one) == 1;
+    write_xml("<?xml version=\"1.0\"?>\n");
+    write_xml("<VTKFile type=\"UnstructuredGrid\" version=\"1.0\" ");
+    write_xml(little_endian ? "byte_order=\"LittleEndian\" "
+                            : "byte_order=\"BigEndian\" ");
+    write_xml("header_type=\"UInt64\"");
+    if (compression == VTUCompression::LZ4) {
+      write_xml(" compressor=\"vtkLZ4DataCompressor\"");
+    }
+    write_xml(">\n<UnstructuredGrid>\n");
+
+    char line[256];
+    std::snprintf(line, sizeof(line),
+                  "<Piece NumberOfPoints=\"%d\" NumberOfCells=\"%d\">\n",
+                  nnodes, nelems);
+    write_xml(line);
+
+    // Write the nodes, padded to three dimensions
+    std::vector<double> xyz(3 * nnodes);
+#pragma omp parallel for
+    for (index_t i = 0; i < nnodes; i++) {
+      for (index_t j = 0; j < 3; j++) {
+        xyz[3 * i + j] = (j < spatial_dim ? RealPart(X(i, j)) : 0.0);
+      }
+    }
+    write_xml("<Points>\n");
+    write_array("Float64", nullptr, 3, xyz.data(), xyz.size() * sizeof(double));
+    write_xml("</Points>\n");
+    std::vector<double>().swap(xyz);
+
+    // Write the connectivity, offsets and types
+    std::vector<int32_t> ints(nelems * nnodes_per_elem);
+#pragma omp parallel for
+    for (index_t i = 0; i < nelems; i++) {
+      for (index_t j = 0; j < nnodes_per_elem; j++) {
+        ints[nnodes_per_elem * i + j] = conn(i, j);
+      }
+    }
+    write_xml("<Cells>\n");
+    write_array("Int32", "connectivity", 1, ints.data(),
+                ints.size() * sizeof(int32_t));
+
+    ints.resize(nelems);
+#pragma omp parallel for
+    for (index_t i = 0; i < nelems; i++) {
+      ints[i] = (i + 1) * nnodes_per_elem;
+    }
+    write_array("Int32", "offsets", 1, ints.data(),
+                ints.size() * sizeof(int32_t));
+    std::vector<int32_t>().swap(ints);
+
+    std::vector<uint8_t> types(nelems, uint8_t(vtk_elem_type));
+    write_array("UInt8", "types", 1, types.data(), types.size());
+    write_xml("</Cells>\n");
+  }
+
+  /**
+   * @brief Write nodal solution to vtu.
+   *
+   * @tparam SolVector solution array type, shape: (nnodes)
+   * @param sol_name solution name
+   * @param sol_vec solution vector
+   */
+  template <class SolVector>
+  void write_sol(const char sol_name[], const SolVector& sol_vec) {
+    if (!point_data_open) {
+      write_xml("<PointData>\n");
+      point_data_open = true;
+    }
+    write_field(nnodes, sol_name, sol_vec);
+  }
+
+  /**
+   * @brief Write cell solution to vtu.
+   *
+   * @tparam SolVector solution array type, shape: (nelems)
+   * @param sol_name solution name
+   * @param sol_vec solution vector
+   */
+  template <class SolVector>
+  void write_cell_sol(const char sol_name[], const SolVector& sol_vec) {
+    // Hold the cell arrays until the PointData section is complete
+    cell_data = &cell_xml;
+    write_field(nelems, sol_name, sol_vec);
+    cell_data = nullptr;
+  }
+
+  /**
+   * @brief Finish the file, called by the destructor if not called before
+   */
+  void close() {
+    if (!fp) {
+      return;
+    }
+
+    cell_data = nullptr;
+    if (point_data_open) {
+      write_xml("</PointData>\n");
+      point_data_open = false;
+    }
+    if (!cell_xml.empty()) {
+      write_xml("<CellData>\n");
+      write_text(cell_xml.data(), cell_xml.size());
+      write_xml("</CellData>\n");
+      std::string().swap(cell_xml);
+    }
+    write_xml("</Piece>\n</UnstructuredGrid>\n");
+    if (format == VTUFormat::APPENDED) {
+      std::fwrite(xml.data(), 1, xml.size(), fp);
+      std::fprintf(fp, "<AppendedData encoding=\"raw\">\n_");
+      for (const std::vector<uint8_t>& block : appended) {
+        std::fwrite(block.data(), 1, block.size(), fp);
+      }
+      std::fprintf(fp, "\n</AppendedData>\n");
+    }
+    std::fprintf(fp, "</VTKFile>\n");
+    std::fclose(fp);
+    fp = nullptr;
+  }
+
+  /**
+   * @brief Compress a block using the LZ4 block format
+   *
+   * @param src the input data
+   * @param size the size of the input
+   * @param dest output buffer with at least lz4_bound(size) bytes
+   * @return the size of the compressed data
+   */
+  static std::size_t lz4_compress(const uint8_t* src, std::size_t size,
+                                  uint8_t* dest) {
+    const std::size_t min_match = 4;
+    const std::size_t hash_bits = 12;
+    std::vector<std::size_t> table(1 << hash_bits, 0);
+
+    // The last match must start 12 bytes before the end and the last 5 bytes
+    // are always literals
+    const std::size_t match_start_limit = (size > 12 ? size - 12 : 0);
+    const std::size_t match_end_limit = (size > 5 ? size - 5 : 0);
+
+    uint8_t* out = dest;
+    std::size_t anchor = 0, ip = 0;
+    while (ip < match_start_limit) {
+      uint32_t seq;
+      std::memcpy(&seq, src + ip, sizeof(seq));
+      const std::size_t h = (seq * 2654435761u) >> (32 - hash_bits);
+
+      // Positions are stored offset by one so that zero is empty
+      const std::size_t ref = table[h];
+      table[h] = ip + 1;
+
+      uint32_t ref_seq = 0;
+      if (ref > 0) {
+        std::memcpy(&ref_seq, src + ref - 1, sizeof(ref_seq));
+      }
+      if (ref == 0 || ip - (ref - 1) > 65535 || ref_seq != seq) {
+        ip++;
+        continue;
+      }
+
+      // Extend the match
+      const std::size_t match = ref - 1;
+      std::size_t len = min_match;
+      while (ip + len < match_end_limit && src[match + len] == src[ip + len]) {
+        len++;
+      }
+
+      out = lz4_write_sequence(out, src + anchor, ip - anchor, ip - match,
+                               len - min_match);
+      ip += len;
+      anchor = ip;
+    }
+
+    // Write the remaining literals
+    out = lz4_write_sequence(out, src + anchor, size - anchor, 0, 0);
+
+    return out - dest;
+  }
+
+  // Maximum size of the LZ4 compressed data
+  static std::size_t lz4_bound(std::size_t size) {
+    return size + size / 255 + 16;
+  }
+
+ private:
+  // Size of the blocks that are compressed independently
+  static constexpr std::size_t block_size = 32768;
+
+  template <class SolVector>
+  void write_field(index_t size, const char sol_name[],
+                   const SolVector& sol_vec) {
+    if (sol_vec.extent(0) != size) {
+      char msg[256];
+      std::snprintf(
+          msg, sizeof(msg),
+          "First dimension of sol_vec (%d) does not match the expected size "
+          "(%d)",
+          (int)sol_vec.extent(0), size);
+      throw std::runtime_error(msg);
+    }
+
+    std::vector<double> vals(size);
+#pragma omp parallel for
+    for (index_t i = 0; i < size; i++) {
+      vals[i] = RealPart(sol_vec(i));
+    }
+    write_array("Float64", sol_name, 1, vals.data(),
+                vals.size() * sizeof(double));
+  }
+
+  // Write XML text, buffered in the appended format since the offsets must
+  // precede the data
+  void write_xml(const char* text) { write_text(text, std::strlen(text)); }
+
+  // Write text to the cell data buffer, the XML buffer or the file
+  void write_text(const char* text, std::size_t size) {
+    if (cell_data) {
+      cell_data->append(text, size);
+    } else if (format == VTUFormat::APPENDED) {
+      xml.append(text, size);
+    } else {
+      std::fwrite(text, 1, size, fp);
+    }
+  }
+
+  // Write the description of the array and its data
+  void write_array(const char* type, const char* name, index_t ncomp,
+                   const void* data, std::size_t nbytes) {
+    std::vector<uint8_t> header, payload;
+    encode(static_cast<const uint8_t*>(data), nbytes, header, payload);
+
+    char line[512];
+    int n = std::snprintf(line, sizeof(line), "<DataArray type=\"%s\"", type);
+    if (name) {
+      n += std::snprintf(line + n, sizeof(line) - n, " Name=\"%s\"", name);
+    }
+    if (ncomp > 1) {
+      n += std::snprintf(line + n, sizeof(line) - n,
+                         " NumberOfComponents=\"%d\"", ncomp);
+    }
+
+    if (format == VTUFormat::APPENDED) {
+      std::snprintf(line + n, sizeof(line) - n,
+                    " format=\"appended\" offset=\"%llu\"/>\n",
+                    (unsigned long long)offset);
+      write_xml(line);
+
+      header.insert(header.end(), payload.begin(), payload.end());
+      offset += header.size();
+      appended.push_back(std::move(header));
+    } else {
+      std::snprintf(line + n, sizeof(line) - n, " format=\"binary\">\n");
+      write_xml(line);
+
+      // Compressed headers are encoded separately from the data while
+      // uncompressed headers are encoded together with the data
+      std::vector<char> text;
+      if (compression == VTUCompression::NONE) {
+        header.insert(header.end(), payload.begin(), payload.end());
+        base64(header.data(), header.size(), text);
+      } else {
+        base64(header.data(), header.size(), text);
+        write_text(text.data(), text.size());
+        base64(payload.data(), payload.size(), text);
+      }
+      write_text(text.data(), text.size());
+      write_xml("\n</DataArray>\n");
+    }
+  }
+
+  // Create the header and the (possibly compressed) data for an array
+  void encode(const uint8_t* data, std::size_t nbytes,
+              std::vector<uint8_t>& header, std::vector<uint8_t>& payload) {
+    if (compression == VTUCompression::NONE) {
+      uint64_t hdr = nbytes;
+      header.resize(sizeof(hdr));
+      std::memcpy(header.data(), &hdr, sizeof(hdr));
+      payload.assign(data, data + nbytes);
+      return;
+    }
+
+    // Compress the blocks in parallel
+    const std::size_t nblocks = (nbytes + block_size - 1) / block_size;
+    std::vector<std::vector<uint8_t>> blocks(nblocks);
+#pragma omp parallel for schedule(dynamic)
+    for (std::size_t k = 0; k < nblocks; k++) {
+      std::size_t size = std::min(block_size, nbytes - k * block_size);
+      blocks[k].resize(lz4_bound(size));
+      blocks[k].resize(
+          lz4_compress(data + k * block_size, size, blocks[k].data()));
+    }
+
+    // Header: number of blocks, block size, last block size and compressed
+    // size of each block
+    std::vector<uint64_t> hdr(3 + nblocks);
+    hdr[0] = nblocks;
+    hdr[1] = block_size;
+    hdr[2] = (nblocks > 0 ? nbytes - (nblocks - 1) * block_size : 0);
+    std::size_t total = 0;
+    for (std::size_t k = 0; k < nblocks; k++) {
+      hdr[3 + k] = blocks[k].size();
+      total += blocks[k].size();
+    }
+    header.resize(hdr.size() * sizeof(uint64_t));
+    std::memcpy(header.data(), hdr.data(), header.size());
+
+    payload.resize(total);
+    for (std::size_t k = 0, pos = 0; k < nblocks; k++) {
+      std::memcpy(payload.data() + pos, blocks[k].data(), blocks[k].size());
+      pos += blocks[k].size();
+    }
+  }
+
+  // Base64 encode the data in parallel over groups of 3-byte chunks
+  static void base64(const uint8_t* data, std::size_t nbytes,
+                     std::vector<char>& text) {
+    static const char table[] =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    const std::size_t nchunks = (nbytes + 2) / 3;
+    text.resize(4 * nchunks);
+
+    const std::size_t group = 16384;
+    const std::size_t ngroups = (nchunks + group - 1) / group;
+#pragma omp parallel for
+    for (std::size_t g = 0; g < ngroups; g++) {
+      const std::size_t end = std::min(nchunks, (g + 1) * group);
+      for (std::size_t c = g * group; c < end; c++) {
+        const std::size_t i = 3 * c;
+        uint32_t b = uint32_t(data[i]) << 16;
+        if (i + 1 < nbytes) {
+          b |= uint32_t(data[i + 1]) << 8;
+        }
+        if (i + 2 < nbytes) {
+          b |= uint32_t(data[i + 2]);
+        }
+        text[4 * c] = table[(b >> 18) & 63];
+        text[4 * c + 1] = table[(b >> 12) & 63];
+        text[4 * c + 2] = (i + 1 < nbytes ? table[(b >> 6) & 63] : '=');
+        text[4 * c + 3] = (i + 2 < nbytes ? table[b & 63] : '=');
+      }
+    }
+  }
+
+  // Write a length using the LZ4 255-byte continuation encoding
+  static uint8_t* lz4_write_length(uint8_t* out, std::size_t len) {
+    while (len >= 255) {
+      *out++ = 255;
+      len -= 255;
+    }
+    *out++ = uint8_t(len);
+    return out;
+  }
+
+  // Write a sequence of literals followed by a match. A match length of zero
+  // with a zero offset denotes the final literals-only sequence.
+  static uint8_t* lz4_write_sequence(uint8_t* out, const uint8_t* literals,
+                                     std::size_t nliterals, std::size_t dist,
+                                     std::size_t match_len) {
+    uint8_t* token = out++;
+    *token = uint8_t((nliterals < 15 ? nliterals : 15) << 4);
+    if (nliterals >= 15) {
+      out = lz4_write_length(out, nliterals - 15);
+    }
+    std::memcpy(out, literals, nliterals);
+    out += nliterals;
+
+    if (dist > 0) {
+      *out++ = uint8_t(dist & 0xff);
+      *out++ = uint8_t(dist >> 8);
+      *token |= uint8_t(match_len < 15 ? match_len : 15);
+      if (match_len >= 15) {
+        out = lz4_write_length(out, match_len - 15);
+      }
+    }
+    return out;
+  }
+
+  VTUFormat format;
+  VTUCompression compression;
+  index_t nnodes, nelems;
+  std::FILE* fp;
+
+  // Buffered XML and data for the appended format
+  std::string xml;
+  std::vector<std::vector<uint8_t>> appended;
+  uint64_t offset;
+
+  // The PointData section is open until the file is closed, the cell arrays
+  // are collected in cell_xml while cell_data points to it
+  bool point_data_open;
+  std::string cell_xml;
+  std::string* cell_data;
+};
+
+/**
+ * @brief Memory-mapped reader for the legacy VTK unstructured grid format
+ *
+ * Supports ASCII and BINARY files with the POINTS, CELLS, CELL_TYPES and
+ * optional CELL_DATA CellEntityIds sections. ASCII sections are split into
+ * chunks at whitespace boundaries and parsed in parallel with
+ * std::from_chars, big-endian binary sections are byte-swapped in parallel.
+ */
+class VTKLegacyReader {
+ public:
+  VTKLegacyReader(const std::string& vtk_name)
+      : vtk_name(vtk_name),
+        data(nullptr),
+        size(0),
+        binary(false),
+        npoints(0),
+        ncells(0),
+        parse_time(0.0) {
+    auto t0 = std::chrono::steady_clock::now();
+    open();
+
+    try {
+      parse();
+    } catch (...) {
+      close();
+      throw;
+    }
+    close();
+
+    parse_time = std::chrono::duration<double>(
+                     std::chrono::steady_clock::now() - t0)
+                     .count();
+  }
+
+  ~VTKLegacyReader() { close(); }
+
+  VTKLegacyReader(const VTKLegacyReader&) = delete;
+  VTKLegacyReader& operator=(const VTKLegacyReader&) = delete;
+
+  bool is_binary() const { return binary; }
+  index_t get_num_points() const { return npoints; }
+  index_t get_num_cells() const { return ncells; }
+
+  // Point coordinates, 3 values for each point
+  const std::vector<double>& get_points() const { return points; }
+
+  // Number of vertices and pointer to the vertices of a cell
+  index_t get_cell_nverts(index_t i) const { return cells[cell_ptr[i]]; }
+  const index_t* get_cell_verts(index_t i) const {
+    return &cells[cell_ptr[i] + 1];
+  }
+
+  const std::vector<int>& get_cell_types() const { return cell_types; }
+
+  bool has_cell_entity_ids() const { return cell_ids.size() == ncells; }
+  const std::vector<int>& get_cell_entity_ids() const { return cell_ids; }
+
+  // Time to read and parse the file in seconds and the throughput in MB/s
+  double get_parse_time() const { return parse_time; }
+  double get_throughput() const {
+    return parse_time > 0.0 ? 1e-6 * file_size / parse_time : 0.0;
+  }
+
+  void report() const {
+    std::printf(
+        "VTKLegacyReader: %s (%s), %u points, %u cells, %.1f MB in %.3f s "
+        "(%.1f MB/s)\n",
+        vtk_name.c_str(), binary ? "binary" : "ascii", npoints, ncells,
+        1e-6 * file_size, parse_time, get_throughput());
+  }
+
+ private:
+  // Approximate number of bytes parsed by each parallel task
+  static constexpr std::size_t chunk_bytes = 1 << 20;
+
+  [[noreturn]] void error(const char* what) const {
+    char msg[512];
+    std::snprintf(msg, sizeof(msg), "VTKLegacyReader: %s in file %s", what,
+                  vtk_name.c_str());
+    throw std::runtime_error(msg);
+  }
+
+  // Map the file into memory, the file is released once it is parsed
+  void open() {
+    const bool sequential = true;
+    file = std::make_unique<MappedFile>(vtk_name, sequential);
+    data = file->data();
+    file_size = size = file->size();
+  }
+
+  void close() {
+    file.reset();
+    data = nullptr;
+    size = 0;
+  }
+
+  void parse() {
+    // The third line of the header is ASCII or BINARY
+    std::size_t pos = 0;
+    for (int i = 0; i < 2; i++) {
+      pos = next_line(pos);
+    }
+    binary = (line_starts_with(pos, "BINARY"));
+
+    std::vector<std::string> tokens;
+
+    // Points, always stored with 3 coordinates
+    pos = find_line(pos, "POINTS", tokens);
+    if (tokens.size() < 3) {
+      error("invalid POINTS line");
+    }
+    npoints = std::stoul(tokens[1]);
+    points.resize(3 * npoints);
+    pos = read_section(pos, tokens[2], points.size(), points.data());
+
+    // Cells, stored as the number of vertices followed by the vertices
+    pos = find_line(pos, "CELLS", tokens);
+    if (tokens.size() < 3) {
+      error("invalid CELLS line");
+    }
+    ncells = std::stoul(tokens[1]);
+    cells.resize(std::stoul(tokens[2]));
+    pos = read_section(pos, "int", cells.size(), cells.data());
+
+    cell_ptr.resize(ncells);
+    for (index_t i = 0, p = 0; i < ncells; i++) {
+      if (p >= cells.size() || p + cells[p] >= cells.size()) {
+        error("inconsistent CELLS section");
+      }
+      cell_ptr[i] = p;
+      p += cells[p] + 1;
+    }
+
+    pos = find_line(pos, "CELL_TYPES", tokens);
+    if (tokens.size() < 2 || std::stoul(tokens[1]) != ncells) {
+      error("invalid CELL_TYPES line");
+    }
+    cell_types.resize(ncells);
+    pos = read_section(pos, "int", ncells, cell_types.data());
+
+    // Cell entity ids are optional
+    std::size_t cell_data = find_line(pos, "CELL_DATA", tokens, false);
+    if (cell_data < size) {
+      std::size_t ids = find_line(cell_data, "SCALARS CellEntityIds", tokens,
+                                  false);
+      if (ids < size) {
+        std::string type = tokens.size() > 2 ? tokens[2] : "int";
+        ids = find_line(ids, "LOOKUP_TABLE", tokens);
+        cell_ids.resize(ncells);
+        read_section(ids, type, ncells, cell_ids.data());
+      }
+    }
+  }
+
+  std::size_t next_line(std::size_t pos) const {
+    const void* nl = std::memchr(data + pos, '\n', size - pos);
+    return nl ? static_cast<const char*>(nl) - data + 1 : size;
+  }
+
+  bool line_starts_with(std::size_t pos, const char* key) const {
+    std::size_t len = std::strlen(key);
+    return pos + len <= size && std::memcmp(data + pos, key, len) == 0;
+  }
+
+  /**
+   * @brief Find the next line that starts with the given key
+   *
+   * @param pos position of the first line to check
+   * @param key the key to match
+   * @param tokens the whitespace-separated tokens of the matching line
+   * @param required throw if the key is not found
+   * @return the position of the line after the match, or size if not found
+   */
+  std::size_t find_line(std::size_t pos, const char* key,
+                        std::vector<std::string>& tokens,
+                        bool required = true) const {
+    while (pos < size) {
+      std::size_t next = next_line(pos);
+      if (line_starts_with(pos, key)) {
+        tokens.clear();
+        std::istringstream iss(std::string(data + pos, next - pos));
+        std::string token;
+        while (iss >> token) {
+          tokens.push_back(token);
+        }
+        return next;
+      }
+      pos = next;
+    }
+    if (required) {
+      char msg[256];
+      std::snprintf(msg, sizeof(msg), "section %s not found", key);
+      error(msg);
+    }
+    return size;
+  }
+
+  /**
+   * @brief Read a section of count values starting at pos
+   *
+   * @param pos start of the section data
+   * @param type the VTK data type of the section
+   * @param count the number of values
+   * @param out the output values
+   * @return the position after the section
+   */
+  template <typename V>
+  std::size_t read_section(std::size_t pos, const std::string& type,
+                           std::size_t count, V* out) const {
+    if (binary) {
+      if (type == "float") {
+        return read_binary<float>(pos, count, out);
+      } else if (type == "double") {
+        return read_binary<double>(pos, count, out);
+      } else if (type == "int" || type == "vtkIdType") {
+        return read_binary<int32_t>(pos, count, out);
+      } else if (type == "long" || type == "vtktypeint64") {
+        return read_binary<int64_t>(pos, count, out);
+      }
+      char msg[256];
+      std::snprintf(msg, sizeof(msg), "unsupported data type %s",
+                    type.c_str());
+      error(msg);
+    }
+    return read_ascii(pos, count, out);
+  }
+
+  // Read big-endian binary values
+  template <typename S, typename V>
+  std::size_t read_binary(std::size_t pos, std::size_t count, V* out) const {
+    if (pos + count * sizeof(S) > size) {
+      error("unexpected end of binary section");
+    }
+    const char* src = data + pos;
+    uint16_t one = 1;
+    const bool swap = *reinterpret_cast<uint8_t*>(&one) == 1;
+#pragma omp parallel for
+    for (std::size_t i = 0; i < count; i++) {
+      char bytes[sizeof(S)];
+      for (std::size_t k = 0; k < sizeof(S); k++) {
+        bytes[k] = src[sizeof(S) * i + (swap ? sizeof(S) - 1 - k : k)];
+      }
+      S value;
+      std::memcpy(&value, bytes, sizeof(S));
+      out[i] = static_cast<V>(value);
+    }
+    return pos + count * sizeof(S);
+  }
+
+  // Read ASCII values in parallel chunks that end at whitespace
+  template <typename V>
+  std::size_t read_ascii(std::size_t pos, std::size_t count, V* out) const {
+    // The section ends at the first line that starts with a keyword
+    std::size_t end = pos;
+    while (end < size) {
+      std::size_t p = end;
+      while (p < size && (data[p] == ' ' || data[p] == '\t')) {
+        p++;
+      }
+      if (is_keyword(p)) {
+        break;
+      }
+      end = next_line(end);
+    }
+
+    const std::size_t nchunks =
+        std::max<std::size_t>(1, (end - pos) / chunk_bytes);
+    std::vector<std::size_t> bounds(nchunks + 1), offsets(nchunks + 1, 0);
+    bounds[0] = pos;
+    bounds[nchunks] = end;
+    for (std::size_t k = 1; k < nchunks; k++) {
+      std::size_t b = pos + k * (end - pos) / nchunks;
+      while (b < end && !is_space(data[b])) {
+        b++;
+      }
+      bounds[k] = b;
+    }
+
+    // Count the tokens that start in each chunk
+#pragma omp parallel for
+    for (std::size_t k = 0; k < nchunks; k++) {
+      std::size_t ntokens = 0;
+      for (std::size_t p = bounds[k]; p < bounds[k + 1];) {
+        while (p < bounds[k + 1] && is_space(data[p])) {
+          p++;
+        }
+        if (p < bounds[k + 1]) {
+          ntokens++;
+          while (p < end && !is_space(data[p])) {
+            p++;
+          }
+        }
+      }
+      offsets[k + 1] = ntokens;
+    }
+    for (std::size_t k = 0; k < nchunks; k++) {
+      offsets[k + 1] += offsets[k];
+    }
+    if (offsets[nchunks] != count) {
+      char msg[256];
+      std::snprintf(msg, sizeof(msg),
+                    "expected %zu values in section, found %zu", count,
+                    offsets[nchunks]);
+      error(msg);
+    }
+
+    // Parse the tokens
+    bool failed = false;
+#pragma omp parallel for reduction(|| : failed)
+    for (std::size_t k = 0; k < nchunks; k++) {
+      std::size_t index = offsets[k];
+      for (std::size_t p = bounds[k]; p < bounds[k + 1];) {
+        while (p < bounds[k + 1] && is_space(data[p])) {
+          p++;
+        }
+        if (p < bounds[k + 1]) {
+          std::size_t q = p;
+          while (q < end && !is_space(data[q])) {
+            q++;
+          }
+          failed = failed || !parse_value(data + p, data + q, out[index]);
+          index++;
+          p = q;
+        }
+      }
+    }
+    if (failed) {
+      error("invalid number in section");
+    }
+
+    return end;
+  }
+
+  static bool is_space(char c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+  }
+
+  /**
+   * @brief Check whether a legacy VTK keyword starts at pos
+   *
+   * Only whole words from the known set match, so values such as NaN or INF
+   * and unknown words do not end a section.
+   */
+  bool is_keyword(std::size_t pos) const {
+    static const char* keywords[] = {
+        "POINTS",       "CELLS",         "CELL_TYPES",
+        "CELL_DATA",    "POINT_DATA",    "SCALARS",
+        "VECTORS",      "NORMALS",       "TENSORS",
+        "LOOKUP_TABLE", "COLOR_SCALARS", "TEXTURE_COORDINATES",
+        "FIELD",        "METADATA",      "DATASET",
+        "VERTICES",     "LINES",         "POLYGONS",
+        "TRIANGLE_STRIPS"};
+    for (const char* key : keywords) {
+      std::size_t end = pos + std::strlen(key);
+      if (line_starts_with(pos, key) && (end == size || is_space(data[end]))) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  template <typename V>
+  static bool parse_value(const char* first, const char* last, V& value) {
+    using P = std::conditional_t<std::is_integral_v<V>, int64_t, double>;
+    P v;
+    auto result = std::from_chars(first, last, v);
+    value = static_cast<V>(v);
+    return result.ec == std::errc() && result.ptr == last;
+  }
+
+  std::string vtk_name;
+
+  // File contents
+  std::unique_ptr<MappedFile> file;
+  const char* data;
+  std::size_t size, file_size;
+
+  bool binary;
+  index_t npoints, ncells;
+  std::vector<double> points;
+  std::vector<index_t> cells, cell_ptr;
+  std::vector<int> cell_types, cell_ids;
+
+  double parse_time;
+};
+
 /**
  * @brief Given a VTK, extract information that MeshConnectivity3D needs.
  */
 template <typename I, typename T>
 class ReadVTK3D {
  public:
-  ReadVTK3D(const std::string& vtk_name)
+  /**
+   * @brief Read the mesh from a legacy VTK file
+   *
+   * @param vtk_name Name of the VTK file
+   * @param verbose Report the contents of the file
+   * @param hilbert_sort Sort the cells of each type along a Hilbert curve
+   * through their centroids, see hilbert_sort_elements()
+   */
+  ReadVTK3D(const std::string& vtk_name, bool verbose = false,
+            bool hilbert_sort = false)
       : vtk_name(vtk_name),
         ntri(0),
         nquad(0),
@@ -302,34 +1194,26 @@ class ReadVTK3D {
         npyramid(0),
         xyz_lower{1e20, 1e20, 1e20},
         xyz_upper{-1e20, -1e20, -1e20} {
-    // If file doesn't exist, exit
-    if (!std::filesystem::exists(vtk_name)) {
+    VTKLegacyReader reader(vtk_name);
+    if (verbose) {
+      reader.report();
+    }
+
+    if (!reader.has_cell_entity_ids()) {
       char msg[256];
-      std::snprintf(msg, sizeof(msg), "file %s does not exists!",
-                    vtk_name.c_str());
+      std::snprintf(msg, sizeof(msg),
+                    "\n[%s:%d]file %s does not contain given string %s!",
+                    __FILE__, __LINE__, vtk_name.c_str(), "CellEntityIds");
       throw std::runtime_error(msg);
     }
 
-    // Scan through the vtk file and save the information.
-    // Note that vtk might contain element types that we don't support here,
-    // we'll trim out those later.
-    I nelems = 0;
-    std::string dummy;  // store string to be discarded
-
-    std::ifstream ifs(vtk_name);
-
-    // Get number of points from vtk
-    goto_line_with_str(ifs, "POINTS") >> dummy >> nverts;
-
-    // Allocate and populate nodal location array, and record domain bounds
-    T coord;
-    Xloc.reserve(nverts * SPATIAL_DIM);
-    std::string line;
-    for (int i = 0; i < nverts; i++) {
-      std::getline(ifs, line);
-      std::istringstream iss(line);
-      for (int j = 0; j < SPATIAL_DIM; j++) {
-        iss >> coord;
+    // Populate nodal location array, and record domain bounds
+    nverts = reader.get_num_points();
+    const std::vector<double>& pts = reader.get_points();
+    Xloc.resize(nverts * SPATIAL_DIM);
+    for (index_t i = 0; i < nverts; i++) {
+      for (index_t j = 0; j < SPATIAL_DIM; j++) {
+        T coord = pts[3 * i + j];
         Xloc[SPATIAL_DIM * i + j] = coord;
         if (coord > xyz_upper[j]) {
           xyz_upper[j] = coord;
@@ -340,77 +1224,59 @@ class ReadVTK3D {
       }
     }
 
-    // Get number of all types of elements (including those that aren't
-    // supported)
-    goto_line_with_str(ifs, "CELLS") >> dummy >> nelems;
-
     // Populate connectivities for supported element types only.
     // Supported types are tet, hex, wedge, pyramid
-    I nelems_celltype = 0, nelems_cellid = 0;
-
-    std::ifstream ifs_celltype(vtk_name);
-    std::ifstream ifs_cellid(vtk_name);
-    goto_line_with_str(ifs_celltype, "CELL_TYPES") >> dummy >> nelems_celltype;
-    goto_line_with_str(ifs_cellid, "CELL_DATA") >> dummy >> nelems_cellid;
-    goto_line_with_str(ifs_cellid, "CellEntityIds");
-    goto_line_with_str(ifs_cellid, "LOOKUP_TABLE");
-
-    assert(nelems == nelems_celltype);
-    assert(nelems == nelems_cellid);
-
-    std::string line_celltype;
-    std::string line_cellid;
-
-    int cell_type = 0;
-    int cell_id = 0;
+    const std::vector<int>& cell_types = reader.get_cell_types();
+    const std::vector<int>& cell_ids = reader.get_cell_entity_ids();
 
     // Loop over all elements
-    for (int i = 0; i < nelems; i++) {
-      // Get element type
-      std::getline(ifs_celltype, line_celltype);
-      std::istringstream(line_celltype) >> cell_type;
-
-      // Get element entity id
-      std::getline(ifs_cellid, line_cellid);
-      std::istringstream(line_cellid) >> cell_id;
-
-      // Get element connectivity
-      std::getline(ifs, line);
+    for (index_t i = 0; i < reader.get_num_cells(); i++) {
+      int cell_type = cell_types[i];
+      int cell_id = cell_ids[i];
 
       // Populate cell id vectors and connectivity
       switch (cell_type) {
         case VTKID::TRIANGLE:
           id_tri.push_back(cell_id);
-          insert_verts_to_conn(line, conn_tri);
+          insert_verts_to_conn(reader, i, conn_tri);
           ntri++;
           break;
         case VTKID::QUAD:
           id_quad.push_back(cell_id);
-          insert_verts_to_conn(line, conn_quad);
+          insert_verts_to_conn(reader, i, conn_quad);
           nquad++;
           break;
         case VTKID::TETRA:
           id_tet.push_back(cell_id);
-          insert_verts_to_conn(line, conn_tet);
+          insert_verts_to_conn(reader, i, conn_tet);
           ntets++;
           break;
         case VTKID::HEXAHEDRON:
           id_hex.push_back(cell_id);
-          insert_verts_to_conn(line, conn_hex);
+          insert_verts_to_conn(reader, i, conn_hex);
           nhex++;
           break;
         case VTKID::WEDGE:
           id_wedge.push_back(cell_id);
-          insert_verts_to_conn(line, conn_wedge);
+          insert_verts_to_conn(reader, i, conn_wedge);
           nwedge++;
           break;
         case VTKID::PYRAMID:
           id_pyramid.push_back(cell_id);
-          insert_verts_to_conn(line, conn_pyramid);
+          insert_verts_to_conn(reader, i, conn_pyramid);
           npyramid++;
           break;
       }
     }
+
+    // Sort the 3d cells so that cells close in space are close in memory
+    if (hilbert_sort) {
+      sort_cells(VTK_NVERTS::TETRA, ntets, conn_tet, id_tet, perm_tet);
+      sort_cells(VTK_NVERTS::HEXAHEDRON, nhex, conn_hex, id_hex, perm_hex);
+      sort_cells(VTK_NVERTS::WEDGE, nwedge, conn_wedge, id_wedge, perm_wedge);
+      sort_cells(VTK_NVERTS::PYRAMID, npyramid, conn_pyramid, id_pyramid,
+                 perm_pyramid);
+    }
   }
 
   /**
@@ -451,10 +1317,17 @@ class ReadVTK3D {
   I* get_wedge() { return conn_wedge.data(); }
   I* get_pyrmd() { return conn_pyramid.data(); }
 
+  // Get the original index of each cell of a type after the Hilbert sort,
+  // empty if the cells are not sorted
+  const std::vector<index_t>& get_tets_perm() { return perm_tet; }
+  const std::vector<index_t>& get_hex_perm() { return perm_hex; }
+  const std::vector<index_t>& get_wedge_perm() { return perm_wedge; }
+  const std::vector<index_t>& get_pyrmd_perm() { return perm_pyramid; }
+
   // Get nodal locations of vertices
   T* get_Xloc() { return Xloc.data(); }
   void get_bounds(T* lower, T* upper) {
-    for (int i = 0; i < SPATIAL_DIM; i++) {
+    for (index_t i = 0; i < SPATIAL_DIM; i++) {
       lower[i] = xyz_lower[i];
       upper[i] = xyz_upper[i];
     }
@@ -471,12 +1344,13 @@ class ReadVTK3D {
    * @param id_vec id vector of this cell type
    * @param conn_vec connectivity vector of this cell type
    */
-  void insert_verts_to_set(const int nverts_per_cell, const std::vector<int> id,
-                           std::set<I>& verts, std::vector<int>& id_vec,
+  void insert_verts_to_set(const index_t nverts_per_cell,
+                           const std::vector<int> id, std::set<I>& verts,
+                           std::vector<int>& id_vec,
                            std::vector<I>& conn_vec) {
-    for (int i = 0; i < id_vec.size(); i++) {
+    for (std::size_t i = 0; i < id_vec.size(); i++) {
       if (std::count(id.begin(), id.end(), id_vec[i])) {
-        for (int j = 0; j < nverts_per_cell; j++) {
+        for (index_t j = 0; j < nverts_per_cell; j++) {
           verts.insert(conn_vec[i * nverts_per_cell + j]);
         }
       }
@@ -487,53 +1361,36 @@ class ReadVTK3D {
    * @brief Insert the vertices of a given cell to corresponding
    * connectivity
    */
-  void insert_verts_to_conn(std::string& conn_line, std::vector<I>& conn) {
-    int elem_nverts;
-    std::istringstream conn_iss = std::istringstream(conn_line);
-    conn_iss >> elem_nverts;  // get number of vertices
-    I vert_idx;
-    for (int i = 0; i < elem_nverts; i++) {
-      conn_iss >> vert_idx;
-      conn.push_back(vert_idx);
-    }
-    return;
+  void insert_verts_to_conn(const VTKLegacyReader& reader, index_t cell,
+                            std::vector<I>& conn) {
+    const index_t* verts = reader.get_cell_verts(cell);
+    conn.insert(conn.end(), verts, verts + reader.get_cell_nverts(cell));
   }
 
   /**
-   * @brief Find the first line that contains given string.
-   *
-   * This function search through the input text until hitting the first
-   * line that contains the given string. Upon returning, the file handle
-   * points to the next line.
-   *
-   * @param file the file input stream
-   * @param str string to be matched
-   * @return a std::istringstream type that can be used to extract data from
-   *         the matching line. Usage: ret >> x >> y >> z ...
+   * @brief Sort the cells of one type along a Hilbert curve and apply the
+   * same permutation to their cell ids
    */
-  std::istringstream goto_line_with_str(std::ifstream& file,
-                                        const std::string str) {
-    std::string line;
-    while (std::getline(file, line)) {
-      if (line.find(str) != std::string::npos) {
-        return std::istringstream(line);
-      }
-    }
-    char msg[256];
-    std::snprintf(msg, sizeof(msg),
-                  "\n[%s:%d]file %s does not contain given string %s!",
-                  __FILE__, __LINE__, vtk_name.c_str(), str.c_str());
-    throw std::runtime_error(msg);
+  void sort_cells(const index_t nverts_per_cell, const index_t ncells,
+                  std::vector<I>& conn_vec, std::vector<int>& id_vec,
+                  std::vector<index_t>& perm) {
+    hilbert_sort_elements(SPATIAL_DIM, ncells, nverts_per_cell,
+                          conn_vec.data(), Xloc.data(), perm);
+    std::vector<int> ids(id_vec);
+    for (index_t i = 0; i < ncells; i++) {
+      id_vec[i] = ids[perm[i]];
+    }
   }
 
   index_t static constexpr SPATIAL_DIM = 3;
   std::string vtk_name;
-  int ntri, nquad;
-  int nverts, ntets, nhex, nwedge, npyramid;
+  index_t ntri, nquad;
+  index_t nverts, ntets, nhex, nwedge, npyramid;
 
   // Connectivity lists for 3d mesh cells
   std::vector<I> conn_tet, conn_hex, conn_wedge, conn_pyramid;
   std::vector<int> id_tet, id_hex, id_wedge, id_pyramid;
+  std::vector<index_t> perm_tet, perm_hex, perm_wedge, perm_pyramid;
 
   // Connectivity lists for 2d mesh cells
   std::vector<I> conn_tri, conn_quad;
@@ -646,17 +1503,14 @@ class ReadVTK {
     return *this;
   }
 
-  ReadVTK(const std::string& vtk_name) {
-    // If file doesn't exist, exit
-    if (!std::filesystem::exists(vtk_name)) {
-      char msg[256];
-      std::snprintf(msg, sizeof(msg), "file %s does not exists!",
-                    vtk_name.c_str());
-      throw std::runtime_error(msg);
+  ReadVTK(const std::string& vtk_name, bool verbose = false) {
+    VTKLegacyReader reader(vtk_name);
+    if (verbose) {
+      reader.report();
     }
 
-    nnodes = 0;
-    nelems_all = 0;
+    nnodes = reader.get_num_points();
+    nelems_all = reader.get_num_cells();
     nelems = 0;
 
     for (int i = 0; i != spatial_dim; i++) {
@@ -665,41 +1519,19 @@ class ReadVTK {
       domain_sizes[i] = 0.0;
     }
 
-    std::ifstream file(vtk_name);
-    std::string line;
-
-    // Get number of points
-    while (std::getline(file, line)) {
-      if (line.find("POINTS") != std::string::npos) {
-        std::istringstream iss(line);
-        std::string dummy;
-        iss >> dummy >> nnodes;
-        break;
-      }
-    }
-
-    // Allocate nodal location array
+    // Allocate and populate nodal location array
     X = NodeArray_t("X", nnodes);
-
-    // Populate nodal location array
-    int count = 0;
-    T pt[spatial_dim];
-    while (std::getline(file, line)) {
-      std::istringstream iss(line);
-
+    const std::vector<double>& pts = reader.get_points();
+    for (I count = 0; count < nnodes; count++) {
       for (int i = 0; i != spatial_dim; i++) {
-        iss >> pt[i];
-        if (pt[i] < domain_lower[i]) {
-          domain_lower[i] = pt[i];
+        T pt = pts[3 * count + i];
+        if (pt < domain_lower[i]) {
+          domain_lower[i] = pt;
         }
-        if (pt[i] > domain_upper[i]) {
-          domain_upper[i] = pt[i];
+        if (pt > domain_upper[i]) {
+          domain_upper[i] = pt;
         }
-        X(count, i) = pt[i];
-      }
-      count++;
-      if (count == nnodes) {
-        break;
+        X(count, i) = pt;
       }
     }
 
@@ -708,59 +1540,25 @@ class ReadVTK {
       domain_sizes[i] = domain_upper[i] - domain_lower[i];
     }
 
-    // Get total number of elements (could have multiple types)
-    while (std::getline(file, line)) {
-      if (line.find("CELLS") != std::string::npos) {
-        std::istringstream iss(line);
-        std::string dummy;
-        iss >> dummy >> nelems_all;
-        break;
+    // Count the elements with the requested number of nodes
+    for (index_t count = 0; count < nelems_all; count++) {
+      if (reader.get_cell_nverts(count) == index_t(nnodes_per_elem)) {
+        nelems++;
       }
     }
 
-    // Allocate connectivity array
-    conn_ = ConnArray_t("conn_", nelems_all);
-
     // Populate connectivity array
-    int _nnodes = -1;
-    count = 0;
-    nelems = 0;
-    while (std::getline(file, line)) {
-      std::istringstream iss(line);
-      iss >> _nnodes;
-      if (_nnodes == nnodes_per_elem) {
+    conn = ConnArray_t("conn", nelems);
+    conn_ = conn;
+    for (index_t count = 0, e = 0; count < nelems_all; count++) {
+      if (reader.get_cell_nverts(count) == index_t(nnodes_per_elem)) {
+        const index_t* verts = reader.get_cell_verts(count);
         for (int i = 0; i != nnodes_per_elem; i++) {
-          iss >> conn_(nelems, i);
+          conn(e, i) = verts[i];
         }
-        nelems++;
-      }
-      count++;
-      if (count == nelems_all) {
-        break;
+        e++;
       }
     }
-
-    // Trim connectivity
-    conn = ConnArray_t("conn", nelems);
-    BLAS::copy(conn, Kokkos::subview(conn_, Kokkos::make_pair(0, (int)nelems),
-                                     Kokkos::ALL));
-
-    // printf("X[%d]\n", nnodes);
-    // printf("lower: %.2f %.2f %.2f\n", domain_lower[1], domain_lower[1],
-    //        domain_lower[2]);
-    // printf("upper: %.2f %.2f %.2f\n", domain_upper[1], domain_upper[1],
-    //        domain_upper[2]);
-    // printf("domain: %.2f %.2f %.2f\n", domain_sizes[1], domain_sizes[1],
-    //        domain_sizes[2]);
-    // for (int i = 0; i != nnodes; i++) {
-    //   printf("%.2f %.2f %.2f\n", X(i, 0), X(i, 1), X(i, 2));
-    // }
-
-    // printf("conn[%d, 4]\n", nelems);
-    // for (int i = 0; i != nelems; i++) {
-    //   printf("%d %d %d %d\n", conn(i, 0), conn(i, 1), conn(i, 2), conn(i,
-    //   3));
-    // }
   }
 
   template <class XArray>
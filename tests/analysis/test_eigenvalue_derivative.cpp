@@ -0,0 +1,261 @@
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "multiphysics/feanalysis.h"
+#include "multiphysics/hex_tools.h"
+#include "multiphysics/integrand_elasticity.h"
+#include "test_commons.h"
+#include "utils/a2dlapack.h"
+#include "utils/a2dmesh.h"
+
+using namespace A2D;
+
+class Environment : public ::testing::Environment {
+ public:
+  void SetUp() override { Kokkos::initialize(); }
+  void TearDown() override { Kokkos::finalize(); }
+};
+
+// Create a new environment and initialize kokkos
+::testing::Environment *const initialize_kokkos =
+    ::testing::AddGlobalTestEnvironment(new Environment);
+
+/*
+  Eigenvalues of K * x = lambda * M * x on a brick of nx^3 linear hexahedra
+  clamped on the face x = 0. K and M are both elasticity stiffness matrices
+  that depend on the density data through the RAMP penalty, with different
+  moduli and penalty parameters so that the eigenvalues depend on the data.
+*/
+class EigenvalueProblem {
+ public:
+  using T = double;
+  static constexpr index_t block_size = 3;
+  static constexpr GreenStrainType etype = GreenStrainType::LINEAR;
+  using Impl_t = DirectCholeskyAnalysisImpl<T, block_size>;
+  using Vec_t = typename Impl_t::Vec_t;
+  using Mat_t = typename Impl_t::Mat_t;
+  using Elem_t = HexTopoElement<Impl_t, etype, 1>;
+  using DataBasis = typename Elem_t::DataBasis;
+  using GeoBasis = typename Elem_t::GeoBasis;
+  using Basis = typename Elem_t::Basis;
+  using Integrand = TopoElasticityIntegrand<T, 3, etype>;
+
+  EigenvalueProblem(index_t nx)
+      : stiffness_integrand(70.0, 0.3, 5.0), mass_integrand(1.0, 0.25, 1.0) {
+    index_t nverts = (nx + 1) * (nx + 1) * (nx + 1);
+    index_t nhex = nx * nx * nx;
+    std::vector<index_t> hex(8 * nhex);
+    std::vector<double> Xloc(3 * nverts);
+    MesherBrick3D mesher(nx, nx, nx, 1.0, 1.0, 1.0);
+    mesher.set_X_conn<index_t, double>(Xloc.data(), hex.data());
+
+    index_t z = 0;
+    index_t *null = nullptr;
+    conn = std::make_unique<MeshConnectivity3D>(nverts, z, null, nhex,
+                                                hex.data(), z, null, z, null);
+
+    std::vector<index_t> verts;
+    for (index_t k = 0; k < nx + 1; k++) {
+      for (index_t j = 0; j < nx + 1; j++) {
+        verts.push_back(j * (nx + 1) + k * (nx + 1) * (nx + 1));
+      }
+    }
+    index_t label =
+        conn->add_boundary_label_from_verts(verts.size(), verts.data());
+    bcinfo.add_boundary_condition(label);
+
+    data_mesh = std::make_shared<ElementMesh<DataBasis>>(*conn);
+    geo_mesh = std::make_shared<ElementMesh<GeoBasis>>(*conn);
+    sol_mesh = std::make_shared<ElementMesh<Basis>>(*conn);
+    bcs = std::make_shared<DirichletBasis<T, Basis>>(*conn, *sol_mesh, bcinfo,
+                                                     0.0);
+
+    data = std::make_shared<Vec_t>(data_mesh->get_num_dof());
+    geo = std::make_shared<Vec_t>(geo_mesh->get_num_dof());
+    for (index_t i = 0; i < data->get_num_dof(); i++) {
+      (*data)[i] = 0.6 + 0.3 * std::cos(1.7 * i);
+    }
+
+    typename Impl_t::template ElementVector<GeoBasis> elem_geo(*geo_mesh,
+                                                               *geo);
+    set_geo_from_hex_nodes<GeoBasis>(nhex, hex.data(), Xloc.data(), elem_geo);
+
+    stiffness.add_element(std::make_shared<Elem_t>(
+        stiffness_integrand, data_mesh, geo_mesh, sol_mesh));
+    mass.add_element(std::make_shared<Elem_t>(mass_integrand, data_mesh,
+                                              geo_mesh, sol_mesh));
+
+    // The free dofs
+    const index_t *dofs;
+    index_t nbcs = bcs->get_bcs(&dofs, nullptr);
+    std::vector<char> is_bc(sol_mesh->get_num_dof(), 0);
+    for (index_t i = 0; i < nbcs; i++) {
+      is_bc[dofs[i]] = 1;
+    }
+    for (index_t i = 0; i < sol_mesh->get_num_dof(); i++) {
+      if (!is_bc[i]) {
+        free_dofs.push_back(i);
+      }
+    }
+  }
+
+  /*
+    Compute the smallest eigenvalue and its M-normalized eigenvector, zero at
+    the bcs, with a dense solve on the free dofs. The generalized problem is
+    reduced to L^{-1} * K * L^{-T} * z = lambda * z with M = L * L^{T}.
+  */
+  T smallest_eigenvalue(bool use_mass, Vec_t &x) {
+    const index_t n = free_dofs.size();
+    std::vector<T> K = assemble_dense(stiffness);
+    std::vector<T> L(n * n, 0.0);
+    if (use_mass) {
+      L = assemble_dense(mass);
+      for (index_t k = 0; k < n; k++) {
+        L[n * k + k] = std::sqrt(L[n * k + k]);
+        for (index_t i = k + 1; i < n; i++) {
+          L[n * i + k] /= L[n * k + k];
+        }
+        for (index_t j = k + 1; j < n; j++) {
+          for (index_t i = j; i < n; i++) {
+            L[n * i + j] -= L[n * i + k] * L[n * j + k];
+          }
+        }
+      }
+    } else {
+      for (index_t k = 0; k < n; k++) {
+        L[n * k + k] = 1.0;
+      }
+    }
+
+    // K <- L^{-1} * K * L^{-T}, applied to the columns and then the rows
+    for (index_t j = 0; j < n; j++) {
+      for (index_t i = 0; i < n; i++) {
+        for (index_t k = 0; k < i; k++) {
+          K[n * i + j] -= L[n * i + k] * K[n * k + j];
+        }
+        K[n * i + j] /= L[n * i + i];
+      }
+    }
+    for (index_t i = 0; i < n; i++) {
+      for (index_t j = 0; j < n; j++) {
+        for (index_t k = 0; k < j; k++) {
+          K[n * i + j] -= L[n * j + k] * K[n * i + k];
+        }
+        K[n * i + j] /= L[n * j + j];
+      }
+    }
+
+    std::vector<double> ap(n * (n + 1) / 2), w(n), z(n * n), work(3 * n);
+    for (index_t j = 0; j < n; j++) {
+      for (index_t i = 0; i <= j; i++) {
+        ap[i + j * (j + 1) / 2] = 0.5 * (K[n * i + j] + K[n * j + i]);
+      }
+    }
+    int size = n, ldz = n, info = 0;
+    LAPACKdspev("V", "U", &size, ap.data(), w.data(), z.data(), &ldz,
+                work.data(), &info);
+    EXPECT_EQ(info, 0);
+
+    // x = L^{-T} * z for the first eigenvector
+    std::vector<T> y(n);
+    for (index_t i = n; i-- > 0;) {
+      T value = z[i];
+      for (index_t k = i + 1; k < n; k++) {
+        value -= L[n * k + i] * y[k];
+      }
+      y[i] = value / L[n * i + i];
+    }
+    x.zero();
+    for (index_t i = 0; i < n; i++) {
+      x[free_dofs[i]] = y[i];
+    }
+
+    return w[0];
+  }
+
+  // Assemble the Jacobian of the assembler in dense form on the free dofs
+  std::vector<T> assemble_dense(ElementAssembler<Impl_t> &assembler) {
+    index_t nrows;
+    std::vector<index_t> rowp, cols;
+    assembler.get_bsr_data(block_size, nrows, rowp, cols);
+    Mat_t mat(nrows, nrows, cols.size(), rowp, cols);
+    Vec_t sol(sol_mesh->get_num_dof());
+    assembler.add_jacobian(T(1.0), *data, *geo, sol, mat);
+
+    std::vector<index_t> index(sol_mesh->get_num_dof(), -1);
+    for (index_t i = 0; i < free_dofs.size(); i++) {
+      index[free_dofs[i]] = i;
+    }
+
+    const index_t n = free_dofs.size();
+    std::vector<T> A(n * n, 0.0);
+    for (index_t i = 0; i < nrows; i++) {
+      for (index_t jp = mat.rowp[i]; jp < mat.rowp[i + 1]; jp++) {
+        for (index_t ii = 0; ii < block_size; ii++) {
+          for (index_t jj = 0; jj < block_size; jj++) {
+            index_t r = index[block_size * i + ii];
+            index_t c = index[block_size * mat.cols[jp] + jj];
+            if (r != index_t(-1) && c != index_t(-1)) {
+              A[n * r + c] = mat.vals(jp, ii, jj);
+            }
+          }
+        }
+      }
+    }
+    return A;
+  }
+
+  Integrand stiffness_integrand, mass_integrand;
+  DirichletBCInfo bcinfo;
+  std::unique_ptr<MeshConnectivity3D> conn;
+  std::shared_ptr<ElementMesh<DataBasis>> data_mesh;
+  std::shared_ptr<ElementMesh<GeoBasis>> geo_mesh;
+  std::shared_ptr<ElementMesh<Basis>> sol_mesh;
+  std::shared_ptr<DirichletBasis<T, Basis>> bcs;
+  std::shared_ptr<Vec_t> data, geo;
+  ElementAssembler<Impl_t> stiffness, mass;
+  std::vector<index_t> free_dofs;
+};
+
+// Compare d(lambda)/dp along a direction with a central difference
+void check_eigenvalue_derivative(bool use_mass) {
+  using P = EigenvalueProblem;
+  P prob(2);
+  P::Vec_t x(prob.sol_mesh->get_num_dof());
+  double lambda = prob.smallest_eigenvalue(use_mass, x);
+
+  P::Vec_t dfdx(prob.data->get_num_dof());
+  add_eigenvalue_derivative(prob.stiffness, use_mass ? &prob.mass : nullptr,
+                            FEVarType::DATA, 1.0, lambda, *prob.data,
+                            *prob.geo, x, dfdx);
+
+  std::vector<double> p(prob.data->get_num_dof()), dir(p.size());
+  double ans = 0.0;
+  for (index_t i = 0; i < p.size(); i++) {
+    p[i] = (*prob.data)[i];
+    dir[i] = std::sin(0.9 * i + 0.2);
+    ans += dfdx[i] * dir[i];
+  }
+
+  const double h = 1e-6;
+  P::Vec_t y(x.get_num_dof());
+  for (index_t i = 0; i < p.size(); i++) {
+    (*prob.data)[i] = p[i] + h * dir[i];
+  }
+  double fwd = prob.smallest_eigenvalue(use_mass, y);
+  for (index_t i = 0; i < p.size(); i++) {
+    (*prob.data)[i] = p[i] - h * dir[i];
+  }
+  double bwd = prob.smallest_eigenvalue(use_mass, y);
+  double fd = 0.5 * (fwd - bwd) / h;
+
+  EXPECT_GT(std::fabs(ans), 1e-3 * lambda);
+  EXPECT_NEAR(ans, fd, 1e-6 * std::fabs(fd));
+}
+
+TEST(EigenvalueDerivativeTest, Standard) { check_eigenvalue_derivative(false); }
+
+TEST(EigenvalueDerivativeTest, Generalized) {
+  check_eigenvalue_derivative(true);
+}
@@ -0,0 +1,140 @@
+#include <memory>
+#include <vector>
+
+#include "multiphysics/feanalysis.h"
+#include "multiphysics/hex_tools.h"
+#include "multiphysics/integrand_elasticity.h"
+#include "test_commons.h"
+#include "utils/a2dmesh.h"
+
+using namespace A2D;
+
+class Environment : public ::testing::Environment {
+ public:
+  void SetUp() override { Kokkos::initialize(); }
+  void TearDown() override { Kokkos::finalize(); }
+};
+
+// Create a new environment and initialize kokkos
+::testing::Environment *const initialize_kokkos =
+    ::testing::AddGlobalTestEnvironment(new Environment);
+
+/*
+  Nonlinear elasticity on a unit brick of nx^3 linear hexahedra, clamped on
+  the face x = 0 and stretched by a prescribed x-displacement on x = 1
+*/
+class StretchProblem {
+ public:
+  using T = double;
+  static constexpr index_t block_size = 3;
+  static constexpr GreenStrainType etype = GreenStrainType::NONLINEAR;
+  using Analysis_t = DirectCholeskyAnalysis<T, block_size>;
+  using Impl_t = typename Analysis_t::Impl_t;
+  using Vec_t = typename Impl_t::Vec_t;
+  using Elem_t = HexTopoElement<Impl_t, etype, 1>;
+  using DataBasis = typename Elem_t::DataBasis;
+  using GeoBasis = typename Elem_t::GeoBasis;
+  using Basis = typename Elem_t::Basis;
+
+  StretchProblem(index_t nx, T stretch) : integrand(70.0, 0.3, 5.0) {
+    index_t nverts = (nx + 1) * (nx + 1) * (nx + 1);
+    index_t nhex = nx * nx * nx;
+    std::vector<index_t> hex(8 * nhex);
+    std::vector<double> Xloc(3 * nverts);
+    MesherBrick3D mesher(nx, nx, nx, 1.0, 1.0, 1.0);
+    mesher.set_X_conn<index_t, double>(Xloc.data(), hex.data());
+
+    index_t z = 0;
+    index_t *null = nullptr;
+    conn = std::make_unique<MeshConnectivity3D>(nverts, z, null, nhex,
+                                                hex.data(), z, null, z, null);
+
+    // Vertices on the faces x = 0 and x = 1
+    std::vector<index_t> verts0, verts1;
+    for (index_t k = 0; k < nx + 1; k++) {
+      for (index_t j = 0; j < nx + 1; j++) {
+        verts0.push_back(j * (nx + 1) + k * (nx + 1) * (nx + 1));
+        verts1.push_back(nx + j * (nx + 1) + k * (nx + 1) * (nx + 1));
+      }
+    }
+    index_t label0 =
+        conn->add_boundary_label_from_verts(verts0.size(), verts0.data());
+    index_t label1 =
+        conn->add_boundary_label_from_verts(verts1.size(), verts1.data());
+
+    DirichletBCInfo clamped, stretched;
+    clamped.add_boundary_condition(label0);
+    const index_t xdof[] = {0};
+    stretched.add_boundary_condition(label1, 0, 1, xdof);
+
+    auto data_mesh = std::make_shared<ElementMesh<DataBasis>>(*conn);
+    auto geo_mesh = std::make_shared<ElementMesh<GeoBasis>>(*conn);
+    auto sol_mesh = std::make_shared<ElementMesh<Basis>>(*conn);
+
+    auto bcs = std::make_shared<DirichletBCs<T>>();
+    bcs->add_bcs(std::make_shared<DirichletBasis<T, Basis>>(
+        *conn, *sol_mesh, clamped, 0.0));
+    bcs->add_bcs(std::make_shared<DirichletBasis<T, Basis>>(
+        *conn, *sol_mesh, stretched, stretch));
+
+    auto data = std::make_shared<Vec_t>(data_mesh->get_num_dof());
+    auto geo = std::make_shared<Vec_t>(geo_mesh->get_num_dof());
+    auto sol = std::make_shared<Vec_t>(sol_mesh->get_num_dof());
+    auto res = std::make_shared<Vec_t>(sol_mesh->get_num_dof());
+    data->fill(1.0);
+
+    typename Impl_t::template ElementVector<GeoBasis> elem_geo(*geo_mesh,
+                                                               *geo);
+    set_geo_from_hex_nodes<GeoBasis>(nhex, hex.data(), Xloc.data(), elem_geo);
+
+    auto assembler = std::make_shared<ElementAssembler<Impl_t>>();
+    assembler->add_element(
+        std::make_shared<Elem_t>(integrand, data_mesh, geo_mesh, sol_mesh));
+
+    analysis = std::make_unique<Analysis_t>(data, geo, sol, res, assembler,
+                                            bcs);
+  }
+
+  TopoElasticityIntegrand<T, 3, etype> integrand;
+  std::unique_ptr<MeshConnectivity3D> conn;
+  std::unique_ptr<Analysis_t> analysis;
+};
+
+TEST(NewtonTest, FullNewton) {
+  StretchProblem prob(3, 0.3);
+  NewtonOptions opts;
+  opts.rtol = 1e-10;
+  prob.analysis->set_newton_options(opts);
+  prob.analysis->nonlinear_solve();
+
+  const NewtonStats &stats = prob.analysis->get_newton_stats();
+  EXPECT_TRUE(stats.converged);
+  EXPECT_GT(stats.iterations, 1);
+
+  // Only the initial point uses the fused assembly, the line search only
+  // assembles residuals and each factorization needs one Jacobian
+  EXPECT_EQ(stats.fused_evals, 1);
+  EXPECT_EQ(stats.residual_evals, stats.iterations + stats.line_search_steps);
+  EXPECT_EQ(stats.factorizations, stats.iterations);
+  EXPECT_EQ(stats.fused_evals + stats.jacobian_evals, stats.factorizations);
+}
+
+TEST(NewtonTest, InexactNewtonFallback) {
+  StretchProblem prob(3, 0.3);
+  NewtonOptions opts;
+  opts.rtol = 1e-10;
+  opts.max_reuse = 5;
+  opts.reuse_rate = 1.0;
+  opts.max_krylov_iters = 1;
+  opts.ew_eta0 = 1e-12;
+  opts.ew_eta_max = 1e-12;
+  prob.analysis->set_newton_options(opts);
+  prob.analysis->nonlinear_solve();
+
+  // A single CG iteration can not reach the forcing tolerance with a stale
+  // factorization, so the steps fall back to a new factorization
+  const NewtonStats &stats = prob.analysis->get_newton_stats();
+  EXPECT_TRUE(stats.converged);
+  EXPECT_GT(stats.krylov_failures, 0);
+  EXPECT_EQ(stats.krylov_failures, stats.reuses);
+}
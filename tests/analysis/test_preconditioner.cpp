@@ -0,0 +1,216 @@
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "multiphysics/feanalysis.h"
+#include "multiphysics/fepreconditioner.h"
+#include "multiphysics/hex_tools.h"
+#include "multiphysics/integrand_elasticity.h"
+#include "test_commons.h"
+#include "utils/a2dmesh.h"
+
+using namespace A2D;
+
+class Environment : public ::testing::Environment {
+ public:
+  void SetUp() override { Kokkos::initialize(); }
+  void TearDown() override { Kokkos::finalize(); }
+};
+
+// Create a new environment and initialize kokkos
+::testing::Environment *const initialize_kokkos =
+    ::testing::AddGlobalTestEnvironment(new Environment);
+
+/*
+  Linear elasticity on a unit brick of nx^3 hexahedra of the given degree,
+  clamped on the face x = 0
+*/
+template <index_t degree>
+class ElasticityProblem {
+ public:
+  using T = double;
+  static constexpr index_t block_size = 3;
+  static constexpr index_t null_size = 6;
+  static constexpr GreenStrainType etype = GreenStrainType::LINEAR;
+  using Impl_t = DirectCholeskyAnalysisImpl<T, block_size>;
+  using Vec_t = typename Impl_t::Vec_t;
+  using Mat_t = typename Impl_t::Mat_t;
+  using Elem_t = HexTopoElement<Impl_t, etype, degree>;
+  using DataBasis = typename Elem_t::DataBasis;
+  using GeoBasis = typename Elem_t::GeoBasis;
+  using Basis = typename Elem_t::Basis;
+  using Integrand = TopoElasticityIntegrand<T, 3, etype>;
+  using Quadrature = HexGaussQuadrature<degree + 1>;
+
+  ElasticityProblem(index_t nx) : integrand(70.0, 0.3, 5.0) {
+    index_t nverts = (nx + 1) * (nx + 1) * (nx + 1);
+    index_t nhex = nx * nx * nx;
+    std::vector<index_t> hex(8 * nhex);
+    std::vector<double> Xloc(3 * nverts);
+    MesherBrick3D mesher(nx, nx, nx, 1.0, 1.0, 1.0);
+    mesher.set_X_conn<index_t, double>(Xloc.data(), hex.data());
+
+    index_t z = 0;
+    index_t *null = nullptr;
+    conn = std::make_unique<MeshConnectivity3D>(nverts, z, null, nhex,
+                                                hex.data(), z, null, z, null);
+
+    std::vector<index_t> verts;
+    for (index_t k = 0; k < nx + 1; k++) {
+      for (index_t j = 0; j < nx + 1; j++) {
+        verts.push_back(j * (nx + 1) + k * (nx + 1) * (nx + 1));
+      }
+    }
+    index_t label =
+        conn->add_boundary_label_from_verts(verts.size(), verts.data());
+    bcinfo.add_boundary_condition(label);
+
+    data_mesh = std::make_shared<ElementMesh<DataBasis>>(*conn);
+    geo_mesh = std::make_shared<ElementMesh<GeoBasis>>(*conn);
+    sol_mesh = std::make_shared<ElementMesh<Basis>>(*conn);
+    bcs = std::make_shared<DirichletBasis<T, Basis>>(*conn, *sol_mesh, bcinfo,
+                                                     0.0);
+
+    data = std::make_shared<Vec_t>(data_mesh->get_num_dof());
+    geo = std::make_shared<Vec_t>(geo_mesh->get_num_dof());
+    sol = std::make_shared<Vec_t>(sol_mesh->get_num_dof());
+    data->fill(1.0);
+
+    typename Impl_t::template ElementVector<GeoBasis> elem_geo(*geo_mesh,
+                                                               *geo);
+    set_geo_from_hex_nodes<GeoBasis>(nhex, hex.data(), Xloc.data(), elem_geo);
+
+    assembler.add_element(
+        std::make_shared<Elem_t>(integrand, data_mesh, geo_mesh, sol_mesh));
+  }
+
+  index_t get_bcs(const index_t **dofs) { return bcs->get_bcs(dofs, nullptr); }
+
+  // Rigid body modes at the nodes of the solution mesh, zero at the bcs. The
+  // geometry and solution nodes coincide since the bases have the same degree
+  MultiArrayNew<T *[block_size][null_size]> create_null_space() {
+    const index_t nnodes = sol->get_num_dof() / block_size;
+    MultiArrayNew<T *[block_size][null_size]> B("B", nnodes);
+    for (index_t i = 0; i < nnodes; i++) {
+      T x = (*geo)[3 * i], y = (*geo)[3 * i + 1], z = (*geo)[3 * i + 2];
+      B(i, 0, 0) = B(i, 1, 1) = B(i, 2, 2) = 1.0;
+      B(i, 1, 3) = z;
+      B(i, 2, 3) = -y;
+      B(i, 0, 4) = z;
+      B(i, 2, 4) = -x;
+      B(i, 0, 5) = y;
+      B(i, 1, 5) = -x;
+    }
+
+    const index_t *dofs;
+    index_t nbcs = get_bcs(&dofs);
+    for (index_t i = 0; i < nbcs; i++) {
+      for (index_t j = 0; j < null_size; j++) {
+        B(dofs[i] / block_size, dofs[i] % block_size, j) = 0.0;
+      }
+    }
+    return B;
+  }
+
+  // Right-hand-side with zeros at the bcs
+  Vec_t create_rhs() {
+    Vec_t rhs(sol->get_num_dof());
+    for (index_t i = 0; i < rhs.get_num_dof(); i++) {
+      rhs[i] = std::cos(0.3 * i);
+    }
+    const index_t *dofs;
+    index_t nbcs = get_bcs(&dofs);
+    for (index_t i = 0; i < nbcs; i++) {
+      rhs[dofs[i]] = 0.0;
+    }
+    return rhs;
+  }
+
+  // Relative residual ||rhs - A * x|| / ||rhs|| with the assembled Jacobian
+  double residual_norm(Vec_t &rhs, Vec_t &x) {
+    index_t nrows;
+    std::vector<index_t> rowp, cols;
+    assembler.get_bsr_data(block_size, nrows, rowp, cols);
+    Mat_t mat(nrows, nrows, cols.size(), rowp, cols);
+    assembler.add_jacobian(T(1.0), *data, *geo, *sol, mat);
+
+    const index_t *dofs;
+    index_t nbcs = get_bcs(&dofs);
+    mat.zero_rows(nbcs, dofs);
+
+    Vec_t r(x.get_num_dof());
+    auto xv = x.template get_block_view<block_size>();
+    auto rv = r.template get_block_view<block_size>();
+    BSRMatVecMult<T, block_size, block_size>(mat, xv, rv);
+
+    double rnorm = 0.0, bnorm = 0.0;
+    for (index_t i = 0; i < rhs.get_num_dof(); i++) {
+      rnorm += (rhs[i] - r[i]) * (rhs[i] - r[i]);
+      bnorm += rhs[i] * rhs[i];
+    }
+    return std::sqrt(rnorm / bnorm);
+  }
+
+  Integrand integrand;
+  DirichletBCInfo bcinfo;
+  std::unique_ptr<MeshConnectivity3D> conn;
+  std::shared_ptr<ElementMesh<DataBasis>> data_mesh;
+  std::shared_ptr<ElementMesh<GeoBasis>> geo_mesh;
+  std::shared_ptr<ElementMesh<Basis>> sol_mesh;
+  std::shared_ptr<DirichletBasis<T, Basis>> bcs;
+  std::shared_ptr<Vec_t> data, geo, sol;
+  ElementAssembler<Impl_t> assembler;
+};
+
+template <index_t degree>
+void check_lor(index_t nx, index_t max_iters) {
+  using P = ElasticityProblem<degree>;
+  P prob(nx);
+  auto B = prob.create_null_space();
+  const index_t *dofs;
+  index_t nbcs = prob.get_bcs(&dofs);
+
+  LORPreconditioner<double, P::block_size, P::null_size,
+                    typename P::Integrand, typename P::Quadrature,
+                    HexGaussQuadrature<2>, typename P::DataBasis,
+                    typename P::GeoBasis, typename P::Basis>
+      lor(prob.integrand, *prob.data_mesh, *prob.geo_mesh, *prob.sol_mesh,
+          *prob.data, *prob.geo, *prob.sol, B, nbcs, dofs);
+  lor.update();
+
+  auto rhs = prob.create_rhs();
+  typename P::Vec_t x(rhs.get_num_dof());
+  double rtol = 1e-10;
+  EXPECT_TRUE(lor.solve(rhs, x, 0, max_iters, rtol));
+  EXPECT_LT(lor.get_stats().mat_vecs, max_iters);
+  EXPECT_LT(prob.residual_norm(rhs, x), 10.0 * rtol);
+}
+
+TEST(PreconditionerTest, LORDegree1) { check_lor<1>(6, 50); }
+
+TEST(PreconditionerTest, LORDegree2) { check_lor<2>(4, 60); }
+
+template <index_t degree>
+void check_pmg(index_t nx, index_t max_iters) {
+  using P = ElasticityProblem<degree>;
+  P prob(nx);
+  auto B = prob.create_null_space();
+
+  PMGPreconditioner<double, P::null_size, typename P::Integrand,
+                    typename P::Quadrature, typename P::DataBasis,
+                    typename P::GeoBasis, typename P::Basis>
+      pmg(prob.integrand, *prob.conn, prob.bcinfo, *prob.data_mesh,
+          *prob.geo_mesh, *prob.sol_mesh, *prob.data, *prob.geo, *prob.sol, B);
+  pmg.update();
+
+  auto rhs = prob.create_rhs();
+  typename P::Vec_t x(rhs.get_num_dof());
+  double rtol = 1e-10;
+  EXPECT_TRUE(pmg.solve(rhs, x, 0, max_iters, rtol));
+  EXPECT_LT(pmg.get_stats().applications, max_iters);
+  EXPECT_LT(prob.residual_norm(rhs, x), 10.0 * rtol);
+}
+
+TEST(PreconditionerTest, PMGDegree2) { check_pmg<2>(4, 30); }
+
+TEST(PreconditionerTest, PMGDegree4) { check_pmg<4>(2, 30); }
@@ -0,0 +1,180 @@
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "multiphysics/feanalysis.h"
+#include "multiphysics/hex_tools.h"
+#include "multiphysics/integrand_elasticity.h"
+#include "test_commons.h"
+#include "utils/a2dmesh.h"
+
+using namespace A2D;
+
+class Environment : public ::testing::Environment {
+ public:
+  void SetUp() override { Kokkos::initialize(); }
+  void TearDown() override { Kokkos::finalize(); }
+};
+
+// Create a new environment and initialize kokkos
+::testing::Environment *const initialize_kokkos =
+    ::testing::AddGlobalTestEnvironment(new Environment);
+
+// Same as DirectCholeskyAnalysisImpl but with the parallel element vectors
+template <typename T, index_t block_size>
+class ParallelAnalysisImpl {
+ public:
+  using type = T;
+  using Vec_t = SolutionVector<T>;
+  using Mat_t = BSRMat<T, block_size, block_size>;
+
+  template <class Basis>
+  using ElementVector = ElementVector_Parallel<type, Basis, Vec_t>;
+
+  template <class Basis>
+  using ElementMatrix = ElementMat_Serial<type, Basis, Mat_t>;
+};
+
+/*
+  Nonlinear elasticity on a brick of nx^3 hexahedra of the given degree. The
+  same element is assembled with the serial and the parallel element vectors
+  and the results are compared.
+*/
+template <index_t degree>
+class ParallelElementTest {
+ public:
+  using T = double;
+  static constexpr index_t block_size = 3;
+  static constexpr GreenStrainType etype = GreenStrainType::NONLINEAR;
+  using SerialImpl = DirectCholeskyAnalysisImpl<T, block_size>;
+  using ParallelImpl = ParallelAnalysisImpl<T, block_size>;
+  using Vec_t = typename SerialImpl::Vec_t;
+  using Mat_t = typename SerialImpl::Mat_t;
+  using SerialElem = HexTopoElement<SerialImpl, etype, degree>;
+  using ParallelElem = HexTopoElement<ParallelImpl, etype, degree>;
+  using DataBasis = typename SerialElem::DataBasis;
+  using GeoBasis = typename SerialElem::GeoBasis;
+  using Basis = typename SerialElem::Basis;
+  using Integrand = TopoElasticityIntegrand<T, 3, etype>;
+
+  ParallelElementTest(index_t nx) : integrand(70.0, 0.3, 5.0) {
+    index_t nverts = (nx + 1) * (nx + 1) * (nx + 1);
+    index_t nhex = nx * nx * nx;
+    std::vector<index_t> hex(8 * nhex);
+    std::vector<double> Xloc(3 * nverts);
+    MesherBrick3D mesher(nx, nx, nx, 1.0, 1.0, 1.0);
+    mesher.set_X_conn<index_t, double>(Xloc.data(), hex.data());
+
+    index_t z = 0;
+    index_t *null = nullptr;
+    conn = std::make_unique<MeshConnectivity3D>(nverts, z, null, nhex,
+                                                hex.data(), z, null, z, null);
+
+    data_mesh = std::make_shared<ElementMesh<DataBasis>>(*conn);
+    geo_mesh = std::make_shared<ElementMesh<GeoBasis>>(*conn);
+    sol_mesh = std::make_shared<ElementMesh<Basis>>(*conn);
+
+    data = std::make_shared<Vec_t>(data_mesh->get_num_dof());
+    geo = std::make_shared<Vec_t>(geo_mesh->get_num_dof());
+    sol = std::make_shared<Vec_t>(sol_mesh->get_num_dof());
+    for (index_t i = 0; i < data->get_num_dof(); i++) {
+      (*data)[i] = 0.6 + 0.3 * std::cos(1.7 * i);
+    }
+    for (index_t i = 0; i < sol->get_num_dof(); i++) {
+      (*sol)[i] = 0.01 * std::sin(0.3 * i + 0.1);
+    }
+
+    typename SerialImpl::template ElementVector<GeoBasis> elem_geo(*geo_mesh,
+                                                                   *geo);
+    set_geo_from_hex_nodes<GeoBasis>(nhex, hex.data(), Xloc.data(), elem_geo);
+
+    serial = std::make_shared<SerialElem>(integrand, data_mesh, geo_mesh,
+                                          sol_mesh);
+    parallel = std::make_shared<ParallelElem>(integrand, data_mesh, geo_mesh,
+                                              sol_mesh);
+  }
+
+  // Largest difference between two vectors relative to the largest entry
+  static double rel_error(Vec_t &a, Vec_t &b) {
+    double max_a = 0.0, max_err = 0.0;
+    for (index_t i = 0; i < a.get_num_dof(); i++) {
+      max_a = std::max(max_a, std::fabs(a[i]));
+      max_err = std::max(max_err, std::fabs(a[i] - b[i]));
+    }
+    EXPECT_GT(max_a, 0.0);
+    return max_err / max_a;
+  }
+
+  // Create a matrix with the non-zero pattern of the element
+  std::shared_ptr<Mat_t> create_matrix() {
+    index_t nrows;
+    std::vector<index_t> rowp, cols;
+    ElementAssembler<SerialImpl> assembler;
+    assembler.add_element(serial);
+    assembler.get_bsr_data(block_size, nrows, rowp, cols);
+    return std::make_shared<Mat_t>(nrows, nrows, cols.size(), rowp, cols);
+  }
+
+  Integrand integrand;
+  std::unique_ptr<MeshConnectivity3D> conn;
+  std::shared_ptr<ElementMesh<DataBasis>> data_mesh;
+  std::shared_ptr<ElementMesh<GeoBasis>> geo_mesh;
+  std::shared_ptr<ElementMesh<Basis>> sol_mesh;
+  std::shared_ptr<Vec_t> data, geo, sol;
+  std::shared_ptr<SerialElem> serial;
+  std::shared_ptr<ParallelElem> parallel;
+};
+
+template <index_t degree>
+void check_residual(index_t nx) {
+  using P = ParallelElementTest<degree>;
+  P test(nx);
+  const index_t ndof = test.sol->get_num_dof();
+  typename P::Vec_t ref(ndof), res(ndof), res_team(ndof);
+
+  test.serial->add_residual(1.0, *test.data, *test.geo, *test.sol, ref);
+  test.parallel->add_residual(1.0, *test.data, *test.geo, *test.sol, res);
+  test.parallel->set_team_policy(true);
+  test.parallel->add_residual(1.0, *test.data, *test.geo, *test.sol,
+                              res_team);
+
+  EXPECT_LT(P::rel_error(ref, res), 1e-13);
+  EXPECT_LT(P::rel_error(ref, res_team), 1e-13);
+}
+
+TEST(ParallelElementTest, ResidualDegree1) { check_residual<1>(3); }
+
+TEST(ParallelElementTest, ResidualDegree2) { check_residual<2>(2); }
+
+template <index_t degree>
+void check_residual_and_jacobian(index_t nx) {
+  using P = ParallelElementTest<degree>;
+  P test(nx);
+  const index_t ndof = test.sol->get_num_dof();
+  typename P::Vec_t ref(ndof), res(ndof);
+  auto ref_mat = test.create_matrix();
+  auto mat = test.create_matrix();
+
+  test.serial->add_residual_and_jacobian(1.0, *test.data, *test.geo,
+                                         *test.sol, ref, *ref_mat);
+  test.parallel->add_residual_and_jacobian(1.0, *test.data, *test.geo,
+                                           *test.sol, res, *mat);
+  EXPECT_LT(P::rel_error(ref, res), 1e-13);
+
+  double max_ref = 0.0, max_err = 0.0;
+  for (index_t k = 0; k < ref_mat->vals.span(); k++) {
+    max_ref = std::max(max_ref, std::fabs(ref_mat->vals.data()[k]));
+    max_err = std::max(max_err, std::fabs(ref_mat->vals.data()[k] -
+                                          mat->vals.data()[k]));
+  }
+  EXPECT_GT(max_ref, 0.0);
+  EXPECT_LT(max_err, 1e-13 * max_ref);
+}
+
+TEST(ParallelElementTest, ResidualAndJacobianDegree1) {
+  check_residual_and_jacobian<1>(3);
+}
+
+TEST(ParallelElementTest, ResidualAndJacobianDegree2) {
+  check_residual_and_jacobian<2>(2);
+}
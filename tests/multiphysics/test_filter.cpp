@@ -0,0 +1,122 @@
+#include <memory>
+#include <vector>
+
+#include "multiphysics/feanalysis.h"
+#include "multiphysics/fefilter.h"
+#include "multiphysics/hex_tools.h"
+#include "multiphysics/integrand_helmholtz.h"
+#include "test_commons.h"
+#include "utils/a2dmesh.h"
+
+using namespace A2D;
+
+class Environment : public ::testing::Environment {
+ public:
+  void SetUp() override { Kokkos::initialize(); }
+  void TearDown() override { Kokkos::finalize(); }
+};
+
+// Create a new environment and initialize kokkos
+::testing::Environment *const initialize_kokkos =
+    ::testing::AddGlobalTestEnvironment(new Environment);
+
+using Vec_t = SolutionVector<double>;
+
+// Fill a vector with reproducible values in [-1, 1]
+void fill_values(Vec_t &x, unsigned int seed) {
+  for (index_t i = 0; i < x.get_num_dof(); i++) {
+    seed = 1103515245u * seed + 12345u;
+    x[i] = -1.0 + 2.0 * ((seed >> 8) % 10000) / 9999.0;
+  }
+}
+
+double dot(Vec_t &x, Vec_t &y) {
+  double d = 0.0;
+  for (index_t i = 0; i < x.get_num_dof(); i++) {
+    d += x[i] * y[i];
+  }
+  return d;
+}
+
+// Check that a constant field is preserved and that apply_transpose is the
+// adjoint of apply
+template <class Filter>
+void check_filter(Filter &filter, index_t n, double tol) {
+  Vec_t x(n), rho(n), y(n), xt(n);
+
+  for (index_t i = 0; i < n; i++) {
+    x[i] = 0.7;
+  }
+  filter.apply(x, rho);
+  for (index_t i = 0; i < n; i++) {
+    EXPECT_NEAR(rho[i], 0.7, tol);
+  }
+
+  // y^{T} (W x) = (W^{T} y)^{T} x
+  fill_values(x, 1);
+  fill_values(y, 2);
+  filter.apply(x, rho);
+  filter.apply_transpose(y, xt);
+  double lhs = dot(y, rho), rhs = dot(xt, x);
+  EXPECT_NEAR(lhs, rhs, tol * std::fabs(lhs));
+}
+
+TEST(FilterTest, DensityFilter) {
+  // Points on a 20 x 10 grid with a spacing of 0.1
+  const index_t nx = 20, ny = 10, npts = nx * ny;
+  std::vector<double> X(2 * npts);
+  for (index_t j = 0; j < ny; j++) {
+    for (index_t i = 0; i < nx; i++) {
+      X[2 * (i + nx * j)] = 0.1 * i;
+      X[2 * (i + nx * j) + 1] = 0.1 * j;
+    }
+  }
+
+  double r = 0.25;
+  DensityFilter<double, 2> filter(npts, X.data(), r);
+  EXPECT_EQ(filter.get_num_design_vars(), npts);
+
+  // Interior points have all the neighbors within the radius: 21 points
+  const CSRMat<double> &H = filter.get_weights();
+  index_t center = 10 + nx * 5;
+  EXPECT_EQ(H.rowp(center + 1) - H.rowp(center), 21);
+
+  check_filter(filter, npts, 1e-12);
+}
+
+TEST(FilterTest, HelmholtzPDEFilter) {
+  using T = double;
+  const index_t degree = 1;
+  const index_t nx = 24, ny = 12;
+  const double lx = 2.0, ly = 1.0;
+
+  const index_t nverts = (nx + 1) * (ny + 1);
+  const index_t ntri = 0, nquad = nx * ny;
+  index_t *tri = nullptr;
+  std::vector<index_t> quad(4 * nquad);
+  std::vector<double> Xloc(2 * nverts);
+  MesherRect2D mesher(nx, ny, lx, ly);
+  mesher.set_X_conn<index_t, T>(Xloc.data(), quad.data());
+  MeshConnectivity2D conn(nverts, ntri, tri, nquad, quad.data());
+
+  using Impl_t = typename DirectCholeskyAnalysis<T, 1>::Impl_t;
+  using Filter_t = QuadHelmholtzFilterElement<Impl_t, degree>;
+
+  auto data_mesh = std::make_shared<ElementMesh<Filter_t::DataBasis>>(conn);
+  auto geo_mesh = std::make_shared<ElementMesh<Filter_t::GeoBasis>>(conn);
+  index_t ndata = data_mesh->get_num_dof();
+
+  auto geo = std::make_shared<Vec_t>(geo_mesh->get_num_dof());
+  typename Impl_t::ElementVector<Filter_t::GeoBasis> elem_geo(*geo_mesh, *geo);
+  set_geo_from_quad_nodes<Filter_t::GeoBasis>(nquad, quad.data(), Xloc.data(),
+                                              elem_geo);
+
+  T r0 = 0.1;
+  HelmholtzFilter<T, 2> integrand(r0);
+  auto assembler = std::make_shared<ElementAssembler<Impl_t>>();
+  assembler->add_element(
+      std::make_shared<Filter_t>(integrand, data_mesh, geo_mesh, data_mesh));
+
+  HelmholtzPDEFilter<Impl_t> filter(assembler, geo, ndata, ndata);
+  check_filter(filter, ndata, 1e-7);
+}
@@ -0,0 +1,186 @@
+#include <cmath>
+#include <vector>
+
+#include "multiphysics/febasis.h"
+#include "multiphysics/fequadrature.h"
+#include "multiphysics/lagrange_hypercube_basis.h"
+#include "multiphysics/lagrange_tools.h"
+#include "test_commons.h"
+
+using namespace A2D;
+
+/*
+  Quadrature on [-1, 1]^2 with scattered points that is not a tensor product,
+  the two coordinates of each point differ
+*/
+class ScatteredQuadrature2D {
+ public:
+  static const bool is_tensor_product = false;
+  static const index_t num_quad_points = 7;
+
+  KOKKOS_FUNCTION static index_t get_num_points() { return num_quad_points; }
+  KOKKOS_FUNCTION static void get_point(const index_t n, double pt[]) {
+    pt[0] = -0.83 + 0.27 * n;
+    pt[1] = 0.91 - 0.29 * n + 0.05 * n * n;
+  }
+  KOKKOS_FUNCTION static double get_weight(const index_t n) {
+    return 4.0 / num_quad_points;
+  }
+};
+
+/*
+  Reference 1D basis: the values from the knots and the derivatives by central
+  differences of the values
+*/
+template <index_t order, InterpolationType interp_type>
+void reference_basis(double pt, double N[], double Nx[]) {
+  const double* knots = get_interpolation_pts<order, interp_type>();
+  const double h = 1e-6;
+  double Np[order], Nm[order];
+  lagrange_basis<order>(knots, pt, N);
+  lagrange_basis<order>(knots, pt + h, Np);
+  lagrange_basis<order>(knots, pt - h, Nm);
+  for (index_t i = 0; i < order; i++) {
+    Nx[i] = 0.5 * (Np[i] - Nm[i]) / h;
+  }
+}
+
+template <index_t order, InterpolationType interp_type>
+void check_basis(double pt, const double N[], const double Nx[]) {
+  double Nr[order], Nxr[order];
+  reference_basis<order, interp_type>(pt, Nr, Nxr);
+  for (index_t i = 0; i < order; i++) {
+    EXPECT_NEAR(N[i], Nr[i], 1e-14);
+    EXPECT_NEAR(Nx[i], Nxr[i], 1e-6);
+  }
+}
+
+template <index_t order, InterpolationType interp_type>
+void check_interpolation_basis() {
+  for (index_t k = 0; k <= 20; k++) {
+    double pt = -1.0 + 0.1 * k;
+    double N[order], Nx[order];
+    interpolation_basis<order, interp_type>(pt, N, Nx);
+    check_basis<order, interp_type>(pt, N, Nx);
+  }
+}
+
+TEST(InterpolationTable, GaussInterpolationDerivatives) {
+  check_interpolation_basis<2, GAUSS_INTERPOLATION>();
+  check_interpolation_basis<3, GAUSS_INTERPOLATION>();
+  check_interpolation_basis<4, GAUSS_INTERPOLATION>();
+  check_interpolation_basis<6, GAUSS_INTERPOLATION>();
+}
+
+TEST(InterpolationTable, GLLInterpolationDerivatives) {
+  check_interpolation_basis<2, GLL_INTERPOLATION>();
+  check_interpolation_basis<3, GLL_INTERPOLATION>();
+  check_interpolation_basis<4, GLL_INTERPOLATION>();
+  check_interpolation_basis<6, GLL_INTERPOLATION>();
+}
+
+// Check the per-point entries of the table against direct evaluation
+template <class Quadrature, index_t dim, index_t order,
+          InterpolationType interp_type>
+void check_point_table() {
+  using Table = InterpolationTable<Quadrature, dim, order, interp_type>;
+  for (index_t q = 0; q < Quadrature::get_num_points(); q++) {
+    double pt[dim];
+    Quadrature::get_point(q, pt);
+    for (index_t d = 0; d < dim; d++) {
+      check_basis<order, interp_type>(pt[d], Table::values(q, d),
+                                      Table::derivs(q, d));
+    }
+  }
+}
+
+// Check the per-direction entries of a tensor-product table
+template <class Quadrature, index_t dim, index_t order,
+          InterpolationType interp_type>
+void check_tensor_table() {
+  using Table = InterpolationTable<Quadrature, dim, order, interp_type>;
+  static_assert(Table::is_tensor_product, "Expected a tensor-product table");
+  for (index_t d = 0; d < dim; d++) {
+    for (index_t q = 0; q < Quadrature::tensor_dim0; q++) {
+      double pt = Quadrature::get_tensor_point(d, q);
+      check_basis<order, interp_type>(pt, Table::tensor_values(d, q),
+                                      Table::tensor_derivs(d, q));
+    }
+  }
+  check_point_table<Quadrature, dim, order, interp_type>();
+}
+
+TEST(InterpolationTable, TensorProduct) {
+  check_tensor_table<QuadGaussQuadrature<3>, 2, 3, GLL_INTERPOLATION>();
+  check_tensor_table<QuadGaussQuadrature<5>, 2, 4, GAUSS_INTERPOLATION>();
+  check_tensor_table<HexGaussQuadrature<4>, 3, 4, GLL_INTERPOLATION>();
+  check_tensor_table<HexGaussQuadrature<4>, 3, 4, GAUSS_INTERPOLATION>();
+  check_tensor_table<HexGaussLobattoQuadrature<3>, 3, 2,
+                     GAUSS_INTERPOLATION>();
+}
+
+TEST(InterpolationTable, NonTensorProduct) {
+  using Table = InterpolationTable<ScatteredQuadrature2D, 2, 4>;
+  static_assert(!Table::is_tensor_product, "Expected a per-point table");
+  check_point_table<ScatteredQuadrature2D, 2, 4, GLL_INTERPOLATION>();
+  check_point_table<ScatteredQuadrature2D, 2, 4, GAUSS_INTERPOLATION>();
+  check_point_table<LineGaussQuadrature<4>, 1, 3, GAUSS_INTERPOLATION>();
+  check_point_table<LineGaussLobattoQuadrature<5>, 1, 5, GLL_INTERPOLATION>();
+}
+
+/*
+  Interpolate a vector-valued polynomial of degree 3 in each coordinate from
+  its nodal values with the 2D basis. The interpolation is exact, so the values
+  and gradients must match the polynomial at the quadrature points.
+*/
+template <class Quadrature, InterpolationType interp_type>
+void check_interp_2d() {
+  constexpr index_t degree = 3, C = 2;
+  using Basis = LagrangeH1HypercubeBasis<T, 2, C, degree, interp_type>;
+  using Space = FESpace<T, 2, H1Space<T, C, 2>>;
+  constexpr index_t order = Basis::order;
+
+  auto f = [](const double x, const double y, double u[], double g[][2]) {
+    u[0] = 1.0 + x - 2.0 * x * x * y + 0.5 * x * x * x * y * y * y;
+    g[0][0] = 1.0 - 4.0 * x * y + 1.5 * x * x * y * y * y;
+    g[0][1] = -2.0 * x * x + 1.5 * x * x * x * y * y;
+    u[1] = 0.3 - x * y + y * y * y;
+    g[1][0] = -y;
+    g[1][1] = -x + 3.0 * y * y;
+  };
+
+  const double* knots = get_interpolation_pts<order, interp_type>();
+  T sol[Basis::ndof];
+  for (index_t j1 = 0; j1 < order; j1++) {
+    for (index_t j0 = 0; j0 < order; j0++) {
+      double u[C], g[C][2];
+      f(knots[j0], knots[j1], u, g);
+      for (index_t i = 0; i < C; i++) {
+        sol[C * (j0 + order * j1) + i] = u[i];
+      }
+    }
+  }
+
+  QptSpace<Quadrature, Space> out;
+  Basis::template interp<0, Quadrature, Space, 0>(sol, out);
+
+  for (index_t q = 0; q < Quadrature::get_num_points(); q++) {
+    double pt[2], u[C], g[C][2];
+    Quadrature::get_point(q, pt);
+    f(pt[0], pt[1], u, g);
+
+    H1Space<T, C, 2>& h1 = out.get(q).template get<0>();
+    for (index_t i = 0; i < C; i++) {
+      EXPECT_NEAR(h1.get_value()(i), u[i], 1e-12);
+      EXPECT_NEAR(h1.get_grad()(i, 0), g[i][0], 1e-12);
+      EXPECT_NEAR(h1.get_grad()(i, 1), g[i][1], 1e-12);
+    }
+  }
+}
+
+TEST(InterpolationTable, BasisInterp2D) {
+  check_interp_2d<QuadGaussQuadrature<4>, GLL_INTERPOLATION>();
+  check_interp_2d<QuadGaussQuadrature<4>, GAUSS_INTERPOLATION>();
+  check_interp_2d<ScatteredQuadrature2D, GLL_INTERPOLATION>();
+  check_interp_2d<ScatteredQuadrature2D, GAUSS_INTERPOLATION>();
+}
@@ -0,0 +1,119 @@
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "multiphysics/feanalysis.h"
+#include "multiphysics/fematrixfree.h"
+#include "multiphysics/hex_tools.h"
+#include "multiphysics/integrand_elasticity.h"
+#include "test_commons.h"
+#include "utils/a2dmesh.h"
+
+using namespace A2D;
+
+class Environment : public ::testing::Environment {
+ public:
+  void SetUp() override { Kokkos::initialize(); }
+  void TearDown() override { Kokkos::finalize(); }
+};
+
+// Create a new environment and initialize kokkos
+::testing::Environment *const initialize_kokkos =
+    ::testing::AddGlobalTestEnvironment(new Environment);
+
+/*
+  Apply the matrix-free state Jacobian of elasticity on a brick of nx^3
+  hexahedra with the full and the on-the-fly storage and compare
+*/
+template <GreenStrainType etype, index_t degree>
+void check_on_the_fly(index_t nx) {
+  using T = double;
+  using Impl_t = DirectCholeskyAnalysisImpl<T, 3>;
+  using Vec_t = typename Impl_t::Vec_t;
+  using Elem_t = HexTopoElement<Impl_t, etype, degree>;
+  using DataBasis = typename Elem_t::DataBasis;
+  using GeoBasis = typename Elem_t::GeoBasis;
+  using Basis = typename Elem_t::Basis;
+  using Integrand = TopoElasticityIntegrand<T, 3, etype>;
+  using Quadrature = HexGaussQuadrature<degree + 1>;
+  using MatFree = MatrixFree<T, FEVarType::STATE, FEVarType::STATE, Integrand,
+                             Quadrature, DataBasis, GeoBasis, Basis>;
+  static_assert(MatFree::use_product_data,
+                "Elasticity should cache the product data");
+
+  index_t nverts = (nx + 1) * (nx + 1) * (nx + 1);
+  index_t nhex = nx * nx * nx;
+  std::vector<index_t> hex(8 * nhex);
+  std::vector<double> Xloc(3 * nverts);
+  MesherBrick3D mesher(nx, nx, nx, 1.0, 1.0, 1.0);
+  mesher.set_X_conn<index_t, double>(Xloc.data(), hex.data());
+
+  index_t z = 0;
+  index_t *null = nullptr;
+  MeshConnectivity3D conn(nverts, z, null, nhex, hex.data(), z, null, z, null);
+  ElementMesh<DataBasis> data_mesh(conn);
+  ElementMesh<GeoBasis> geo_mesh(conn);
+  ElementMesh<Basis> sol_mesh(conn);
+
+  Vec_t data(data_mesh.get_num_dof()), geo(geo_mesh.get_num_dof());
+  Vec_t sol(sol_mesh.get_num_dof()), x(sol_mesh.get_num_dof());
+  for (index_t i = 0; i < data.get_num_dof(); i++) {
+    data[i] = 0.6 + 0.3 * std::cos(1.7 * i);
+  }
+  for (index_t i = 0; i < sol.get_num_dof(); i++) {
+    sol[i] = 0.05 * std::sin(0.3 * i + 0.1);
+    x[i] = std::cos(0.7 * i);
+  }
+
+  typename Impl_t::template ElementVector<DataBasis> elem_data(data_mesh,
+                                                               data);
+  typename Impl_t::template ElementVector<GeoBasis> elem_geo(geo_mesh, geo);
+  typename Impl_t::template ElementVector<Basis> elem_sol(sol_mesh, sol);
+  set_geo_from_hex_nodes<GeoBasis>(nhex, hex.data(), Xloc.data(), elem_geo);
+
+  Integrand integrand(70.0, 0.3, 5.0);
+  MatFree full(MatFreeStorage::FULL);
+  MatFree on_the_fly(MatFreeStorage::ON_THE_FLY);
+  full.initialize(integrand, elem_data, elem_geo, elem_sol);
+  on_the_fly.initialize(integrand, elem_data, elem_geo, elem_sol);
+  EXPECT_LT(on_the_fly.get_memory_usage(), full.get_memory_usage());
+
+  Vec_t y_full(sol_mesh.get_num_dof()), y(sol_mesh.get_num_dof());
+  typename Impl_t::template ElementVector<Basis> elem_x(sol_mesh, x);
+  typename Impl_t::template ElementVector<Basis> elem_y_full(sol_mesh,
+                                                             y_full);
+  typename Impl_t::template ElementVector<Basis> elem_y(sol_mesh, y);
+  full.add_jacobian_vector_product(elem_x, elem_y_full);
+  on_the_fly.add_jacobian_vector_product(elem_x, elem_y);
+
+  double max_ref = 0.0, max_err = 0.0;
+  for (index_t i = 0; i < y.get_num_dof(); i++) {
+    max_ref = std::max(max_ref, std::fabs(y_full[i]));
+    max_err = std::max(max_err, std::fabs(y_full[i] - y[i]));
+  }
+  EXPECT_GT(max_ref, 0.0);
+  EXPECT_LT(max_err, 1e-12 * max_ref);
+}
+
+TEST(MatrixFreeTest, OnTheFlyLinear) {
+  check_on_the_fly<GreenStrainType::LINEAR, 1>(3);
+  check_on_the_fly<GreenStrainType::LINEAR, 2>(2);
+}
+
+TEST(MatrixFreeTest, OnTheFlyNonlinear) {
+  check_on_the_fly<GreenStrainType::NONLINEAR, 1>(3);
+  check_on_the_fly<GreenStrainType::NONLINEAR, 2>(2);
+}
+
+TEST(MatrixFreeTest, OnTheFlyRequiresStateJacobian) {
+  using T = double;
+  using Integrand = TopoElasticityIntegrand<T, 3>;
+  using DataBasis = FEBasis<T, LagrangeH1HexBasis<T, 1, 1>>;
+  using Basis = FEBasis<T, LagrangeH1HexBasis<T, 3, 1>>;
+  using MatFree = MatrixFree<T, FEVarType::DATA, FEVarType::DATA, Integrand,
+                             HexGaussQuadrature<2>, DataBasis, Basis, Basis>;
+
+  MatFree full(MatFreeStorage::FULL);
+  EXPECT_EQ(full.get_storage(), MatFreeStorage::FULL);
+  EXPECT_THROW(MatFree(MatFreeStorage::ON_THE_FLY), std::runtime_error);
+}
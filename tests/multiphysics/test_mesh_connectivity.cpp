@@ -0,0 +1,139 @@
+#include <vector>
+
+#include "multiphysics/femesh.h"
+#include "test_commons.h"
+
+using namespace A2D;
+
+class Environment : public ::testing::Environment {
+ public:
+  void SetUp() override { Kokkos::initialize(); }
+  void TearDown() override { Kokkos::finalize(); }
+};
+
+// Create a new environment and initialize kokkos
+::testing::Environment *const initialize_kokkos =
+    ::testing::AddGlobalTestEnvironment(new Environment);
+
+using ET = ElementTypes;
+
+// Check that the two connectivities have identical numbering
+void expect_same_connectivity(MeshConnectivityBase &a,
+                              MeshConnectivityBase &b) {
+  ASSERT_EQ(a.get_num_elements(), b.get_num_elements());
+  ASSERT_EQ(a.get_num_bounds(), b.get_num_bounds());
+  ASSERT_EQ(a.get_num_edges(), b.get_num_edges());
+
+  for (index_t elem = 0; elem < a.get_num_elements(); elem++) {
+    const index_t *ab, *bb, *ae, *be;
+    index_t nb = a.get_element_bounds(elem, &ab);
+    ASSERT_EQ(nb, b.get_element_bounds(elem, &bb));
+    EXPECT_VEC_EQ(nb, ab, bb);
+
+    index_t ne = a.get_element_edges(elem, &ae);
+    ASSERT_EQ(ne, b.get_element_edges(elem, &be));
+    EXPECT_VEC_EQ(ne, ae, be);
+  }
+
+  for (index_t bound = 0; bound < a.get_num_bounds(); bound++) {
+    index_t a1, a2, b1, b2;
+    a.get_bound_elements(bound, &a1, &a2);
+    b.get_bound_elements(bound, &b1, &b2);
+    EXPECT_EQ(a1, b1);
+    EXPECT_EQ(a2, b2);
+  }
+
+  for (index_t vert = 0; vert < a.get_num_verts(); vert++) {
+    const index_t *ae, *be;
+    index_t na = a.get_adjacent_elements_from_vert(vert, &ae);
+    ASSERT_EQ(na, b.get_adjacent_elements_from_vert(vert, &be));
+    EXPECT_VEC_EQ(na, ae, be);
+  }
+
+  const index_t *abound, *alabel, *bbound, *blabel;
+  index_t na = a.get_boundary_bounds(&abound, &alabel);
+  ASSERT_EQ(na, b.get_boundary_bounds(&bbound, &blabel));
+  EXPECT_VEC_EQ(na, abound, bbound);
+  EXPECT_VEC_EQ(na, alabel, blabel);
+}
+
+// Create a structured n x n x n mesh of hexahedra or 6 * n^3 tetrahedra
+void create_mesh_3d(index_t n, bool tets, index_t &nverts,
+                    std::vector<index_t> &hex, std::vector<index_t> &tet) {
+  auto node = [&](index_t i, index_t j, index_t k) {
+    return i + j * (n + 1) + k * (n + 1) * (n + 1);
+  };
+  nverts = (n + 1) * (n + 1) * (n + 1);
+
+  // Split each hex into 6 tets that share the diagonal from vertex 0 to 6
+  const index_t hex_to_tet[6][4] = {{0, 1, 2, 6}, {0, 2, 3, 6}, {0, 3, 7, 6},
+                              {0, 7, 4, 6}, {0, 4, 5, 6}, {0, 5, 1, 6}};
+
+  for (index_t k = 0; k < n; k++) {
+    for (index_t j = 0; j < n; j++) {
+      for (index_t i = 0; i < n; i++) {
+        index_t v[8];
+        for (index_t ii = 0; ii < 8; ii++) {
+          v[ii] = node(i + ET::HEX_VERTS_CART[ii][0],
+                       j + ET::HEX_VERTS_CART[ii][1],
+                       k + ET::HEX_VERTS_CART[ii][2]);
+        }
+        if (tets) {
+          for (index_t t = 0; t < 6; t++) {
+            for (index_t ii = 0; ii < 4; ii++) {
+              tet.push_back(v[hex_to_tet[t][ii]]);
+            }
+          }
+        } else {
+          hex.insert(hex.end(), v, v + 8);
+        }
+      }
+    }
+  }
+}
+
+// Build the 3D connectivity with both algorithms and compare
+void check_mesh_3d(index_t n, bool tets) {
+  index_t nverts, z = 0;
+  index_t *null = nullptr;
+  std::vector<index_t> hex, tet;
+  create_mesh_3d(n, tets, nverts, hex, tet);
+  index_t nhex = hex.size() / 8, ntets = tet.size() / 4;
+
+  MeshConnectivity3D ser(nverts, ntets, tet.data(), nhex, hex.data(), z, null,
+                         z, null, MeshConnectivityBuild::SERIAL);
+  MeshConnectivity3D par(nverts, ntets, tet.data(), nhex, hex.data(), z, null,
+                         z, null, MeshConnectivityBuild::PARALLEL);
+  expect_same_connectivity(ser, par);
+}
+
+TEST(MeshConnectivityTest, Hex3D) { check_mesh_3d(5, false); }
+
+TEST(MeshConnectivityTest, Tet3D) { check_mesh_3d(4, true); }
+
+TEST(MeshConnectivityTest, Mixed2D) {
+  // Structured n x n grid, the cells with i + j odd are split into triangles
+  const index_t n = 6;
+  auto node = [&](index_t i, index_t j) { return i + j * (n + 1); };
+  index_t nverts = (n + 1) * (n + 1);
+
+  std::vector<index_t> quad, tri;
+  for (index_t j = 0; j < n; j++) {
+    for (index_t i = 0; i < n; i++) {
+      index_t v[4] = {node(i, j), node(i + 1, j), node(i + 1, j + 1),
+                node(i, j + 1)};
+      if ((i + j) % 2 == 1) {
+        tri.insert(tri.end(), {v[0], v[1], v[2], v[0], v[2], v[3]});
+      } else {
+        quad.insert(quad.end(), v, v + 4);
+      }
+    }
+  }
+  index_t nquad = quad.size() / 4, ntri = tri.size() / 3;
+
+  MeshConnectivity2D ser(nverts, ntri, tri.data(), nquad, quad.data(),
+                         MeshConnectivityBuild::SERIAL);
+  MeshConnectivity2D par(nverts, ntri, tri.data(), nquad, quad.data(),
+                         MeshConnectivityBuild::PARALLEL);
+  expect_same_connectivity(ser, par);
+}
@@ -0,0 +1,304 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "multiphysics/febasis.h"
+#include "multiphysics/femesh.h"
+#include "multiphysics/femesh_ordering.h"
+#include "multiphysics/lagrange_hypercube_basis.h"
+#include "test_commons.h"
+#include "utils/a2dmesh.h"
+#include "utils/a2dvtk.h"
+
+using namespace A2D;
+
+class Environment : public ::testing::Environment {
+ public:
+  void SetUp() override { Kokkos::initialize(); }
+  void TearDown() override { Kokkos::finalize(); }
+};
+
+// Create a new environment and initialize kokkos
+::testing::Environment *const initialize_kokkos =
+    ::testing::AddGlobalTestEnvironment(new Environment);
+
+// Check that perm contains each index in [0, n) exactly once
+void check_permutation(index_t n, const std::vector<index_t> &perm) {
+  ASSERT_EQ(perm.size(), n);
+  std::vector<char> found(n, 0);
+  for (index_t i : perm) {
+    ASSERT_LT(i, n);
+    EXPECT_FALSE(found[i]);
+    found[i] = 1;
+  }
+}
+
+/*
+  A brick of nx x ny x nz hexahedra with the elements and the vertices in a
+  random order
+*/
+class ShuffledBrick {
+ public:
+  ShuffledBrick(index_t nx, index_t ny, index_t nz)
+      : nverts((nx + 1) * (ny + 1) * (nz + 1)),
+        nhex(nx * ny * nz),
+        hex(8 * nhex),
+        Xloc(3 * nverts) {
+    std::vector<index_t> conn(8 * nhex);
+    std::vector<double> X(3 * nverts);
+    MesherBrick3D mesher(nx, ny, nz, 1.0, 1.0, 1.0);
+    mesher.set_X_conn<index_t, double>(X.data(), conn.data());
+
+    std::mt19937 gen(1234);
+    std::vector<index_t> order(nhex), label(nverts);
+    for (index_t e = 0; e < nhex; e++) {
+      order[e] = e;
+    }
+    for (index_t i = 0; i < nverts; i++) {
+      label[i] = i;
+    }
+    std::shuffle(order.begin(), order.end(), gen);
+    std::shuffle(label.begin(), label.end(), gen);
+
+    for (index_t e = 0; e < nhex; e++) {
+      for (index_t j = 0; j < 8; j++) {
+        hex[8 * e + j] = label[conn[8 * order[e] + j]];
+      }
+    }
+    for (index_t i = 0; i < nverts; i++) {
+      for (index_t k = 0; k < 3; k++) {
+        Xloc[3 * label[i] + k] = X[3 * i + k];
+      }
+    }
+  }
+
+  // Average distance between the centroids of consecutive elements
+  double centroid_step() const {
+    double total = 0.0;
+    for (index_t e = 1; e < nhex; e++) {
+      double d2 = 0.0;
+      for (index_t k = 0; k < 3; k++) {
+        double dx = 0.0;
+        for (index_t j = 0; j < 8; j++) {
+          dx += Xloc[3 * hex[8 * e + j] + k] -
+                Xloc[3 * hex[8 * (e - 1) + j] + k];
+        }
+        d2 += (dx / 8.0) * (dx / 8.0);
+      }
+      total += std::sqrt(d2);
+    }
+    return total / (nhex - 1);
+  }
+
+  index_t nverts, nhex;
+  std::vector<index_t> hex;
+  std::vector<double> Xloc;
+};
+
+// Largest and average spread of the dof within each element
+template <class Basis>
+void element_bandwidth(ElementMesh<Basis> &mesh, index_t &max_bandwidth,
+                       double &avg_bandwidth) {
+  max_bandwidth = 0;
+  avg_bandwidth = 0.0;
+  for (index_t e = 0; e < mesh.get_num_elements(); e++) {
+    const index_t *dof;
+    mesh.get_element_dof(e, &dof);
+    auto [lo, hi] = std::minmax_element(dof, dof + Basis::ndof);
+    max_bandwidth = std::max(max_bandwidth, *hi - *lo);
+    avg_bandwidth += *hi - *lo;
+  }
+  avg_bandwidth /= mesh.get_num_elements();
+}
+
+TEST(MeshOrderingTest, ReverseCuthillMcKee) {
+  // 5-point stencil on an n x n grid with the nodes randomly labeled
+  const index_t n = 20, nnodes = n * n;
+  std::vector<index_t> label(nnodes);
+  for (index_t i = 0; i < nnodes; i++) {
+    label[i] = i;
+  }
+  std::mt19937 gen(42);
+  std::shuffle(label.begin(), label.end(), gen);
+
+  std::vector<std::vector<index_t>> adj(nnodes);
+  for (index_t i = 0; i < n; i++) {
+    for (index_t j = 0; j < n; j++) {
+      index_t node = label[i * n + j];
+      if (i > 0) adj[node].push_back(label[(i - 1) * n + j]);
+      if (i < n - 1) adj[node].push_back(label[(i + 1) * n + j]);
+      if (j > 0) adj[node].push_back(label[i * n + j - 1]);
+      if (j < n - 1) adj[node].push_back(label[i * n + j + 1]);
+    }
+  }
+  std::vector<index_t> rowp(1, 0), cols;
+  for (index_t i = 0; i < nnodes; i++) {
+    cols.insert(cols.end(), adj[i].begin(), adj[i].end());
+    rowp.push_back(cols.size());
+  }
+
+  std::vector<index_t> order;
+  reverse_cuthill_mckee(nnodes, rowp, cols, order);
+  check_permutation(nnodes, order);
+
+  std::vector<index_t> position(nnodes);
+  for (index_t k = 0; k < nnodes; k++) {
+    position[order[k]] = k;
+  }
+  index_t bandwidth = 0, shuffled_bandwidth = 0;
+  for (index_t i = 0; i < nnodes; i++) {
+    for (index_t jp = rowp[i]; jp < rowp[i + 1]; jp++) {
+      index_t j = cols[jp];
+      shuffled_bandwidth =
+          std::max(shuffled_bandwidth, i > j ? i - j : j - i);
+      index_t pi = position[i], pj = position[j];
+      bandwidth = std::max(bandwidth, pi > pj ? pi - pj : pj - pi);
+    }
+  }
+
+  // The level sets of the grid are the anti-diagonals, of at most n nodes
+  EXPECT_LE(bandwidth, n + 1);
+  EXPECT_LT(4 * bandwidth, shuffled_bandwidth);
+}
+
+/*
+  Check the RCM ordering of an ElementMesh against the natural ordering, the
+  element dof must be permuted consistently and the spread of the dof within
+  the elements must shrink by at least the given factor
+*/
+template <index_t degree>
+void check_element_mesh_rcm(double factor) {
+  using T = double;
+  using Basis = FEBasis<T, LagrangeH1HexBasis<T, 3, degree>>;
+  const index_t block_size = 3;
+
+  // A long bar, so that the RCM levels are narrow
+  ShuffledBrick brick(20, 2, 2);
+  index_t z = 0;
+  index_t *null = nullptr;
+  MeshConnectivity3D conn(brick.nverts, z, null, brick.nhex, brick.hex.data(),
+                          z, null, z, null);
+  ElementMesh<Basis> natural(conn);
+  ElementMesh<Basis> rcm(conn, DofOrdering::RCM, block_size);
+
+  ASSERT_EQ(natural.get_num_dof(), rcm.get_num_dof());
+  EXPECT_TRUE(natural.get_dof_permutation().empty());
+  const std::vector<index_t> &perm = rcm.get_dof_permutation();
+  check_permutation(rcm.get_num_dof(), perm);
+
+  // The blocks stay contiguous
+  for (index_t i = 0; i < rcm.get_num_dof(); i++) {
+    EXPECT_EQ(perm[i] % block_size, i % block_size);
+    EXPECT_EQ(perm[i] / block_size,
+              perm[block_size * (i / block_size)] / block_size);
+  }
+
+  // The element dof are the permuted natural dof
+  for (index_t e = 0; e < rcm.get_num_elements(); e++) {
+    const index_t *dof, *natural_dof;
+    rcm.get_element_dof(e, &dof);
+    natural.get_element_dof(e, &natural_dof);
+    for (index_t j = 0; j < Basis::ndof; j++) {
+      EXPECT_EQ(dof[j], perm[natural_dof[j]]);
+    }
+  }
+
+  // The shuffled mesh gives a wide natural numbering
+  index_t max_natural, max_rcm;
+  double avg_natural, avg_rcm;
+  element_bandwidth(natural, max_natural, avg_natural);
+  element_bandwidth(rcm, max_rcm, avg_rcm);
+  EXPECT_LT(factor * max_rcm, max_natural);
+  EXPECT_LT(factor * avg_rcm, avg_natural);
+}
+
+// The natural ordering numbers the dof of each element together as they are
+// first encountered, so the shuffled elements widen it by a moderate factor
+TEST(MeshOrderingTest, ElementMeshRCMDegree1) {
+  check_element_mesh_rcm<1>(2.0);
+}
+
+TEST(MeshOrderingTest, ElementMeshRCMDegree2) {
+  check_element_mesh_rcm<2>(2.0);
+}
+
+TEST(MeshOrderingTest, HilbertSort) {
+  ShuffledBrick brick(8, 8, 8);
+  std::vector<index_t> hex(brick.hex);
+  double shuffled_step = brick.centroid_step();
+
+  std::vector<index_t> perm;
+  hilbert_sort_elements(3, brick.nhex, 8, brick.hex.data(), brick.Xloc.data(),
+                        perm);
+  check_permutation(brick.nhex, perm);
+  for (index_t e = 0; e < brick.nhex; e++) {
+    for (index_t j = 0; j < 8; j++) {
+      EXPECT_EQ(brick.hex[8 * e + j], hex[8 * perm[e] + j]);
+    }
+  }
+
+  // Consecutive elements along the curve are mostly neighbors
+  const double h = 1.0 / 8;
+  EXPECT_LT(brick.centroid_step(), 1.5 * h);
+  EXPECT_LT(4 * brick.centroid_step(), shuffled_step);
+}
+
+TEST(MeshOrderingTest, ReadVTK3DHilbertSort) {
+  // Write the shuffled brick with the element index as the cell entity id
+  ShuffledBrick brick(4, 4, 4);
+  std::string name = "test_mesh_ordering.vtk";
+  std::FILE *fp = std::fopen(name.c_str(), "w");
+  ASSERT_NE(fp, nullptr);
+  std::fprintf(fp, "# vtk DataFile Version 3.0\nbrick\nASCII\n");
+  std::fprintf(fp, "DATASET UNSTRUCTURED_GRID\n");
+  std::fprintf(fp, "POINTS %d double\n", brick.nverts);
+  for (index_t i = 0; i < brick.nverts; i++) {
+    std::fprintf(fp, "%.17g %.17g %.17g\n", brick.Xloc[3 * i],
+                 brick.Xloc[3 * i + 1], brick.Xloc[3 * i + 2]);
+  }
+  std::fprintf(fp, "CELLS %d %d\n", brick.nhex, 9 * brick.nhex);
+  for (index_t e = 0; e < brick.nhex; e++) {
+    std::fprintf(fp, "8");
+    for (index_t j = 0; j < 8; j++) {
+      std::fprintf(fp, " %d", brick.hex[8 * e + j]);
+    }
+    std::fprintf(fp, "\n");
+  }
+  std::fprintf(fp, "CELL_TYPES %d\n", brick.nhex);
+  for (index_t e = 0; e < brick.nhex; e++) {
+    std::fprintf(fp, "%d\n", VTKID::HEXAHEDRON);
+  }
+  std::fprintf(fp, "CELL_DATA %d\n", brick.nhex);
+  std::fprintf(fp, "SCALARS CellEntityIds int 1\nLOOKUP_TABLE default\n");
+  for (index_t e = 0; e < brick.nhex; e++) {
+    std::fprintf(fp, "%d\n", e);
+  }
+  std::fclose(fp);
+
+  bool verbose = false, hilbert_sort = true;
+  ReadVTK3D<index_t, double> unsorted(name);
+  ReadVTK3D<index_t, double> sorted(name, verbose, hilbert_sort);
+  std::remove(name.c_str());
+
+  EXPECT_TRUE(unsorted.get_hex_perm().empty());
+  const std::vector<index_t> &perm = sorted.get_hex_perm();
+  ASSERT_EQ(sorted.get_nhex(), brick.nhex);
+  check_permutation(brick.nhex, perm);
+
+  // The cells and their entity ids are permuted together
+  for (index_t e = 0; e < brick.nhex; e++) {
+    for (index_t j = 0; j < 8; j++) {
+      EXPECT_EQ(sorted.get_hex()[8 * e + j],
+                unsorted.get_hex()[8 * perm[e] + j]);
+    }
+    std::vector<int> id{int(perm[e])};
+    std::vector<index_t> verts = sorted.get_verts_given_cell_entity_id(id);
+    std::vector<index_t> expected(brick.hex.begin() + 8 * perm[e],
+                                  brick.hex.begin() + 8 * perm[e] + 8);
+    std::sort(expected.begin(), expected.end());
+    EXPECT_EQ(verts, expected);
+  }
+}
@@ -0,0 +1,92 @@
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "multiphysics/febasis.h"
+#include "multiphysics/fequadrature.h"
+#include "multiphysics/lagrange_hypercube_basis.h"
+#include "test_commons.h"
+
+using namespace A2D;
+
+template <index_t dim, index_t degree>
+struct GaussQuadrature;
+
+template <index_t degree>
+struct GaussQuadrature<2, degree> {
+  using type = QuadGaussQuadrature<degree + 1>;
+};
+
+template <index_t degree>
+struct GaussQuadrature<3, degree> {
+  using type = HexGaussQuadrature<degree + 1>;
+};
+
+/*
+  Form the element matrix from random Jacobians at the quadrature points with
+  the sum-factorized add_outer_tensor() and with add_outer() at each point,
+  and compare the two
+*/
+template <index_t dim, index_t C, index_t degree,
+          InterpolationType interp_type = GLL_INTERPOLATION>
+void check_outer_tensor() {
+  using Basis =
+      FEBasis<T, LagrangeH1HypercubeBasis<T, dim, C, degree, interp_type>>;
+  using Quadrature = typename GaussQuadrature<dim, degree>::type;
+  using QMat = Mat<T, Basis::ncomp, Basis::ncomp>;
+  using ElemMat = Mat<T, Basis::ndof, Basis::ndof>;
+
+  static_assert(Basis::template has_outer_tensor<Quadrature, QMat, ElemMat>(),
+                "The basis should provide add_outer_tensor()");
+
+  const index_t num_points = Quadrature::get_num_points();
+  std::vector<QMat> jac(num_points);
+  for (index_t q = 0; q < num_points; q++) {
+    for (index_t i = 0; i < Basis::ncomp; i++) {
+      for (index_t j = 0; j < Basis::ncomp; j++) {
+        jac[q](i, j) = std::cos(1.3 * q + 0.7 * i - 0.4 * j + 0.1 * i * j);
+      }
+    }
+  }
+
+  // The element matrices may be too large for the stack
+  auto mat = std::make_unique<ElemMat>();
+  auto ref = std::make_unique<ElemMat>();
+  mat->zero();
+  ref->zero();
+
+  Basis::template add_outer_tensor<Quadrature>(jac.data(), *mat);
+  for (index_t q = 0; q < num_points; q++) {
+    Basis::template add_outer<Quadrature>(q, jac[q], *ref);
+  }
+
+  double max_ref = 0.0, max_err = 0.0;
+  for (index_t i = 0; i < Basis::ndof; i++) {
+    for (index_t j = 0; j < Basis::ndof; j++) {
+      max_ref = std::max(max_ref, std::fabs((*ref)(i, j)));
+      max_err = std::max(max_err, std::fabs((*mat)(i, j) - (*ref)(i, j)));
+    }
+  }
+  EXPECT_GT(max_ref, 0.0);
+  EXPECT_LT(max_err, 1e-12 * max_ref);
+}
+
+template <index_t dim, index_t C>
+void check_degrees() {
+  check_outer_tensor<dim, C, 1>();
+  check_outer_tensor<dim, C, 2>();
+  check_outer_tensor<dim, C, 3>();
+  check_outer_tensor<dim, C, 4>();
+}
+
+TEST(OuterTensor, Quad1) { check_degrees<2, 1>(); }
+TEST(OuterTensor, Quad2) { check_degrees<2, 2>(); }
+TEST(OuterTensor, Quad3) { check_degrees<2, 3>(); }
+TEST(OuterTensor, Hex1) { check_degrees<3, 1>(); }
+TEST(OuterTensor, Hex2) { check_degrees<3, 2>(); }
+TEST(OuterTensor, Hex3) { check_degrees<3, 3>(); }
+
+TEST(OuterTensor, GaussInterpolation) {
+  check_outer_tensor<2, 2, 3, GAUSS_INTERPOLATION>();
+  check_outer_tensor<3, 2, 3, GAUSS_INTERPOLATION>();
+}
@@ -0,0 +1,258 @@
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "multiphysics/febasis.h"
+#include "multiphysics/femesh.h"
+#include "multiphysics/lagrange_hypercube_basis.h"
+#include "multiphysics/static_condensation.h"
+#include "sparse/sparse_amg.h"
+#include "test_commons.h"
+#include "utils/a2dmesh.h"
+
+using namespace A2D;
+
+class Environment : public ::testing::Environment {
+ public:
+  void SetUp() override { Kokkos::initialize(); }
+  void TearDown() override { Kokkos::finalize(); }
+};
+
+// Create a new environment and initialize kokkos
+::testing::Environment *const initialize_kokkos =
+    ::testing::AddGlobalTestEnvironment(new Environment);
+
+/*
+  Solve A * X = B in place with Gaussian elimination and partial pivoting,
+  where A is n x n and B is n x m, both stored by rows
+*/
+void dense_solve(index_t n, index_t m, std::vector<double> &A,
+                 std::vector<double> &B) {
+  for (index_t k = 0; k < n; k++) {
+    index_t p = k;
+    for (index_t i = k + 1; i < n; i++) {
+      if (std::fabs(A[i * n + k]) > std::fabs(A[p * n + k])) {
+        p = i;
+      }
+    }
+    for (index_t j = 0; j < n; j++) {
+      std::swap(A[k * n + j], A[p * n + j]);
+    }
+    for (index_t j = 0; j < m; j++) {
+      std::swap(B[k * m + j], B[p * m + j]);
+    }
+    for (index_t i = k + 1; i < n; i++) {
+      double f = A[i * n + k] / A[k * n + k];
+      for (index_t j = k; j < n; j++) {
+        A[i * n + j] -= f * A[k * n + j];
+      }
+      for (index_t j = 0; j < m; j++) {
+        B[i * m + j] -= f * B[k * m + j];
+      }
+    }
+  }
+  for (index_t k = n; k > 0; k--) {
+    index_t i = k - 1;
+    for (index_t j = 0; j < m; j++) {
+      double value = B[i * m + j];
+      for (index_t l = i + 1; l < n; l++) {
+        value -= A[i * n + l] * B[l * m + j];
+      }
+      B[i * m + j] = value / A[i * n + i];
+    }
+  }
+}
+
+/*
+  Static condensation of a continuous H1 field coupled to an element-local L2
+  field on a brick of nx^3 hexahedra. The element matrices are synthetic and
+  the same matrices are assembled into a dense uncondensed matrix.
+*/
+class CondensationTest {
+ public:
+  using T = double;
+  static constexpr index_t block_size = 1;
+  static constexpr index_t basis_offset = 1;
+  using Basis = FEBasis<T, LagrangeH1HexBasis<T, 1, 1>,
+                        LagrangeL2HexBasis<T, 1, 1>>;
+  using SCMat = StaticCondensationMat<T, block_size, basis_offset, Basis>;
+  static constexpr index_t ndof = Basis::ndof;
+
+  CondensationTest(index_t nx, bool symmetric) {
+    index_t nverts = (nx + 1) * (nx + 1) * (nx + 1);
+    index_t nhex = nx * nx * nx;
+    std::vector<index_t> hex(8 * nhex);
+    std::vector<double> Xloc(3 * nverts);
+    MesherBrick3D mesher(nx, nx, nx, 1.0, 1.0, 1.0);
+    mesher.set_X_conn<index_t, double>(Xloc.data(), hex.data());
+
+    index_t z = 0;
+    index_t *null = nullptr;
+    conn = std::make_unique<MeshConnectivity3D>(nverts, z, null, nhex,
+                                                hex.data(), z, null, z, null);
+    mesh = std::make_unique<ElementMesh<Basis>>(*conn);
+    sc = std::make_unique<SCMat>(*mesh);
+
+    n = mesh->get_num_dof();
+    nb = mesh->get_num_cumulative_dof(basis_offset - 1);
+    K.assign(n * n, 0.0);
+
+    for (index_t elem = 0; elem < nhex; elem++) {
+      // Element matrix K = A * A^{T} + ndof * I, with a perturbation of the
+      // interior block in the non-symmetric case
+      double Ke[ndof][ndof];
+      for (index_t i = 0; i < ndof; i++) {
+        for (index_t j = 0; j < ndof; j++) {
+          double value = (i == j ? ndof : 0.0);
+          for (index_t k = 0; k < ndof; k++) {
+            value += std::cos(0.3 * elem + 1.1 * i + 0.7 * k) *
+                     std::cos(0.3 * elem + 1.1 * j + 0.7 * k);
+          }
+          if (!symmetric && i >= SCMat::bsize && j >= SCMat::bsize) {
+            value += 0.5 * std::sin(0.2 * elem + i - 2.0 * j);
+          }
+          Ke[i][j] = value;
+        }
+      }
+
+      typename SCMat::FEMat elem_mat(elem, *sc);
+      for (index_t i = 0; i < ndof; i++) {
+        for (index_t j = 0; j < ndof; j++) {
+          elem_mat(i, j) = Ke[i][j];
+        }
+      }
+      sc->add_element_values(elem, elem_mat);
+
+      index_t dof[ndof];
+      get_dof(elem, dof);
+      for (index_t i = 0; i < ndof; i++) {
+        for (index_t j = 0; j < ndof; j++) {
+          K[dof[i] * n + dof[j]] += Ke[i][j];
+        }
+      }
+    }
+  }
+
+  // Get the global dof of an element in the element order
+  void get_dof(index_t elem, index_t dof[]) {
+    for (index_t i = 0; i < Basis::template get_ndof<0>(); i++) {
+      dof[i] = mesh->template get_global_dof<0>(elem, i);
+    }
+    const index_t offset = Basis::template get_dof_offset<1>();
+    for (index_t i = 0; i < Basis::template get_ndof<1>(); i++) {
+      dof[offset + i] = mesh->template get_global_dof<1>(elem, i);
+    }
+  }
+
+  // Compute the dense Schur complement Kbb - Kbc * Kcc^{-1} * Kcb
+  std::vector<double> schur_complement() {
+    const index_t nc = n - nb;
+    std::vector<double> Kcc(nc * nc), Kcb(nc * nb);
+    for (index_t i = 0; i < nc; i++) {
+      for (index_t j = 0; j < nc; j++) {
+        Kcc[i * nc + j] = K[(nb + i) * n + nb + j];
+      }
+      for (index_t j = 0; j < nb; j++) {
+        Kcb[i * nb + j] = K[(nb + i) * n + j];
+      }
+    }
+    dense_solve(nc, nb, Kcc, Kcb);
+
+    std::vector<double> S(nb * nb);
+    for (index_t i = 0; i < nb; i++) {
+      for (index_t j = 0; j < nb; j++) {
+        double value = K[i * n + j];
+        for (index_t k = 0; k < nc; k++) {
+          value -= K[i * n + nb + k] * Kcb[k * nb + j];
+        }
+        S[i * nb + j] = value;
+      }
+    }
+    return S;
+  }
+
+  // Check the condensed matrix against the dense Schur complement
+  void check_condensed_matrix() {
+    std::vector<double> S = schur_complement();
+    auto mat = sc->get_condensed_mat();
+    ASSERT_EQ(mat->nbrows, nb);
+
+    std::vector<double> Sc(nb * nb, 0.0);
+    for (index_t i = 0; i < mat->nbrows; i++) {
+      for (index_t jp = mat->rowp[i]; jp < mat->rowp[i + 1]; jp++) {
+        Sc[i * nb + mat->cols[jp]] = mat->vals(jp, 0, 0);
+      }
+    }
+
+    double max_ref = 0.0, max_err = 0.0;
+    for (index_t k = 0; k < nb * nb; k++) {
+      max_ref = std::max(max_ref, std::fabs(S[k]));
+      max_err = std::max(max_err, std::fabs(S[k] - Sc[k]));
+    }
+    EXPECT_GT(max_ref, 0.0);
+    EXPECT_LT(max_err, 1e-12 * max_ref);
+  }
+
+  std::unique_ptr<MeshConnectivity3D> conn;
+  std::unique_ptr<ElementMesh<Basis>> mesh;
+  std::unique_ptr<SCMat> sc;
+  index_t n, nb;
+  std::vector<double> K;
+};
+
+TEST(StaticCondensationTest, SymmetricCondensedMatrix) {
+  CondensationTest test(3, true);
+  test.sc->factor();
+  EXPECT_GT(test.sc->get_num_colors(), 1);
+  test.check_condensed_matrix();
+}
+
+TEST(StaticCondensationTest, NonSymmetricCondensedMatrix) {
+  CondensationTest test(3, false);
+  test.sc->factor();
+  test.check_condensed_matrix();
+}
+
+TEST(StaticCondensationTest, Solve) {
+  // Solve with CG preconditioned by the static condensation and compare with
+  // a direct solve of the uncondensed system
+  CondensationTest test(3, true);
+  test.sc->factor();
+  const index_t n = test.n;
+
+  MultiArrayNew<double *[1]> rhs("rhs", n), x("x", n);
+  std::vector<double> ref(n);
+  for (index_t i = 0; i < n; i++) {
+    rhs(i, 0) = ref[i] = 1.0 + std::sin(0.37 * i);
+  }
+  std::vector<double> K(test.K);
+  dense_solve(n, 1, K, ref);
+
+  auto mat_vec = [&](MultiArrayNew<double *[1]> &in,
+                     MultiArrayNew<double *[1]> &out) {
+    for (index_t i = 0; i < n; i++) {
+      double value = 0.0;
+      for (index_t j = 0; j < n; j++) {
+        value += test.K[i * n + j] * in(j, 0);
+      }
+      out(i, 0) = value;
+    }
+  };
+  auto apply_factor = [&](MultiArrayNew<double *[1]> &in,
+                          MultiArrayNew<double *[1]> &out) {
+    test.sc->apply_factor(in, out);
+  };
+
+  index_t monitor = 0, max_iters = 100;
+  double rtol = 1e-12;
+  bool success = conjugate_gradient<double, 1>(mat_vec, apply_factor, rhs, x,
+                                               monitor, max_iters, rtol);
+  EXPECT_TRUE(success);
+
+  double max_ref = 0.0, max_err = 0.0;
+  for (index_t i = 0; i < n; i++) {
+    max_ref = std::max(max_ref, std::fabs(ref[i]));
+    max_err = std::max(max_err, std::fabs(x(i, 0) - ref[i]));
+  }
+  EXPECT_LT(max_err, 1e-9 * max_ref);
+}
@@ -0,0 +1,277 @@
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "a2dcore.h"
+#include "block_numeric.h"
+#include "sparse/sparse_matrix.h"
+#include "sparse/sparse_numeric.h"
+#include "test_commons.h"
+
+using namespace A2D;
+
+class Environment : public ::testing::Environment {
+ public:
+  void SetUp() override { Kokkos::initialize(); }
+  void TearDown() override { Kokkos::finalize(); }
+};
+
+// Create a new environment and initialize kokkos
+::testing::Environment *const initialize_kokkos =
+    ::testing::AddGlobalTestEnvironment(new Environment);
+
+// Reproducible values in [-1, 1]
+double next_value(unsigned int &seed) {
+  seed = 1103515245u * seed + 12345u;
+  return -1.0 + 2.0 * ((seed >> 8) % 10000) / 9999.0;
+}
+
+/*
+  Random block with small diagonal entries and a dominant entry at (i, i + 1)
+  (cyclically), so partial pivoting must swap rows to factor it
+*/
+template <int M>
+void pivoting_block(Mat<double, M, M> &A, unsigned int seed) {
+  for (int i = 0; i < M; i++) {
+    for (int j = 0; j < M; j++) {
+      A(i, j) = next_value(seed);
+    }
+    A(i, i) *= 1e-3;
+    A(i, (i + 1) % M) += (M > 1 ? 2.0 * M : 2.0);
+  }
+}
+
+// Block with a zero last column, the last pivot is exactly zero
+template <int M>
+void singular_block(Mat<double, M, M> &A, unsigned int seed) {
+  pivoting_block<M>(A, seed);
+  for (int i = 0; i < M; i++) {
+    A(i, M - 1) = 0.0;
+  }
+}
+
+// Block whose last row is a combination of the others, the last pivot is zero
+// only up to round-off
+template <int M>
+void rank_deficient_block(Mat<double, M, M> &A, unsigned int seed) {
+  pivoting_block<M>(A, seed);
+  for (int j = 0; j < M; j++) {
+    double value = 0.0;
+    for (int i = 0; i < M - 1; i++) {
+      value += (0.3 + 0.2 * i) * A(i, j);
+    }
+    A(M - 1, j) = value;
+  }
+}
+
+template <int M>
+double max_abs(const Mat<double, M, M> &A) {
+  double value = 0.0;
+  for (int i = 0; i < M; i++) {
+    for (int j = 0; j < M; j++) {
+      value = std::max(value, std::fabs(A(i, j)));
+    }
+  }
+  return value;
+}
+
+template <int M>
+void check_factor_and_solve() {
+  constexpr int P = 3;
+  Mat<double, M, M> A, LU;
+  Vec<index_t, M> ipiv;
+  pivoting_block<M>(A, 17 * M);
+  LU.copy(A);
+
+  ASSERT_EQ((blockLUFactor<double, M>(LU, ipiv)), 0);
+  if (M > 1) {
+    // The dominant entry of the first column is in the last row
+    EXPECT_EQ(ipiv(0), M - 1);
+  }
+
+  // Solve for a single right-hand side
+  Vec<double, M> x0, x;
+  unsigned int seed = 3 * M;
+  for (int i = 0; i < M; i++) {
+    x0(i) = next_value(seed);
+  }
+  for (int i = 0; i < M; i++) {
+    x(i) = 0.0;
+    for (int j = 0; j < M; j++) {
+      x(i) += A(i, j) * x0(j);
+    }
+  }
+  blockLUSolve<double, M>(LU, ipiv, x);
+  for (int i = 0; i < M; i++) {
+    EXPECT_NEAR(x(i), x0(i), 1e-13);
+  }
+
+  // Solve for P right-hand sides
+  Mat<double, M, P> X0, X;
+  for (int i = 0; i < M; i++) {
+    for (int k = 0; k < P; k++) {
+      X0(i, k) = next_value(seed);
+    }
+  }
+  for (int i = 0; i < M; i++) {
+    for (int k = 0; k < P; k++) {
+      X(i, k) = 0.0;
+      for (int j = 0; j < M; j++) {
+        X(i, k) += A(i, j) * X0(j, k);
+      }
+    }
+  }
+  blockLUSolveMat<double, M, P>(LU, ipiv, X);
+  for (int i = 0; i < M; i++) {
+    for (int k = 0; k < P; k++) {
+      EXPECT_NEAR(X(i, k), X0(i, k), 1e-13);
+    }
+  }
+
+  // The inverse
+  Mat<double, M, M> Ainv;
+  LU.copy(A);
+  ASSERT_EQ((blockInverse<double, M>(LU, Ainv, ipiv)), 0);
+  for (int i = 0; i < M; i++) {
+    for (int j = 0; j < M; j++) {
+      double value = 0.0;
+      for (int k = 0; k < M; k++) {
+        value += A(i, k) * Ainv(k, j);
+      }
+      EXPECT_NEAR(value, (i == j ? 1.0 : 0.0), 1e-13);
+    }
+  }
+}
+
+template <int M>
+void check_singular() {
+  Mat<double, M, M> A, Ainv;
+  Vec<index_t, M> ipiv;
+
+  // An exactly zero pivot fails with the default tolerance
+  singular_block<M>(A, 5 * M);
+  EXPECT_EQ((blockLUFactor<double, M>(A, ipiv)), M);
+  singular_block<M>(A, 5 * M);
+  EXPECT_EQ((blockInverse<double, M>(A, Ainv, ipiv)), M);
+
+  // A small pivot fails only when it is below the relative tolerance
+  if (M > 1) {
+    rank_deficient_block<M>(A, 7 * M);
+    A(M - 1, M - 1) += 1e-9 * max_abs<M>(A);
+    Mat<double, M, M> LU;
+    LU.copy(A);
+    EXPECT_EQ((blockLUFactor<double, M>(LU, ipiv, 1e-12)), 0);
+    LU.copy(A);
+    EXPECT_EQ((blockLUFactor<double, M>(LU, ipiv, 1e-6)), M);
+  }
+}
+
+template <int M>
+void check_block_sizes() {
+  check_factor_and_solve<M>();
+  check_singular<M>();
+}
+
+TEST(BlockLU, FactorAndSolve) {
+  check_block_sizes<1>();
+  check_block_sizes<2>();
+  check_block_sizes<3>();
+  check_block_sizes<4>();
+  check_block_sizes<5>();
+  check_block_sizes<6>();
+  check_block_sizes<7>();
+  check_block_sizes<8>();
+}
+
+/*
+  Extract and invert the diagonal of a block-tridiagonal matrix. Block rows
+  1 and 3 are singular and use the pseudo-inverse fallback, the others must
+  be exact inverses.
+*/
+template <index_t M>
+void check_extract_block_diagonal() {
+  const index_t nrows = 5;
+  std::vector<index_t> rowp(1, 0), cols;
+  for (index_t i = 0; i < nrows; i++) {
+    for (index_t j = (i > 0 ? i - 1 : 0); j < nrows && j <= i + 1; j++) {
+      cols.push_back(j);
+    }
+    rowp.push_back(cols.size());
+  }
+  BSRMat<double, M, M> A(nrows, nrows, cols.size(), rowp, cols);
+
+  std::vector<Mat<double, M, M>> blocks(nrows);
+  for (index_t i = 0; i < nrows; i++) {
+    if (i == 1) {
+      rank_deficient_block<M>(blocks[i], 11 * i + M);
+    } else if (i == 3) {
+      singular_block<M>(blocks[i], 11 * i + M);
+    } else {
+      pivoting_block<M>(blocks[i], 11 * i + M);
+    }
+
+    unsigned int seed = 23 * i + M;
+    for (index_t jp = A.rowp[i]; jp < A.rowp[i + 1]; jp++) {
+      for (index_t k1 = 0; k1 < M; k1++) {
+        for (index_t k2 = 0; k2 < M; k2++) {
+          A.vals(jp, k1, k2) = (A.cols[jp] == i ? blocks[i](k1, k2)
+                                                : next_value(seed));
+        }
+      }
+    }
+  }
+
+  // Block row 1 passes the exact zero-pivot check, so only the relative
+  // pivot tolerance sends it to the pseudo-inverse
+  Mat<double, M, M> LU;
+  Vec<index_t, M> ipiv;
+  LU.copy(blocks[1]);
+  EXPECT_EQ((blockLUFactor<double, M>(LU, ipiv)), 0);
+  LU.copy(blocks[1]);
+  const double pivot_tol = M * std::numeric_limits<double>::epsilon();
+  EXPECT_NE((blockLUFactor<double, M>(LU, ipiv, pivot_tol)), 0);
+
+  std::unique_ptr<BSRMat<double, M, M>> D(
+      BSRMatExtractBlockDiagonal(A, true));
+  ASSERT_EQ(D->nnz, nrows);
+
+  for (index_t i = 0; i < nrows; i++) {
+    const Mat<double, M, M> &Ai = blocks[i];
+    Mat<double, M, M> Di, AD, ADA, DAD;
+    for (index_t k1 = 0; k1 < M; k1++) {
+      for (index_t k2 = 0; k2 < M; k2++) {
+        Di(k1, k2) = D->vals(D->rowp[i], k1, k2);
+      }
+    }
+    MatMatMult(Ai, Di, AD);
+    MatMatMult(AD, Ai, ADA);
+    MatMatMult(Di, AD, DAD);
+
+    if (i == 1 || i == 3) {
+      // The pseudo-inverse satisfies A * D * A = A and D * A * D = D and
+      // stays bounded
+      const double scale = max_abs<M>(Ai) * max_abs<M>(Di);
+      EXPECT_LT(scale, 1e6);
+      for (index_t k1 = 0; k1 < M; k1++) {
+        for (index_t k2 = 0; k2 < M; k2++) {
+          EXPECT_NEAR(ADA(k1, k2), Ai(k1, k2), 1e-10 * max_abs<M>(Ai));
+          EXPECT_NEAR(DAD(k1, k2), Di(k1, k2), 1e-10 * max_abs<M>(Di));
+        }
+      }
+    } else {
+      for (index_t k1 = 0; k1 < M; k1++) {
+        for (index_t k2 = 0; k2 < M; k2++) {
+          EXPECT_NEAR(AD(k1, k2), (k1 == k2 ? 1.0 : 0.0), 1e-13);
+        }
+      }
+    }
+  }
+}
+
+TEST(BlockLU, ExtractBlockDiagonal) {
+  check_extract_block_diagonal<3>();
+  check_extract_block_diagonal<4>();
+  check_extract_block_diagonal<6>();
+  check_extract_block_diagonal<8>();
+}
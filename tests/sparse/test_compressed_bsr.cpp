@@ -0,0 +1,228 @@
+#include <memory>
+#include <vector>
+
+#include "a2dcore.h"
+#include "sparse/sparse_amg.h"
+#include "sparse/sparse_matrix.h"
+#include "sparse/sparse_numeric.h"
+#include "sparse/sparse_symbolic.h"
+#include "test_commons.h"
+
+using namespace A2D;
+
+class Environment : public ::testing::Environment {
+ public:
+  void SetUp() override { Kokkos::initialize(); }
+  void TearDown() override { Kokkos::finalize(); }
+};
+
+// Create a new environment and initialize kokkos
+::testing::Environment *const initialize_kokkos =
+    ::testing::AddGlobalTestEnvironment(new Environment);
+
+// Reproducible values in [-1, 1]
+double next_value(unsigned int &seed) {
+  seed = 1103515245u * seed + 12345u;
+  return -1.0 + 2.0 * ((seed >> 8) % 10000) / 9999.0;
+}
+
+template <index_t M>
+void fill_values(MultiArrayNew<double *[M]> &x, unsigned int seed) {
+  for (index_t i = 0; i < x.extent(0); i++) {
+    for (index_t k = 0; k < M; k++) {
+      x(i, k) = next_value(seed);
+    }
+  }
+}
+
+template <index_t M>
+void expect_near(MultiArrayNew<double *[M]> &x, MultiArrayNew<double *[M]> &y,
+                 double tol) {
+  ASSERT_EQ(x.extent(0), y.extent(0));
+  for (index_t i = 0; i < x.extent(0); i++) {
+    for (index_t k = 0; k < M; k++) {
+      EXPECT_NEAR(x(i, k), y(i, k), tol);
+    }
+  }
+}
+
+/*
+  Create the BSR matrix of the 27-point stencil on an n x n x n grid. The
+  off-diagonal blocks are random. The diagonal blocks are random plus
+  diag * I.
+*/
+template <index_t M>
+std::shared_ptr<BSRMat<double, M, M>> create_grid_matrix(index_t n,
+                                                         double diag) {
+  auto node = [n](index_t i, index_t j, index_t k) {
+    return i + n * (j + n * k);
+  };
+
+  std::vector<index_t> rowp(1, 0), cols;
+  for (index_t k = 0; k < n; k++) {
+    for (index_t j = 0; j < n; j++) {
+      for (index_t i = 0; i < n; i++) {
+        for (index_t kk = (k > 0 ? k - 1 : 0); kk < n && kk <= k + 1; kk++) {
+          for (index_t jj = (j > 0 ? j - 1 : 0); jj < n && jj <= j + 1; jj++) {
+            for (index_t ii = (i > 0 ? i - 1 : 0); ii < n && ii <= i + 1;
+                 ii++) {
+              cols.push_back(node(ii, jj, kk));
+            }
+          }
+        }
+        rowp.push_back(cols.size());
+      }
+    }
+  }
+
+  const index_t nrows = n * n * n;
+  auto A = std::make_shared<BSRMat<double, M, M>>(nrows, nrows, cols.size(),
+                                                  rowp, cols);
+  unsigned int seed = 1234;
+  for (index_t i = 0; i < nrows; i++) {
+    for (index_t jp = A->rowp[i]; jp < A->rowp[i + 1]; jp++) {
+      for (index_t k1 = 0; k1 < M; k1++) {
+        for (index_t k2 = 0; k2 < M; k2++) {
+          A->vals(jp, k1, k2) = next_value(seed);
+        }
+        if (A->cols[jp] == i) {
+          A->vals(jp, k1, k1) += diag;
+        }
+      }
+    }
+  }
+  return A;
+}
+
+template <index_t M>
+void check_mat_vec(BSRMat<double, M, M> &A, bool short_offsets) {
+  std::unique_ptr<CompressedBSRMat<double, M, M>> C(BSRMatCompressIndex(A));
+  EXPECT_EQ(C->offsets16.is_allocated(), short_offsets);
+  EXPECT_EQ(C->offsets32.is_allocated(), !short_offsets);
+
+  MultiArrayNew<double *[M]> x("x", A.nbcols), y("y", A.nbrows),
+      z("z", A.nbrows);
+  fill_values(x, 1);
+
+  BSRMatVecMult<double, M, M>(A, x, y);
+  CompressedBSRMatVecMult(*C, x, z);
+  expect_near(y, z, 1e-12);
+
+  BSRMatVecMultAdd<double, M, M>(A, x, y);
+  CompressedBSRMatVecMultAdd(*C, x, z);
+  expect_near(y, z, 1e-12);
+
+  fill_values(y, 2);
+  BLAS::copy(z, y);
+  BSRMatVecMultSub<double, M, M>(A, x, y);
+  CompressedBSRMatVecMultSub(*C, x, z);
+  expect_near(y, z, 1e-12);
+}
+
+template <index_t M>
+void check_ssor(index_t n) {
+  auto A = create_grid_matrix<M>(n, 60.0);
+  std::unique_ptr<BSRMat<double, M, M>> Dinv(
+      BSRMatExtractBlockDiagonal(*A, true));
+
+  MultiArrayNew<double *[M]> b("b", A->nbrows), x1("x1", A->nbrows),
+      x2("x2", A->nbrows);
+  fill_values(b, 3);
+
+  // Natural ordering
+  std::unique_ptr<CompressedBSRMat<double, M, M>> C(BSRMatCompressIndex(*A));
+  BSRApplySSOR(*Dinv, *A, 1.0, b, x1);
+  CompressedBSRApplySSOR(*Dinv, *C, 1.0, b, x2);
+  expect_near(x1, x2, 1e-12);
+
+  // Multicolor ordering, shared with the compressed matrix
+  BSRMatMultiColorOrder(*A);
+  C.reset(BSRMatCompressIndex(*A));
+  EXPECT_EQ(C->num_colors, A->num_colors);
+  BLAS::zero(x1);
+  BLAS::zero(x2);
+  BSRApplySSOR(*Dinv, *A, 1.0, b, x1);
+  CompressedBSRApplySSOR(*Dinv, *C, 1.0, b, x2);
+  expect_near(x1, x2, 1e-12);
+}
+
+TEST(CompressedBSRMatTest, MatVecBlock1) {
+  auto A = create_grid_matrix<1>(8, 0.0);
+  check_mat_vec(*A, true);
+}
+
+TEST(CompressedBSRMatTest, MatVecBlock3) {
+  auto A = create_grid_matrix<3>(8, 0.0);
+  check_mat_vec(*A, true);
+}
+
+TEST(CompressedBSRMatTest, MatVecLongOffsets) {
+  // A row that spans more than 2^16 columns needs the 32-bit offsets
+  const index_t nrows = 70000;
+  std::vector<index_t> rowp(nrows + 1), cols;
+  rowp[0] = 0;
+  for (index_t i = 0; i < nrows; i++) {
+    cols.push_back(i);
+    if (i == 5) {
+      cols.push_back(nrows - 1);
+    }
+    rowp[i + 1] = cols.size();
+  }
+
+  BSRMat<double, 1, 1> A(nrows, nrows, cols.size(), rowp, cols);
+  for (index_t jp = 0; jp < A.nnz; jp++) {
+    A.vals(jp, 0, 0) = 1.0 + jp % 7;
+  }
+  check_mat_vec(A, false);
+}
+
+TEST(CompressedBSRMatTest, SSORBlock1) { check_ssor<1>(8); }
+
+TEST(CompressedBSRMatTest, SSORBlock3) { check_ssor<3>(8); }
+
+TEST(CompressedBSRMatTest, AmgCompressIndex) {
+  // Block Laplacian of the grid graph shifted by the identity, which is
+  // symmetric positive definite, with the constant modes as the null-space
+  constexpr index_t M = 3, N = 3;
+  const index_t n = 10;
+  auto A = create_grid_matrix<M>(n, 0.0);
+  for (index_t i = 0; i < A->nbrows; i++) {
+    const index_t degree = A->rowp[i + 1] - A->rowp[i] - 1;
+    for (index_t jp = A->rowp[i]; jp < A->rowp[i + 1]; jp++) {
+      double value = (A->cols[jp] == i ? degree + 1.0 : -1.0);
+      for (index_t k1 = 0; k1 < M; k1++) {
+        for (index_t k2 = 0; k2 < M; k2++) {
+          A->vals(jp, k1, k2) = (k1 == k2 ? value : 0.0);
+        }
+      }
+    }
+  }
+
+  MultiArrayNew<double *[M][N]> B("B", A->nbrows);
+  for (index_t i = 0; i < A->nbrows; i++) {
+    for (index_t k = 0; k < M; k++) {
+      B(i, k, k) = 1.0;
+    }
+  }
+
+  BSRMatAmg<double, M, N> amg(3, 0.5, 0.0, A, B);
+  ASSERT_GT(amg.get_num_levels(), 1);
+
+  MultiArrayNew<double *[M]> b("b", A->nbrows), x1("x1", A->nbrows),
+      x2("x2", A->nbrows);
+  fill_values(b, 4);
+  amg.applyFactor(b, x1);
+
+  amg.compressIndex();
+  amg.applyFactor(b, x2);
+  expect_near(x1, x2, 1e-12);
+
+  // The compressed matrices share the values, so they see the update
+  amg.update();
+  amg.applyFactor(b, x2);
+  expect_near(x1, x2, 1e-12);
+
+  amg.compressIndex(false);
+  amg.applyFactor(b, x2);
+  expect_near(x1, x2, 1e-12);
+}
@@ -0,0 +1,180 @@
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "a2dcore.h"
+#include "sparse/sparse_eigen.h"
+#include "sparse/sparse_matrix.h"
+#include "sparse/sparse_numeric.h"
+#include "test_commons.h"
+
+using namespace A2D;
+
+class Environment : public ::testing::Environment {
+ public:
+  void SetUp() override { Kokkos::initialize(); }
+  void TearDown() override { Kokkos::finalize(); }
+};
+
+// Create a new environment and initialize kokkos
+::testing::Environment *const initialize_kokkos =
+    ::testing::AddGlobalTestEnvironment(new Environment);
+
+/*
+  The block-tridiagonal operator tridiag(-S, 2 * S, -S) = T_n (x) S with the
+  2 x 2 block S = [[2, 1], [1, 2]]. The eigenvalues of T_n are
+  2 - 2 cos(k pi / (n + 1)) for k = 1, ..., n and those of S are 1 and 3, so
+  the eigenvalues of the operator are their products.
+*/
+class LOBPCGTest : public ::testing::Test {
+ protected:
+  static constexpr index_t M = 2;
+  static constexpr index_t K = 4;
+  static constexpr index_t n = 40;
+  using BSRMat_t = BSRMat<double, M, M>;
+  using Vec_t = MultiArrayNew<double *[M]>;
+  using LOBPCG_t = LOBPCG<double, M, K>;
+
+  void SetUp() override {
+    const double S[M][M] = {{2.0, 1.0}, {1.0, 2.0}};
+
+    std::vector<index_t> rowp(n + 1), cols;
+    rowp[0] = 0;
+    for (index_t i = 0; i < n; i++) {
+      for (index_t j = (i > 0 ? i - 1 : 0); j <= std::min(i + 1, n - 1); j++) {
+        cols.push_back(j);
+      }
+      rowp[i + 1] = cols.size();
+    }
+
+    A = std::make_shared<BSRMat_t>(n, n, cols.size(), rowp, cols);
+    for (index_t i = 0; i < n; i++) {
+      for (index_t jp = A->rowp[i]; jp < A->rowp[i + 1]; jp++) {
+        double scale = (A->cols[jp] == i ? 2.0 : -1.0);
+        for (index_t k1 = 0; k1 < M; k1++) {
+          for (index_t k2 = 0; k2 < M; k2++) {
+            A->vals(jp, k1, k2) = scale * S[k1][k2];
+          }
+        }
+      }
+    }
+
+    Dinv = std::shared_ptr<BSRMat_t>(BSRMatExtractBlockDiagonal(*A, true));
+  }
+
+  // The K smallest eigenvalues of T_m (x) S divided by mass
+  static std::vector<double> exact_eigenvalues(index_t m, double mass) {
+    std::vector<double> eigs;
+    for (index_t k = 1; k <= m; k++) {
+      double t = 2.0 - 2.0 * std::cos(k * M_PI / (m + 1));
+      eigs.push_back(t / mass);
+      eigs.push_back(3.0 * t / mass);
+    }
+    std::sort(eigs.begin(), eigs.end());
+    eigs.resize(K);
+    return eigs;
+  }
+
+  // Check the eigenvalues, the residuals on the block rows r0, ..., n - 1 and
+  // the M-orthonormality
+  void check(LOBPCG_t &eig, double mass, const std::vector<double> &exact,
+             index_t r0 = 0) {
+    Vec_t x("x", n), Kx("Kx", n), y("y", n);
+    for (index_t i = 0; i < K; i++) {
+      EXPECT_NEAR(eig.get_eigenvalue(i), exact[i], 1e-8 * exact[i]);
+
+      eig.get_eigenvector(i, x);
+      BSRMatVecMult<double, M, M>(*A, x, Kx);
+      double rnorm = 0.0, knorm = 0.0;
+      for (index_t r = r0; r < n; r++) {
+        for (index_t c = 0; c < M; c++) {
+          double res = Kx(r, c) - eig.get_eigenvalue(i) * mass * x(r, c);
+          rnorm += res * res;
+          knorm += Kx(r, c) * Kx(r, c);
+        }
+      }
+      EXPECT_LT(std::sqrt(rnorm / knorm), 1e-6);
+
+      for (index_t j = 0; j < K; j++) {
+        eig.get_eigenvector(j, y);
+        double dot = 0.0;
+        for (index_t r = 0; r < n; r++) {
+          for (index_t c = 0; c < M; c++) {
+            dot += mass * x(r, c) * y(r, c);
+          }
+        }
+        EXPECT_NEAR(dot, (i == j ? 1.0 : 0.0), 1e-8);
+      }
+    }
+  }
+
+  std::shared_ptr<BSRMat_t> A, Dinv;
+};
+
+TEST_F(LOBPCGTest, Standard) {
+  auto kmat = [&](Vec_t &x, Vec_t &y) {
+    BSRMatVecMult<double, M, M>(*A, x, y);
+  };
+  auto prec = [&](Vec_t &x, Vec_t &y) {
+    BSRMatVecMult<double, M, M>(*Dinv, x, y);
+  };
+
+  LOBPCG_t eig(n, kmat, nullptr, prec);
+  EXPECT_TRUE(eig.solve(1000, 1e-10));
+  check(eig, 1.0, exact_eigenvalues(n, 1.0));
+}
+
+TEST_F(LOBPCGTest, GeneralizedWithBCs) {
+  // M = mass * I and the dofs of the first block row are constrained, which
+  // leaves T_{n - 1} (x) S on the free dofs
+  const double mass = 2.0;
+  auto kmat = [&](Vec_t &x, Vec_t &y) {
+    BSRMatVecMult<double, M, M>(*A, x, y);
+  };
+  auto mmat = [&](Vec_t &x, Vec_t &y) {
+    for (index_t r = 0; r < n; r++) {
+      for (index_t c = 0; c < M; c++) {
+        y(r, c) = mass * x(r, c);
+      }
+    }
+  };
+  const index_t bc_dofs[] = {0, 1};
+
+  LOBPCG_t eig(n, kmat, mmat, nullptr, 2, bc_dofs);
+  EXPECT_TRUE(eig.solve(1000, 1e-10));
+
+  Vec_t x("x", n);
+  for (index_t i = 0; i < K; i++) {
+    eig.get_eigenvector(i, x);
+    EXPECT_EQ(x(0, 0), 0.0);
+    EXPECT_EQ(x(0, 1), 0.0);
+  }
+  check(eig, mass, exact_eigenvalues(n - 1, mass), 1);
+}
+
+TEST_F(LOBPCGTest, Buckling) {
+  // (K_s + lambda * K_G) * u = 0 with K_s = A and K_G = -c * I, so that the
+  // critical load factors are the eigenvalues of A divided by c. Following
+  // the LOBPCG documentation, K_G is passed as K and K_s as M.
+  const double c = 0.5;
+  auto kmat = [&](Vec_t &x, Vec_t &y) {
+    for (index_t r = 0; r < n; r++) {
+      for (index_t k = 0; k < M; k++) {
+        y(r, k) = -c * x(r, k);
+      }
+    }
+  };
+  auto mmat = [&](Vec_t &x, Vec_t &y) {
+    BSRMatVecMult<double, M, M>(*A, x, y);
+  };
+
+  LOBPCG_t eig(n, kmat, mmat);
+  EXPECT_TRUE(eig.solve(1000, 1e-10));
+
+  std::vector<double> exact = exact_eigenvalues(n, c);
+  for (index_t i = 0; i < K; i++) {
+    double mu = eig.get_eigenvalue(i);
+    EXPECT_LT(mu, 0.0);
+    EXPECT_NEAR(-1.0 / mu, exact[i], 1e-8 * exact[i]);
+  }
+}
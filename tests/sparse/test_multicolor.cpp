@@ -0,0 +1,93 @@
+#include <memory>
+#include <vector>
+
+#include "a2dcore.h"
+#include "sparse/sparse_matrix.h"
+#include "sparse/sparse_symbolic.h"
+#include "test_commons.h"
+
+using namespace A2D;
+
+class Environment : public ::testing::Environment {
+ public:
+  void SetUp() override { Kokkos::initialize(); }
+  void TearDown() override { Kokkos::finalize(); }
+};
+
+// Create a new environment and initialize kokkos
+::testing::Environment *const initialize_kokkos =
+    ::testing::AddGlobalTestEnvironment(new Environment);
+
+// The pattern of the 9-point stencil on an n x n grid
+std::shared_ptr<BSRMat<double, 2, 2>> create_matrix(index_t n) {
+  std::vector<index_t> rowp(1, 0), cols;
+  for (index_t i = 0; i < n; i++) {
+    for (index_t j = 0; j < n; j++) {
+      for (index_t ii = (i > 0 ? i - 1 : 0); ii <= i + 1 && ii < n; ii++) {
+        for (index_t jj = (j > 0 ? j - 1 : 0); jj <= j + 1 && jj < n; jj++) {
+          cols.push_back(ii * n + jj);
+        }
+      }
+      rowp.push_back(cols.size());
+    }
+  }
+  return std::make_shared<BSRMat<double, 2, 2>>(n * n, n * n, cols.size(),
+                                                rowp, cols);
+}
+
+/*
+  Check that the rows listed in perm are sorted by color, with color_count
+  rows of each color, and that no two rows of the same color are coupled
+*/
+void check_coloring(BSRMat<double, 2, 2> &A) {
+  ASSERT_GT(A.num_colors, 0);
+  ASSERT_EQ(A.color_count.extent(0), A.num_colors);
+
+  index_t total = 0;
+  for (index_t c = 0; c < A.num_colors; c++) {
+    EXPECT_GT(A.color_count[c], 0);
+    total += A.color_count[c];
+  }
+  ASSERT_EQ(total, A.nbrows);
+
+  std::vector<index_t> colors(A.nbrows, MAX_INDEX);
+  for (index_t c = 0, k = 0; c < A.num_colors; c++) {
+    for (index_t end = k + A.color_count[c]; k < end; k++) {
+      ASSERT_LT(A.perm[k], A.nbrows);
+      ASSERT_EQ(colors[A.perm[k]], MAX_INDEX);
+      colors[A.perm[k]] = c;
+    }
+  }
+
+  for (index_t i = 0; i < A.nbrows; i++) {
+    for (index_t jp = A.rowp[i]; jp < A.rowp[i + 1]; jp++) {
+      index_t j = A.cols[jp];
+      if (j != i) {
+        EXPECT_NE(colors[i], colors[j]);
+      }
+    }
+  }
+}
+
+TEST(MultiColorTest, Serial) {
+  auto A = create_matrix(12);
+  BSRMatMultiColorOrder(*A);
+  check_coloring(*A);
+
+  // The 9-point stencil has a 4-coloring, found by the greedy algorithm in
+  // the natural order
+  EXPECT_EQ(A->num_colors, 4);
+
+  // The serial coloring is deterministic
+  auto B = create_matrix(12);
+  BSRMatMultiColorOrder(*B);
+  ASSERT_EQ(A->num_colors, B->num_colors);
+  EXPECT_VEC_EQ(A->nbrows, A->perm, B->perm);
+}
+
+TEST(MultiColorTest, Parallel) {
+  auto A = create_matrix(12);
+  bool parallel = true;
+  BSRMatMultiColorOrder(*A, parallel);
+  check_coloring(*A);
+}
@@ -0,0 +1,171 @@
+#include <memory>
+#include <set>
+#include <vector>
+
+#include "a2dcore.h"
+#include "sparse/sparse_matrix.h"
+#include "sparse/sparse_numeric.h"
+#include "sparse/sparse_symbolic.h"
+#include "test_commons.h"
+
+using namespace A2D;
+
+class Environment : public ::testing::Environment {
+ public:
+  void SetUp() override { Kokkos::initialize(); }
+  void TearDown() override { Kokkos::finalize(); }
+};
+
+// Create a new environment and initialize kokkos
+::testing::Environment *const initialize_kokkos =
+    ::testing::AddGlobalTestEnvironment(new Environment);
+
+class SymBSRMatTest : public ::testing::Test {
+ protected:
+  static constexpr index_t M = 3;
+  static constexpr index_t nbrows = 60;
+  using BSRMat_t = BSRMat<double, M, M>;
+  using SymBSRMat_t = SymBSRMat<double, M>;
+  using Vec_t = MultiArrayNew<double *[M]>;
+
+  // Reproducible values in [-1, 1]
+  double next_value() { return -1.0 + 2.0 * next_index(10000) / 9999.0; }
+
+  // Reproducible indices in [0, n)
+  index_t next_index(index_t n) {
+    seed = 1103515245u * seed + 12345u;
+    return (seed >> 8) % n;
+  }
+
+  /*
+    Create a full BSR matrix with a symmetric random pattern and symmetric
+    values. The diagonal block of every row with i % skip_diag == 1 is left
+    out when skip_diag > 0.
+  */
+  std::shared_ptr<BSRMat_t> create_matrix(index_t skip_diag) {
+    std::vector<std::set<index_t>> pattern(nbrows);
+    for (index_t i = 0; i < nbrows; i++) {
+      if (!(skip_diag > 0 && i % skip_diag == 1)) {
+        pattern[i].insert(i);
+      }
+      for (index_t k = 0; k < 3; k++) {
+        index_t j = (i + 1 + next_index(17)) % nbrows;
+        if (j != i) {
+          pattern[i].insert(j);
+          pattern[j].insert(i);
+        }
+      }
+    }
+
+    std::vector<index_t> rowp(nbrows + 1), cols;
+    rowp[0] = 0;
+    for (index_t i = 0; i < nbrows; i++) {
+      cols.insert(cols.end(), pattern[i].begin(), pattern[i].end());
+      rowp[i + 1] = cols.size();
+    }
+
+    auto A = std::make_shared<BSRMat_t>(nbrows, nbrows, cols.size(), rowp,
+                                        cols);
+    for (index_t i = 0; i < nbrows; i++) {
+      for (index_t jp = A->rowp[i]; jp < A->rowp[i + 1]; jp++) {
+        index_t j = A->cols[jp];
+        if (j < i) {
+          continue;
+        }
+        index_t kp = A->find_value_index(j, i);
+        for (index_t k1 = 0; k1 < M; k1++) {
+          for (index_t k2 = 0; k2 < M; k2++) {
+            double value = next_value();
+            if (j == i && k2 < k1) {
+              value = A->vals(jp, k2, k1);
+            }
+            A->vals(jp, k1, k2) = value;
+            A->vals(kp, k2, k1) = value;
+          }
+        }
+      }
+    }
+    return A;
+  }
+
+  // Compare the products with the full and the symmetric matrix
+  void check_product(BSRMat_t &A, SymBSRMat_t &S) {
+    Vec_t x("x", nbrows), y("y", nbrows), z("z", nbrows);
+    for (index_t i = 0; i < nbrows; i++) {
+      for (index_t k = 0; k < M; k++) {
+        x(i, k) = next_value();
+      }
+    }
+
+    BSRMatVecMult<double, M, M>(A, x, y);
+    SymBSRMatVecMult(S, x, z);
+    for (index_t i = 0; i < nbrows; i++) {
+      for (index_t k = 0; k < M; k++) {
+        EXPECT_NEAR(z(i, k), y(i, k), 1e-13);
+      }
+    }
+  }
+
+  // Check that the rows of each color write to disjoint entries of y, i.e.
+  // row i writes y[i] and y[j] for all the stored columns j
+  void check_colors(SymBSRMat_t &S) {
+    ASSERT_TRUE(S.perm.is_allocated());
+    index_t total = 0;
+    for (index_t color = 0, offset = 0; color < S.num_colors; color++) {
+      std::set<index_t> written;
+      for (index_t k = 0; k < S.color_count[color]; k++) {
+        index_t i = S.perm[offset + k];
+        std::set<index_t> entries = {i};
+        for (index_t jp = S.rowp[i]; jp < S.rowp[i + 1]; jp++) {
+          entries.insert(S.cols[jp]);
+        }
+        for (index_t j : entries) {
+          EXPECT_TRUE(written.insert(j).second)
+              << "entry " << j << " is written twice by color " << color;
+        }
+      }
+      offset += S.color_count[color];
+      total += S.color_count[color];
+    }
+    EXPECT_EQ(total, nbrows);
+  }
+
+  unsigned int seed = 1;
+};
+
+TEST_F(SymBSRMatTest, Pattern) {
+  auto A = create_matrix(0);
+  std::unique_ptr<SymBSRMat_t> S(SymBSRMatFromBSRMat(*A));
+  EXPECT_EQ(S->num_diag, nbrows);
+  EXPECT_EQ(2 * S->nnz - S->num_diag, A->nnz);
+  for (index_t i = 0; i < nbrows; i++) {
+    for (index_t jp = S->rowp[i]; jp < S->rowp[i + 1]; jp++) {
+      EXPECT_GE(S->cols[jp], i);
+    }
+  }
+}
+
+TEST_F(SymBSRMatTest, VecMult) {
+  auto A = create_matrix(0);
+  std::unique_ptr<SymBSRMat_t> S(SymBSRMatFromBSRMat(*A));
+  check_product(*A, *S);
+}
+
+TEST_F(SymBSRMatTest, VecMultColored) {
+  auto A = create_matrix(0);
+  std::unique_ptr<SymBSRMat_t> S(SymBSRMatFromBSRMat(*A));
+  SymBSRMatMultiColorOrder(*S);
+  check_colors(*S);
+  check_product(*A, *S);
+}
+
+TEST_F(SymBSRMatTest, VecMultMissingDiagonal) {
+  auto A = create_matrix(4);
+  std::unique_ptr<SymBSRMat_t> S(SymBSRMatFromBSRMat(*A));
+  EXPECT_EQ(S->num_diag, nbrows - nbrows / 4);
+  check_product(*A, *S);
+
+  SymBSRMatMultiColorOrder(*S);
+  check_colors(*S);
+  check_product(*A, *S);
+}
@@ -0,0 +1,412 @@
+#include <cmath>
+#include <complex>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "a2ddefs.h"
+#include "array.h"
+#include "multiphysics/febasis.h"
+#include "multiphysics/femesh.h"
+#include "multiphysics/lagrange_hypercube_basis.h"
+#include "sparse/sparse_amg.h"
+#include "test_commons.h"
+#include "utils/a2dcheckpoint.h"
+#include "utils/a2dmesh.h"
+
+using namespace A2D;
+
+class Environment : public ::testing::Environment {
+ public:
+  void SetUp() override { Kokkos::initialize(); }
+  void TearDown() override { Kokkos::finalize(); }
+};
+
+// Create a new environment and initialize kokkos
+::testing::Environment *const initialize_kokkos =
+    ::testing::AddGlobalTestEnvironment(new Environment);
+
+class CheckpointTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    filename = "test_checkpoint.a2d";
+
+    vals.resize(1000);
+    for (std::size_t i = 0; i < vals.size(); i++) {
+      vals[i] = 0.5 * i - 3.0;
+    }
+    ids.resize(77);
+    for (std::size_t i = 0; i < ids.size(); i++) {
+      ids[i] = 3 * i + 1;
+    }
+    cvals = {{1.0, -2.0}, {0.0, 3.5}};
+
+    view = MultiArrayNew<double *[3]>("view", 10);
+    for (index_t i = 0; i < 10; i++) {
+      for (index_t j = 0; j < 3; j++) {
+        view(i, j) = 10.0 * i + j;
+      }
+    }
+
+    CheckpointWriter writer(filename);
+    writer.write("vals", vals);
+    writer.write("ids", ids);
+    writer.write("cvals", cvals);
+    writer.write_view("view", view);
+    writer.write_scalar("step", 42);
+    writer.write("empty", std::vector<double>());
+  }
+
+  void TearDown() override { std::remove(filename.c_str()); }
+
+  // Read the whole file
+  std::string read_file() {
+    std::ifstream ifs(filename, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(ifs), {});
+  }
+
+  // Replace the file contents
+  void write_file(const std::string &contents) {
+    std::ofstream ofs(filename, std::ios::binary | std::ios::trunc);
+    ofs.write(contents.data(), contents.size());
+  }
+
+  std::string filename;
+  std::vector<double> vals;
+  std::vector<index_t> ids;
+  std::vector<std::complex<double>> cvals;
+  MultiArrayNew<double *[3]> view;
+};
+
+TEST_F(CheckpointTest, RoundTrip) {
+  CheckpointReader reader(filename);
+  EXPECT_EQ(reader.get_version(), CheckpointFormat::version);
+  EXPECT_TRUE(reader.has("vals"));
+  EXPECT_FALSE(reader.has("missing"));
+
+  std::vector<double> vals_in;
+  reader.read("vals", vals_in);
+  EXPECT_VEC_EQ(vals.size(), vals_in, vals);
+
+  std::size_t count;
+  const index_t *ids_in = reader.get<index_t>("ids", &count);
+  EXPECT_EQ(count, ids.size());
+  EXPECT_VEC_EQ(ids.size(), ids_in, ids);
+
+  std::vector<std::complex<double>> cvals_in;
+  reader.read("cvals", cvals_in);
+  ASSERT_EQ(cvals_in.size(), cvals.size());
+  for (std::size_t i = 0; i < cvals.size(); i++) {
+    EXPECT_EQ(cvals_in[i], cvals[i]);
+  }
+
+  MultiArrayNew<double *[3]> view_in("view_in", 10);
+  reader.read_view("view", view_in);
+  for (index_t i = 0; i < 10; i++) {
+    for (index_t j = 0; j < 3; j++) {
+      EXPECT_EQ(view_in(i, j), view(i, j));
+    }
+  }
+
+  EXPECT_EQ(reader.read_scalar<int>("step"), 42);
+  EXPECT_EQ(reader.get_count<double>("empty"), 0);
+}
+
+TEST_F(CheckpointTest, WrongAccess) {
+  CheckpointReader reader(filename);
+  EXPECT_THROW(reader.get<double>("missing"), std::runtime_error);
+  EXPECT_THROW(reader.get<float>("vals"), std::runtime_error);
+
+  std::vector<double> short_vals(10);
+  EXPECT_THROW(reader.read("vals", short_vals.data(), short_vals.size()),
+               std::runtime_error);
+}
+
+TEST_F(CheckpointTest, MissingFile) {
+  EXPECT_THROW(CheckpointReader reader("no_such_checkpoint.a2d"),
+               std::runtime_error);
+}
+
+TEST_F(CheckpointTest, BadMagic) {
+  std::string contents = read_file();
+  contents[0] = 'X';
+  write_file(contents);
+  EXPECT_THROW(CheckpointReader reader(filename), std::runtime_error);
+}
+
+TEST_F(CheckpointTest, UnsupportedVersion) {
+  std::string contents = read_file();
+  CheckpointFormat::Header header;
+  std::memcpy(&header, contents.data(), sizeof(header));
+  header.version = CheckpointFormat::version + 1;
+  std::memcpy(&contents[0], &header, sizeof(header));
+  write_file(contents);
+  EXPECT_THROW(CheckpointReader reader(filename), std::runtime_error);
+}
+
+TEST_F(CheckpointTest, TruncatedHeader) {
+  write_file(read_file().substr(0, sizeof(CheckpointFormat::Header) / 2));
+  EXPECT_THROW(CheckpointReader reader(filename), std::runtime_error);
+}
+
+TEST_F(CheckpointTest, TruncatedContents) {
+  std::string contents = read_file();
+  write_file(contents.substr(0, contents.size() - 1));
+  EXPECT_THROW(CheckpointReader reader(filename), std::runtime_error);
+}
+
+TEST_F(CheckpointTest, CorruptedSectionOffset) {
+  std::string contents = read_file();
+  CheckpointFormat::Header header;
+  std::memcpy(&header, contents.data(), sizeof(header));
+
+  // Point the first section past the table of contents
+  CheckpointFormat::Section s;
+  std::memcpy(&s, contents.data() + header.contents_offset, sizeof(s));
+  s.offset = header.contents_offset;
+  std::memcpy(&contents[header.contents_offset], &s, sizeof(s));
+  write_file(contents);
+  EXPECT_THROW(CheckpointReader reader(filename), std::runtime_error);
+}
+
+TEST_F(CheckpointTest, CloseFailure) {
+  // Writes to /dev/full fail once the buffered data is flushed
+  if (!std::ifstream("/dev/full")) {
+    GTEST_SKIP() << "/dev/full is not available";
+  }
+  CheckpointWriter writer("/dev/full");
+  writer.write_scalar("step", 42);
+  EXPECT_THROW(writer.close(), std::runtime_error);
+}
+
+/*
+  Round trips of the objects that save themselves to a checkpoint. The
+  restored objects are compared entry by entry with the originals.
+*/
+class CheckpointObjectTest : public ::testing::Test {
+ protected:
+  using T = double;
+  using Basis = FEBasis<T, LagrangeH1HexBasis<T, 2, 2>,
+                        LagrangeL2HexBasis<T, 1, 1>>;
+
+  void SetUp() override { filename = "test_checkpoint_objects.a2d"; }
+  void TearDown() override { std::remove(filename.c_str()); }
+
+  // A brick of nx^3 linear hexahedra with a labeled face
+  std::unique_ptr<MeshConnectivity3D> create_conn(index_t nx) {
+    index_t nverts = (nx + 1) * (nx + 1) * (nx + 1);
+    index_t nhex = nx * nx * nx;
+    std::vector<index_t> hex(8 * nhex);
+    std::vector<double> Xloc(3 * nverts);
+    MesherBrick3D mesher(nx, nx, nx, 1.0, 1.0, 1.0);
+    mesher.set_X_conn<index_t, double>(Xloc.data(), hex.data());
+
+    index_t z = 0;
+    index_t *null = nullptr;
+    auto conn = std::make_unique<MeshConnectivity3D>(
+        nverts, z, null, nhex, hex.data(), z, null, z, null);
+
+    std::vector<index_t> verts;
+    for (index_t k = 0; k < nx + 1; k++) {
+      for (index_t j = 0; j < nx + 1; j++) {
+        verts.push_back(j * (nx + 1) + k * (nx + 1) * (nx + 1));
+      }
+    }
+    conn->add_boundary_label_from_verts(verts.size(), verts.data());
+    return conn;
+  }
+
+  // The shifted 5-point Laplacian on an n x n grid
+  std::shared_ptr<BSRMat<T, 1, 1>> create_laplacian(index_t n) {
+    std::vector<index_t> rowp(1, 0), cols;
+    for (index_t i = 0; i < n; i++) {
+      for (index_t j = 0; j < n; j++) {
+        const index_t row = i * n + j;
+        if (i > 0) cols.push_back(row - n);
+        if (j > 0) cols.push_back(row - 1);
+        cols.push_back(row);
+        if (j < n - 1) cols.push_back(row + 1);
+        if (i < n - 1) cols.push_back(row + n);
+        rowp.push_back(cols.size());
+      }
+    }
+
+    auto A = std::make_shared<BSRMat<T, 1, 1>>(n * n, n * n, cols.size(),
+                                               rowp, cols);
+    for (index_t i = 0; i < n * n; i++) {
+      for (index_t jp = A->rowp[i]; jp < A->rowp[i + 1]; jp++) {
+        A->vals(jp, 0, 0) = (A->cols[jp] == i ? 4.01 : -1.0);
+      }
+    }
+    return A;
+  }
+
+  template <class MatType>
+  void expect_bsr_eq(const MatType &A, const MatType &B) {
+    ASSERT_EQ(A.nbrows, B.nbrows);
+    ASSERT_EQ(A.nbcols, B.nbcols);
+    ASSERT_EQ(A.nnz, B.nnz);
+    EXPECT_EQ(A.num_colors, B.num_colors);
+    EXPECT_VEC_EQ(A.nbrows + 1, A.rowp, B.rowp);
+    EXPECT_VEC_EQ(A.nnz, A.cols, B.cols);
+    EXPECT_VEC_EQ(A.diag.extent(0), A.diag, B.diag);
+    EXPECT_VEC_EQ(A.perm.extent(0), A.perm, B.perm);
+    EXPECT_VEC_EQ(A.iperm.extent(0), A.iperm, B.iperm);
+    EXPECT_VEC_EQ(A.color_count.extent(0), A.color_count, B.color_count);
+    ASSERT_EQ(A.vals.span(), B.vals.span());
+    EXPECT_VEC_EQ(A.vals.span(), A.vals.data(), B.vals.data());
+  }
+
+  std::string filename;
+};
+
+TEST_F(CheckpointObjectTest, MeshConnectivity) {
+  auto conn = create_conn(3);
+  {
+    CheckpointWriter writer(filename);
+    conn->save(writer);
+    writer.close();
+  }
+
+  CheckpointReader reader(filename);
+  MeshConnectivity3D conn_in(reader);
+  ASSERT_EQ(conn_in.get_num_elements(), conn->get_num_elements());
+  ASSERT_EQ(conn_in.get_num_verts(), conn->get_num_verts());
+  ASSERT_EQ(conn_in.get_num_bounds(), conn->get_num_bounds());
+  ASSERT_EQ(conn_in.get_num_edges(), conn->get_num_edges());
+  ASSERT_EQ(conn_in.get_num_boundary_labels(),
+            conn->get_num_boundary_labels());
+
+  for (index_t e = 0; e < conn->get_num_elements(); e++) {
+    const index_t *a, *b;
+    index_t n = conn->get_element_verts(e, &a);
+    ASSERT_EQ(conn_in.get_element_verts(e, &b), n);
+    EXPECT_VEC_EQ(n, a, b);
+    n = conn->get_element_bounds(e, &a);
+    ASSERT_EQ(conn_in.get_element_bounds(e, &b), n);
+    EXPECT_VEC_EQ(n, a, b);
+    n = conn->get_element_edges(e, &a);
+    ASSERT_EQ(conn_in.get_element_edges(e, &b), n);
+    EXPECT_VEC_EQ(n, a, b);
+  }
+
+  const index_t *bounds, *labels, *bounds_in, *labels_in;
+  index_t nb = conn->get_boundary_bounds(&bounds, &labels);
+  ASSERT_EQ(conn_in.get_boundary_bounds(&bounds_in, &labels_in), nb);
+  EXPECT_VEC_EQ(nb, bounds, bounds_in);
+  EXPECT_VEC_EQ(nb, labels, labels_in);
+}
+
+TEST_F(CheckpointObjectTest, ElementMesh) {
+  auto conn = create_conn(3);
+  ElementMesh<Basis> mesh(*conn, DofOrdering::RCM);
+  {
+    CheckpointWriter writer(filename);
+    mesh.save(writer);
+    writer.close();
+  }
+
+  CheckpointReader reader(filename);
+  ElementMesh<Basis> mesh_in(reader);
+  ASSERT_EQ(mesh_in.get_num_elements(), mesh.get_num_elements());
+  ASSERT_EQ(mesh_in.get_num_dof(), mesh.get_num_dof());
+  for (index_t b = 0; b < Basis::nbasis; b++) {
+    EXPECT_EQ(mesh_in.get_num_cumulative_dof(b),
+              mesh.get_num_cumulative_dof(b));
+  }
+  ASSERT_FALSE(mesh.get_dof_permutation().empty());
+  EXPECT_EQ(mesh_in.get_dof_permutation(), mesh.get_dof_permutation());
+
+  for (index_t e = 0; e < mesh.get_num_elements(); e++) {
+    const index_t *dof, *dof_in;
+    const int *signs, *signs_in;
+    mesh.get_element_dof(e, &dof);
+    mesh_in.get_element_dof(e, &dof_in);
+    mesh.get_element_signs(e, &signs);
+    mesh_in.get_element_signs(e, &signs_in);
+    EXPECT_VEC_EQ(Basis::ndof, dof, dof_in);
+    EXPECT_VEC_EQ(Basis::ndof, signs, signs_in);
+  }
+}
+
+TEST_F(CheckpointObjectTest, BSRMat) {
+  auto A = create_laplacian(10);
+  BSRMatMultiColorOrder(*A);
+  {
+    CheckpointWriter writer(filename);
+    BSRMatSave(writer, "A", *A);
+    BSRMatSave(writer, "pattern", *A, false);
+    writer.close();
+  }
+
+  CheckpointReader reader(filename);
+  std::unique_ptr<BSRMat<T, 1, 1>> A_in(BSRMatLoad<T, 1, 1>(reader, "A"));
+  ASSERT_GT(A->num_colors, 0);
+  expect_bsr_eq(*A, *A_in);
+
+  // Without the values, the pattern is restored with zero entries
+  std::unique_ptr<BSRMat<T, 1, 1>> P_in(
+      BSRMatLoad<T, 1, 1>(reader, "pattern"));
+  EXPECT_VEC_EQ(A->nnz, A->cols, P_in->cols);
+  for (index_t jp = 0; jp < A->nnz; jp++) {
+    EXPECT_EQ(P_in->vals(jp, 0, 0), 0.0);
+  }
+
+  EXPECT_THROW((BSRMatLoad<T, 2, 2>(reader, "A")), std::runtime_error);
+}
+
+TEST_F(CheckpointObjectTest, BSRMatAmg) {
+  const int num_levels = 3;
+  const T omega = 0.5, epsilon = 0.01;
+  auto A = create_laplacian(16);
+  MultiArrayNew<T *[1][1]> B("B", A->nbrows);
+  for (index_t i = 0; i < A->nbrows; i++) {
+    B(i, 0, 0) = 1.0;
+  }
+
+  BSRMatAmg<T, 1, 1> amg(num_levels, omega, epsilon, A, B);
+  ASSERT_EQ(amg.get_num_levels(), num_levels);
+  {
+    CheckpointWriter writer(filename);
+    amg.save(writer);
+    writer.close();
+  }
+
+  // Restore the hierarchy on a copy of the matrix
+  CheckpointReader reader(filename);
+  auto A_in = create_laplacian(16);
+  BSRMatAmg<T, 1, 1> amg_in(num_levels, omega, epsilon, A_in, B, reader);
+  ASSERT_EQ(amg_in.get_num_levels(), num_levels);
+
+  // The saved prolongation of each level is restored exactly
+  for (int level = 0; level < num_levels - 1; level++) {
+    std::string name = "amg/level" + std::to_string(level) + "/P";
+    std::unique_ptr<BSRMat<T, 1, 1>> P(BSRMatLoad<T, 1, 1>(reader, name));
+    EXPECT_GT(P->nnz, 0);
+    EXPECT_LT(P->nbcols, P->nbrows);
+  }
+
+  // The multigrid cycles match
+  MultiArrayNew<T *[1]> b("b", A->nbrows), x("x", A->nbrows),
+      x_in("x_in", A->nbrows);
+  for (index_t i = 0; i < A->nbrows; i++) {
+    b(i, 0) = std::cos(0.37 * i);
+  }
+  amg.applyFactor(b, x);
+  amg_in.applyFactor(b, x_in);
+
+  double max_x = 0.0;
+  for (index_t i = 0; i < A->nbrows; i++) {
+    max_x = std::max(max_x, std::fabs(x(i, 0)));
+    EXPECT_NEAR(x_in(i, 0), x(i, 0), 1e-12 * std::fabs(x(i, 0)) + 1e-14);
+  }
+  EXPECT_GT(max_x, 0.0);
+
+  // A checkpoint with a different number of levels is rejected
+  auto A_bad = create_laplacian(16);
+  EXPECT_THROW((BSRMatAmg<T, 1, 1>(num_levels + 1, omega, epsilon, A_bad, B,
+                                   reader)),
+               std::runtime_error);
+}
@@ -0,0 +1,491 @@
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "multiphysics/hex_tools.h"
+#include "test_commons.h"
+#include "utils/a2dmesh.h"
+#include "utils/a2dvtk.h"
+
+using namespace A2D;
+
+class Environment : public ::testing::Environment {
+ public:
+  void SetUp() override { Kokkos::initialize(); }
+  void TearDown() override { Kokkos::finalize(); }
+};
+
+// Create a new environment and initialize kokkos
+::testing::Environment *const initialize_kokkos =
+    ::testing::AddGlobalTestEnvironment(new Environment);
+
+// Write the given contents to a file
+void write_file(const std::string &name, const std::string &contents) {
+  std::FILE *fp = std::fopen(name.c_str(), "w");
+  ASSERT_NE(fp, nullptr);
+  std::fputs(contents.c_str(), fp);
+  std::fclose(fp);
+}
+
+TEST(VTKReaderTest, RoundTrip) {
+  using ConnArray = MultiArrayNew<index_t *[8]>;
+  using NodeArray = MultiArrayNew<double *[3]>;
+  using SolArray = MultiArrayNew<double *>;
+
+  // A 3 x 2 x 2 brick of hexahedra written with ToVTK, with a nodal solution
+  // after the mesh
+  const index_t nx = 3, ny = 2, nz = 2;
+  const index_t nverts = (nx + 1) * (ny + 1) * (nz + 1), nhex = nx * ny * nz;
+  std::vector<index_t> hex(8 * nhex);
+  std::vector<double> Xloc(3 * nverts);
+  MesherBrick3D mesher(nx, ny, nz, 1.5, 1.0, 0.5);
+  mesher.set_X_conn<index_t, double>(Xloc.data(), hex.data());
+
+  ConnArray conn("conn", nhex);
+  NodeArray X("X", nverts);
+  SolArray sol("sol", nverts);
+  for (index_t e = 0; e < nhex; e++) {
+    for (index_t j = 0; j < 8; j++) {
+      conn(e, j) = hex[8 * e + j];
+    }
+  }
+  for (index_t i = 0; i < nverts; i++) {
+    for (index_t k = 0; k < 3; k++) {
+      X(i, k) = Xloc[3 * i + k] + 0.01 * std::sin(1.0 + i + k);
+    }
+    sol(i) = std::cos(0.3 * i);
+  }
+
+  std::string name = "test_vtk_round_trip.vtk";
+  {
+    ToVTK<ConnArray, NodeArray> vtk(conn, X, -1, name);
+    vtk.write_mesh();
+    vtk.write_sol("sol", sol);
+  }
+
+  VTKLegacyReader reader(name);
+  EXPECT_FALSE(reader.is_binary());
+  ASSERT_EQ(reader.get_num_points(), nverts);
+  ASSERT_EQ(reader.get_num_cells(), nhex);
+  EXPECT_FALSE(reader.has_cell_entity_ids());
+  for (index_t i = 0; i < nverts; i++) {
+    for (index_t k = 0; k < 3; k++) {
+      EXPECT_NEAR(reader.get_points()[3 * i + k], X(i, k), 1e-14);
+    }
+  }
+  for (index_t e = 0; e < nhex; e++) {
+    EXPECT_EQ(reader.get_cell_types()[e], VTKID::HEXAHEDRON);
+    ASSERT_EQ(reader.get_cell_nverts(e), 8);
+    const index_t *verts = &hex[8 * e];
+    EXPECT_VEC_EQ(8, reader.get_cell_verts(e), verts);
+  }
+
+  // The same file through ReadVTK
+  ReadVTK<8, 3, double, index_t> readvtk(name);
+  std::remove(name.c_str());
+  ConnArray conn2("conn2", nhex);
+  NodeArray X2("X2", nverts);
+  readvtk.set_conn(conn2);
+  readvtk.set_X(X2);
+  for (index_t e = 0; e < nhex; e++) {
+    for (index_t j = 0; j < 8; j++) {
+      EXPECT_EQ(conn2(e, j), conn(e, j));
+    }
+  }
+  for (index_t i = 0; i < nverts; i++) {
+    for (index_t k = 0; k < 3; k++) {
+      EXPECT_NEAR(X2(i, k), X(i, k), 1e-14);
+    }
+  }
+}
+
+TEST(VTKReaderTest, NonFiniteValues) {
+  // Values such as NaN and INF start with an uppercase letter but do not end
+  // the section, while the FIELD keyword after the cell entity ids does
+  std::string name = "test_vtk_non_finite.vtk";
+  write_file(name,
+             "# vtk DataFile Version 3.0\n"
+             "non-finite values\n"
+             "ASCII\n"
+             "DATASET UNSTRUCTURED_GRID\n"
+             "POINTS 4 double\n"
+             "0.0 0.0 0.0\n"
+             "NaN 1.0 0.0\n"
+             "INF -Infinity 0.0\n"
+             "1.0 nan inf\n"
+             "CELLS 1 5\n"
+             "4 0 1 2 3\n"
+             "CELL_TYPES 1\n"
+             "10\n"
+             "CELL_DATA 1\n"
+             "SCALARS CellEntityIds int 1\n"
+             "LOOKUP_TABLE default\n"
+             "7\n"
+             "FIELD FieldData 1\n"
+             "Temperature 1 1 double\n"
+             "1.5\n");
+
+  VTKLegacyReader reader(name);
+  std::remove(name.c_str());
+  ASSERT_EQ(reader.get_num_points(), 4);
+  const std::vector<double> &pts = reader.get_points();
+  EXPECT_TRUE(std::isnan(pts[3]));
+  EXPECT_TRUE(std::isinf(pts[6]) && pts[6] > 0.0);
+  EXPECT_TRUE(std::isinf(pts[7]) && pts[7] < 0.0);
+  EXPECT_TRUE(std::isnan(pts[10]));
+  EXPECT_TRUE(std::isinf(pts[11]));
+  EXPECT_EQ(reader.get_cell_types()[0], VTKID::TETRA);
+  ASSERT_TRUE(reader.has_cell_entity_ids());
+  EXPECT_EQ(reader.get_cell_entity_ids()[0], 7);
+}
+
+TEST(VTKReaderTest, InvalidSection) {
+  // An unknown word inside a section is reported rather than silently ending
+  // the section
+  std::string name = "test_vtk_invalid.vtk";
+  write_file(name,
+             "# vtk DataFile Version 3.0\n"
+             "invalid\n"
+             "ASCII\n"
+             "DATASET UNSTRUCTURED_GRID\n"
+             "POINTS 2 double\n"
+             "0.0 0.0 0.0\n"
+             "BAD 1.0 0.0\n"
+             "CELLS 1 3\n"
+             "2 0 1\n"
+             "CELL_TYPES 1\n"
+             "3\n");
+
+  EXPECT_THROW(VTKLegacyReader reader(name), std::runtime_error);
+  std::remove(name.c_str());
+}
+
+/*
+  Decoder for the VTU files written by ToVTU, returns the bytes of each
+  DataArray by name with the points stored as "Points"
+*/
+class VTUDecoder {
+ public:
+  VTUDecoder(const std::string &name) {
+    std::ifstream file(name, std::ios::binary);
+    std::stringstream ss;
+    ss << file.rdbuf();
+    text = ss.str();
+
+    compressed = text.find("vtkLZ4DataCompressor") != std::string::npos;
+    std::size_t appended = text.find("<AppendedData encoding=\"raw\">\n_");
+    if (appended != std::string::npos) {
+      appended = text.find('_', appended) + 1;
+    }
+
+    for (std::size_t pos = text.find("<DataArray"); pos < appended;
+         pos = text.find("<DataArray", pos + 1)) {
+      std::size_t tag_end = text.find('>', pos);
+      std::string tag = text.substr(pos, tag_end - pos);
+      std::string array_name = attribute(tag, "Name");
+      if (array_name.empty()) {
+        array_name = "Points";
+      }
+
+      std::vector<uint8_t> bytes;
+      if (appended != std::string::npos) {
+        std::size_t start = appended + std::stoull(attribute(tag, "offset"));
+        bytes = read_array(reinterpret_cast<const uint8_t *>(&text[start]));
+      } else {
+        std::size_t start = tag_end + 2;
+        std::size_t end = text.find("\n</DataArray>", start);
+        bytes = decode_binary(text.substr(start, end - start));
+      }
+      arrays[array_name] = bytes;
+    }
+  }
+
+  template <typename V>
+  std::vector<V> get(const std::string &name) {
+    std::vector<uint8_t> &bytes = arrays.at(name);
+    std::vector<V> values(bytes.size() / sizeof(V));
+    std::memcpy(values.data(), bytes.data(), bytes.size());
+    return values;
+  }
+
+  bool compressed;
+  std::string text;
+  std::map<std::string, std::vector<uint8_t>> arrays;
+
+ private:
+  static std::string attribute(const std::string &tag, const char *attr) {
+    std::string key = std::string(" ") + attr + "=\"";
+    std::size_t pos = tag.find(key);
+    if (pos == std::string::npos) {
+      return "";
+    }
+    pos += key.size();
+    return tag.substr(pos, tag.find('"', pos) - pos);
+  }
+
+  static std::vector<uint8_t> base64(const std::string &s) {
+    std::vector<uint8_t> out;
+    uint32_t b = 0;
+    int nbits = 0;
+    for (char c : s) {
+      int v;
+      if (c >= 'A' && c <= 'Z') {
+        v = c - 'A';
+      } else if (c >= 'a' && c <= 'z') {
+        v = c - 'a' + 26;
+      } else if (c >= '0' && c <= '9') {
+        v = c - '0' + 52;
+      } else if (c == '+') {
+        v = 62;
+      } else if (c == '/') {
+        v = 63;
+      } else {
+        continue;
+      }
+      b = (b << 6) | v;
+      nbits += 6;
+      if (nbits >= 8) {
+        nbits -= 8;
+        out.push_back(uint8_t(b >> nbits));
+      }
+    }
+    return out;
+  }
+
+  static std::vector<uint8_t> lz4_decompress(const uint8_t *src,
+                                             std::size_t size,
+                                             std::size_t out_size) {
+    std::vector<uint8_t> out;
+    out.reserve(out_size);
+    std::size_t ip = 0;
+    while (ip < size) {
+      uint8_t token = src[ip++];
+      std::size_t nliterals = token >> 4;
+      if (nliterals == 15) {
+        for (uint8_t b = 255; b == 255;) {
+          b = src[ip++];
+          nliterals += b;
+        }
+      }
+      out.insert(out.end(), src + ip, src + ip + nliterals);
+      ip += nliterals;
+      if (ip >= size) {
+        break;
+      }
+
+      std::size_t dist = src[ip] | (std::size_t(src[ip + 1]) << 8);
+      ip += 2;
+      std::size_t len = (token & 15);
+      if (len == 15) {
+        for (uint8_t b = 255; b == 255;) {
+          b = src[ip++];
+          len += b;
+        }
+      }
+      len += 4;
+      std::size_t start = out.size() - dist;
+      for (std::size_t k = 0; k < len; k++) {
+        out.push_back(out[start + k]);
+      }
+    }
+    EXPECT_EQ(out.size(), out_size);
+    return out;
+  }
+
+  // Read the header and the data of an array from the raw bytes
+  std::vector<uint8_t> read_array(const uint8_t *data) {
+    uint64_t nbytes;
+    std::memcpy(&nbytes, data, sizeof(nbytes));
+    if (!compressed) {
+      return std::vector<uint8_t>(data + 8, data + 8 + nbytes);
+    }
+    std::vector<uint64_t> hdr(3);
+    std::memcpy(hdr.data(), data, 3 * sizeof(uint64_t));
+    hdr.resize(3 + hdr[0]);
+    std::memcpy(hdr.data(), data, hdr.size() * sizeof(uint64_t));
+    return decompress(hdr, data + hdr.size() * sizeof(uint64_t));
+  }
+
+  std::vector<uint8_t> decompress(const std::vector<uint64_t> &hdr,
+                                  const uint8_t *payload) {
+    std::vector<uint8_t> out;
+    const uint64_t nblocks = hdr[0];
+    for (uint64_t k = 0, pos = 0; k < nblocks; k++) {
+      uint64_t size = (k + 1 < nblocks ? hdr[1] : hdr[2]);
+      std::vector<uint8_t> block =
+          lz4_decompress(payload + pos, hdr[3 + k], size);
+      out.insert(out.end(), block.begin(), block.end());
+      pos += hdr[3 + k];
+    }
+    return out;
+  }
+
+  // Decode an inline base64 array, the compressed header is encoded
+  // separately from the data
+  std::vector<uint8_t> decode_binary(const std::string &s) {
+    if (!compressed) {
+      std::vector<uint8_t> bytes = base64(s);
+      return read_array(bytes.data());
+    }
+    std::vector<uint8_t> first = base64(s.substr(0, 32));
+    uint64_t nblocks;
+    std::memcpy(&nblocks, first.data(), sizeof(nblocks));
+    std::size_t hdr_chars = 4 * ((8 * (3 + nblocks) + 2) / 3);
+    std::vector<uint8_t> hdr_bytes = base64(s.substr(0, hdr_chars));
+    std::vector<uint64_t> hdr(3 + nblocks);
+    std::memcpy(hdr.data(), hdr_bytes.data(), hdr.size() * sizeof(uint64_t));
+    std::vector<uint8_t> payload = base64(s.substr(hdr_chars));
+    return decompress(hdr, payload.data());
+  }
+};
+
+/*
+  Write a quad mesh with nodal and cell fields through ToVTU and check the
+  decoded arrays
+*/
+void check_vtu(VTUFormat format, VTUCompression compression) {
+  using ConnArray = MultiArrayNew<index_t *[4]>;
+  using NodeArray = MultiArrayNew<double *[2]>;
+  using SolArray = MultiArrayNew<double *>;
+
+  // Large enough for several compression blocks
+  const index_t nx = 60, ny = 50;
+  const index_t nnodes = (nx + 1) * (ny + 1), nelems = nx * ny;
+  ConnArray conn("conn", nelems);
+  NodeArray X("X", nnodes);
+  SolArray u("u", nnodes), c("c", nelems);
+  for (index_t j = 0; j < ny + 1; j++) {
+    for (index_t i = 0; i < nx + 1; i++) {
+      index_t n = i + (nx + 1) * j;
+      X(n, 0) = 0.1 * i;
+      X(n, 1) = 0.2 * j;
+      u(n) = std::sin(0.01 * n);
+    }
+  }
+  for (index_t j = 0; j < ny; j++) {
+    for (index_t i = 0; i < nx; i++) {
+      index_t e = i + nx * j, n = i + (nx + 1) * j;
+      conn(e, 0) = n;
+      conn(e, 1) = n + 1;
+      conn(e, 2) = n + nx + 2;
+      conn(e, 3) = n + nx + 1;
+      c(e) = e % 7;
+    }
+  }
+
+  std::string name = "test_vtk.vtu";
+  {
+    ToVTU vtu(name, format, compression);
+    vtu.write_mesh(conn, X);
+    vtu.write_cell_sol("c", c);
+    vtu.write_sol("u", u);
+  }
+
+  VTUDecoder decoder(name);
+  std::remove(name.c_str());
+  EXPECT_EQ(decoder.compressed, compression == VTUCompression::LZ4);
+  EXPECT_EQ(decoder.text.find("<PointData>"),
+            decoder.text.rfind("<PointData>"));
+
+  std::vector<double> xyz = decoder.get<double>("Points");
+  std::vector<int32_t> connectivity = decoder.get<int32_t>("connectivity");
+  std::vector<int32_t> offsets = decoder.get<int32_t>("offsets");
+  std::vector<uint8_t> types = decoder.get<uint8_t>("types");
+  std::vector<double> uvals = decoder.get<double>("u");
+  std::vector<double> cvals = decoder.get<double>("c");
+  ASSERT_EQ(xyz.size(), 3 * nnodes);
+  ASSERT_EQ(connectivity.size(), 4 * nelems);
+  ASSERT_EQ(offsets.size(), nelems);
+  ASSERT_EQ(types.size(), nelems);
+  ASSERT_EQ(uvals.size(), nnodes);
+  ASSERT_EQ(cvals.size(), nelems);
+
+  for (index_t n = 0; n < nnodes; n++) {
+    EXPECT_EQ(xyz[3 * n], X(n, 0));
+    EXPECT_EQ(xyz[3 * n + 1], X(n, 1));
+    EXPECT_EQ(xyz[3 * n + 2], 0.0);
+    EXPECT_EQ(uvals[n], u(n));
+  }
+  for (index_t e = 0; e < nelems; e++) {
+    for (index_t j = 0; j < 4; j++) {
+      EXPECT_EQ(connectivity[4 * e + j], int32_t(conn(e, j)));
+    }
+    EXPECT_EQ(offsets[e], int32_t(4 * (e + 1)));
+    EXPECT_EQ(types[e], VTKID::QUAD);
+    EXPECT_EQ(cvals[e], c(e));
+  }
+}
+
+TEST(VTUWriterTest, Appended) {
+  check_vtu(VTUFormat::APPENDED, VTUCompression::NONE);
+}
+
+TEST(VTUWriterTest, AppendedLZ4) {
+  check_vtu(VTUFormat::APPENDED, VTUCompression::LZ4);
+}
+
+TEST(VTUWriterTest, Binary) {
+  check_vtu(VTUFormat::BINARY, VTUCompression::NONE);
+}
+
+TEST(VTUWriterTest, BinaryLZ4) {
+  check_vtu(VTUFormat::BINARY, VTUCompression::LZ4);
+}
+
+TEST(VTUWriterTest, WriteOutputs) {
+  // The format and compression are passed through by write_vtk_outputs(),
+  // which is used by write_hex_to_vtk() and write_quad_to_vtk()
+  using ConnArray = MultiArrayNew<int *[8]>;
+  using NodeArray = MultiArrayNew<double *[3]>;
+  using OutputArray = MultiArrayNew<double *[2]>;
+
+  const index_t nx = 4, ny = 3, nz = 2;
+  const index_t nverts = (nx + 1) * (ny + 1) * (nz + 1), nhex = nx * ny * nz;
+  std::vector<index_t> hex(8 * nhex);
+  std::vector<double> Xloc(3 * nverts);
+  MesherBrick3D mesher(nx, ny, nz, 1.0, 1.0, 1.0);
+  mesher.set_X_conn<index_t, double>(Xloc.data(), hex.data());
+
+  ConnArray conn("conn", nhex);
+  NodeArray X("X", nverts);
+  OutputArray outputs("outputs", nverts);
+  for (index_t e = 0; e < nhex; e++) {
+    for (index_t j = 0; j < 8; j++) {
+      conn(e, j) = hex[8 * e + j];
+    }
+  }
+  for (index_t i = 0; i < nverts; i++) {
+    for (index_t k = 0; k < 3; k++) {
+      X(i, k) = Xloc[3 * i + k];
+    }
+    outputs(i, 0) = i;
+    outputs(i, 1) = -2.0 * i;
+  }
+
+  std::string name = "test_vtk_outputs.vtu";
+  write_vtk_outputs<2>(name, conn, X, outputs, VTUFormat::BINARY,
+                       VTUCompression::LZ4);
+
+  VTUDecoder decoder(name);
+  std::remove(name.c_str());
+  EXPECT_TRUE(decoder.compressed);
+  EXPECT_EQ(decoder.text.find("AppendedData"), std::string::npos);
+  std::vector<double> xyz = decoder.get<double>("Points");
+  std::vector<double> sol1 = decoder.get<double>("solution1");
+  std::vector<double> sol2 = decoder.get<double>("solution2");
+  ASSERT_EQ(sol1.size(), nverts);
+  ASSERT_EQ(sol2.size(), nverts);
+  for (index_t i = 0; i < nverts; i++) {
+    for (index_t k = 0; k < 3; k++) {
+      EXPECT_EQ(xyz[3 * i + k], Xloc[3 * i + k]);
+    }
+    EXPECT_EQ(sol1[i], outputs(i, 0));
+    EXPECT_EQ(sol2[i], outputs(i, 1));
+  }
+}